@@ -0,0 +1,80 @@
+// Batched event ingestion benchmark: events/sec through
+// PortManager::process_port_events as a function of batch size, against the
+// one-call-per-event path.
+//
+// Usage: bench_batch_ingest [num_ports] [total_events] (defaults 65536, 4000000)
+
+#include "bench_util.h"
+#include "logger.h"
+#include "port_manager.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace control_plane;
+using namespace control_plane::bench;
+
+namespace {
+
+// Heartbeat-sweep shaped workload: walk the ports in order, bringing each up
+// and then heartbeating it
+std::vector<PortEventRecord> make_workload(int num_ports, size_t total_events) {
+    static const PortEvent cycle[] = {PortEvent::POWER_ON, PortEvent::INIT_COMPLETE,
+                                      PortEvent::HEARTBEAT_OK, PortEvent::HEARTBEAT_OK};
+    std::vector<PortEventRecord> records(total_events);
+    for (size_t i = 0; i < total_events; i++) {
+        int port_id = static_cast<int>(i % num_ports);
+        size_t pass = i / num_ports;
+        records[i] = {port_id, cycle[pass % 4]};
+    }
+    return records;
+}
+
+double run_single(PortSyncMode mode, int num_ports, const std::vector<PortEventRecord>& records) {
+    PortManager manager(num_ports, mode);
+    Stopwatch timer;
+    for (const auto& record : records) {
+        manager.process_port_event(record.port_id, record.event);
+    }
+    return records.size() / timer.elapsed_s();
+}
+
+double run_batched(PortSyncMode mode, int num_ports, const std::vector<PortEventRecord>& records,
+                   size_t batch_size) {
+    PortManager manager(num_ports, mode);
+    std::vector<PortEventResult> results(batch_size);
+    Stopwatch timer;
+    for (size_t begin = 0; begin < records.size(); begin += batch_size) {
+        size_t count = std::min(batch_size, records.size() - begin);
+        manager.process_port_events(records.data() + begin, count, results.data());
+    }
+    return records.size() / timer.elapsed_s();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int num_ports = argc > 1 ? std::atoi(argv[1]) : 65536;
+    size_t total_events = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4000000;
+    Logger::instance().set_level(LogLevel::ERROR);
+
+    auto records = make_workload(num_ports, total_events);
+    std::cout << "Batch ingestion benchmark: " << num_ports << " ports, "
+              << total_events << " events\n\n";
+
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << std::left << std::setw(14) << "batch size"
+              << std::setw(16) << "mutex ev/s" << "lock_free ev/s\n";
+    std::cout << std::setw(14) << "unbatched"
+              << std::setw(16) << run_single(PortSyncMode::MUTEX, num_ports, records)
+              << run_single(PortSyncMode::LOCK_FREE, num_ports, records) << "\n";
+
+    for (size_t batch_size = 1; batch_size <= 16384; batch_size *= 4) {
+        std::cout << std::setw(14) << batch_size
+                  << std::setw(16) << run_batched(PortSyncMode::MUTEX, num_ports, records, batch_size)
+                  << run_batched(PortSyncMode::LOCK_FREE, num_ports, records, batch_size) << "\n";
+    }
+
+    return 0;
+}
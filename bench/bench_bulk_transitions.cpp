@@ -0,0 +1,92 @@
+// Chassis-wide event benchmark: ports/sec for one event applied to every
+// port, through the raw transition kernel (AVX2 and scalar), through
+// PortManager::process_port_event_range, and through one
+// process_port_event call per port.
+//
+// Usage: bench_bulk_transitions [num_ports] [rounds] (defaults 1048576, 20)
+
+#include "bench_util.h"
+#include "logger.h"
+#include "port_manager.h"
+#include "transition_kernel.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace control_plane;
+using namespace control_plane::bench;
+
+namespace {
+
+// Every round brings all ports up and flaps them again
+const PortEvent kCycle[] = {PortEvent::POWER_ON, PortEvent::INIT_COMPLETE,
+                            PortEvent::HEARTBEAT_OK, PortEvent::LINK_FLAP};
+
+template <typename Kernel>
+double run_kernel(Kernel kernel, int num_ports, int rounds) {
+    std::vector<uint64_t> words(num_ports, PortTable::make_word(PortState::DOWN, 0, 0));
+    std::vector<uint64_t> mask((num_ports + 63) / 64);
+    uint64_t transitions = 0;
+    Stopwatch timer;
+    for (int round = 0; round < rounds; round++) {
+        for (PortEvent event : kCycle) {
+            transitions += kernel(words.data(), words.size(), event, mask.data()).transitions;
+        }
+    }
+    double seconds = timer.elapsed_s();
+    do_not_optimize(transitions);
+    return static_cast<double>(num_ports) * rounds * 4 / seconds;
+}
+
+double run_range(PortSyncMode mode, int num_ports, int rounds) {
+    PortManager manager(num_ports, mode);
+    Stopwatch timer;
+    for (int round = 0; round < rounds; round++) {
+        for (PortEvent event : kCycle) {
+            manager.process_port_event_range(0, num_ports, event);
+        }
+    }
+    return static_cast<double>(num_ports) * rounds * 4 / timer.elapsed_s();
+}
+
+double run_per_port(PortSyncMode mode, int num_ports, int rounds) {
+    PortManager manager(num_ports, mode);
+    Stopwatch timer;
+    for (int round = 0; round < rounds; round++) {
+        for (PortEvent event : kCycle) {
+            for (int port_id = 0; port_id < num_ports; port_id++) {
+                manager.process_port_event(port_id, event);
+            }
+        }
+    }
+    return static_cast<double>(num_ports) * rounds * 4 / timer.elapsed_s();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int num_ports = argc > 1 ? std::atoi(argv[1]) : 1048576;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+    Logger::instance().set_level(LogLevel::ERROR);
+
+    std::cout << "Bulk transition benchmark: " << num_ports << " ports, " << rounds
+              << " rounds of " << sizeof(kCycle) / sizeof(kCycle[0]) << " events\n"
+              << "AVX2 kernel: " << (transition_kernel_uses_avx2() ? "yes" : "no") << "\n\n";
+
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << std::left << std::setw(28) << "path" << "ports/s\n";
+    std::cout << std::setw(28) << "kernel (dispatch)"
+              << run_kernel(apply_event_to_words, num_ports, rounds) << "\n";
+    std::cout << std::setw(28) << "kernel (scalar)"
+              << run_kernel(apply_event_to_words_scalar, num_ports, rounds) << "\n";
+    std::cout << std::setw(28) << "range, mutex"
+              << run_range(PortSyncMode::MUTEX, num_ports, rounds) << "\n";
+    std::cout << std::setw(28) << "range, lock_free"
+              << run_range(PortSyncMode::LOCK_FREE, num_ports, rounds) << "\n";
+    // The per-port path is far slower; one round is plenty
+    std::cout << std::setw(28) << "per-port calls, mutex"
+              << run_per_port(PortSyncMode::MUTEX, num_ports, 1) << "\n";
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+// Discrete-event mode benchmark: simulated days per wall-clock second over a
+// sweep of flap probabilities, at the default 100 ms tick.
+//
+// Usage: bench_discrete [num_ports] [simulated_hours] [seed]
+//        (defaults 1000, 24, 1)
+
+#include "bench_util.h"
+#include "event_loop.h"
+#include "logger.h"
+#include "port_manager.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+using namespace control_plane;
+using namespace control_plane::bench;
+
+int main(int argc, char** argv) {
+    int num_ports = argc > 1 ? std::atoi(argv[1]) : 1000;
+    double hours = argc > 2 ? std::atof(argv[2]) : 24.0;
+    uint32_t seed = argc > 3 ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 1;
+    Logger::instance().set_level(LogLevel::ERROR);
+
+    Config config;
+    config.ports_count = num_ports;
+    config.mode = "discrete";
+    config.seed = seed;
+    config.duration_ticks = static_cast<uint64_t>(hours * 3600.0 * 1000.0 / config.tick_ms);
+
+    std::cout << "Discrete mode: " << num_ports << " ports, " << hours << " simulated hours ("
+              << config.duration_ticks << " ticks of " << config.tick_ms << " ms)\n\n";
+    std::cout << std::left << std::setw(12) << "flap prob" << std::setw(14) << "events"
+              << std::setw(12) << "flaps" << std::setw(12) << "wall s" << std::setw(14) << "speedup"
+              << "trace\n";
+
+    for (double probability : {0.0001, 0.001, 0.01, 0.1}) {
+        config.flap_probability = probability;
+        auto port_manager = std::make_shared<PortManager>(num_ports);
+        EventLoop loop(port_manager, config);
+
+        Stopwatch timer;
+        loop.start();
+        while (!loop.is_finished()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        double seconds = timer.elapsed_s();
+        loop.stop();
+
+        std::cout << std::left << std::setw(12) << probability << std::setw(14)
+                  << port_manager->get_total_events_processed() << std::setw(12)
+                  << port_manager->get_metrics().get_counter("link_flaps_injected_total")
+                  << std::fixed << std::setprecision(2) << std::setw(12) << seconds
+                  << std::setprecision(0) << std::setw(14) << hours * 3600.0 / seconds
+                  << loop.get_trace().hash_string() << "\n" << std::defaultfloat;
+    }
+    return 0;
+}
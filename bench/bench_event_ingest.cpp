@@ -0,0 +1,87 @@
+// Event ingestion benchmark: events/sec through ingest_events() for NDJSON
+// and packed binary bodies (the POST /events path minus HTTP), against
+// PortManager::process_port_events on pre-built records.
+//
+// Usage: bench_event_ingest [num_ports] [num_events] (defaults 1000, 1000000)
+
+#include "bench_util.h"
+#include "event_ingest.h"
+#include "logger.h"
+#include "port_manager.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace control_plane;
+using namespace control_plane::bench;
+
+int main(int argc, char** argv) {
+    int num_ports = argc > 1 ? std::atoi(argv[1]) : 1000;
+    size_t num_events = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+    Logger::instance().set_level(LogLevel::ERROR);
+
+    // Bring every port up, then heartbeat it
+    std::vector<PortEventRecord> records(num_events);
+    std::string ndjson;
+    std::string binary;
+    for (size_t i = 0; i < num_events; i++) {
+        int port_id = static_cast<int>(i % num_ports);
+        size_t pass = i / num_ports;
+        PortEvent event = pass == 0 ? PortEvent::POWER_ON
+                        : pass == 1 ? PortEvent::INIT_COMPLETE : PortEvent::HEARTBEAT_OK;
+        records[i] = {port_id, event};
+
+        ndjson += "{\"port_id\":";
+        ndjson += std::to_string(port_id);
+        ndjson += ",\"event\":\"";
+        ndjson += port_event_name(event);
+        ndjson += "\"}\n";
+
+        uint32_t bits = static_cast<uint32_t>(port_id);
+        for (int shift = 0; shift < 32; shift += 8) {
+            binary.push_back(static_cast<char>((bits >> shift) & 0xFF));
+        }
+        binary.push_back(static_cast<char>(event));
+    }
+
+    std::cout << "Event ingest benchmark: " << num_events << " events over " << num_ports
+              << " ports\n\n";
+    std::cout << std::left << std::setw(12) << "body" << std::setw(14) << "bytes/event"
+              << "events/s\n";
+
+    auto report = [&](const char* name, double bytes_per_event, double seconds) {
+        std::cout << std::left << std::setw(12) << name << std::fixed << std::setprecision(1)
+                  << std::setw(14) << bytes_per_event << std::setprecision(0)
+                  << num_events / seconds << "\n";
+    };
+
+    {
+        PortManager manager(num_ports);
+        Stopwatch timer;
+        for (size_t begin = 0; begin < records.size(); begin += kIngestBatchSize) {
+            size_t count = std::min(kIngestBatchSize, records.size() - begin);
+            manager.process_port_events(records.data() + begin, count);
+        }
+        report("records", sizeof(PortEventRecord), timer.elapsed_s());
+    }
+    {
+        PortManager manager(num_ports);
+        Stopwatch timer;
+        EventIngestSummary summary = ingest_events(manager, binary, EventIngestFormat::BINARY);
+        double seconds = timer.elapsed_s();
+        do_not_optimize(summary.applied);
+        report("binary", static_cast<double>(binary.size()) / num_events, seconds);
+    }
+    {
+        PortManager manager(num_ports);
+        Stopwatch timer;
+        EventIngestSummary summary = ingest_events(manager, ndjson, EventIngestFormat::NDJSON);
+        double seconds = timer.elapsed_s();
+        do_not_optimize(summary.applied);
+        report("ndjson", static_cast<double>(ndjson.size()) / num_events, seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+// Event socket benchmark: events/sec through the SOCK_SEQPACKET event channel
+// with several clients, each keeping a window of batches in flight.
+//
+// Usage: bench_event_socket [clients] [batch] [seconds] [path]
+//        (defaults 4, 1024, 3; without a path an in-process server with 1000
+//        ports is started, otherwise the running service at `path` is used)
+
+#include "bench_util.h"
+#include "event_socket.h"
+#include "event_socket_client.h"
+#include "logger.h"
+#include "port_manager.h"
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace control_plane;
+using namespace control_plane::bench;
+
+namespace {
+
+// Batches a client sends ahead of their acks
+constexpr int kWindow = 8;
+
+struct ClientResult {
+    uint64_t events = 0;
+    uint64_t batches = 0;
+    bool ok = true;
+};
+
+void run_client(const std::string& path, int client, size_t batch_size, int num_ports,
+                const std::atomic<bool>& done, ClientResult& result) {
+    EventSocketClient socket_client;
+    if (!socket_client.connect(path)) {
+        result.ok = false;
+        return;
+    }
+    std::vector<PortEventRecord> batch(batch_size);
+    for (size_t i = 0; i < batch_size; i++) {
+        int port_id = static_cast<int>((client * batch_size + i) % num_ports);
+        batch[i] = {port_id, PortEvent::HEARTBEAT_OK};
+    }
+
+    int in_flight = 0;
+    while (!done.load(std::memory_order_relaxed) || in_flight > 0) {
+        if (!done.load(std::memory_order_relaxed) && in_flight < kWindow) {
+            if (!socket_client.send_batch(batch.data(), batch.size())) {
+                result.ok = false;
+                return;
+            }
+            in_flight++;
+            continue;
+        }
+        EventBatchAck ack{};
+        if (!socket_client.read_ack(ack) || ack.status != EventBatchStatus::OK) {
+            result.ok = false;
+            return;
+        }
+        in_flight--;
+        result.events += ack.applied + ack.rejected;
+        result.batches++;
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int clients = argc > 1 ? std::atoi(argv[1]) : 4;
+    size_t batch_size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1024;
+    double seconds = argc > 3 ? std::atof(argv[3]) : 3.0;
+    std::string path = argc > 4 ? argv[4] : "";
+    const int num_ports = 1000;
+    Logger::instance().set_level(LogLevel::ERROR);
+
+    if (clients < 1 || batch_size < 1 || batch_size > kMaxEventBatchRecords) {
+        std::cerr << "clients must be >= 1 and batch between 1 and " << kMaxEventBatchRecords << "\n";
+        return 1;
+    }
+
+    std::unique_ptr<EventSocketServer> server;
+    if (path.empty()) {
+        path = "/tmp/bench_event_socket_" + std::to_string(getpid()) + ".sock";
+        server = std::make_unique<EventSocketServer>(std::make_shared<PortManager>(num_ports), path);
+        if (!server->start()) {
+            std::cerr << "Failed to start event socket at " << path << "\n";
+            return 1;
+        }
+    }
+
+    std::cout << "Event socket benchmark: " << clients << " clients, " << batch_size
+              << " events/batch, window " << kWindow << ", " << seconds << "s\n\n";
+
+    std::atomic<bool> done(false);
+    std::vector<ClientResult> results(clients);
+    std::vector<std::thread> threads;
+    Stopwatch timer;
+    for (int c = 0; c < clients; c++) {
+        threads.emplace_back(run_client, std::cref(path), c, batch_size, num_ports,
+                             std::cref(done), std::ref(results[c]));
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    done.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double elapsed = timer.elapsed_s();
+
+    uint64_t events = 0;
+    uint64_t batches = 0;
+    for (const auto& result : results) {
+        if (!result.ok) {
+            std::cerr << "A client failed (is the event socket listening at " << path << "?)\n";
+            return 1;
+        }
+        events += result.events;
+        batches += result.batches;
+    }
+    std::cout << "batches:  " << batches << "\n"
+              << "events:   " << events << "\n"
+              << "events/s: " << static_cast<uint64_t>(events / elapsed) << "\n"
+              << "batches/s: " << static_cast<uint64_t>(batches / elapsed) << "\n";
+    return 0;
+}
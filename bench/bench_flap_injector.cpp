@@ -0,0 +1,65 @@
+// Flap injector benchmark: CPU per injection cycle as the port count grows,
+// for the geometric skip sampler versus one Bernoulli trial per port (the
+// previous injector, with the same counter-based draws).
+//
+// Usage: bench_flap_injector [flap_probability] [seed]
+//        (defaults 1e-5, 42)
+
+#include "bench_util.h"
+#include "counter_rng.h"
+#include "flap_sampler.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace control_plane;
+using namespace control_plane::bench;
+
+int main(int argc, char** argv) {
+    double probability = argc > 1 ? std::atof(argv[1]) : 1e-5;
+    uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 42;
+    CounterRng rng(seed);
+    FlapSampler sampler(rng, probability);
+
+    std::cout << "Flap injector: p = " << probability << " per port per cycle\n\n"
+              << std::left << std::setw(12) << "ports" << std::setw(14) << "flaps/cycle"
+              << std::setw(18) << "skip us/cycle" << std::setw(20) << "per-port us/cycle"
+              << "speedup\n"
+              << std::fixed;
+
+    std::vector<uint32_t> ports;
+    for (uint32_t num_ports : {1000u, 10000u, 100000u, 1000000u, 10000000u}) {
+        // Enough cycles for a stable time, but at most ~1e8 per-port trials
+        uint64_t skip_cycles = 20000;
+        uint64_t trial_cycles = std::max<uint64_t>(3, std::min<uint64_t>(20000, 100000000ull / num_ports));
+
+        uint64_t picks = 0;
+        Stopwatch timer;
+        for (uint64_t tick = 1; tick <= skip_cycles; tick++) {
+            ports.clear();
+            sampler.sample(num_ports, tick, ports);
+            picks += ports.size();
+        }
+        double skip_us = timer.elapsed_ms() * 1000.0 / skip_cycles;
+
+        uint64_t trial_picks = 0;
+        timer.reset();
+        for (uint64_t tick = 1; tick <= trial_cycles; tick++) {
+            for (uint32_t port = 0; port < num_ports; port++) {
+                CounterRng::Block draw = rng.draw(port, tick);
+                trial_picks += CounterRng::to_unit(draw[0], draw[1]) < probability;
+            }
+        }
+        double trial_us = timer.elapsed_ms() * 1000.0 / trial_cycles;
+        do_not_optimize(trial_picks);
+
+        std::cout << std::setw(12) << num_ports << std::setw(14) << std::setprecision(2)
+                  << static_cast<double>(picks) / skip_cycles << std::setw(18) << std::setprecision(2)
+                  << skip_us << std::setw(20) << std::setprecision(1) << trial_us << std::setprecision(0)
+                  << trial_us / skip_us << "x\n";
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+// Event journal benchmark: process_port_event and process_port_events
+// throughput with and without the journal, then the time to replay a journal
+// of `recovery_events` records.
+//
+// Usage: bench_journal [num_ports] [num_events] [recovery_events] [dir]
+//        (defaults 1000, 2000000, 10000000, /tmp/bench_journal_<pid>)
+
+#include "bench_util.h"
+#include "event_journal.h"
+#include "logger.h"
+#include "port_manager.h"
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace control_plane;
+using namespace control_plane::bench;
+
+namespace {
+
+// Bring every port up, then mostly heartbeat it with a flap every 64 passes,
+// like the simulator's own event mix
+PortEvent event_for(size_t i, int num_ports) {
+    size_t pass = i / num_ports;
+    if (pass == 0) return PortEvent::POWER_ON;
+    if (pass == 1 || pass % 64 == 1) return PortEvent::INIT_COMPLETE;
+    if (pass % 64 == 0) return PortEvent::LINK_FLAP;
+    return PortEvent::HEARTBEAT_OK;
+}
+
+std::shared_ptr<EventJournal> attach_journal(PortManager& manager, const std::string& dir) {
+    std::filesystem::remove_all(dir);
+    auto journal = std::make_shared<EventJournal>(dir, manager.get_num_ports(), manager.get_metrics());
+    if (!journal->open()) {
+        std::cerr << "Cannot open journal in " << dir << "\n";
+        std::exit(1);
+    }
+    manager.set_journal(journal);
+    return journal;
+}
+
+double run_single(int num_ports, size_t num_events, const std::string* journal_dir) {
+    PortManager manager(num_ports);
+    std::shared_ptr<EventJournal> journal;
+    if (journal_dir) {
+        journal = attach_journal(manager, *journal_dir);
+    }
+    Stopwatch timer;
+    for (size_t i = 0; i < num_events; i++) {
+        manager.process_port_event(static_cast<int>(i % num_ports), event_for(i, num_ports));
+    }
+    double seconds = timer.elapsed_s();
+    if (journal) {
+        journal->close();
+    }
+    return num_events / seconds;
+}
+
+double run_batches(int num_ports, const std::vector<PortEventRecord>& records,
+                   const std::string* journal_dir) {
+    constexpr size_t kBatch = 1024;
+    PortManager manager(num_ports);
+    std::shared_ptr<EventJournal> journal;
+    if (journal_dir) {
+        journal = attach_journal(manager, *journal_dir);
+    }
+    Stopwatch timer;
+    for (size_t begin = 0; begin < records.size(); begin += kBatch) {
+        manager.process_port_events(records.data() + begin, std::min(kBatch, records.size() - begin));
+    }
+    double seconds = timer.elapsed_s();
+    if (journal) {
+        journal->close();
+    }
+    return records.size() / seconds;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int num_ports = argc > 1 ? std::atoi(argv[1]) : 1000;
+    size_t num_events = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000000;
+    size_t recovery_events = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 10000000;
+    std::string dir = argc > 4 ? argv[4] : "/tmp/bench_journal_" + std::to_string(getpid());
+    Logger::instance().set_level(LogLevel::ERROR);
+
+    std::vector<PortEventRecord> records(num_events);
+    for (size_t i = 0; i < num_events; i++) {
+        records[i] = {static_cast<int>(i % num_ports), event_for(i, num_ports)};
+    }
+
+    std::cout << "Journal benchmark: " << num_events << " events over " << num_ports << " ports\n\n";
+    std::cout << std::left << std::setw(22) << "path" << std::setw(16) << "events/s"
+              << std::setw(16) << "journaled/s" << "overhead\n";
+    auto report = [](const char* name, double plain, double journaled) {
+        std::cout << std::left << std::setw(22) << name << std::fixed << std::setprecision(0)
+                  << std::setw(16) << plain << std::setw(16) << journaled << std::setprecision(1)
+                  << (plain / journaled - 1.0) * 100.0 << "%\n";
+    };
+
+    // Best of three, to keep page-cache writeback noise out of the ratio
+    double plain = 0, journaled = 0;
+    for (int round = 0; round < 3; round++) {
+        plain = std::max(plain, run_single(num_ports, num_events, nullptr));
+        journaled = std::max(journaled, run_single(num_ports, num_events, &dir));
+    }
+    report("process_port_event", plain, journaled);
+
+    plain = 0;
+    journaled = 0;
+    for (int round = 0; round < 3; round++) {
+        plain = std::max(plain, run_batches(num_ports, records, nullptr));
+        journaled = std::max(journaled, run_batches(num_ports, records, &dir));
+    }
+    report("process_port_events", plain, journaled);
+
+    // Write a journal of `recovery_events` records through the batch path,
+    // then time a cold replay of it (page cache warm, as after a restart)
+    {
+        PortManager manager(num_ports);
+        std::shared_ptr<EventJournal> journal = attach_journal(manager, dir);
+        std::vector<PortEventRecord> batch(1024);
+        for (size_t done = 0; done < recovery_events; done += batch.size()) {
+            size_t n = std::min(batch.size(), recovery_events - done);
+            for (size_t i = 0; i < n; i++) {
+                batch[i] = {static_cast<int>((done + i) % num_ports), event_for(done + i, num_ports)};
+            }
+            manager.process_port_events(batch.data(), n);
+        }
+        journal->close();
+
+        Stopwatch timer;
+        JournalReplay replay;
+        EventJournal::replay(dir, num_ports, replay);
+        double seconds = timer.elapsed_s();
+        PortManager recovered(num_ports);
+        recovered.restore_states(replay.ports);
+        bool match = recovered.get_all_states() == manager.get_all_states();
+
+        std::cout << "\nRecovery: " << replay.records << " records in " << replay.segments
+                  << " segments replayed in " << std::setprecision(2) << seconds << " s ("
+                  << std::setprecision(0) << replay.records / seconds << " records/s), states "
+                  << (match ? "match" : "DIFFER") << "\n";
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
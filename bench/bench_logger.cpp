@@ -0,0 +1,117 @@
+// Logger throughput benchmark: records/sec from 1-8 producer threads in
+// synchronous mode and in async mode (block and drop policies), for JSON and
+// binary output, with output sent to /dev/null so only the logging path
+// itself is measured. Also reports bytes per record in each format.
+//
+// Usage: bench_logger [records_per_thread] (default 200000)
+
+#include "bench_util.h"
+#include "logger.h"
+#include "port_state_machine.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace control_plane;
+using namespace control_plane::bench;
+
+namespace {
+
+// Log `records` lines from each of `num_threads` threads; returns records/sec
+// including the time to drain the async ring
+double run_producers(int num_threads, int records) {
+
+    std::vector<std::thread> threads;
+    std::atomic<bool> go(false);
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            for (int i = 0; i < records; i++) {
+                Logger::instance().infof("PortStateMachine", t,
+                                         "Port {} transitioned from {} to {} on event {}",
+                                         t, PortState::DOWN, PortState::INIT, PortEvent::POWER_ON);
+            }
+        });
+    }
+    Stopwatch timer;
+    go.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    Logger::instance().flush();
+    return static_cast<double>(records) * num_threads / timer.elapsed_s();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int records = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+    int null_fd = ::open("/dev/null", O_WRONLY);
+    if (null_fd < 0) {
+        std::cerr << "cannot open /dev/null\n";
+        return 1;
+    }
+    Logger::instance().set_output_fd(null_fd);
+
+    std::cout << "Logger benchmark: " << records << " records per thread, "
+              << std::thread::hardware_concurrency() << " hardware threads\n";
+    std::cout << std::fixed << std::setprecision(0);
+
+    for (LogOutputFormat format : {LogOutputFormat::JSON, LogOutputFormat::BINARY}) {
+        Logger::instance().set_format(format);
+
+        // Output size of one transition record, measured through a temp file
+        char path[] = "/tmp/bench_logger_XXXXXX";
+        int size_fd = mkstemp(path);
+        Logger::instance().set_output_fd(size_fd);
+        const int kSizeRecords = 10000;
+        run_producers(1, kSizeRecords);
+        struct stat info;
+        fstat(size_fd, &info);
+        ::close(size_fd);
+        std::remove(path);
+        Logger::instance().set_output_fd(null_fd);
+
+        std::cout << "\n" << log_output_format_to_string(format) << " output, "
+                  << std::setprecision(1) << static_cast<double>(info.st_size) / kSizeRecords
+                  << " bytes/record\n" << std::setprecision(0);
+        std::cout << std::left << std::setw(10) << "threads"
+                  << std::setw(16) << "sync rec/s"
+                  << std::setw(16) << "async block" << std::setw(16) << "async drop"
+                  << "dropped\n";
+
+        for (int num_threads = 1; num_threads <= 8; num_threads *= 2) {
+            double sync_rate = run_producers(num_threads, records);
+
+            Logger::instance().start_async(8192, LogOverflowPolicy::BLOCK);
+            double block_rate = run_producers(num_threads, records);
+            Logger::instance().stop_async();
+
+            uint64_t dropped_before = Logger::instance().get_dropped_count();
+            Logger::instance().start_async(8192, LogOverflowPolicy::DROP);
+            double drop_rate = run_producers(num_threads, records);
+            Logger::instance().stop_async();
+            uint64_t dropped = Logger::instance().get_dropped_count() - dropped_before;
+
+            std::cout << std::setw(10) << num_threads
+                      << std::setw(16) << sync_rate
+                      << std::setw(16) << block_rate
+                      << std::setw(16) << drop_rate << dropped << "\n";
+        }
+    }
+
+    Logger::instance().set_format(LogOutputFormat::JSON);
+    Logger::instance().set_output_fd(STDOUT_FILENO);
+    ::close(null_fd);
+    return 0;
+}
@@ -0,0 +1,136 @@
+// Metrics contention benchmark: counter increments/sec with 1-32 writer
+// threads, comparing the legacy global-mutex map, the string shim and the
+// handle fast path of the sharded registry. Also reports the cost of one
+// histogram observation and of a timed (clock-reading) scope.
+//
+// Usage: bench_metrics_contention [increments_per_thread] (default 1000000)
+
+#include "bench_util.h"
+#include "metrics.h"
+#include "port_manager.h"
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace control_plane;
+using namespace control_plane::bench;
+
+namespace {
+
+// The registry Metrics used before handles: one mutex and a map lookup on
+// every increment
+class LegacyMetrics {
+public:
+    void increment_counter(const std::string& name, uint64_t value = 1) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        counters_[name].fetch_add(value);
+    }
+
+    uint64_t get_counter(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return counters_[name].load();
+    }
+
+private:
+    std::mutex mutex_;
+    std::map<std::string, std::atomic<uint64_t>> counters_;
+};
+
+// Run `body(increments)` on `num_threads` threads; returns increments/sec
+template <typename Body>
+double run_threads(int num_threads, uint64_t increments, Body body) {
+    std::vector<std::thread> threads;
+    std::atomic<bool> go(false);
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&]() {
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            body(increments);
+        });
+    }
+    Stopwatch timer;
+    go.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return static_cast<double>(increments) * num_threads / timer.elapsed_s();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint64_t increments = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const std::string name = "events_processed_total";
+
+    std::cout << "Metrics contention benchmark: " << increments
+              << " increments per thread, " << std::thread::hardware_concurrency()
+              << " hardware threads\n\n";
+
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << std::left << std::setw(10) << "threads"
+              << std::setw(18) << "legacy inc/s"
+              << std::setw(18) << "string inc/s" << "handle inc/s\n";
+
+    for (int num_threads = 1; num_threads <= 32; num_threads *= 2) {
+        LegacyMetrics legacy;
+        double legacy_rate = run_threads(num_threads, increments, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) legacy.increment_counter(name);
+        });
+
+        Metrics shim;
+        double shim_rate = run_threads(num_threads, increments, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) shim.increment_counter(name);
+        });
+
+        Metrics sharded;
+        CounterHandle counter = sharded.register_counter(name);
+        double handle_rate = run_threads(num_threads, increments, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) sharded.increment(counter);
+        });
+
+        // All three must agree on the total
+        uint64_t expected = increments * num_threads;
+        if (legacy.get_counter(name) != expected || shim.get_counter(name) != expected ||
+            sharded.value(counter) != expected) {
+            std::cerr << "count mismatch at " << num_threads << " threads\n";
+            return 1;
+        }
+
+        std::cout << std::setw(10) << num_threads
+                  << std::setw(18) << legacy_rate
+                  << std::setw(18) << shim_rate << handle_rate << "\n";
+    }
+
+    // Histogram recording cost, single thread
+    Metrics histograms;
+    HistogramHandle histogram = histograms.register_histogram("bench_seconds");
+    Stopwatch timer;
+    for (uint64_t i = 0; i < increments; i++) {
+        histograms.observe(histogram, i & 0xFFFF);
+    }
+    double observe_ns = timer.elapsed_ms() * 1e6 / increments;
+    timer.reset();
+    for (uint64_t i = 0; i < increments; i++) {
+        ScopedLatency latency(histograms, histogram);
+    }
+    double scoped_ns = timer.elapsed_ms() * 1e6 / increments;
+    LatencySampler sampler(PortManager::kDefaultEventLatencySampleInterval);
+    timer.reset();
+    for (uint64_t i = 0; i < increments; i++) {
+        ScopedLatency latency(histograms, histogram, sampler.due());
+    }
+    double sampled_ns = timer.elapsed_ms() * 1e6 / increments;
+
+    std::cout << std::setprecision(1) << "\nhistogram observe: " << observe_ns
+              << " ns/op, timed scope (two clock reads): " << scoped_ns
+              << " ns/op, sampled 1 in " << sampler.interval() << ": " << sampled_ns << " ns/op\n";
+
+    return 0;
+}
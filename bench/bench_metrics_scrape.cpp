@@ -0,0 +1,149 @@
+// /metrics scrape benchmark: event writers running through
+// PortManager::process_port_event while scraper threads call
+// Metrics::exposition(), with and without a cached render, as extra
+// per-port series are registered. Reports writer events/sec and scrape
+// latency percentiles.
+//
+// Usage: bench_metrics_scrape [run_ms] [writers] (defaults 500, 2)
+
+#include "bench_util.h"
+#include "logger.h"
+#include "port_manager.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace control_plane;
+using namespace control_plane::bench;
+
+namespace {
+
+constexpr int kPorts = 4096;
+
+struct RunResult {
+    double events_per_sec = 0;
+    double scrapes_per_sec = 0;
+    double p50_us = 0;
+    double p99_us = 0;
+    size_t bytes = 0;
+};
+
+double percentile_us(std::vector<uint64_t>& samples, double q) {
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t rank = static_cast<size_t>(q * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return samples[rank] / 1000.0;
+}
+
+RunResult run(int extra_series, int writers, int scrapers, int max_age_ms, int run_ms) {
+    PortManager manager(kPorts, PortSyncMode::MUTEX);
+    Metrics& metrics = manager.get_metrics();
+    for (int i = 0; i < extra_series; i++) {
+        metrics.increment(metrics.register_counter("port_heartbeats_total{port=\"" +
+                                                   std::to_string(i) + "\"}"), i);
+    }
+    metrics.set_exposition_max_age(std::chrono::milliseconds(max_age_ms));
+    for (int port = 0; port < kPorts; port++) {
+        manager.process_port_event(port, PortEvent::POWER_ON);
+        manager.process_port_event(port, PortEvent::INIT_COMPLETE);
+    }
+
+    std::atomic<bool> go(false);
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> events(0);
+    std::vector<std::vector<uint64_t>> latencies(scrapers);
+    std::atomic<size_t> bytes(0);
+    std::vector<std::thread> threads;
+
+    for (int w = 0; w < writers; w++) {
+        threads.emplace_back([&, w]() {
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            uint64_t count = 0;
+            int port = w;
+            while (!stop.load(std::memory_order_relaxed)) {
+                manager.process_port_event(port, PortEvent::HEARTBEAT_OK);
+                port = (port + writers) % kPorts;
+                count++;
+            }
+            events.fetch_add(count);
+        });
+    }
+    for (int s = 0; s < scrapers; s++) {
+        threads.emplace_back([&, s]() {
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            while (!stop.load(std::memory_order_relaxed)) {
+                uint64_t start = latency_clock_ns();
+                std::shared_ptr<const std::string> text = metrics.exposition();
+                latencies[s].push_back(latency_clock_ns() - start);
+                bytes.store(text->size(), std::memory_order_relaxed);
+            }
+        });
+    }
+
+    Stopwatch timer;
+    go.store(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(run_ms));
+    stop.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double elapsed = timer.elapsed_s();
+
+    std::vector<uint64_t> all;
+    for (auto& samples : latencies) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    RunResult result;
+    result.events_per_sec = events.load() / elapsed;
+    result.scrapes_per_sec = all.size() / elapsed;
+    result.p50_us = percentile_us(all, 0.50);
+    result.p99_us = percentile_us(all, 0.99);
+    result.bytes = bytes.load();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int run_ms = argc > 1 ? std::atoi(argv[1]) : 500;
+    int writers = argc > 2 ? std::atoi(argv[2]) : 2;
+    Logger::instance().set_level(LogLevel::ERROR);
+
+    std::cout << "Metrics scrape benchmark: " << writers << " event writers, " << kPorts
+              << " ports, " << run_ms << " ms per run, "
+              << std::thread::hardware_concurrency() << " hardware threads\n\n";
+
+    std::cout << std::left << std::setw(8) << "series" << std::setw(10) << "scrapers"
+              << std::setw(10) << "max_age" << std::setw(14) << "events/s"
+              << std::setw(12) << "scrapes/s" << std::setw(12) << "p50 us"
+              << std::setw(12) << "p99 us" << "bytes\n";
+
+    for (int extra_series : {0, 250, 1000}) {
+        struct Case {
+            int scrapers;
+            int max_age_ms;
+        };
+        for (Case c : {Case{0, 0}, Case{1, 0}, Case{4, 0}, Case{1, 1000}, Case{4, 1000}}) {
+            RunResult result = run(extra_series, writers, c.scrapers, c.max_age_ms, run_ms);
+            std::cout << std::left << std::setw(8) << extra_series << std::setw(10) << c.scrapers
+                      << std::setw(10) << (std::to_string(c.max_age_ms) + "ms")
+                      << std::fixed << std::setprecision(0)
+                      << std::setw(14) << result.events_per_sec
+                      << std::setw(12) << result.scrapes_per_sec << std::setprecision(1)
+                      << std::setw(12) << result.p50_us << std::setw(12) << result.p99_us
+                      << result.bytes << "\n";
+        }
+    }
+    return 0;
+}
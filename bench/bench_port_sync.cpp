@@ -0,0 +1,109 @@
+// Port writer synchronization benchmark: striped mutexes versus lock-free CAS
+// on the packed state word, under the ThreadSafetyTest access patterns.
+//
+// Usage: bench_port_sync [max_threads] [num_ports] (defaults 64, 8)
+
+#include "bench_util.h"
+#include "logger.h"
+#include "port_manager.h"
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace control_plane;
+using namespace control_plane::bench;
+
+namespace {
+
+constexpr int kEventsPerThread = 200000;
+
+// ConcurrentEventProcessing pattern: each thread cycles POWER_ON,
+// INIT_COMPLETE and HEARTBEAT_OK round-robin over all ports
+double run_writers(PortSyncMode mode, int num_threads, int num_ports) {
+    PortManager manager(num_ports, mode);
+    std::vector<std::thread> threads;
+
+    Stopwatch timer;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&manager, num_ports]() {
+            for (int i = 0; i < kEventsPerThread; i++) {
+                int port_id = i % num_ports;
+                if (i % 3 == 0) {
+                    manager.process_port_event(port_id, PortEvent::POWER_ON);
+                } else if (i % 3 == 1) {
+                    manager.process_port_event(port_id, PortEvent::INIT_COMPLETE);
+                } else {
+                    manager.process_port_event(port_id, PortEvent::HEARTBEAT_OK);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    return static_cast<double>(num_threads) * kEventsPerThread / timer.elapsed_s();
+}
+
+// ConcurrentReadAndWrite pattern: half the threads write, half read states
+double run_mixed(PortSyncMode mode, int num_threads, int num_ports) {
+    PortManager manager(num_ports, mode);
+    std::vector<std::thread> threads;
+    std::atomic<uint64_t> reads(0);
+    int writers = std::max(1, num_threads / 2);
+
+    Stopwatch timer;
+    for (int t = 0; t < num_threads; t++) {
+        if (t < writers) {
+            threads.emplace_back([&manager, num_ports]() {
+                for (int i = 0; i < kEventsPerThread; i++) {
+                    manager.process_port_event(i % num_ports,
+                        i % 2 ? PortEvent::LINK_FLAP : PortEvent::POWER_ON);
+                }
+            });
+        } else {
+            threads.emplace_back([&manager, &reads, num_ports]() {
+                uint64_t local = 0;
+                for (int i = 0; i < kEventsPerThread; i++) {
+                    do_not_optimize(manager.get_port_state(i % num_ports));
+                    local++;
+                }
+                reads.fetch_add(local);
+            });
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    double ops = static_cast<double>(writers) * kEventsPerThread + reads.load();
+    return ops / timer.elapsed_s();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int max_threads = argc > 1 ? std::atoi(argv[1]) : 64;
+    int num_ports = argc > 2 ? std::atoi(argv[2]) : 8;
+    Logger::instance().set_level(LogLevel::ERROR);
+
+    std::cout << "Port sync benchmark: " << num_ports << " ports, "
+              << kEventsPerThread << " ops/thread, "
+              << std::thread::hardware_concurrency() << " hardware threads\n\n";
+    std::cout << std::left << std::setw(10) << "threads"
+              << std::setw(16) << "mutex ev/s" << std::setw(16) << "lock_free ev/s"
+              << std::setw(18) << "mutex mixed/s" << "lock_free mixed/s\n";
+
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        std::cout << std::left << std::setw(10) << threads << std::fixed << std::setprecision(0)
+                  << std::setw(16) << run_writers(PortSyncMode::MUTEX, threads, num_ports)
+                  << std::setw(16) << run_writers(PortSyncMode::LOCK_FREE, threads, num_ports)
+                  << std::setw(18) << run_mixed(PortSyncMode::MUTEX, threads, num_ports)
+                  << run_mixed(PortSyncMode::LOCK_FREE, threads, num_ports) << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Port table layout benchmark: memory footprint and full-table scan time of
+// the legacy pointer-per-port layout versus the structure-of-arrays PortTable.
+//
+// Usage: bench_port_table [num_ports] (default 1000000)
+
+#include "bench_util.h"
+#include "logger.h"
+#include "port_manager.h"
+#include "port_state_machine.h"
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace control_plane;
+using namespace control_plane::bench;
+
+namespace {
+
+constexpr int kScanRounds = 10;
+
+// The layout PortManager used before the port table: one heap-allocated
+// state machine plus one mutex per port
+struct LegacyPorts {
+    std::vector<std::unique_ptr<PortStateMachine>> ports;
+    std::vector<std::mutex> mutexes;
+
+    explicit LegacyPorts(int num_ports) : mutexes(num_ports) {
+        ports.reserve(num_ports);
+        for (int i = 0; i < num_ports; i++) {
+            ports.push_back(std::make_unique<PortStateMachine>(i));
+        }
+    }
+
+    // Equivalent of the old get_all_states(): lock each port in turn
+    std::vector<PortState> get_all_states() {
+        std::vector<PortState> states;
+        states.reserve(ports.size());
+        for (size_t i = 0; i < ports.size(); i++) {
+            std::lock_guard<std::mutex> lock(mutexes[i]);
+            states.push_back(ports[i]->get_state());
+        }
+        return states;
+    }
+};
+
+void report(const char* layout, int num_ports, size_t bytes, double build_ms, double scan_ms) {
+    std::cout << layout << ":\n"
+              << "  memory:       " << bytes / (1024.0 * 1024.0) << " MiB ("
+              << static_cast<double>(bytes) / num_ports << " bytes/port)\n"
+              << "  construction: " << build_ms << " ms\n"
+              << "  full scan:    " << scan_ms << " ms ("
+              << scan_ms * 1e6 / num_ports << " ns/port)\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int num_ports = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    Logger::instance().set_level(LogLevel::WARN);
+
+    std::cout << "Port table benchmark: " << num_ports << " ports, "
+              << kScanRounds << " scans averaged\n\n";
+
+    // Before: pointer-per-port layout
+    {
+        size_t heap_before = heap_bytes_in_use();
+        Stopwatch build;
+        LegacyPorts legacy(num_ports);
+        double build_ms = build.elapsed_ms();
+        size_t bytes = heap_bytes_in_use() - heap_before;
+
+        Stopwatch scan;
+        for (int round = 0; round < kScanRounds; round++) {
+            auto states = legacy.get_all_states();
+            do_not_optimize(states.data());
+        }
+        report("Legacy (unique_ptr<PortStateMachine> + mutex per port)",
+               num_ports, bytes, build_ms, scan.elapsed_ms() / kScanRounds);
+    }
+
+    std::cout << "\n";
+
+    // After: structure-of-arrays port table
+    {
+        size_t heap_before = heap_bytes_in_use();
+        Stopwatch build;
+        PortManager manager(num_ports);
+        double build_ms = build.elapsed_ms();
+        size_t bytes = heap_bytes_in_use() - heap_before;
+
+        Stopwatch scan;
+        for (int round = 0; round < kScanRounds; round++) {
+            auto states = manager.get_all_states();
+            do_not_optimize(states.data());
+        }
+        report("PortTable (structure of arrays, striped locks)",
+               num_ports, bytes, build_ms, scan.elapsed_ms() / kScanRounds);
+        std::cout << "  table arrays: " << manager.get_port_table().memory_bytes() / (1024.0 * 1024.0)
+                  << " MiB\n";
+    }
+
+    return 0;
+}
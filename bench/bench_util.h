@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <malloc.h>
+
+namespace control_plane {
+namespace bench {
+
+// Wall-clock stopwatch for benchmark phases
+class Stopwatch {
+public:
+    Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+    void reset() { start_ = std::chrono::steady_clock::now(); }
+
+    double elapsed_ms() const {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start_).count();
+    }
+
+    double elapsed_s() const { return elapsed_ms() / 1000.0; }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Bytes currently allocated from the heap (glibc)
+inline size_t heap_bytes_in_use() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+// Keep the optimizer from discarding a computed value
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace bench
+} // namespace control_plane
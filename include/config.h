@@ -8,14 +8,41 @@ namespace control_plane {
 
 // Configuration structure
 struct Config {
+    // Largest ports_count: 16M ports, well inside the 32-bit port ids and
+    // per-state counts
+    static constexpr int kMaxPorts = 1 << 24;
+    
     int ports_count = 8;
     int tick_ms = 100;
     double flap_probability = 0.01;  // Probability per tick per port
     int flap_min_ms = 500;
     int flap_max_ms = 5000;
+    std::string init_latency_distribution = "uniform"; // INIT -> UP latency: uniform, exponential
+    int init_latency_min_ms = 200;
+    int init_latency_max_ms = 200;
     std::string log_level = "info";  // debug, info, warn, error
     std::optional<uint32_t> seed;    // Random seed for determinism
     int http_port = 8080;
+    int worker_threads = 0;          // Event workers (0 = hardware concurrency)
+    std::string port_sync = "mutex"; // Port writer sync: mutex, lock_free
+    std::string log_mode = "sync";   // Logger output: sync, async
+    int log_queue_capacity = 8192;   // Async log ring size in records
+    std::string log_overflow = "block"; // Full async ring: block, drop
+    std::string log_format = "json"; // Log encoding: json, binary
+    double log_rate_limit = 0.0;     // Records/sec per (component, port, level); 0 = unlimited
+    int log_rate_burst = 20;         // Records per key before the rate limit applies
+    int metrics_max_age_ms = 0;      // How long /metrics may serve a cached render
+    std::string event_socket_path;   // Unix socket for binary event batches; empty = off
+    std::string journal_dir;         // Event journal directory; empty = off
+    int journal_segment_mb = 64;     // Journal segment file size
+    int journal_commit_ms = 10;      // Journal group commit interval
+    std::string snapshot_path;       // Port table snapshot file; empty = off
+    std::string mode = "realtime";   // Simulation clock: realtime, discrete
+    uint64_t duration_ticks = 0;     // Stop after this many ticks; 0 = until signalled
+    std::string trace_path;          // Binary event trace file; empty = off
+    std::string tick_catch_up = "burst"; // Overdue ticks: burst (run each), skip (jump the clock)
+    int tick_lag_threshold_ms = 1000; // Tick lag that counts against readiness; 0 = never unready
+    int tick_lag_sustain_ms = 5000;  // How long lag must stay over the threshold
     
     // Load from YAML file
     static Config load_from_file(const std::string& path);
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace control_plane {
+
+// Philox4x32-10 block function (Salmon et al., "Parallel Random Numbers: As
+// Easy as 1, 2, 3", SC'11). Maps a 128-bit counter and a 64-bit key to 128
+// random bits; there is no state, so any block can be computed directly.
+class Philox4x32 {
+public:
+    using Counter = std::array<uint32_t, 4>;
+    using Key = std::array<uint32_t, 2>;
+
+    static constexpr int kRounds = 10;
+
+    static Counter generate(Counter counter, Key key) {
+        for (int round = 0; round < kRounds; round++) {
+            if (round > 0) {
+                key[0] += kWeyl0;
+                key[1] += kWeyl1;
+            }
+            uint64_t product0 = static_cast<uint64_t>(kMultiplier0) * counter[0];
+            uint64_t product1 = static_cast<uint64_t>(kMultiplier1) * counter[2];
+            counter = {static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                       static_cast<uint32_t>(product1),
+                       static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                       static_cast<uint32_t>(product0)};
+        }
+        return counter;
+    }
+
+private:
+    static constexpr uint32_t kMultiplier0 = 0xD2511F53;
+    static constexpr uint32_t kMultiplier1 = 0xCD9E8D57;
+    static constexpr uint32_t kWeyl0 = 0x9E3779B9;
+    static constexpr uint32_t kWeyl1 = 0xBB67AE85;
+};
+
+// Random draws addressed by (port, tick, stream) under a seed. Each port's
+// draws depend only on those coordinates, never on what other ports drew or
+// which thread asked first, so a seeded simulation makes the same choices
+// for every port with any number of workers. Thread-safe: it has no
+// mutable state.
+class CounterRng {
+public:
+    using Block = Philox4x32::Counter;
+
+    explicit CounterRng(uint64_t seed = 0) : seed_(seed) {}
+
+    uint64_t get_seed() const { return seed_; }
+
+    // 128 random bits for `port_id` at `tick`; `stream` separates
+    // independent uses at the same coordinates
+    Block draw(uint32_t port_id, uint64_t tick, uint32_t stream = 0) const {
+        return Philox4x32::generate(
+            {port_id, static_cast<uint32_t>(tick), static_cast<uint32_t>(tick >> 32), stream},
+            {static_cast<uint32_t>(seed_), static_cast<uint32_t>(seed_ >> 32)});
+    }
+
+    // Uniform double in [0, 1) from two words (53 random bits)
+    static double to_unit(uint32_t high, uint32_t low) {
+        uint64_t bits = (static_cast<uint64_t>(high) << 32 | low) >> 11;
+        return static_cast<double>(bits) * (1.0 / 9007199254740992.0);
+    }
+
+    // Integer in [0, range) from two words (the high 32 bits of a 64x32-bit
+    // product); the bias is below range / 2^64
+    static uint32_t to_range(uint32_t high, uint32_t low, uint32_t range) {
+        uint64_t carry = (static_cast<uint64_t>(low) * range) >> 32;
+        return static_cast<uint32_t>((static_cast<uint64_t>(high) * range + carry) >> 32);
+    }
+
+private:
+    uint64_t seed_;
+};
+
+} // namespace control_plane
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "port_manager.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace control_plane {
+
+// Body encodings accepted by POST /events
+enum class EventIngestFormat {
+    NDJSON, // One {"port_id":3,"event":"POWER_ON"} object per line
+    BINARY  // Packed records: little-endian int32 port_id, uint8 PortEvent
+};
+
+constexpr size_t kBinaryEventRecordBytes = 5;
+
+// Records handed to PortManager::process_port_events per call
+constexpr size_t kIngestBatchSize = 1024;
+
+// Format for a request Content-Type (parameters ignored): NDJSON for
+// application/x-ndjson, application/json and text/plain, BINARY for
+// application/octet-stream. False for anything else.
+bool parse_event_ingest_format(std::string_view content_type, EventIngestFormat& format);
+
+// Outcome of ingesting one body
+struct EventIngestSummary {
+    uint64_t applied = 0;     // Records applied to a port
+    uint64_t transitions = 0; // Applied records that changed state
+    uint64_t rejected = 0;    // Records not applied: malformed or invalid port id
+    uint64_t malformed = 0;   // Of those, records that did not parse
+};
+
+// Parse one NDJSON object. "event" is a name in any case or its numeric
+// value; other keys are ignored if their value is a string, number, bool or
+// null. False if malformed or either field is missing.
+bool parse_event_json(std::string_view line, PortEventRecord& record);
+
+// Decodes a request body in place, a batch of records at a time. Malformed
+// records are skipped and counted; blank NDJSON lines are ignored.
+class EventBodyReader {
+public:
+    EventBodyReader(std::string_view body, EventIngestFormat format)
+        : body_(body), format_(format), pos_(0), malformed_(0) {}
+
+    // Fill up to `capacity` records; returns how many (0 once the body is
+    // exhausted)
+    size_t read(PortEventRecord* out, size_t capacity);
+
+    uint64_t malformed() const { return malformed_; }
+
+private:
+    size_t read_ndjson(PortEventRecord* out, size_t capacity);
+    size_t read_binary(PortEventRecord* out, size_t capacity);
+
+    std::string_view body_;
+    EventIngestFormat format_;
+    size_t pos_;
+    uint64_t malformed_;
+};
+
+// Apply every event in `body` through PortManager::process_port_events in
+// batches of kIngestBatchSize, preserving the body's order per port. Uses a
+// fixed stack buffer, so the cost does not grow with the body beyond the
+// events themselves.
+EventIngestSummary ingest_events(PortManager& manager, std::string_view body,
+                                 EventIngestFormat format);
+
+} // namespace control_plane
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "metrics.h"
+#include "port_manager.h"
+#include "port_state_machine.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace control_plane {
+
+// Event journal format. A journal is a directory of segment files named
+// journal-<base_seq>.seg, each preallocated to its full size:
+//
+//   JournalSegmentHeader                64 bytes
+//   JournalRecord x header.capacity      16 bytes each, zero until written
+//
+// A record's sequence number is its position: base_seq + slot. Records are
+// written in place through a shared mapping, so they survive a process crash
+// as soon as they are written; a commit (msync) makes them survive a machine
+// crash. Concurrent writers fill slots out of order, so an empty slot may sit
+// behind written ones. Each record carries the port's transition count after
+// the event, which makes replay independent of record order: a port's state
+// is the one in its record with the highest count.
+constexpr uint32_t kJournalMagic = 0x4C4A5043; // "CPJL"
+constexpr uint32_t kJournalVersion = 1;
+
+struct JournalSegmentHeader {
+    uint32_t magic;           // kJournalMagic
+    uint32_t version;         // kJournalVersion
+    uint64_t base_seq;        // Sequence number of slot 0
+    uint64_t capacity;        // Record slots in the segment
+    int32_t num_ports;        // Port count of the writing process
+    uint32_t record_bytes;    // sizeof(JournalRecord)
+    int64_t steady_base_ns;   // steady_clock and system_clock read together
+    int64_t realtime_base_ns; // at creation; record times are offsets from them
+    uint8_t reserved[16];
+};
+
+struct JournalRecord {
+    int32_t port_id;
+    uint32_t transitions; // The port's transition count after the event
+    uint32_t time_ms;     // When the event was applied, ms after steady_base_ns
+    PortEvent event;
+    PortState state;      // The port's state after the event
+    uint16_t check;       // journal_record_check(); 0 marks an empty slot
+};
+
+static_assert(sizeof(JournalSegmentHeader) == 64, "JournalSegmentHeader is part of the file format");
+static_assert(sizeof(JournalRecord) == 16, "JournalRecord is part of the file format");
+
+// An applied event as handed to EventJournal::append()
+struct JournalEntry {
+    int32_t port_id;
+    PortEvent event;
+    uint64_t word; // The port's state word after the event
+};
+
+// Check value of a record in slot `seq`, over every field before `check`;
+// never 0
+uint16_t journal_record_check(const JournalRecord& record, uint64_t seq);
+
+// Outcome of replaying a journal directory
+struct JournalReplay {
+    std::vector<PortRecoveryState> ports; // One per port of the replaying table
+    uint64_t segments = 0;
+    uint64_t records = 0;  // Valid records read
+    uint64_t corrupt = 0;  // Torn or damaged records (skipped)
+    uint64_t skipped = 0;  // Valid records for ports outside the table
+};
+
+// Append-only, memory-mapped journal of applied events.
+//
+// Writers reserve slots in the current segment with one fetch_add and copy
+// their records straight into the mapping; the segment lock is only taken
+// to roll over to the next segment, which the commit thread preallocates
+// ahead of time. The commit thread msyncs everything written since the last
+// commit once per commit interval (group commit), so a machine crash loses
+// at most one interval of events. It also retires segments after
+// kMaxSegmentAge, well before their 32-bit record times could wrap.
+class EventJournal {
+public:
+    static constexpr size_t kDefaultSegmentBytes = 64u << 20;
+    static constexpr size_t kMinSegmentBytes = 4096;
+    static constexpr std::chrono::hours kMaxSegmentAge{24 * 30};
+
+    EventJournal(std::string dir, int num_ports, Metrics& metrics,
+                 size_t segment_bytes = kDefaultSegmentBytes,
+                 std::chrono::milliseconds commit_interval = std::chrono::milliseconds(10));
+    ~EventJournal();
+
+    EventJournal(const EventJournal&) = delete;
+    EventJournal& operator=(const EventJournal&) = delete;
+
+    // Create the directory if needed, start a new segment after any existing
+    // ones and start the commit thread; false if the journal can't be written
+    bool open();
+
+    // Commit everything and unmap the segments. Writers must have stopped.
+    // The last segment is truncated to the records it holds.
+    void close();
+
+    bool is_open() const { return open_; }
+
+    // Append the records of events applied at `now_ns` (steady_clock).
+    // Thread-safe. If a new segment can't be created the journal stops
+    // recording (logged once) rather than blocking the caller.
+    void append(const JournalEntry* entries, size_t count, int64_t now_ns);
+
+    // Append the record of one applied event
+    void append(int32_t port_id, PortEvent event, uint64_t word, int64_t now_ns) {
+        JournalEntry entry{port_id, event, word};
+        append(&entry, 1, now_ns);
+    }
+
+    // Sync everything written so far; called by the commit thread
+    void commit();
+
+    // Records made durable by commits so far
+    uint64_t get_records_committed() const { return records_committed_.load(); }
+
+    const std::string& dir() const { return dir_; }
+
+    // Rebuild every port's state from the segments in `dir` (a missing
+    // directory replays as empty); false if the directory can't be read
+    static bool replay(const std::string& dir, int num_ports, JournalReplay& out);
+
+    // Segment files in `dir`, in sequence order
+    static std::vector<std::string> list_segments(const std::string& dir);
+
+private:
+    struct Segment;
+
+    std::unique_ptr<Segment> create_segment(uint64_t base_seq);
+    void destroy_segment(Segment& segment, bool remove_file);
+    // Make a new segment current once `full` has no slots left (or, with
+    // `retire`, close `full` early); false if the journal has failed
+    bool roll(Segment* full, bool retire = false);
+    void prepare_spare();
+    void run_commits();
+
+    std::string dir_;
+    int num_ports_;
+    uint64_t capacity_; // Record slots per segment
+    std::chrono::milliseconds commit_interval_;
+    bool open_;
+
+    std::atomic<Segment*> current_;
+    std::mutex roll_mutex_;    // Serializes segment creation; taken before segment_mutex_
+    std::mutex segment_mutex_; // Guards segments_ and spare_
+    std::vector<std::unique_ptr<Segment>> segments_;
+    std::unique_ptr<Segment> spare_; // Preallocated next segment
+    std::atomic<bool> failed_;
+
+    std::mutex commit_mutex_; // One commit at a time
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stopping_;
+    std::thread commit_thread_;
+    std::atomic<uint64_t> records_committed_;
+
+    Metrics& metrics_;
+    CounterHandle records_metric_;
+    CounterHandle commits_metric_;
+    HistogramHandle commit_latency_metric_;
+};
+
+} // namespace control_plane
@@ -2,56 +2,211 @@
 
 #include "port_manager.h"
 #include "config.h"
+#include "counter_rng.h"
+#include "event_trace.h"
+#include "flap_sampler.h"
+#include "stop_token.h"
+#include "timing_wheel.h"
+#include "work_stealing_executor.h"
 #include <thread>
 #include <vector>
 #include <atomic>
-#include <random>
+#include <chrono>
+#include <functional>
 #include <memory>
 
 namespace control_plane {
 
-// Event loop that manages simulation timing and worker threads
+// Per-port timer kinds held in the event loop's timing wheel.
+// A port has at most one pending timer at any time.
+enum class PortTimer : uint8_t {
+    HEARTBEAT,      // Next heartbeat (powers the port on if it is DOWN)
+    INIT_COMPLETE,  // Port finishes initialization
+    FLAP_RECOVERY   // Flapped port comes back and powers on again
+};
+
+// How the simulation clock advances
+enum class SimulationMode {
+    REALTIME, // One tick every tick_ms of wall-clock time
+    DISCRETE  // Virtual clock: each tick runs as soon as the last one is done
+};
+
+// Convert simulation mode to/from its config string ("realtime", "discrete")
+std::string simulation_mode_to_string(SimulationMode mode);
+bool parse_simulation_mode(const std::string& str, SimulationMode& mode);
+
+// Event loop that manages simulation timing.
+// Per-port deadlines live in a hierarchical timing wheel driven by the tick
+// thread, so each tick only touches the ports whose timers are due. The due
+// ports are handed to a work-stealing worker pool, sharded by port range.
+//
+// The wheel is the simulation's event calendar and the tick count is its
+// clock. In DISCRETE mode the tick thread never sleeps, so simulated time
+// runs as fast as the ticks can be processed; only the pacing differs from
+// REALTIME mode, and given a seed both modes apply the same events with any
+// number of workers: random draws are keyed by port and tick. With
+// tracing on (DISCRETE mode or trace_path), the events of each tick are
+// recorded in an EventTrace, phase by phase in port order.
 class EventLoop {
 public:
+    // Simulation cadence, in ticks (INIT -> UP latency is sampled per port
+    // from the configured distribution)
+    static constexpr uint64_t kHeartbeatTicks = 5;  // Heartbeat interval
+    static constexpr uint64_t kFlapCycleTicks = 10; // Flap injection interval
+    
+    // Work granularity handed to the worker pool
+    static constexpr uint32_t kTimerChunkSize = 64; // Expired timers or flaps per chunk
+
     EventLoop(std::shared_ptr<PortManager> port_manager, const Config& config);
     ~EventLoop();
-    
-    // Start the event loop and worker threads
+
+    // Start the event loop and tick thread
     void start();
-    
-    // Stop the event loop gracefully
+
+    // Stop the event loop gracefully; the tick thread is woken from its
+    // sleep, so this returns within one tick's processing, not one tick_ms
     void stop();
     
+    // Called on the tick thread once duration_ticks have run (set before start)
+    void set_finished_callback(std::function<void()> callback) { on_finished_ = std::move(callback); }
+
     // Check if running
     bool is_running() const { return running_.load(); }
     
+    // True once the simulation has run its duration_ticks
+    bool is_finished() const { return finished_.load(); }
+    
+    SimulationMode get_mode() const { return mode_; }
+    
+    // Events applied so far; valid once stopped or finished, and only
+    // recorded with tracing on
+    const EventTrace& get_trace() const { return trace_; }
+    bool is_tracing() const { return tracing_; }
+
     // Get current tick count (for determinism)
     uint64_t get_tick_count() const { return tick_count_.load(); }
+    
+    // How far behind its wall-clock deadline the last tick started
+    // (REALTIME mode)
+    std::chrono::nanoseconds get_tick_lag() const { return std::chrono::nanoseconds(tick_lag_ns_.load()); }
+    
+    // True while tick lag has stayed above tick_lag_threshold_ms for
+    // tick_lag_sustain_ms; /health reports unready
+    bool is_lagging() const { return lagging_.load(); }
+    
+    // Number of event worker threads (valid once started)
+    int get_num_workers() const { return executor_ ? executor_->get_num_workers() : 0; }
 
 private:
     std::shared_ptr<PortManager> port_manager_;
     Config config_;
+    SimulationMode mode_;
     std::atomic<bool> running_;
+    std::atomic<bool> finished_;
     std::atomic<uint64_t> tick_count_;
+    StopToken stop_token_;                // Wakes the tick thread on stop()
+    std::function<void()> on_finished_;
     
-    // Random number generation (with optional seed for determinism)
-    std::mt19937 rng_;
-    std::mutex rng_mutex_; // Protect RNG access
+    // REALTIME tick schedule: tick N is due at start + N * tick_ms, however
+    // long earlier ticks took (tick thread only, except the atomics)
+    using SteadyClock = std::chrono::steady_clock;
+    bool catch_up_skip_;                  // Else burst through overdue ticks
+    SteadyClock::time_point next_deadline_;
+    SteadyClock::time_point last_tick_start_;
+    SteadyClock::time_point lagging_since_; // Lag over threshold since; epoch = not
+    std::atomic<int64_t> tick_lag_ns_;
+    std::atomic<bool> lagging_;
     
-    // Worker threads
-    std::vector<std::thread> worker_threads_;
-    std::thread tick_thread_;
+    // Applied events, in canonical order (tick thread only)
+    bool tracing_;
+    EventTrace trace_;
+    std::vector<PortEventRecord> trace_batch_;
+
+    // Random draws keyed by (seed, port, tick), shared lock-free by the
+    // workers; the seed is config.seed or a random one
+    CounterRng rng_;
+    std::unique_ptr<FlapSampler> flap_sampler_;      // Created in start()
+    bool init_latency_exponential_;                  // Else uniform
+    std::vector<uint32_t> flap_ports_;               // Ports picked this cycle
+
+    // A timer (re)schedule produced by a worker, applied by the tick thread
+    struct TimerUpdate {
+        uint32_t port_id;
+        uint64_t deadline;
+        PortTimer timer;
+    };
+    
+    // Per-worker output of one batch, consumed by the tick thread
+    struct WorkerBuffers {
+        std::vector<PortEventRecord> events;      // Events for the current chunk
+        std::vector<TimerUpdate> timer_updates;   // Reschedules for the wheel
+        std::vector<PortEventRecord> traced;      // Applied events, when tracing
+        uint64_t flaps_injected = 0;
+    };
+    
+    // Per-port deadlines (owned by the tick thread while running)
+    std::unique_ptr<TimingWheel> wheel_;
+    std::vector<TimingWheel::Expired> expired_;
     
-    // Worker functions
+    // Worker pool and per-tick batch state
+    std::unique_ptr<WorkStealingExecutor> executor_;
+    std::vector<TimingWheel::Expired> batch_;        // Expired timers grouped by shard
+    std::vector<uint32_t> batch_bounds_;             // Shard boundaries within batch_
+    std::vector<uint32_t> port_bounds_;              // Shard boundaries over port ids
+    std::vector<WorkerBuffers> worker_buffers_;      // One per worker
+    std::vector<uint64_t> published_items_;         // Worker stats already exported
+    std::vector<uint64_t> published_steals_;
+    
+    // Metric handles, registered in start()
+    CounterHandle flaps_injected_metric_;
+    CounterHandle ticks_missed_metric_;
+    HistogramHandle tick_lag_metric_;
+    HistogramHandle tick_jitter_metric_;
+    std::vector<CounterHandle> worker_items_metrics_;
+    std::vector<CounterHandle> worker_steals_metrics_;
+
+    std::thread tick_thread_;
+
+    // Tick thread: advances the wheel and dispatches due timers to the workers
     void tick_loop();
-    void heartbeat_worker(int worker_id);
-    void flap_injector_worker(int worker_id);
     
-    // Helper: should inject flap this tick?
-    bool should_inject_flap();
+    // Wait for the next tick's deadline and choose the tick to run: the next
+    // one, or with the skip policy the latest one that is due. False if
+    // stopped while waiting.
+    bool wait_for_next_tick(uint64_t& tick);
     
-    // Helper: generate random flap duration
-    int generate_flap_duration_ms();
+    // Track how late a tick started, for the metrics and is_lagging()
+    void record_tick_lag(SteadyClock::time_point now, std::chrono::nanoseconds lag);
+
+    // Handle one expired port timer (runs on a worker); the resulting event
+    // is queued on the worker's batch
+    void on_port_timer(WorkerBuffers& buffers, int port_id, PortTimer timer, uint64_t now);
+    
+    // Apply a worker's queued events as one PortManager batch
+    void flush_events(WorkerBuffers& buffers);
+
+    // Run one flap injection pass: sample the flapping ports, then flap the
+    // ones that are UP
+    void flap_injector_cycle(uint64_t tick);
+    
+    // Apply the timer updates and flap counts produced by the last batch,
+    // and trace its events as applied at `tick`
+    void apply_worker_output(uint64_t tick);
+    
+    // Export per-worker throughput and steal counters
+    void publish_worker_metrics();
+    
+    // Shard owning a port: contiguous port ranges, one per worker
+    int shard_of(uint32_t port_id) const;
+
+    // Helper: random flap duration, from the port's draw for this cycle
+    int generate_flap_duration_ms(const CounterRng::Block& draw) const;
+
+    // Helper: INIT -> UP latency for a port powering on at `tick`, in ticks
+    uint64_t init_latency_ticks(uint32_t port_id, uint64_t tick) const;
+
+    // Helper: convert a duration in milliseconds to whole ticks (at least 1)
+    uint64_t ms_to_ticks(int ms) const;
 };
 
 } // namespace control_plane
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "metrics.h"
+#include "port_manager.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+
+namespace control_plane {
+
+// Event socket wire format (AF_UNIX SOCK_SEQPACKET, host byte order since
+// both ends share the machine). Each message is one batch:
+//
+//   EventBatchHeader                    16 bytes
+//   PortEventRecord x header.count       8 bytes each (int32 port_id,
+//                                        uint8 event, 3 bytes padding)
+//
+// and is answered, in order, by one EventBatchAck. The record layout is
+// PortEventRecord's own, so batches go from the receive buffer to
+// PortManager::process_port_events without decoding.
+constexpr uint32_t kEventBatchMagic = 0x56455043; // "CPEV"
+constexpr uint32_t kEventAckMagic = 0x41455043;   // "CPEA"
+constexpr uint32_t kMaxEventBatchRecords = 16384;
+
+struct EventBatchHeader {
+    uint32_t magic;    // kEventBatchMagic
+    uint32_t sequence; // Echoed in the ack
+    uint32_t count;    // Records that follow
+    uint32_t reserved; // 0
+};
+
+enum class EventBatchStatus : uint32_t {
+    OK = 0,
+    MALFORMED = 1 // Bad magic, or a length that does not match count; nothing applied
+};
+
+struct EventBatchAck {
+    uint32_t magic;     // kEventAckMagic
+    uint32_t sequence;  // From the batch header
+    EventBatchStatus status;
+    uint32_t applied;
+    uint32_t rejected;  // Invalid port ids or event values
+    uint32_t transitions;
+};
+
+static_assert(sizeof(EventBatchHeader) == 16, "EventBatchHeader is part of the wire format");
+static_assert(sizeof(EventBatchAck) == 24, "EventBatchAck is part of the wire format");
+static_assert(sizeof(PortEventRecord) == 8 && offsetof(PortEventRecord, event) == 4,
+              "PortEventRecord is part of the event socket wire format");
+static_assert(std::is_trivially_copyable_v<PortEventRecord>,
+              "PortEventRecord is received straight off the socket");
+
+// Optional event listener bypassing HTTP: accepts any number of clients on a
+// SOCK_SEQPACKET socket and serves them all from one epoll thread. Each
+// batch is received into one reusable buffer and applied in place.
+class EventSocketServer {
+public:
+    EventSocketServer(std::shared_ptr<PortManager> port_manager, std::string path);
+    ~EventSocketServer();
+
+    EventSocketServer(const EventSocketServer&) = delete;
+    EventSocketServer& operator=(const EventSocketServer&) = delete;
+
+    // Bind (replacing a stale socket file) and start the epoll thread;
+    // false if the socket could not be set up
+    bool start();
+
+    // Close every connection, remove the socket file and join the thread
+    void stop();
+
+    bool is_running() const { return running_.load(); }
+
+    const std::string& path() const { return path_; }
+
+private:
+    struct Connection;
+
+    void run();
+    void accept_clients();
+    // Receive and apply batches until the socket would block; false once the
+    // connection should be closed
+    bool serve(Connection& connection);
+    // Send queued acks; false on a write error
+    bool flush_acks(Connection& connection);
+    EventBatchAck apply_batch(size_t length);
+    void close_connection(int fd);
+
+    std::shared_ptr<PortManager> port_manager_;
+    std::string path_;
+    std::atomic<bool> running_;
+    int listen_fd_;
+    int epoll_fd_;
+    int wake_fd_; // eventfd that interrupts epoll_wait on stop()
+    std::thread thread_;
+    std::unique_ptr<PortEventRecord[]> buffer_; // Header slot + kMaxEventBatchRecords
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_; // By fd
+
+    CounterHandle events_injected_metric_;
+    CounterHandle batches_metric_;
+};
+
+} // namespace control_plane
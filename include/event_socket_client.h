@@ -0,0 +1,44 @@
+#pragma once
+
+#include "event_socket.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace control_plane {
+
+// Client for EventSocketServer. Batches are sent straight from the caller's
+// records (one sendmsg with the header in a separate iovec) and may be
+// pipelined: the server answers each with an ack, in order.
+class EventSocketClient {
+public:
+    EventSocketClient() = default;
+    ~EventSocketClient() { close(); }
+
+    EventSocketClient(const EventSocketClient&) = delete;
+    EventSocketClient& operator=(const EventSocketClient&) = delete;
+
+    // Connect to the server at `path`; false on failure (errno is set)
+    bool connect(const std::string& path);
+    void close();
+    bool connected() const { return fd_ >= 0; }
+
+    // Send one batch of at most kMaxEventBatchRecords records. Blocks while
+    // the socket is full. `sequence`, if non-null, receives the number the
+    // ack will carry.
+    bool send_batch(const PortEventRecord* records, size_t count, uint32_t* sequence = nullptr);
+
+    // Block for the next ack
+    bool read_ack(EventBatchAck& ack);
+
+    // Send one batch and wait for its ack
+    bool submit(const PortEventRecord* records, size_t count, EventBatchAck& ack) {
+        return send_batch(records, count) && read_ack(ack);
+    }
+
+private:
+    int fd_ = -1;
+    uint32_t next_sequence_ = 0;
+};
+
+} // namespace control_plane
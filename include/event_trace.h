@@ -0,0 +1,55 @@
+#pragma once
+
+#include "port_manager.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace control_plane {
+
+// One event applied by the simulation, as written to a trace file
+struct TraceRecord {
+    uint64_t tick;
+    int32_t port_id;
+    PortEvent event;
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(TraceRecord) == 16, "TraceRecord is part of the trace file format");
+
+// The sequence of events a simulation applied, folded into a running hash
+// and optionally written to a file of TraceRecords. Two runs produced the
+// same trace exactly when their hashes match.
+//
+// Not thread-safe: the event loop's tick thread owns it.
+class EventTrace {
+public:
+    EventTrace() = default;
+    ~EventTrace();
+
+    EventTrace(const EventTrace&) = delete;
+    EventTrace& operator=(const EventTrace&) = delete;
+
+    // Also write records to `path` (truncated); false if it can't be created
+    bool open(const std::string& path);
+
+    // Flush and close the file, if any
+    void close();
+
+    // Record events applied at `tick`, in order
+    void append(uint64_t tick, const PortEventRecord* records, size_t count);
+
+    uint64_t get_hash() const { return hash_; }
+    uint64_t get_count() const { return count_; }
+
+    // The hash as 16 hex digits
+    std::string hash_string() const;
+
+private:
+    uint64_t hash_ = 0xCBF29CE484222325ull;
+    uint64_t count_ = 0;
+    std::FILE* file_ = nullptr;
+};
+
+} // namespace control_plane
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "counter_rng.h"
+#include <cstdint>
+#include <vector>
+
+namespace control_plane {
+
+// Picks the ports that flap on one injection cycle, as if every port ran an
+// independent Bernoulli(p) trial, in time proportional to the number picked.
+//
+// The gap between picked ports is geometric: P(gap = k) = (1 - p)^k * p, so
+// the sampler draws each gap by inversion, floor(ln U / ln(1 - p)), and jumps
+// straight to the next picked port. Gaps are CounterRng draws keyed by the
+// cycle's tick, so a tick's picks are the same on every run with the seed.
+// Thread-safe: it has no mutable state.
+class FlapSampler {
+public:
+    // CounterRng stream the gaps are drawn from (per-port draws use stream 0)
+    static constexpr uint32_t kGapStream = 1;
+
+    FlapSampler(const CounterRng& rng, double probability);
+
+    // Append the ports in [0, num_ports) picked at `tick` to `ports`, in
+    // ascending order
+    void sample(uint32_t num_ports, uint64_t tick, std::vector<uint32_t>& ports) const;
+
+    // Number of ports to skip before the next pick, for a uniform draw `u`
+    // in [0, 1); saturates at UINT32_MAX
+    uint32_t gap(double u) const;
+
+    double get_probability() const { return probability_; }
+
+private:
+    CounterRng rng_;
+    double probability_;
+    double inverse_log_q_; // 1 / ln(1 - p)
+};
+
+} // namespace control_plane
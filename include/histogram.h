@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Latency histograms can be compiled out (cmake -DENABLE_LATENCY_HISTOGRAMS=OFF);
+// recording then costs nothing and no histogram series are exported.
+#ifndef CONTROL_PLANE_LATENCY_HISTOGRAMS
+#define CONTROL_PLANE_LATENCY_HISTOGRAMS 1
+#endif
+
+namespace control_plane {
+
+// Log-linear (HDR-style) bucket layout for nanosecond latencies.
+//
+// Values below kSubBuckets get one exact bucket each. Above that every power
+// of two [2^e, 2^(e+1)) is split into kSubBuckets equal buckets, so a bucket
+// is at most 25% wide relative to its lower bound. Values of 2^kMaxExponent ns
+// (~69 s) and above land in a final overflow bucket.
+struct LatencyBuckets {
+    static constexpr int kSubBucketBits = 2;
+    static constexpr uint64_t kSubBuckets = 1ull << kSubBucketBits;
+    static constexpr int kMaxExponent = 36;
+    static constexpr int kOverflow =
+        static_cast<int>(kSubBuckets + (kMaxExponent - kSubBucketBits) * kSubBuckets);
+    static constexpr int kCount = kOverflow + 1;
+
+    static int index_of(uint64_t value_ns) {
+        if (value_ns < kSubBuckets) {
+            return static_cast<int>(value_ns);
+        }
+        int exponent = 63 - __builtin_clzll(value_ns);
+        if (exponent >= kMaxExponent) {
+            return kOverflow;
+        }
+        uint64_t sub = (value_ns >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+        return static_cast<int>(kSubBuckets + (exponent - kSubBucketBits) * kSubBuckets + sub);
+    }
+
+    // Largest value that falls in `index` (inclusive, as Prometheus `le`)
+    static uint64_t upper_bound_ns(int index) {
+        if (index < static_cast<int>(kSubBuckets)) {
+            return static_cast<uint64_t>(index);
+        }
+        uint64_t offset = static_cast<uint64_t>(index) - kSubBuckets;
+        int exponent = static_cast<int>(offset / kSubBuckets) + kSubBucketBits;
+        uint64_t sub = offset % kSubBuckets;
+        return ((kSubBuckets + sub + 1) << (exponent - kSubBucketBits)) - 1;
+    }
+};
+
+// One thread's cells of one histogram
+struct HistogramCells {
+    std::atomic<uint64_t> buckets[LatencyBuckets::kCount];
+    std::atomic<uint64_t> sum_ns;
+    std::atomic<uint64_t> count;
+
+    HistogramCells() : sum_ns(0), count(0) {
+        for (auto& bucket : buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Single writer (the owning thread), so plain load/store is enough
+    void record(uint64_t value_ns) {
+        bump(buckets[LatencyBuckets::index_of(value_ns)], 1);
+        bump(sum_ns, value_ns);
+        bump(count, 1);
+    }
+
+private:
+    static void bump(std::atomic<uint64_t>& cell, uint64_t value) {
+        cell.store(cell.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+};
+
+// Monotonic nanosecond clock used for latency measurements
+inline uint64_t latency_clock_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace control_plane
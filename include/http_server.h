@@ -3,11 +3,14 @@
 #include "port_manager.h"
 #include <memory>
 #include <atomic>
+#include <functional>
+#include <string>
 #include <thread>
 
 namespace control_plane {
 
-// Minimal HTTP server for health and metrics endpoints
+// Minimal HTTP server for health, metrics, port status and event injection
+// endpoints
 class HttpServer {
 public:
     HttpServer(std::shared_ptr<PortManager> port_manager, int port = 8080);
@@ -21,11 +24,24 @@ public:
     
     // Check if running
     bool is_running() const { return running_.load(); }
+    
+    // Enable POST /snapshot, writing the port table to `path`. Call before
+    // start().
+    void set_snapshot_path(std::string path) { snapshot_path_ = std::move(path); }
+    
+    // Readiness check behind /health: returns false with a reason to report
+    // 503 unready. /health/live stays ok regardless. Call before start().
+    using HealthCheck = std::function<bool(std::string& reason)>;
+    void set_health_check(HealthCheck check) { health_check_ = std::move(check); }
 
 private:
     std::shared_ptr<PortManager> port_manager_;
     int port_;
+    std::string snapshot_path_; // Empty: POST /snapshot is not available
+    HealthCheck health_check_;  // Empty: always ready
     std::atomic<bool> running_;
+    HistogramHandle metrics_render_metric_; // /metrics render time
+    CounterHandle events_injected_metric_;  // Events applied through POST /events
     
     // Implementation details hidden (uses cpp-httplib)
     void* server_impl_; // Opaque pointer to avoid header dependency
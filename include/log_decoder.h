@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace control_plane {
+
+// Turns a binary log stream (LogOutputFormat::BINARY, layout in log_format.h)
+// back into the JSON lines the logger would have written. Input can arrive
+// in arbitrary pieces; a frame split across feed() calls is held until it is
+// complete.
+class BinaryLogDecoder {
+public:
+    BinaryLogDecoder();
+
+    // Decode every complete frame in `data`, appending JSON lines to `out`.
+    // Returns false (and stops) on a malformed stream; see error().
+    bool feed(const char* data, size_t size, std::string& out);
+
+    // True if no partial frame is waiting for more input
+    bool at_frame_boundary() const { return pending_.empty(); }
+
+    uint64_t records_decoded() const { return records_; }
+    const std::string& error() const { return error_; }
+
+private:
+    // Decode one frame at the start of `input`. Returns the bytes consumed,
+    // 0 if the frame is incomplete, or sets error_.
+    size_t decode_frame(std::string_view input, std::string& out);
+    size_t decode_record(std::string_view input, std::string& out);
+
+    // Expand `fmt` with the arguments encoded in `payload`
+    bool format_message(std::string_view fmt, std::string_view payload);
+
+    std::string pending_;
+    bool stream_started_;
+    std::vector<std::string> templates_;
+    std::vector<std::string> components_;
+    uint64_t records_;
+    std::string error_;
+};
+
+} // namespace control_plane
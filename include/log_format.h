@@ -0,0 +1,254 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace control_plane {
+
+// Message formatting shared by the logger's text and binary outputs and by
+// the offline decoder, so a decoded binary log matches what the JSON output
+// would have printed.
+
+// Enums that log by name. Specialise with a stable kKind (written to binary
+// logs in place of the name) and a name() lookup; other enums log as their
+// underlying value.
+template <typename T>
+struct LogEnum {
+    static constexpr bool kNamed = false;
+};
+
+// Fixed-capacity message buffer the format front end writes into. Output past
+// kCapacity is cut off and marked with a trailing "...".
+class LogLineBuffer {
+public:
+    static constexpr size_t kCapacity = 1024;
+
+    void clear() { size_ = 0; }
+    std::string_view view() const { return {data_, size_}; }
+
+    void append(std::string_view text) {
+        size_t room = kCapacity - size_;
+        if (text.size() > room) {
+            std::memcpy(data_ + size_, text.data(), room);
+            size_ = kCapacity;
+            std::memcpy(data_ + kCapacity - 3, "...", 3);
+            return;
+        }
+        std::memcpy(data_ + size_, text.data(), text.size());
+        size_ += text.size();
+    }
+
+    template <typename T>
+    void append_number(T value) {
+        char digits[32];
+        std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+        append(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+    }
+
+private:
+    char data_[kCapacity];
+    size_t size_ = 0;
+};
+
+// Append one log argument: strings as-is, numbers via to_chars, named enums
+// by name and other enums as their underlying value
+template <typename T>
+void append_log_arg(LogLineBuffer& out, const T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        out.append(value ? "true" : "false");
+    } else if constexpr (std::is_same_v<T, char>) {
+        out.append(std::string_view(&value, 1));
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        out.append_number(value);
+    } else if constexpr (std::is_enum_v<T>) {
+        if constexpr (LogEnum<T>::kNamed) {
+            out.append(LogEnum<T>::name(value));
+        } else {
+            out.append_number(static_cast<std::underlying_type_t<T>>(value));
+        }
+    } else {
+        out.append(std::string_view(value));
+    }
+}
+
+// Format `fmt` into `out`, replacing each "{}" with the next argument.
+// Placeholders without an argument are copied through.
+inline void format_log_message(LogLineBuffer& out, std::string_view fmt) {
+    out.append(fmt);
+}
+
+template <typename T, typename... Rest>
+void format_log_message(LogLineBuffer& out, std::string_view fmt, const T& first, const Rest&... rest) {
+    size_t pos = fmt.find("{}");
+    if (pos == std::string_view::npos) {
+        out.append(fmt);
+        return;
+    }
+    out.append(fmt.substr(0, pos));
+    append_log_arg(out, first);
+    format_log_message(out, fmt.substr(pos + 2), rest...);
+}
+
+// Binary log stream layout (host byte order). The stream starts with
+// kBinaryLogMagic, followed by frames that each begin with a BinaryLogFrame
+// tag:
+//   TEMPLATE   u16 id, varint length, bytes   (a message template)
+//   COMPONENT  u16 id, varint length, bytes   (a component name)
+//   RECORD     u8 level, u16 component id, u16 template id, i64 timestamp_ns,
+//              i32 port_id, varint payload length, payload
+// Templates and components are defined once per stream, before the first
+// record that uses them. Template 0 is the implicit "{}" and component 0 is
+// "no component". The payload is a sequence of arguments, each a
+// BinaryLogArg tag followed by its value.
+inline constexpr char kBinaryLogMagic[8] = {'C', 'P', 'L', 'O', 'G', 'B', '1', '\n'};
+
+enum class BinaryLogFrame : uint8_t {
+    TEMPLATE = 1,
+    COMPONENT = 2,
+    RECORD = 3
+};
+
+enum class BinaryLogArg : uint8_t {
+    INT = 0,    // zigzag varint
+    UINT = 1,   // varint
+    DOUBLE = 2, // 8 bytes
+    FLOAT = 3,  // 4 bytes
+    STRING = 4, // varint length, bytes
+    BOOL_FALSE = 5,
+    BOOL_TRUE = 6,
+    ENUM = 7    // u8 kind (LogEnum::kKind), u8 value
+};
+
+// Fixed header size of a RECORD frame, tag included, before the payload length
+constexpr size_t kBinaryLogRecordHeader = 1 + 1 + 2 + 2 + 8 + 4;
+
+// Encodes log arguments into a caller-provided buffer. An argument that does
+// not fit is left out (strings are cut short and marked with "..."), and
+// every later one with it, so the payload always stays well-formed.
+class BinaryArgWriter {
+public:
+    BinaryArgWriter(char* data, size_t capacity) : data_(data), capacity_(capacity), size_(0),
+                                                   full_(false) {}
+
+    size_t size() const { return size_; }
+
+    void put_int(int64_t value) {
+        uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        put_varint_arg(BinaryLogArg::INT, zigzag);
+    }
+
+    void put_uint(uint64_t value) { put_varint_arg(BinaryLogArg::UINT, value); }
+
+    void put_double(double value) { put_fixed(BinaryLogArg::DOUBLE, &value, sizeof(value)); }
+    void put_float(float value) { put_fixed(BinaryLogArg::FLOAT, &value, sizeof(value)); }
+
+    void put_bool(bool value) {
+        put_fixed(value ? BinaryLogArg::BOOL_TRUE : BinaryLogArg::BOOL_FALSE, nullptr, 0);
+    }
+
+    void put_enum(uint8_t kind, uint8_t value) {
+        uint8_t bytes[2] = {kind, value};
+        put_fixed(BinaryLogArg::ENUM, bytes, sizeof(bytes));
+    }
+
+    void put_string(std::string_view text) {
+        if (full_) {
+            return;
+        }
+        // Tag plus a length varint of at most 3 bytes for any text that fits
+        size_t room = capacity_ - size_;
+        if (room < 4 + 3) {
+            full_ = true;
+            return;
+        }
+        bool truncated = text.size() > room - 4;
+        size_t length = truncated ? room - 4 : text.size();
+        data_[size_++] = static_cast<char>(BinaryLogArg::STRING);
+        append_varint(length);
+        if (truncated) {
+            std::memcpy(data_ + size_, text.data(), length - 3);
+            std::memcpy(data_ + size_ + length - 3, "...", 3);
+            full_ = true;
+        } else {
+            std::memcpy(data_ + size_, text.data(), length);
+        }
+        size_ += length;
+    }
+
+    // Append an unsigned LEB128 varint (no bounds check)
+    static size_t encode_varint(char* out, uint64_t value) {
+        size_t n = 0;
+        while (value >= 0x80) {
+            out[n++] = static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        out[n++] = static_cast<char>(value);
+        return n;
+    }
+
+private:
+    void put_varint_arg(BinaryLogArg tag, uint64_t value) {
+        if (full_ || capacity_ - size_ < 1 + 10) {
+            full_ = true;
+            return;
+        }
+        data_[size_++] = static_cast<char>(tag);
+        append_varint(value);
+    }
+
+    void put_fixed(BinaryLogArg tag, const void* value, size_t size) {
+        if (full_ || capacity_ - size_ < 1 + size) {
+            full_ = true;
+            return;
+        }
+        data_[size_++] = static_cast<char>(tag);
+        if (size > 0) {
+            std::memcpy(data_ + size_, value, size);
+        }
+        size_ += size;
+    }
+
+    void append_varint(uint64_t value) { size_ += encode_varint(data_ + size_, value); }
+
+    char* data_;
+    size_t capacity_;
+    size_t size_;
+    bool full_;
+};
+
+// Encode one log argument; mirrors append_log_arg
+template <typename T>
+void encode_log_arg(BinaryArgWriter& out, const T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        out.put_bool(value);
+    } else if constexpr (std::is_same_v<T, char>) {
+        out.put_string(std::string_view(&value, 1));
+    } else if constexpr (std::is_same_v<T, float>) {
+        out.put_float(value);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        out.put_double(static_cast<double>(value));
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        out.put_int(static_cast<int64_t>(value));
+    } else if constexpr (std::is_integral_v<T>) {
+        out.put_uint(static_cast<uint64_t>(value));
+    } else if constexpr (std::is_enum_v<T>) {
+        if constexpr (LogEnum<T>::kNamed) {
+            out.put_enum(LogEnum<T>::kKind, static_cast<uint8_t>(value));
+        } else {
+            encode_log_arg(out, static_cast<std::underlying_type_t<T>>(value));
+        }
+    } else {
+        out.put_string(std::string_view(value));
+    }
+}
+
+template <typename... Args>
+void encode_log_args(BinaryArgWriter& out, const Args&... args) {
+    (encode_log_arg(out, args), ...);
+}
+
+} // namespace control_plane
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace control_plane {
+
+// Token-bucket limiter for log records, keyed by (component, port, level).
+//
+// Each key gets `burst` records up front and then `rate` records per second.
+// The bucket is kept as a single "theoretical arrival time" per key (the
+// GCRA form of a token bucket), so a check is one load and one CAS on that
+// key's slot; no locks are taken. Keys live in a fixed open-addressed table;
+// if it fills up, new keys are not limited.
+//
+// Suppressed records are counted per key. A key's suppression window closes
+// once its bucket has refilled; the count is then handed back exactly once,
+// either to the next allowed record for that key or to collect().
+class LogRateLimiter {
+public:
+    static constexpr size_t kSlots = 4096;
+    static constexpr size_t kMaxProbe = 16;
+
+    struct Suppression {
+        uint64_t count = 0;    // Records suppressed in the window
+        int64_t window_ns = 0; // From the first suppressed record to now
+    };
+
+    // `records_per_sec` <= 0 disables limiting. Every bucket starts full
+    // again. Call while no other thread is logging.
+    void configure(double records_per_sec, uint32_t burst) {
+        if (records_per_sec <= 0 || burst == 0) {
+            enabled_.store(false, std::memory_order_release);
+            return;
+        }
+        if (!slots_) {
+            slots_.reset(new Slot[kSlots]);
+        }
+        for (size_t i = 0; i < kSlots; i++) {
+            slots_[i].tat_ns.store(0, std::memory_order_relaxed);
+        }
+        int64_t interval = static_cast<int64_t>(1e9 / records_per_sec);
+        interval_ns_.store(interval > 0 ? interval : 1, std::memory_order_relaxed);
+        tolerance_ns_.store(interval_ns_.load(std::memory_order_relaxed) * (static_cast<int64_t>(burst) - 1),
+                            std::memory_order_relaxed);
+        enabled_.store(true, std::memory_order_release);
+    }
+
+    bool enabled() const { return enabled_.load(std::memory_order_acquire); }
+
+    // Pack a key; never 0
+    static uint64_t make_key(uint16_t component_id, int32_t port_id, uint8_t level) {
+        return (1ull << 63) | (static_cast<uint64_t>(component_id) << 40) |
+               (static_cast<uint64_t>(level) << 32) | static_cast<uint32_t>(port_id);
+    }
+
+    static uint16_t key_component(uint64_t key) { return static_cast<uint16_t>(key >> 40); }
+    static uint8_t key_level(uint64_t key) { return static_cast<uint8_t>(key >> 32); }
+    static int32_t key_port(uint64_t key) { return static_cast<int32_t>(static_cast<uint32_t>(key)); }
+
+    // Whether a record for `key` may be written at `now_ns` (monotonic). If
+    // the key was suppressing records and this one is allowed, `closed`
+    // receives the finished window.
+    bool allow(uint64_t key, int64_t now_ns, Suppression& closed) {
+        Slot* slot = find_slot(key);
+        if (!slot) {
+            return true;
+        }
+
+        int64_t interval = interval_ns_.load(std::memory_order_relaxed);
+        int64_t tolerance = tolerance_ns_.load(std::memory_order_relaxed);
+        int64_t tat = slot->tat_ns.load(std::memory_order_relaxed);
+        while (true) {
+            if (now_ns < tat - tolerance) {
+                if (slot->suppressed.fetch_add(1, std::memory_order_relaxed) == 0) {
+                    slot->first_suppressed_ns.store(now_ns, std::memory_order_relaxed);
+                }
+                total_suppressed_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            int64_t next = (tat > now_ns ? tat : now_ns) + interval;
+            if (slot->tat_ns.compare_exchange_weak(tat, next, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        if (slot->suppressed.load(std::memory_order_relaxed) != 0) {
+            take(*slot, now_ns, closed);
+        }
+        return true;
+    }
+
+    // Hand every closed window (all windows with suppressed records if
+    // `force`) to on_closed(key, Suppression)
+    template <typename OnClosed>
+    void collect(int64_t now_ns, bool force, OnClosed on_closed) {
+        if (!slots_) {
+            return;
+        }
+        for (size_t i = 0; i < kSlots; i++) {
+            Slot& slot = slots_[i];
+            if (slot.suppressed.load(std::memory_order_relaxed) == 0) {
+                continue;
+            }
+            if (!force && now_ns < slot.tat_ns.load(std::memory_order_relaxed)) {
+                continue; // Bucket still empty: the window is open
+            }
+            Suppression closed;
+            take(slot, now_ns, closed);
+            if (closed.count > 0) {
+                on_closed(slot.key.load(std::memory_order_relaxed), closed);
+            }
+        }
+    }
+
+    // Records suppressed since startup
+    uint64_t total_suppressed() const { return total_suppressed_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> key{0};
+        std::atomic<int64_t> tat_ns{0};
+        std::atomic<uint64_t> suppressed{0};
+        std::atomic<int64_t> first_suppressed_ns{0};
+    };
+
+    Slot* find_slot(uint64_t key) {
+        uint64_t hash = key * 0x9E3779B97F4A7C15ull;
+        size_t index = static_cast<size_t>(hash >> 40);
+        for (size_t probe = 0; probe < kMaxProbe; probe++) {
+            Slot& slot = slots_[(index + probe) & (kSlots - 1)];
+            uint64_t current = slot.key.load(std::memory_order_acquire);
+            if (current == key) {
+                return &slot;
+            }
+            if (current == 0) {
+                uint64_t empty = 0;
+                if (slot.key.compare_exchange_strong(empty, key, std::memory_order_acq_rel) ||
+                    empty == key) {
+                    return &slot;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    static void take(Slot& slot, int64_t now_ns, Suppression& closed) {
+        int64_t first = slot.first_suppressed_ns.load(std::memory_order_relaxed);
+        closed.count = slot.suppressed.exchange(0, std::memory_order_relaxed);
+        closed.window_ns = now_ns > first ? now_ns - first : 0;
+    }
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<int64_t> interval_ns_{0};
+    std::atomic<int64_t> tolerance_ns_{0};
+    std::atomic<uint64_t> total_suppressed_{0};
+    std::unique_ptr<Slot[]> slots_;
+};
+
+} // namespace control_plane
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+
+namespace control_plane {
+
+// One log line as queued by the async logger: fixed size, no heap data, so
+// producers only copy bytes into the ring
+struct LogRecord {
+    static constexpr size_t kMaxComponent = 28;
+    static constexpr size_t kMaxMessage = 208;
+
+    int64_t timestamp_ns;   // system_clock, since the epoch
+    int32_t port_id;        // -1 if none
+    uint8_t level;          // LogLevel
+    uint8_t component_len;
+    uint16_t message_len;
+    uint16_t template_id;   // Binary output: interned template; `message` holds encoded args
+    uint16_t component_id;  // Binary output: interned component
+    char component[kMaxComponent];
+    char message[kMaxMessage];
+
+    std::string_view component_view() const { return {component, component_len}; }
+    std::string_view message_view() const { return {message, message_len}; }
+
+    // Copy `text` into `message`, marking truncation with a trailing "..."
+    void set_message(std::string_view text) {
+        if (text.size() <= kMaxMessage) {
+            message_len = static_cast<uint16_t>(text.size());
+            std::memcpy(message, text.data(), text.size());
+            return;
+        }
+        message_len = kMaxMessage;
+        std::memcpy(message, text.data(), kMaxMessage - 3);
+        std::memcpy(message + kMaxMessage - 3, "...", 3);
+    }
+
+    void set_component(std::string_view text) {
+        component_len = static_cast<uint8_t>(std::min(text.size(), kMaxComponent));
+        std::memcpy(component, text.data(), component_len);
+    }
+};
+
+static_assert(sizeof(LogRecord) == 256, "LogRecord should stay one fixed 256-byte slot");
+
+// Bounded lock-free queue of LogRecords (Vyukov's array queue).
+//
+// Each cell carries a sequence number that tells producers and the consumer
+// whether it is free or full for the current lap, so a push is one CAS on the
+// tail plus a copy, and the single consumer never takes a lock. Safe for any
+// number of producers and one consumer.
+class LogRing {
+public:
+    // `capacity` is rounded up to a power of two
+    explicit LogRing(size_t capacity) : mask_(round_up(capacity) - 1),
+                                        cells_(new Cell[mask_ + 1]),
+                                        enqueue_pos_(0), dequeue_pos_(0) {
+        for (size_t i = 0; i <= mask_; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // Returns false if the ring is full
+    bool try_push(const LogRecord& record) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->record = record;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if the ring is empty (single consumer only)
+    bool try_pop(LogRecord& record) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Cell* cell = &cells_[pos & mask_];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1) < 0) {
+            return false;
+        }
+        dequeue_pos_.store(pos + 1, std::memory_order_relaxed);
+        record = cell->record;
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<size_t> sequence;
+        LogRecord record;
+    };
+
+    static size_t round_up(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> enqueue_pos_;
+    alignas(64) std::atomic<size_t> dequeue_pos_;
+};
+
+} // namespace control_plane
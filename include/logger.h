@@ -1,79 +1,392 @@
 #pragma once
 
+#include "log_format.h"
+#include "log_rate_limiter.h"
+#include "log_ring.h"
 #include <string>
+#include <string_view>
+#include <cstring>
 #include <sstream>
 #include <iostream>
 #include <chrono>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+// Lowest level compiled in: 0=DEBUG, 1=INFO, 2=WARN, 3=ERROR. Calls below it
+// through the *f front end compile to nothing. Defaults to INFO when NDEBUG
+// is defined (release builds) and DEBUG otherwise.
+#ifndef CONTROL_PLANE_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define CONTROL_PLANE_LOG_MIN_LEVEL 1
+#else
+#define CONTROL_PLANE_LOG_MIN_LEVEL 0
+#endif
+#endif
 
 namespace control_plane {
 
 // Log levels
-enum class LogLevel {
+enum class LogLevel : uint8_t {
     DEBUG,
     INFO,
     WARN,
     ERROR
 };
 
+// What an async producer does when the ring is full
+enum class LogOverflowPolicy {
+    BLOCK, // Wait for the writer to make room
+    DROP   // Discard the record and count it
+};
+
+// Output encoding
+enum class LogOutputFormat {
+    JSON,  // One JSON object per line
+    BINARY // Compact records with interned templates (see log_format.h)
+};
+
 // Convert log level to string
 std::string log_level_to_string(LogLevel level);
+std::string_view log_level_name(LogLevel level);
 
 // Parse log level from string
 LogLevel parse_log_level(const std::string& level_str);
 
+// Convert overflow policy to/from its config string ("block", "drop")
+std::string log_overflow_policy_to_string(LogOverflowPolicy policy);
+bool parse_log_overflow_policy(const std::string& str, LogOverflowPolicy& policy);
+
+// Convert output format to/from its config string ("json", "binary")
+std::string log_output_format_to_string(LogOutputFormat format);
+bool parse_log_output_format(const std::string& str, LogOutputFormat& format);
+
+// Append one JSON log line, as the logger writes it (also used by the binary
+// log decoder)
+void append_log_json_line(std::string& out, int64_t timestamp_ns, LogLevel level,
+                          std::string_view message, std::string_view component, int port_id);
+
 // Structured JSON logger (thread-safe)
+//
+// In the default synchronous mode each call formats its line and writes it
+// with one write(2) under a mutex. In async mode (start_async) callers copy a
+// fixed-size LogRecord into a lock-free ring and return; a background writer
+// thread formats records and writes them in large batches.
+//
+// With the BINARY output format, templated calls are written as a fixed
+// header plus their encoded arguments, and each message template and
+// component name is written once per stream; tools/log_decoder turns the
+// stream back into JSON lines.
+//
+// Optional rate limits (set_rate_limit) drop records per (component, port,
+// level) past a token-bucket budget and later log one summary line with the
+// number suppressed.
+//
+// Hot paths should use the format front end (debugf/infof/warnf/errorf),
+// which checks the level before formatting anything and formats into a
+// thread-local buffer, so a filtered call costs one relaxed load and an
+// enabled one does no heap allocation.
 class Logger {
 public:
+    static constexpr LogLevel kCompiledMinLevel = static_cast<LogLevel>(CONTROL_PLANE_LOG_MIN_LEVEL);
+
     static Logger& instance() {
         static Logger logger;
         return logger;
     }
-    
+
+    ~Logger();
+
     // Set minimum log level
     void set_level(LogLevel level) {
-        min_level_ = level;
+        min_level_.store(level, std::memory_order_relaxed);
+    }
+
+    // Whether a record at `level` would be written
+    bool enabled(LogLevel level) const {
+        return level >= kCompiledMinLevel && level >= min_level_.load(std::memory_order_relaxed);
+    }
+
+    // Switch to async mode with a ring of `capacity` records (rounded up to a
+    // power of two). No-op if already async.
+    void start_async(size_t capacity, LogOverflowPolicy policy);
+
+    // Write out everything queued and return to synchronous mode. Call once
+    // the other logging threads have stopped; a record racing the switch is
+    // written by the next drain.
+    void stop_async();
+
+    bool is_async() const { return async_active_.load(std::memory_order_acquire); }
+
+    // Block until every record queued before the call has been written
+    // (reports open suppression windows first)
+    void flush();
+
+    // Records discarded by the DROP overflow policy
+    uint64_t get_dropped_count() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // Limit each (component, port, level) to `records_per_sec` after an
+    // initial `burst`; a rate <= 0 turns limiting off
+    void set_rate_limit(double records_per_sec, uint32_t burst) {
+        rate_limiter_.configure(records_per_sec, burst);
     }
-    
+
+    // Records dropped by the rate limit
+    uint64_t get_suppressed_count() const { return rate_limiter_.total_suppressed(); }
+
+    // Log a summary line for every key that suppressed records since its
+    // last summary, whether or not its window has closed
+    void report_suppressed();
+
+    // Redirect output (default: stdout). A binary stream starts over on the
+    // new fd.
+    void set_output_fd(int fd);
+
+    // Select JSON or binary output. Fails while async (records already queued
+    // were encoded for the current format).
+    bool set_format(LogOutputFormat format);
+    LogOutputFormat get_format() const { return format_.load(std::memory_order_relaxed); }
+
     // Log a structured message
-    void log(LogLevel level, const std::string& message, 
-             const std::string& component = "",
-             int port_id = -1);
-    
+    void log(LogLevel level, std::string_view message,
+             std::string_view component = "",
+             int port_id = -1) {
+        if (enabled(level) && admit(level, component, port_id)) {
+            write_record(level, message, component, port_id);
+        }
+    }
+
     // Convenience methods
-    void debug(const std::string& message, const std::string& component = "", int port_id = -1) {
+    void debug(std::string_view message, std::string_view component = "", int port_id = -1) {
         log(LogLevel::DEBUG, message, component, port_id);
     }
-    
-    void info(const std::string& message, const std::string& component = "", int port_id = -1) {
+
+    void info(std::string_view message, std::string_view component = "", int port_id = -1) {
         log(LogLevel::INFO, message, component, port_id);
     }
-    
-    void warn(const std::string& message, const std::string& component = "", int port_id = -1) {
+
+    void warn(std::string_view message, std::string_view component = "", int port_id = -1) {
         log(LogLevel::WARN, message, component, port_id);
     }
-    
-    void error(const std::string& message, const std::string& component = "", int port_id = -1) {
+
+    void error(std::string_view message, std::string_view component = "", int port_id = -1) {
         log(LogLevel::ERROR, message, component, port_id);
     }
 
+    // Format front end: `fmt` uses "{}" placeholders, e.g.
+    //   infof("PortManager", port, "Port {} went {}", port, state);
+    // Arguments are only formatted if the level is enabled and the record is
+    // within its rate limit. In binary mode
+    // `fmt` is interned and the arguments are encoded instead of formatted.
+    template <typename... Args>
+    void logf(LogLevel level, std::string_view component, int port_id,
+              std::string_view fmt, const Args&... args) {
+        if (enabled(level) && admit(level, component, port_id)) {
+            emit(level, component, port_id, fmt, args...);
+        }
+    }
+
+    template <typename... Args>
+    void debugf(std::string_view component, int port_id, std::string_view fmt, const Args&... args) {
+        if constexpr (kCompiledMinLevel <= LogLevel::DEBUG) {
+            logf(LogLevel::DEBUG, component, port_id, fmt, args...);
+        }
+    }
+
+    template <typename... Args>
+    void infof(std::string_view component, int port_id, std::string_view fmt, const Args&... args) {
+        if constexpr (kCompiledMinLevel <= LogLevel::INFO) {
+            logf(LogLevel::INFO, component, port_id, fmt, args...);
+        }
+    }
+
+    template <typename... Args>
+    void warnf(std::string_view component, int port_id, std::string_view fmt, const Args&... args) {
+        if constexpr (kCompiledMinLevel <= LogLevel::WARN) {
+            logf(LogLevel::WARN, component, port_id, fmt, args...);
+        }
+    }
+
+    template <typename... Args>
+    void errorf(std::string_view component, int port_id, std::string_view fmt, const Args&... args) {
+        logf(LogLevel::ERROR, component, port_id, fmt, args...);
+    }
+
 private:
-    Logger() : min_level_(LogLevel::INFO) {}
-    
-    LogLevel min_level_;
-    std::mutex mutex_;
-    
-    // Get ISO8601 timestamp
-    std::string get_timestamp() const;
-    
-    // Escape JSON string
-    std::string escape_json(const std::string& str) const;
+    Logger();
+
+    // Records per write(2) batch are flushed once the buffer reaches this size
+    static constexpr size_t kWriteBatchBytes = 64 * 1024;
+
+    // Interned strings: id 0 is reserved, texts never move once added
+    struct InternTable {
+        std::mutex mutex;
+        std::deque<std::string> texts;
+        std::unordered_map<std::string_view, uint16_t> ids;
+    };
+
+    // Per-thread direct-mapped cache in front of an InternTable
+    struct InternCacheEntry {
+        const char* key;
+        size_t size;
+        const char* stored;
+        uint16_t id;
+    };
+    static constexpr size_t kInternCacheSlots = 64;
+
+    std::atomic<LogLevel> min_level_;
+    std::atomic<int> output_fd_;
+    std::atomic<LogOutputFormat> format_;
+    std::mutex mutex_;        // Serializes mode switches
+    std::mutex output_mutex_; // Serializes writes and the binary stream state below
+
+    // Binary stream state (guarded by output_mutex_)
+    bool stream_started_;
+    std::vector<bool> templates_written_;
+    std::vector<bool> components_written_;
+
+    InternTable templates_;
+    InternTable components_;
+
+    LogRateLimiter rate_limiter_;
+    std::atomic<int64_t> next_suppression_sweep_ns_;
+
+    // How often logging calls look for keys that went quiet with records
+    // still suppressed
+    static constexpr int64_t kSuppressionSweepNs = 1000000000;
+
+    // Async state
+    std::unique_ptr<LogRing> ring_;
+    std::atomic<bool> async_active_;
+    LogOverflowPolicy overflow_policy_;
+    std::thread writer_thread_;
+    std::atomic<bool> writer_stop_;
+    std::atomic<bool> writer_idle_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::atomic<uint64_t> enqueued_;
+    std::atomic<uint64_t> written_;
+    std::atomic<uint64_t> dropped_;
+
+    // Write a templated record that passed the level and rate checks
+    template <typename... Args>
+    void emit(LogLevel level, std::string_view component, int port_id,
+              std::string_view fmt, const Args&... args) {
+        if (format_.load(std::memory_order_relaxed) == LogOutputFormat::BINARY) {
+            LogRecord record;
+            record.template_id = intern_template(fmt);
+            BinaryArgWriter writer(record.message, LogRecord::kMaxMessage);
+            encode_log_args(writer, args...);
+            record.message_len = static_cast<uint16_t>(writer.size());
+            write_binary_record(record, level, component, port_id);
+            return;
+        }
+        LogLineBuffer& buffer = format_buffer();
+        buffer.clear();
+        format_log_message(buffer, fmt, args...);
+        write_record(level, buffer.view(), component, port_id);
+    }
+
+
+    // Rate limit check; true if the record may be written
+    bool admit(LogLevel level, std::string_view component, int port_id) {
+        return !rate_limiter_.enabled() || admit_limited(level, component, port_id);
+    }
+
+    bool admit_limited(LogLevel level, std::string_view component, int port_id);
+
+    // Log the summary for a closed suppression window
+    void emit_suppression(uint64_t key, const LogRateLimiter::Suppression& closed);
+
+    // Write one record that passed the level check
+    void write_record(LogLevel level, std::string_view message,
+                      std::string_view component, int port_id);
+
+    static LogLineBuffer& format_buffer() {
+        static thread_local LogLineBuffer buffer;
+        return buffer;
+    }
+
+    // Fill in the rest of a binary record (template and payload already set)
+    // and queue or write it
+    void write_binary_record(LogRecord& record, LogLevel level,
+                             std::string_view component, int port_id);
+
+    // Ids for message templates and component names (0 if the table is full,
+    // or for an empty component)
+    uint16_t intern_template(std::string_view text) {
+        static thread_local InternCacheEntry cache[kInternCacheSlots];
+        return intern_cached(cache, templates_, text);
+    }
+
+    uint16_t intern_component(std::string_view text) {
+        static thread_local InternCacheEntry cache[kInternCacheSlots];
+        return text.empty() ? 0 : intern_cached(cache, components_, text);
+    }
+
+    uint16_t intern_cached(InternCacheEntry* cache, InternTable& table, std::string_view text) {
+        InternCacheEntry& entry = cache[((reinterpret_cast<uintptr_t>(text.data()) >> 3) ^ text.size()) &
+                                        (kInternCacheSlots - 1)];
+        // The content check keeps reused (non-literal) buffers correct
+        if (entry.key == text.data() && entry.size == text.size() &&
+            std::memcmp(entry.stored, text.data(), text.size()) == 0) {
+            return entry.id;
+        }
+        const char* stored = nullptr;
+        uint16_t id = intern(table, text, stored);
+        if (stored == nullptr) {
+            // Table full: not cached, since there is no stored copy to check
+            // a later call's contents against
+            return id;
+        }
+        entry.id = id;
+        entry.stored = stored;
+        entry.key = text.data();
+        entry.size = text.size();
+        return entry.id;
+    }
+
+    // Id of `text`, added if new; `stored` is set to the table's copy, or
+    // to null when the table is full and the reserved id 0 is returned
+    static uint16_t intern(InternTable& table, std::string_view text, const char*& stored);
+    static std::string_view interned_text(InternTable& table, uint16_t id);
+
+    // Append a record in the current output format (output_mutex_ held)
+    void append_record(std::string& out, const LogRecord& record);
+    void append_binary_record(std::string& out, const LogRecord& record);
+    void append_definition(std::string& out, BinaryLogFrame frame, InternTable& table,
+                           std::vector<bool>& written, uint16_t id);
+
+    // Queue a record (async mode); false if it was dropped or the logger left
+    // async mode
+    bool enqueue(const LogRecord& record);
+
+    // Writer thread body and one drain pass (returns records written)
+    void writer_loop();
+    size_t drain(std::string& buffer);
+
+    // Write a whole buffer to the output fd
+    void write_all(const std::string& buffer);
+
+    static int64_t now_ns();
+    static int64_t steady_now_ns();
 };
 
-// Convenience macros
-#define LOG_DEBUG(msg, comp, port) control_plane::Logger::instance().debug(msg, comp, port)
-#define LOG_INFO(msg, comp, port) control_plane::Logger::instance().info(msg, comp, port)
-#define LOG_WARN(msg, comp, port) control_plane::Logger::instance().warn(msg, comp, port)
-#define LOG_ERROR(msg, comp, port) control_plane::Logger::instance().error(msg, comp, port)
+// Convenience macros; the message expression is only evaluated if the level
+// is enabled
+#define CONTROL_PLANE_LOG_AT(level, msg, comp, port) \
+    do { \
+        if (control_plane::Logger::instance().enabled(level)) \
+            control_plane::Logger::instance().log(level, msg, comp, port); \
+    } while (0)
+#define LOG_DEBUG(msg, comp, port) CONTROL_PLANE_LOG_AT(control_plane::LogLevel::DEBUG, msg, comp, port)
+#define LOG_INFO(msg, comp, port) CONTROL_PLANE_LOG_AT(control_plane::LogLevel::INFO, msg, comp, port)
+#define LOG_WARN(msg, comp, port) CONTROL_PLANE_LOG_AT(control_plane::LogLevel::WARN, msg, comp, port)
+#define LOG_ERROR(msg, comp, port) CONTROL_PLANE_LOG_AT(control_plane::LogLevel::ERROR, msg, comp, port)
 
 } // namespace control_plane
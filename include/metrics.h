@@ -1,42 +1,356 @@
 #pragma once
 
+#include "histogram.h"
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <map>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace control_plane {
 
-// Thread-safe metrics collector for Prometheus-style exposition
+// Handle to a registered counter (index into the registry)
+struct CounterHandle {
+    static constexpr uint32_t kInvalid = UINT32_MAX;
+    uint32_t index = kInvalid;
+
+    bool valid() const { return index != kInvalid; }
+};
+
+// Handle to a registered gauge (index into the registry)
+struct GaugeHandle {
+    static constexpr uint32_t kInvalid = UINT32_MAX;
+    uint32_t index = kInvalid;
+
+    bool valid() const { return index != kInvalid; }
+};
+
+// Handle to a registered latency histogram (index into the registry)
+struct HistogramHandle {
+    static constexpr uint32_t kInvalid = UINT32_MAX;
+    uint32_t index = kInvalid;
+
+    bool valid() const { return index != kInvalid; }
+};
+
+// Summed contents of a histogram across all threads
+struct HistogramSnapshot {
+    uint64_t buckets[LatencyBuckets::kCount] = {};
+    uint64_t sum_ns = 0;
+    uint64_t count = 0;
+};
+
+// Thread-safe metrics collector for Prometheus-style exposition.
+//
+// Metrics are registered once by name and then updated through their handle.
+// Counter increments go to a per-thread, cache-line aligned shard owned by
+// this registry, so they take no lock and never share a cache line with
+// another writer; shards are summed only when a counter is read or scraped.
+// Gauges are a single atomic slot each, or a callback evaluated on read for
+// values owned elsewhere. Latency histograms record into per-thread shards
+// like counters and are exported as Prometheus _bucket/_sum/_count series.
+//
+// The string API (increment_counter / set_gauge / get_*) is a slow-path shim
+// that resolves the name under the registry mutex on every call.
+//
+// The Prometheus exposition is laid out once per registry change: every
+// metric name, label set and bucket bound is formatted into a layout, and a
+// render only appends the current numbers to it. Renders read the shards
+// without the registry mutex, and exposition() serves a cached render for up
+// to a configurable max age, so scrapes never hold up registrations or
+// writers.
 class Metrics {
 public:
+    // Registry capacity; registrations beyond it return an invalid handle
+    static constexpr uint32_t kMaxCounters = 1024;
+    static constexpr uint32_t kMaxGauges = 256;
+    static constexpr uint32_t kMaxHistograms = 64;
+
     Metrics();
+    ~Metrics();
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    // Register a metric, or return the existing handle for `name`
+    CounterHandle register_counter(const std::string& name);
+    GaugeHandle register_gauge(const std::string& name);
+    
+    // Register (or convert) a gauge whose value is read from `read` on every
+    // scrape. set()/add() on it are ignored. `read` may run on any scraping
+    // thread, under the registry mutex for value()/get_*(), and must not call
+    // back into this registry.
+    GaugeHandle register_gauge_callback(const std::string& name, std::function<double()> read);
+    
+    // Same for a counter maintained elsewhere; its value is `read()` plus
+    // anything added through increment()
+    CounterHandle register_counter_callback(const std::string& name, std::function<uint64_t()> read);
     
+    // Register a latency histogram, exported as `name` (in seconds) with the
+    // given Prometheus label set, e.g. ("port_event_latency_seconds",
+    // "event=\"POWER_ON\""). Returns the existing handle for the same pair.
+    HistogramHandle register_histogram(const std::string& name, const std::string& labels = "");
+
+    // Handle fast path (lock-free; invalid handles are ignored)
+    void increment(CounterHandle counter, uint64_t value = 1) {
+        if (!counter.valid()) {
+            return;
+        }
+        // Only this thread writes its shard, so a plain load/store is enough
+        std::atomic<uint64_t>& slot = local_shard().values[counter.index];
+        slot.store(slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    void set(GaugeHandle gauge, double value) {
+        if (gauge.valid()) {
+            gauges_[gauge.index].store(value, std::memory_order_relaxed);
+        }
+    }
+
+    void add(GaugeHandle gauge, double delta) {
+        if (!gauge.valid()) {
+            return;
+        }
+        std::atomic<double>& slot = gauges_[gauge.index];
+        double current = slot.load(std::memory_order_relaxed);
+        while (!slot.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Record one latency sample (lock-free; a no-op when histograms are
+    // compiled out)
+    void observe(HistogramHandle histogram, uint64_t value_ns) {
+#if CONTROL_PLANE_LATENCY_HISTOGRAMS
+        if (histogram.valid()) {
+            local_histogram(histogram.index).record(value_ns);
+        }
+#else
+        (void)histogram;
+        (void)value_ns;
+#endif
+    }
+
+    // Current value (counters and histograms sum every shard)
+    uint64_t value(CounterHandle counter) const;
+    double value(GaugeHandle gauge) const;
+    HistogramSnapshot value(HistogramHandle histogram) const;
+
     // Increment a counter
     void increment_counter(const std::string& name, uint64_t value = 1);
-    
+
     // Set a gauge value
     void set_gauge(const std::string& name, double value);
-    
+
     // Get counter value
     uint64_t get_counter(const std::string& name) const;
-    
+
     // Get gauge value
     double get_gauge(const std::string& name) const;
-    
-    // Export all metrics in Prometheus text format
+
+    // Export all metrics in Prometheus text format, freshly rendered
     std::string export_prometheus() const;
 
+    // The exposition for scrapers: a shared render no older than the max age.
+    // While one caller renders, concurrent callers get the previous render
+    // instead of waiting for it.
+    std::shared_ptr<const std::string> exposition() const;
+
+    // How long exposition() may reuse a render (default 0: render every call)
+    void set_exposition_max_age(std::chrono::milliseconds max_age) {
+        max_age_ns_.store(static_cast<uint64_t>(std::chrono::nanoseconds(max_age).count()),
+                          std::memory_order_relaxed);
+    }
+
 private:
-    mutable std::mutex mutex_;
-    std::map<std::string, std::atomic<uint64_t>> counters_;
-    std::map<std::string, std::atomic<double>> gauges_;
-    
-    // Helper to get or create counter
-    std::atomic<uint64_t>& get_or_create_counter(const std::string& name);
-    
-    // Helper to get or create gauge
-    std::atomic<double>& get_or_create_gauge(const std::string& name);
+    // One thread's counter values and histogram cells. Histogram cells are
+    // allocated by the owning thread on its first sample and published with
+    // a release store for scrapers.
+    struct alignas(64) ThreadShard {
+        std::atomic<uint64_t> values[kMaxCounters];
+        std::atomic<HistogramCells*> histograms[kMaxHistograms];
+        ThreadShard* next = nullptr; // Shard list, newest first
+
+        ThreadShard() {
+            for (auto& value : values) {
+                value.store(0, std::memory_order_relaxed);
+            }
+            for (auto& cells : histograms) {
+                cells.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        ~ThreadShard() {
+            for (auto& cells : histograms) {
+                delete cells.load(std::memory_order_relaxed);
+            }
+        }
+    };
+
+    struct HistogramKey {
+        std::string name;
+        std::string labels;
+
+        bool operator<(const HistogramKey& other) const {
+            return name != other.name ? name < other.name : labels < other.labels;
+        }
+    };
+
+    // Unique per registry and never reused, so thread caches can't alias a
+    // destroyed registry's shard
+    const uint64_t registry_id_;
+
+    mutable std::mutex mutex_; // Guards names, callbacks and shard creation
+    std::map<std::string, uint32_t> counter_names_;
+    std::map<std::string, uint32_t> gauge_names_;
+    std::map<HistogramKey, uint32_t> histogram_names_;
+    std::unordered_map<std::thread::id, std::unique_ptr<ThreadShard>> shards_by_thread_;
+    std::atomic<ThreadShard*> shards_head_{nullptr}; // Readable without mutex_
+    std::unique_ptr<std::atomic<double>[]> gauges_;
+    std::vector<std::function<double()>> gauge_callbacks_;     // Empty for plain gauges
+    std::vector<std::function<uint64_t()>> counter_callbacks_; // Empty for plain counters
+    std::atomic<uint64_t> layout_version_{0}; // Bumped under mutex_ by every registration
+
+    // Exposition state. Lock order: render_mutex_, then mutex_.
+    struct ExpositionLayout;
+    mutable std::mutex render_mutex_; // Serializes renders; guards layout_
+    mutable std::unique_ptr<ExpositionLayout> layout_;
+    mutable std::mutex cache_mutex_;  // Guards the cached render
+    mutable std::shared_ptr<const std::string> cached_exposition_;
+    mutable uint64_t cached_at_ns_ = 0;
+    std::atomic<uint64_t> max_age_ns_{0};
+
+    // This thread's shard, created on first use
+    ThreadShard& local_shard() {
+        struct CacheEntry {
+            uint64_t registry_id;
+            ThreadShard* shard;
+        };
+        static constexpr int kCacheSize = 8;
+        static thread_local CacheEntry cache[kCacheSize] = {};
+        static thread_local int next_victim = 0;
+
+        for (const auto& entry : cache) {
+            if (entry.registry_id == registry_id_) {
+                return *entry.shard;
+            }
+        }
+        ThreadShard* shard = create_local_shard();
+        cache[next_victim] = {registry_id_, shard};
+        next_victim = (next_victim + 1) % kCacheSize;
+        return *shard;
+    }
+
+    HistogramCells& local_histogram(uint32_t index) {
+        std::atomic<HistogramCells*>& slot = local_shard().histograms[index];
+        HistogramCells* cells = slot.load(std::memory_order_relaxed);
+        if (!cells) {
+            cells = new HistogramCells();
+            slot.store(cells, std::memory_order_release);
+        }
+        return *cells;
+    }
+
+    ThreadShard* create_local_shard();
+    uint64_t sum_shards(uint32_t index) const;  // Lock-free
+    uint64_t sum_counter(uint32_t index) const; // Caller holds mutex_
+    double read_gauge(uint32_t index) const;    // Caller holds mutex_
+    HistogramSnapshot sum_histogram(uint32_t index) const; // Lock-free
+    void build_layout() const;                  // Caller holds render_mutex_
+    std::string render_exposition() const;      // Caller holds render_mutex_
+};
+
+// Picks which calls of a hot path get timed: 1 in `interval` on each thread,
+// so the path pays for the two clock reads (~45 ns on the dev VM) only on a
+// fraction of its calls. Never picks a call when histograms are compiled out.
+//
+// Each thread keeps a countdown per sampler, in a small direct-mapped table
+// keyed by the sampler's id. A sampler's first call on a thread, and its
+// first call after set_interval(), is always picked, so N calls on one
+// thread pick exactly ceil(N / interval). Two samplers that share a slot
+// and alternate on one thread restart each other's countdown, which only
+// picks more calls than asked.
+class LatencySampler {
+public:
+    explicit LatencySampler(uint32_t interval = 1)
+        : interval_(interval == 0 ? 1 : interval), id_(next_id()) {}
+
+    // Takes effect at each thread's next call
+    void set_interval(uint32_t interval) {
+        interval_.store(interval == 0 ? 1 : interval, std::memory_order_relaxed);
+        id_.store(next_id(), std::memory_order_release);
+    }
+    uint32_t interval() const { return interval_.load(std::memory_order_relaxed); }
+
+    // True for every interval()-th call on the calling thread
+    bool due() const {
+#if CONTROL_PLANE_LATENCY_HISTOGRAMS
+        uint64_t id = id_.load(std::memory_order_acquire);
+        Countdown& countdown = thread_countdowns()[id & (kThreadSlots - 1)];
+        if (countdown.owner != id) {
+            countdown.owner = id;
+            countdown.remaining = 0;
+        }
+        if (countdown.remaining == 0) {
+            countdown.remaining = interval() - 1;
+            return true;
+        }
+        countdown.remaining--;
+#endif
+        return false;
+    }
+
+private:
+    struct Countdown {
+        uint64_t owner = 0; // Sampler id; 0 = unused
+        uint32_t remaining = 0;
+    };
+    static constexpr uint32_t kThreadSlots = 8;
+
+    std::atomic<uint32_t> interval_;
+    std::atomic<uint64_t> id_; // New on every set_interval()
+
+    static Countdown* thread_countdowns() {
+        thread_local Countdown countdowns[kThreadSlots];
+        return countdowns;
+    }
+
+    static uint64_t next_id() {
+        static std::atomic<uint64_t> next(1);
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+// Records the lifetime of the scope into a histogram, if `timed` (e.g. a
+// LatencySampler pick). Reads no clock when histograms are compiled out.
+class ScopedLatency {
+public:
+    ScopedLatency(Metrics& metrics, HistogramHandle histogram, bool timed = true)
+        : metrics_(metrics), histogram_(histogram),
+          timed_(CONTROL_PLANE_LATENCY_HISTOGRAMS && timed),
+          start_ns_(timed_ ? latency_clock_ns() : 0) {}
+
+    ~ScopedLatency() {
+#if CONTROL_PLANE_LATENCY_HISTOGRAMS
+        if (timed_) {
+            metrics_.observe(histogram_, latency_clock_ns() - start_ns_);
+        }
+#endif
+    }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    Metrics& metrics_;
+    HistogramHandle histogram_;
+    bool timed_;
+    uint64_t start_ns_;
 };
 
 } // namespace control_plane
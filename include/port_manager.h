@@ -1,52 +1,200 @@
 #pragma once
 
 #include "port_state_machine.h"
+#include "port_table.h"
+#include "port_population.h"
 #include "metrics.h"
 #include <vector>
 #include <mutex>
 #include <memory>
 #include <atomic>
+#include <string>
 
 namespace control_plane {
 
-// Thread-safe manager for all ports
+// How PortManager serializes writers of a port
+enum class PortSyncMode {
+    MUTEX,     // Striped mutexes around each event
+    LOCK_FREE  // CAS loop on the port's packed state word
+};
+
+// One event addressed to a port, as accepted by the batch API
+struct PortEventRecord {
+    int32_t port_id;
+    PortEvent event;
+};
+
+// Per-record outcome of a batch
+enum class PortEventResult : uint8_t {
+    NO_TRANSITION, // Applied, state unchanged
+    TRANSITIONED,  // Applied, state changed
+    INVALID_PORT   // Rejected: port id out of range
+};
+
+// Aggregate outcome of a batch
+struct PortEventBatchSummary {
+    uint64_t applied = 0;     // Records applied to a port
+    uint64_t transitions = 0; // Applied records that changed state
+    uint64_t rejected = 0;    // Records with an invalid port id
+};
+
+// A port's state as recovered from persistent storage
+struct PortRecoveryState {
+    PortState state = PortState::DOWN;
+    uint64_t transitions = 0;
+    int64_t last_transition_ns = 0; // steady_clock
+};
+
+class EventJournal;
+
+// Convert sync mode to/from its config string ("mutex", "lock_free")
+std::string port_sync_mode_to_string(PortSyncMode mode);
+bool parse_port_sync_mode(const std::string& str, PortSyncMode& mode);
+
+// Thread-safe manager for all ports.
+// Port state lives in a structure-of-arrays PortTable. In MUTEX mode writers
+// serialize on a small pool of striped mutexes (port_id masked to a stripe);
+// in LOCK_FREE mode each event is a CAS loop on the port's state word.
+// Readers never lock: a port's state is a single acquire load.
 class PortManager {
 public:
-    explicit PortManager(int num_ports);
+    explicit PortManager(int num_ports, PortSyncMode sync_mode = PortSyncMode::MUTEX);
+    
+    // Manage an existing table, e.g. one restored by PortSnapshot::load()
+    explicit PortManager(PortTable table, PortSyncMode sync_mode = PortSyncMode::MUTEX);
     
     // Process an event on a specific port
     // Thread-safe: can be called from multiple threads
     bool process_port_event(int port_id, PortEvent event);
     
+    // Process a batch of events. Records are grouped by port (preserving their
+    // relative order per port) and each port's events are applied under one
+    // lock acquisition; counters and gauges are published once per batch.
+    // If `results` is non-null it receives one entry per record.
+    // Thread-safe: can be called from multiple threads
+    PortEventBatchSummary process_port_events(const PortEventRecord* records, size_t count,
+                                              PortEventResult* results = nullptr);
+    
+    // Apply one event to every port in [first_port, first_port + count), e.g.
+    // "power on all linecards" (POST /events/range). Runs the bulk transition kernel over the
+    // packed state words and logs a single summary line instead of one line
+    // per port. If `changed_mask` is non-null it receives (count + 63) / 64
+    // words, bit i set when port first_port + i transitioned.
+    // An out-of-range span is rejected as a whole.
+    // Thread-safe: can be called from multiple threads
+    PortEventBatchSummary process_port_event_range(int first_port, int count, PortEvent event,
+                                                   uint64_t* changed_mask = nullptr);
+    
+    // Record every applied event in `journal` (null stops recording).
+    // Call before events are processed.
+    void set_journal(std::shared_ptr<EventJournal> journal) { journal_ = std::move(journal); }
+    
+    // Move ports forward to recovered states (index = port id; extra
+    // entries are ignored). A port is only restored if the recovered state
+    // has more transitions than its current one, so a journal can be
+    // replayed over a restored snapshot. Call before events are processed.
+    void restore_states(const std::vector<PortRecoveryState>& ports);
+    
+    // Write a snapshot of the port table to `path` (see PortSnapshot). In
+    // MUTEX mode writers are paused while the table is copied, so the
+    // snapshot is one point in time; in LOCK_FREE mode each port is copied
+    // atomically but the ports may be from slightly different times.
+    // Thread-safe; false on error (logged)
+    bool save_snapshot(const std::string& path);
+    
     // Get snapshot of all port states (thread-safe)
     std::vector<PortState> get_all_states() const;
     
     // Get state of specific port (thread-safe)
     PortState get_port_state(int port_id) const;
     
+    // Get number of state transitions of a specific port (thread-safe)
+    uint64_t get_transition_count(int port_id) const;
+    
+    // Get last transition time of a specific port (thread-safe)
+    std::chrono::steady_clock::time_point get_last_transition_time(int port_id) const;
+    
     // Get total number of ports
     int get_num_ports() const { return num_ports_; }
     
+    // Get the writer synchronization mode
+    PortSyncMode get_sync_mode() const { return sync_mode_; }
+    
     // Get total events processed across all ports
     uint64_t get_total_events_processed() const {
         return total_events_processed_.load();
     }
     
+    // Exact number of ports in each state (thread-safe)
+    const PortPopulation& get_population() const { return population_; }
+    
+    // Time 1 in `interval` events into port_event_latency_seconds (per
+    // thread; default kDefaultEventLatencySampleInterval, 1 = every event)
+    void set_event_latency_sample_interval(uint32_t interval) { latency_sampler_.set_interval(interval); }
+    
     // Get metrics reference
     Metrics& get_metrics() { return metrics_; }
     const Metrics& get_metrics() const { return metrics_; }
+    
+    // Get the underlying port table (read-only)
+    const PortTable& get_port_table() const { return table_; }
+    
+    // Upper bound on the number of lock stripes
+    static constexpr int kMaxLockStripes = 4096;
+    
+    // Events timed per event latency sample: keeps the clock reads to a few
+    // ns per event on average
+    static constexpr uint32_t kDefaultEventLatencySampleInterval = 16;
 
 private:
     int num_ports_;
-    std::vector<std::unique_ptr<PortStateMachine>> ports_;
-    mutable std::vector<std::mutex> port_mutexes_; // One mutex per port
+    PortSyncMode sync_mode_;
+    PortTable table_;
+    std::vector<std::mutex> stripe_mutexes_; // Power-of-two sized lock pool
+    int stripe_mask_;
     std::atomic<uint64_t> total_events_processed_;
+    PortPopulation population_;
     Metrics metrics_;
+    std::shared_ptr<EventJournal> journal_; // Optional; after metrics_, which it reports to
+    std::mutex snapshot_mutex_;             // One snapshot write at a time
+    
+    // Hot-path metric handles
+    CounterHandle events_processed_metric_;
+    CounterHandle state_transitions_metric_;
+    HistogramHandle event_latency_metrics_[kNumPortEvents]; // Per PortEvent
+    LatencySampler latency_sampler_;                        // Which events to time
+    HistogramHandle lock_wait_metric_;
+    HistogramHandle snapshot_metric_;
     
     // Validate port ID
     bool is_valid_port(int port_id) const {
         return port_id >= 0 && port_id < num_ports_;
     }
+    
+    // Mutex serializing writers of a port
+    std::mutex& stripe_for(int port_id) {
+        return stripe_mutexes_[port_id & stripe_mask_];
+    }
+    
+    // Acquire a port's stripe, recording the wait time (an uncontended
+    // acquisition records zero without reading the clock)
+    std::unique_lock<std::mutex> lock_stripe(int port_id);
+    
+    // Lock / unlock the stripes covering a contiguous port range, in
+    // ascending stripe order
+    void lock_stripe_range(int first_port, int count);
+    void unlock_stripe_range(int first_port, int count);
+    
+    // Number of lock stripes for a table of `num_ports` ports
+    static int stripe_count(int num_ports);
+    
+    // Journal one event applied to every port of a range; caller still
+    // holds the range's locks in MUTEX mode
+    void journal_range(int first_port, int count, PortEvent event, int64_t now_ns);
+    
+    // Publish the metric deltas of a batch of applied events
+    void publish_event_metrics(uint64_t applied, uint64_t transitions,
+                               const int64_t state_deltas[3]);
 };
 
 } // namespace control_plane
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "port_state_machine.h"
+#include <atomic>
+#include <cstdint>
+
+namespace control_plane {
+
+// Number of ports in each state, as exact integers.
+//
+// The DOWN and INIT counts are packed into one 64-bit atomic word
+// (DOWN in the low 32 bits, INIT in the high 32 bits) and UP is derived as
+// total - DOWN - INIT. A batch of transitions is published with a single
+// fetch_add, so every snapshot sums exactly to the number of ports.
+//
+// Publishes happen after the transitions they describe, so while writers are
+// active a single state's count may lag by the transitions in flight (and can
+// briefly dip below zero); at quiescence the counts are exact.
+class PortPopulation {
+public:
+    struct Counts {
+        int64_t down = 0;
+        int64_t init = 0;
+        int64_t up = 0;
+    };
+
+    // All ports start DOWN
+    explicit PortPopulation(uint32_t total_ports)
+        : total_(total_ports), packed_(total_ports) {}
+
+    // Apply per-state population deltas (indexed by PortState; they must sum
+    // to zero). One atomic add regardless of how many ports moved.
+    void apply(const int64_t deltas[kNumPortStates]) {
+        uint64_t packed_delta =
+            static_cast<uint64_t>(deltas[static_cast<int>(PortState::DOWN)]) +
+            (static_cast<uint64_t>(deltas[static_cast<int>(PortState::INIT)]) << 32);
+        if (packed_delta != 0) {
+            packed_.fetch_add(packed_delta, std::memory_order_relaxed);
+        }
+    }
+
+    // Consistent counts from one load
+    Counts snapshot() const {
+        uint64_t packed = packed_.load(std::memory_order_relaxed);
+        Counts counts;
+        // The DOWN field is read as signed so a transient negative borrows
+        // back from the INIT field
+        counts.down = static_cast<int32_t>(static_cast<uint32_t>(packed));
+        counts.init = static_cast<int64_t>(packed - static_cast<uint64_t>(counts.down)) >> 32;
+        counts.up = static_cast<int64_t>(total_) - counts.down - counts.init;
+        return counts;
+    }
+
+    int64_t count(PortState state) const {
+        Counts counts = snapshot();
+        switch (state) {
+            case PortState::DOWN: return counts.down;
+            case PortState::INIT: return counts.init;
+            case PortState::UP: return counts.up;
+        }
+        return 0;
+    }
+
+    uint32_t total() const { return total_; }
+
+private:
+    uint32_t total_;
+    std::atomic<uint64_t> packed_;
+};
+
+} // namespace control_plane
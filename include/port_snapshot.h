@@ -0,0 +1,58 @@
+#pragma once
+
+#include "port_table.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace control_plane {
+
+// Port table snapshot format. One file holding the whole table, laid out so
+// that it can be mapped and used as the live table without a copy:
+//
+//   PortSnapshotHeader                 64 bytes
+//   uint64_t words[num_ports]          PortTable state words
+//   int64_t last_transition[num_ports] steady_clock ns of the writer
+//
+// The checksum covers the header (with `checksum` zero) and both arrays.
+constexpr uint32_t kSnapshotMagic = 0x4E535043; // "CPSN"
+constexpr uint32_t kSnapshotVersion = 1;
+
+struct PortSnapshotHeader {
+    uint32_t magic;        // kSnapshotMagic
+    uint32_t version;      // kSnapshotVersion
+    int32_t num_ports;
+    uint32_t header_bytes; // sizeof(PortSnapshotHeader)
+    uint64_t checksum;     // PortSnapshot::checksum() of the file
+    int64_t steady_ns;     // steady_clock and system_clock read together
+    int64_t realtime_ns;   // when the table was copied
+    uint8_t reserved[24];
+};
+
+static_assert(sizeof(PortSnapshotHeader) == 64, "PortSnapshotHeader is part of the file format");
+
+// Writing and restoring port table snapshots
+class PortSnapshot {
+public:
+    // Copy `table` into the image of a snapshot file, in 64-bit words. Each
+    // port is read atomically; the image is one point in time only if
+    // writers are stopped for the copy.
+    static std::vector<uint64_t> capture(const PortTable& table);
+
+    // Seal an image from capture() with its checksum and write it to `path`,
+    // replacing any previous snapshot atomically (temp file + rename);
+    // false on error (logged)
+    static bool write(const std::string& path, std::vector<uint64_t>& image);
+
+    // Map the snapshot at `path` copy-on-write and adopt it as `table`: the
+    // file is never modified and only pages that change are copied. False if
+    // it is missing, of another version, truncated or fails its checksum.
+    static bool load(const std::string& path, std::optional<PortTable>& table);
+
+    // 64-bit checksum of `count` words, chained from `seed`
+    static uint64_t checksum(const uint64_t* words, size_t count, uint64_t seed = 0);
+};
+
+} // namespace control_plane
@@ -1,33 +1,114 @@
 #pragma once
 
+#include "log_format.h"
 #include <string>
+#include <string_view>
 #include <chrono>
+#include <cstdint>
 
 namespace control_plane {
 
 // Port states following the state machine: DOWN -> INIT -> UP
-enum class PortState {
+enum class PortState : uint8_t {
     DOWN,  // Port is down/offline
     INIT,  // Port is initializing
     UP     // Port is operational
 };
 
 // Events that can trigger state transitions
-enum class PortEvent {
+enum class PortEvent : uint8_t {
     POWER_ON,      // Brings port from DOWN to INIT
     INIT_COMPLETE, // Brings port from INIT to UP
     LINK_FLAP,     // Brings port from any state to DOWN
     HEARTBEAT_OK   // Keeps port in UP (no transition)
 };
 
+constexpr int kNumPortStates = 3;
+constexpr int kNumPortEvents = 4;
+
+// The DOWN/INIT/UP x event rules. Only used to generate the transition table
+// below; everything else goes through the table.
+constexpr PortState port_transition_rule(PortState state, PortEvent event) {
+    switch (state) {
+        case PortState::DOWN:
+            return event == PortEvent::POWER_ON ? PortState::INIT : state;
+        case PortState::INIT:
+            if (event == PortEvent::INIT_COMPLETE) return PortState::UP;
+            if (event == PortEvent::LINK_FLAP) return PortState::DOWN;
+            return state;
+        case PortState::UP:
+            // HEARTBEAT_OK keeps us in UP state (no transition)
+            return event == PortEvent::LINK_FLAP ? PortState::DOWN : state;
+    }
+    return state;
+}
+
+// Next-state table indexed by [state][event], generated at compile time
+struct PortTransitionTable {
+    PortState next[kNumPortStates][kNumPortEvents];
+};
+
+constexpr PortTransitionTable make_port_transition_table() {
+    PortTransitionTable table{};
+    for (int s = 0; s < kNumPortStates; s++) {
+        for (int e = 0; e < kNumPortEvents; e++) {
+            table.next[s][e] = port_transition_rule(static_cast<PortState>(s),
+                                                    static_cast<PortEvent>(e));
+        }
+    }
+    return table;
+}
+
+inline constexpr PortTransitionTable kPortTransitionTable = make_port_transition_table();
+
+static_assert(kPortTransitionTable.next[0][0] == PortState::INIT, "DOWN + POWER_ON -> INIT");
+static_assert(kPortTransitionTable.next[1][1] == PortState::UP, "INIT + INIT_COMPLETE -> UP");
+static_assert(kPortTransitionTable.next[2][2] == PortState::DOWN, "UP + LINK_FLAP -> DOWN");
+static_assert(kPortTransitionTable.next[2][3] == PortState::UP, "UP + HEARTBEAT_OK stays UP");
+
 // Convert enum to string for logging
 std::string port_state_to_string(PortState state);
 std::string port_event_to_string(PortEvent event);
 
+// Allocation-free variants for the log format front end
+std::string_view port_state_name(PortState state);
+std::string_view port_event_name(PortEvent event);
+
+// Parse a state or event name ("UP", "power_on", ...; any case)
+bool parse_port_state(std::string_view str, PortState& state);
+bool parse_port_event(std::string_view str, PortEvent& event);
+
+// States and events log by name (kinds are part of the binary log format)
+template <>
+struct LogEnum<PortState> {
+    static constexpr bool kNamed = true;
+    static constexpr uint8_t kKind = 1;
+    static std::string_view name(PortState state) { return port_state_name(state); }
+};
+
+template <>
+struct LogEnum<PortEvent> {
+    static constexpr bool kNamed = true;
+    static constexpr uint8_t kKind = 2;
+    static std::string_view name(PortEvent event) { return port_event_name(event); }
+};
+
+// Log the outcome of applying `event` to a port (INFO on a transition,
+// DEBUG when the state is unchanged)
+void log_port_event(int port_id, PortState old_state, PortState new_state, PortEvent event);
+
+// Single-port state machine. The transition rules are exposed as a pure
+// table lookup so the port table can apply them to its packed per-port arrays.
 class PortStateMachine {
 public:
     explicit PortStateMachine(int port_id);
     
+    // Pure transition rule: the state a port in `state` moves to on `event`
+    // (returns `state` itself when the event causes no transition)
+    static constexpr PortState next_state(PortState state, PortEvent event) {
+        return kPortTransitionTable.next[static_cast<int>(state)][static_cast<int>(event)];
+    }
+    
     // Process an event and potentially transition state
     // Returns true if state changed
     bool process_event(PortEvent event);
@@ -51,9 +132,6 @@ private:
     PortState state_;
     uint64_t transition_count_;
     std::chrono::steady_clock::time_point last_transition_time_;
-    
-    // Helper to transition to new state
-    void transition_to(PortState new_state);
 };
 
 } // namespace control_plane
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "port_table.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace control_plane {
+
+// Output shape of a PortStatusWriter
+enum class PortStatusFormat {
+    PAGE,  // One JSON object: {"total_ports":..,"ports":[..],"next_offset":..}
+    NDJSON // One JSON object per port per line
+};
+
+// Which ports to write
+struct PortStatusQuery {
+    int offset = 0;                  // First port id to consider
+    int limit = -1;                  // Most ports to write; -1 = no limit
+    std::optional<PortState> state;  // Only ports in this state
+};
+
+// Serializes port status as JSON straight from the port table, one bounded
+// chunk at a time, so a dump of any size needs one chunk buffer and the
+// first chunk is ready without scanning the table. Each port is read with a
+// single load of its state word; ports change while a dump is in progress,
+// so a dump is consistent per port, not across ports.
+class PortStatusWriter {
+public:
+    static constexpr size_t kChunkBytes = 16 * 1024;
+
+    PortStatusWriter(const PortTable& table, const PortStatusQuery& query,
+                     PortStatusFormat format);
+
+    // The next chunk (at most kChunkBytes), valid until the next call; empty
+    // once everything has been written
+    std::string_view next_chunk();
+
+    bool done() const { return phase_ == Phase::DONE; }
+
+private:
+    enum class Phase { HEADER, PORTS, FOOTER, DONE };
+
+    // Upper bound on one serialized port, separator and newline included
+    static constexpr size_t kMaxEntryBytes = 128;
+
+    void write_header();
+    void write_ports();
+    void write_footer();
+    void write_port(int port_id, uint64_t word);
+
+    const PortTable& table_;
+    PortStatusQuery query_;
+    PortStatusFormat format_;
+    int64_t now_ns_;   // Reference time for ms_in_state
+    Phase phase_;
+    int next_port_;    // Next port id to consider
+    int written_;      // Ports written so far
+    std::string chunk_;
+};
+
+} // namespace control_plane
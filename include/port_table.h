@@ -0,0 +1,167 @@
+#pragma once
+
+#include "port_state_machine.h"
+#include "transition_kernel.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace control_plane {
+
+// Outcome of applying one event to a port
+struct PortTransition {
+    PortState old_state;
+    PortState new_state;
+    uint64_t word; // The port's state word after the event
+
+    bool changed() const { return old_state != new_state; }
+};
+
+// Structure-of-arrays storage for every port's state.
+//
+// Each port has one packed 64-bit state word and a last-transition timestamp,
+// each in its own contiguous array indexed by port id. The state word holds
+//
+//   bits  0..7   PortState
+//   bits  8..39  transition count (32 bits)
+//   bits 40..63  version, bumped on every write (24 bits, wraps)
+//
+// so a port's state and history can be read with a single acquire load.
+//
+// The arrays live in heap memory, or in a mapping of a snapshot file that the
+// table adopts (see PortSnapshot::load), so a restored table needs no copy.
+// Writers either serialize per port externally and use apply_event(), or
+// use apply_event_atomic(), which is a lock-free CAS loop.
+class PortTable {
+public:
+    explicit PortTable(int num_ports);
+
+    // Adopt arrays of `num_ports` entries each that live in `storage`.
+    // Stored transition times are `time_offset_ns` behind this process's
+    // steady clock (they were written by another process).
+    PortTable(int num_ports, std::shared_ptr<void> storage, std::atomic<uint64_t>* words,
+              std::atomic<int64_t>* last_transition_ns, int64_t time_offset_ns);
+
+    PortTable(PortTable&&) = default;
+    PortTable& operator=(PortTable&&) = default;
+
+    int size() const { return num_ports_; }
+
+    PortState get_state(int port_id) const {
+        return word_state(load_word(port_id));
+    }
+
+    uint64_t get_transition_count(int port_id) const {
+        return word_transitions(load_word(port_id));
+    }
+
+    uint32_t get_version(int port_id) const {
+        return word_version(load_word(port_id));
+    }
+
+    // The packed state word, for reading several fields consistently
+    uint64_t get_word(int port_id) const {
+        return load_word(port_id);
+    }
+
+    // Last transition time, in steady_clock nanoseconds: the newest
+    // timestamp of any transition so far, even when racing lock-free
+    // writers finish out of order
+    int64_t get_last_transition_ns(int port_id) const {
+        return last_transition_ns_[port_id].load(std::memory_order_relaxed) + time_offset_ns_;
+    }
+
+    // Apply an event to one port using the PortStateMachine rules.
+    // Caller must hold the port's write lock.
+    PortTransition apply_event(int port_id, PortEvent event, int64_t now_ns);
+
+    // Lock-free variant: CAS loop on the port's state word. Events that cause
+    // no transition are a single load and never write.
+    PortTransition apply_event_atomic(int port_id, PortEvent event, int64_t now_ns);
+
+    // Apply one event to ports [first_port, first_port + count) with the bulk
+    // transition kernel. Per-port events are not logged. If `changed_mask` is
+    // non-null it receives (count + 63) / 64 words, bit i set when port
+    // first_port + i transitioned.
+    // Caller must hold the write lock of every port in the range.
+    BulkTransitionResult apply_event_range(int first_port, int count, PortEvent event,
+                                           int64_t now_ns, uint64_t* changed_mask);
+
+    // Lock-free variant: the kernel computes the new words and each changed
+    // word is committed with a CAS (ports that lose a race are re-applied).
+    BulkTransitionResult apply_event_range_atomic(int first_port, int count, PortEvent event,
+                                                  int64_t now_ns, uint64_t* changed_mask);
+
+    // Overwrite one port's state, transition count and last transition time,
+    // e.g. when recovering from the event journal. Must not race with writers.
+    void restore_port(int port_id, PortState state, uint64_t transitions, int64_t last_transition_ns);
+
+    // Copy all states into `out` (linear scan, no locks)
+    void copy_states(PortState* out) const;
+
+    // Copy every state word and last transition time (linear scan, no
+    // locks; each port is read atomically but the table as a whole is only
+    // consistent if writers are stopped)
+    void copy_words(uint64_t* words, int64_t* last_transition_ns) const;
+
+    // Number of ports in each state, indexed by PortState (linear scan)
+    void count_states(int64_t counts[kNumPortStates]) const;
+
+    // Bytes of per-port storage held by the table
+    size_t memory_bytes() const;
+
+    // Steady clock reading in the table's timestamp unit
+    static int64_t now_ns();
+
+    // State word layout
+    static constexpr int kTransitionShift = 8;
+    static constexpr int kVersionShift = 40;
+    static constexpr uint64_t kStateMask = 0xFF;
+    static constexpr uint64_t kTransitionMask = 0xFFFFFFFFull;
+    static constexpr uint64_t kVersionMask = 0xFFFFFFull;
+
+    static PortState word_state(uint64_t word) {
+        return static_cast<PortState>(word & kStateMask);
+    }
+    static uint64_t word_transitions(uint64_t word) {
+        return (word >> kTransitionShift) & kTransitionMask;
+    }
+    static uint32_t word_version(uint64_t word) {
+        return static_cast<uint32_t>((word >> kVersionShift) & kVersionMask);
+    }
+    static uint64_t make_word(PortState state, uint64_t transitions, uint32_t version) {
+        return static_cast<uint64_t>(state) |
+               ((transitions & kTransitionMask) << kTransitionShift) |
+               ((static_cast<uint64_t>(version) & kVersionMask) << kVersionShift);
+    }
+
+private:
+    int num_ports_;
+    std::shared_ptr<void> storage_; // Owns both arrays
+    std::atomic<uint64_t>* words_;
+    std::atomic<int64_t>* last_transition_ns_; // Steady clock - time_offset_ns_
+    int64_t time_offset_ns_;
+
+    uint64_t load_word(int port_id) const {
+        return words_[port_id].load(std::memory_order_acquire);
+    }
+
+    // CAS loop behind apply_event_atomic, without the logging
+    PortTransition transition_atomic(int port_id, PortEvent event, int64_t now_ns);
+
+    // Store `now_ns` as the port's transition time unless a newer one is
+    // already stored
+    void record_transition_time(int port_id, int64_t now_ns);
+
+    // Shared body of the range variants
+    BulkTransitionResult apply_range(int first_port, int count, PortEvent event,
+                                     int64_t now_ns, uint64_t* changed_mask, bool atomic);
+
+    // Word after a transition to `new_state`: one more transition, next version
+    static uint64_t next_word(uint64_t word, PortState new_state) {
+        return make_word(new_state, word_transitions(word) + 1, word_version(word) + 1);
+    }
+};
+
+} // namespace control_plane
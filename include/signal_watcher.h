@@ -0,0 +1,45 @@
+#pragma once
+
+#include <csignal>
+#include <functional>
+#include <initializer_list>
+#include <thread>
+
+namespace control_plane {
+
+// Receives process signals on a dedicated thread through a signalfd, so they
+// are handled as ordinary events instead of in an async-signal handler.
+//
+// Construct it in main before any other thread starts: threads inherit
+// the signal mask, and a signal that some thread still accepts would take
+// its default action there instead of reaching the signalfd.
+class SignalWatcher {
+public:
+    // Called on the watcher thread with the signal number
+    using Handler = std::function<void(int signal)>;
+
+    // Block `signals` in the calling thread and start holding them for start()
+    explicit SignalWatcher(std::initializer_list<int> signals);
+    ~SignalWatcher();
+
+    SignalWatcher(const SignalWatcher&) = delete;
+    SignalWatcher& operator=(const SignalWatcher&) = delete;
+
+    // Start delivering the blocked signals (including any already pending)
+    // to `handler`; false if the signalfd could not be created
+    bool start(Handler handler);
+
+    // Join the watcher thread; the signals stay blocked
+    void stop();
+
+private:
+    sigset_t signals_;
+    int signal_fd_;
+    int wake_fd_;
+    Handler handler_;
+    std::thread thread_;
+
+    void run();
+};
+
+} // namespace control_plane
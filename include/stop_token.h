@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace control_plane {
+
+// A stop request that threads can sleep on. request_stop() wakes every
+// waiter at once, so a thread that waits here instead of sleeping notices a
+// stop immediately rather than at the end of its sleep.
+class StopToken {
+public:
+    StopToken() = default;
+
+    StopToken(const StopToken&) = delete;
+    StopToken& operator=(const StopToken&) = delete;
+
+    // Request a stop and wake all waiters; later waits return at once
+    void request_stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    bool stop_requested() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stopped_;
+    }
+
+    // Clear the request, for a component that can be started again
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = false;
+    }
+
+    // Sleep until `deadline` or a stop request; true if a stop was requested
+    template <typename Clock, typename Duration>
+    bool wait_until(const std::chrono::time_point<Clock, Duration>& deadline) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_until(lock, deadline, [this]() { return stopped_; });
+    }
+
+    // Sleep for `timeout` or until a stop request; true if a stop was requested
+    template <typename Rep, typename Period>
+    bool wait_for(const std::chrono::duration<Rep, Period>& timeout) {
+        return wait_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    // Sleep until a stop is requested
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return stopped_; });
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopped_ = false;
+};
+
+} // namespace control_plane
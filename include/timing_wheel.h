@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace control_plane {
+
+// Hierarchical timing wheel holding at most one pending deadline per timer id.
+//
+// Deadlines are absolute tick numbers. The wheel has kLevels levels of
+// kSlotsPerLevel slots; a timer is filed on the level of the highest 8-bit
+// group in which its deadline differs from the current tick, and cascades one
+// level down each time the wheel turns past that group. Scheduling and
+// cancelling are O(1) and advancing one tick costs O(expired + cascaded),
+// independent of how many timers are pending.
+//
+// Not thread-safe: the wheel is owned and driven by a single thread.
+class TimingWheel {
+public:
+    static constexpr int kLevelBits = 8;
+    static constexpr int kLevels = 4;
+    static constexpr uint32_t kSlotsPerLevel = 1u << kLevelBits;
+
+    // A timer that fired during advance()
+    struct Expired {
+        uint32_t id;
+        uint8_t kind;
+    };
+
+    // Create a wheel with room for timer ids [0, num_timers)
+    explicit TimingWheel(uint32_t num_timers, uint64_t start_tick = 0);
+
+    // Schedule (or reschedule) timer `id` to fire at absolute tick `deadline`.
+    // Deadlines at or before the current tick fire on the next tick.
+    // `kind` is an opaque tag handed back when the timer expires.
+    void schedule(uint32_t id, uint64_t deadline, uint8_t kind = 0);
+
+    // Cancel a pending timer (no-op if not scheduled)
+    void cancel(uint32_t id);
+
+    // Advance the wheel to tick `now`, appending every timer whose deadline
+    // has been reached to `expired` in deadline order. Expired timers are
+    // unscheduled before being reported, so callers may reschedule them.
+    void advance(uint64_t now, std::vector<Expired>& expired);
+
+    bool is_scheduled(uint32_t id) const { return timers_[id].slot != kNoSlot; }
+    uint64_t get_deadline(uint32_t id) const { return timers_[id].deadline; }
+    uint8_t get_kind(uint32_t id) const { return timers_[id].kind; }
+
+    uint64_t get_current_tick() const { return current_tick_; }
+    size_t get_pending_count() const { return pending_; }
+    uint32_t get_capacity() const { return static_cast<uint32_t>(timers_.size()); }
+
+private:
+    static constexpr uint32_t kNil = UINT32_MAX;
+    static constexpr uint16_t kNoSlot = UINT16_MAX;
+    // Timers beyond the top level's horizon wait here until the wheel wraps
+    static constexpr uint16_t kOverflowSlot = kLevels * kSlotsPerLevel;
+
+    struct Timer {
+        uint64_t deadline = 0;
+        uint32_t next = kNil;
+        uint32_t prev = kNil;
+        uint16_t slot = kNoSlot;
+        uint8_t kind = 0;
+    };
+
+    std::vector<Timer> timers_;
+    std::vector<uint32_t> heads_; // One intrusive list head per slot
+    uint64_t current_tick_;
+    size_t pending_;
+
+    // File a timer into the slot matching its deadline
+    void insert(uint32_t id);
+
+    // Remove a timer from whichever slot list it is on
+    void unlink(uint32_t id);
+
+    // Re-file every timer on a slot relative to the current tick
+    void cascade(uint16_t slot);
+};
+
+} // namespace control_plane
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "port_state_machine.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace control_plane {
+
+// Outcome of applying one event to a range of ports
+struct BulkTransitionResult {
+    uint64_t transitions = 0;                      // Ports whose state changed
+    uint64_t from_state[kNumPortStates] = {0, 0, 0}; // ...broken down by old state
+};
+
+// Apply `event` to `count` packed PortTable state words in one pass, using
+// kPortTransitionTable. Each word that changes state gets its transition count
+// and version bumped, exactly as PortTable::apply_event would.
+//
+// If `changed_mask` is non-null it must hold (count + 63) / 64 words; bit i is
+// set when words[i] transitioned and cleared otherwise.
+//
+// The caller must have exclusive write access to the words. Uses an AVX2
+// table-lookup kernel when the CPU supports it, otherwise the scalar loop.
+BulkTransitionResult apply_event_to_words(uint64_t* words, size_t count, PortEvent event,
+                                          uint64_t* changed_mask);
+
+// Portable reference implementation of apply_event_to_words
+BulkTransitionResult apply_event_to_words_scalar(uint64_t* words, size_t count, PortEvent event,
+                                                 uint64_t* changed_mask);
+
+// Whether apply_event_to_words dispatches to the AVX2 kernel on this CPU
+bool transition_kernel_uses_avx2();
+
+} // namespace control_plane
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace control_plane {
+
+// Fixed pool of worker threads that runs batches of indexed work items.
+//
+// A batch is split into per-worker shards; each shard is cut into chunks that
+// are pushed onto the owning worker's deque. Workers pop their own chunks from
+// the back and, once their deque runs dry, steal from the front of the other
+// workers' deques, so one slow shard cannot hold up the rest of the batch.
+class WorkStealingExecutor {
+public:
+    // Processes items [begin, end) on behalf of worker `worker_id`
+    using Body = std::function<void(int worker_id, uint32_t begin, uint32_t end)>;
+
+    // Start `num_workers` threads (0 = one per hardware thread)
+    explicit WorkStealingExecutor(int num_workers);
+    ~WorkStealingExecutor();
+
+    WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+    WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+    // Run one batch and block until every item has been processed.
+    // `shard_bounds` has get_num_workers() + 1 entries: worker w owns items
+    // [shard_bounds[w], shard_bounds[w + 1]).
+    void run(const std::vector<uint32_t>& shard_bounds, uint32_t chunk_size, const Body& body);
+
+    int get_num_workers() const { return static_cast<int>(workers_.size()); }
+
+    // Cumulative per-worker statistics
+    uint64_t get_items_processed(int worker_id) const;
+    uint64_t get_steals(int worker_id) const;
+
+    // Resolve a configured worker count (0 = hardware concurrency, at least 1)
+    static int resolve_worker_count(int configured);
+
+private:
+    struct Chunk {
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    // Per-worker state, padded so workers never share a cache line
+    struct alignas(64) Worker {
+        std::mutex mutex;
+        std::deque<Chunk> chunks;
+        std::atomic<uint64_t> items_processed{0};
+        std::atomic<uint64_t> steals{0};
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    // Batch hand-off between run() and the workers
+    std::mutex batch_mutex_;
+    std::condition_variable batch_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_;
+    bool stopping_;
+    const Body* body_;
+    int active_workers_; // Workers currently draining the batch
+    std::atomic<uint32_t> remaining_chunks_;
+
+    void worker_loop(int worker_id);
+
+    // Take a chunk from our own deque, or steal one; returns false when all are empty
+    bool next_chunk(int worker_id, Chunk& chunk, bool& stolen);
+};
+
+} // namespace control_plane
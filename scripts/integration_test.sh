@@ -2,7 +2,7 @@
 # Integration test for Control Plane Simulator
 # 
 # This test validates:
-# - HTTP endpoints (/health, /metrics, /status)
+# - HTTP endpoints (/health, /metrics, /status, /ports)
 # - Event processing and metrics collection
 # - Prometheus exposition format
 #
@@ -141,6 +141,42 @@ else
     exit 1
 fi
 
+# Test 5: Per-port status endpoints
+echo ""
+echo "Test 5: Testing /ports and /ports/stream endpoints..."
+PORTS_RESPONSE=$(curl -s "http://localhost:$HTTP_PORT/ports?offset=0&limit=2")
+echo "Response: $PORTS_RESPONSE"
+
+if echo "$PORTS_RESPONSE" | grep -q '"ports":\[{"port_id":0,' && \
+   echo "$PORTS_RESPONSE" | grep -q '"next_offset":2}'; then
+    echo "✓ Ports page passed"
+else
+    echo "✗ Ports page failed"
+    exit 1
+fi
+
+TOTAL_PORTS=$(echo "$STATUS_RESPONSE" | grep '"total_ports"' | tr -dc '0-9')
+STREAM_LINES=$(curl -s "http://localhost:$HTTP_PORT/ports/stream" | wc -l)
+if [ "$STREAM_LINES" -eq "$TOTAL_PORTS" ]; then
+    echo "✓ Ports stream passed ($STREAM_LINES ports)"
+else
+    echo "✗ Ports stream failed ($STREAM_LINES lines, expected $TOTAL_PORTS)"
+    exit 1
+fi
+
+# Test 6: Chassis-wide event over a port range
+echo ""
+echo "Test 6: Testing POST /events/range..."
+RANGE_RESPONSE=$(curl -s -X POST "http://localhost:$HTTP_PORT/events/range?first_port=0&count=2&event=LINK_FLAP")
+echo "Response: $RANGE_RESPONSE"
+
+if echo "$RANGE_RESPONSE" | grep -q '"applied":2,'; then
+    echo "✓ Event range passed"
+else
+    echo "✗ Event range failed"
+    exit 1
+fi
+
 echo ""
 echo "=== All integration tests passed! ==="
 echo "Stopping simulator..."
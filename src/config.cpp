@@ -4,9 +4,17 @@
 #include <sstream>
 #include <iostream>
 #include <cstring>
+#include <sys/un.h>
 
 namespace control_plane {
 
+namespace {
+
+// sun_path holds the socket path and its terminating NUL
+constexpr size_t kMaxEventSocketPath = sizeof(sockaddr_un::sun_path);
+
+} // namespace
+
 Config Config::load_from_file(const std::string& path) {
     Config config;  // Start with defaults
     
@@ -23,7 +31,7 @@ Config Config::load_from_file(const std::string& path) {
         if (yaml_config["ports_count"]) {
             try {
                 int value = yaml_config["ports_count"].as<int>();
-                if (value > 0 && value <= 1000) {
+                if (value > 0 && value <= kMaxPorts) {
                     config.ports_count = value;
                 } else {
                     std::cerr << "Warning: ports_count value " << value 
@@ -99,6 +107,57 @@ Config Config::load_from_file(const std::string& path) {
             }
         }
         
+        // Parse init_latency_distribution - trim whitespace
+        if (yaml_config["init_latency_distribution"]) {
+            try {
+                std::string value = yaml_config["init_latency_distribution"].as<std::string>();
+                value.erase(0, value.find_first_not_of(" \t\r\n"));
+                value.erase(value.find_last_not_of(" \t\r\n") + 1);
+                if (value == "uniform" || value == "exponential") {
+                    config.init_latency_distribution = value;
+                } else {
+                    std::cerr << "Warning: init_latency_distribution value '" << value 
+                              << "' is not uniform or exponential, using default "
+                              << config.init_latency_distribution << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse init_latency_distribution: " << e.what() 
+                          << ", using default " << config.init_latency_distribution << "\n";
+            }
+        }
+        
+        // Parse init_latency_min_ms with validation
+        if (yaml_config["init_latency_min_ms"]) {
+            try {
+                int value = yaml_config["init_latency_min_ms"].as<int>();
+                if (value >= 0) {
+                    config.init_latency_min_ms = value;
+                } else {
+                    std::cerr << "Warning: init_latency_min_ms value " << value 
+                              << " out of range, using default " << config.init_latency_min_ms << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse init_latency_min_ms: " << e.what() 
+                          << ", using default " << config.init_latency_min_ms << "\n";
+            }
+        }
+        
+        // Parse init_latency_max_ms with validation
+        if (yaml_config["init_latency_max_ms"]) {
+            try {
+                int value = yaml_config["init_latency_max_ms"].as<int>();
+                if (value >= 0) {
+                    config.init_latency_max_ms = value;
+                } else {
+                    std::cerr << "Warning: init_latency_max_ms value " << value 
+                              << " out of range, using default " << config.init_latency_max_ms << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse init_latency_max_ms: " << e.what() 
+                          << ", using default " << config.init_latency_max_ms << "\n";
+            }
+        }
+        
         // Parse log_level - trim whitespace
         if (yaml_config["log_level"]) {
             try {
@@ -133,6 +192,325 @@ Config Config::load_from_file(const std::string& path) {
             }
         }
         
+        // Parse worker_threads with validation
+        if (yaml_config["worker_threads"]) {
+            try {
+                int value = yaml_config["worker_threads"].as<int>();
+                if (value >= 0 && value <= 256) {
+                    config.worker_threads = value;
+                } else {
+                    std::cerr << "Warning: worker_threads value " << value 
+                              << " out of range, using default " << config.worker_threads << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse worker_threads: " << e.what() 
+                          << ", using default " << config.worker_threads << "\n";
+            }
+        }
+        
+        // Parse port_sync - trim whitespace
+        if (yaml_config["port_sync"]) {
+            try {
+                std::string value = yaml_config["port_sync"].as<std::string>();
+                value.erase(0, value.find_first_not_of(" \t\r\n"));
+                value.erase(value.find_last_not_of(" \t\r\n") + 1);
+                if (value == "mutex" || value == "lock_free") {
+                    config.port_sync = value;
+                } else {
+                    std::cerr << "Warning: port_sync value '" << value 
+                              << "' is not mutex or lock_free, using default " << config.port_sync << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse port_sync: " << e.what() 
+                          << ", using default " << config.port_sync << "\n";
+            }
+        }
+        
+        // Parse log_mode - trim whitespace
+        if (yaml_config["log_mode"]) {
+            try {
+                std::string value = yaml_config["log_mode"].as<std::string>();
+                value.erase(0, value.find_first_not_of(" \t\r\n"));
+                value.erase(value.find_last_not_of(" \t\r\n") + 1);
+                if (value == "sync" || value == "async") {
+                    config.log_mode = value;
+                } else {
+                    std::cerr << "Warning: log_mode value '" << value 
+                              << "' is not sync or async, using default " << config.log_mode << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse log_mode: " << e.what() 
+                          << ", using default " << config.log_mode << "\n";
+            }
+        }
+        
+        // Parse log_queue_capacity with validation
+        if (yaml_config["log_queue_capacity"]) {
+            try {
+                int value = yaml_config["log_queue_capacity"].as<int>();
+                if (value >= 64 && value <= 1048576) {
+                    config.log_queue_capacity = value;
+                } else {
+                    std::cerr << "Warning: log_queue_capacity value " << value 
+                              << " out of range, using default " << config.log_queue_capacity << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse log_queue_capacity: " << e.what() 
+                          << ", using default " << config.log_queue_capacity << "\n";
+            }
+        }
+        
+        // Parse log_overflow - trim whitespace
+        if (yaml_config["log_overflow"]) {
+            try {
+                std::string value = yaml_config["log_overflow"].as<std::string>();
+                value.erase(0, value.find_first_not_of(" \t\r\n"));
+                value.erase(value.find_last_not_of(" \t\r\n") + 1);
+                if (value == "block" || value == "drop") {
+                    config.log_overflow = value;
+                } else {
+                    std::cerr << "Warning: log_overflow value '" << value 
+                              << "' is not block or drop, using default " << config.log_overflow << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse log_overflow: " << e.what() 
+                          << ", using default " << config.log_overflow << "\n";
+            }
+        }
+        
+        // Parse log_format - trim whitespace
+        if (yaml_config["log_format"]) {
+            try {
+                std::string value = yaml_config["log_format"].as<std::string>();
+                value.erase(0, value.find_first_not_of(" \t\r\n"));
+                value.erase(value.find_last_not_of(" \t\r\n") + 1);
+                if (value == "json" || value == "binary") {
+                    config.log_format = value;
+                } else {
+                    std::cerr << "Warning: log_format value '" << value 
+                              << "' is not json or binary, using default " << config.log_format << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse log_format: " << e.what() 
+                          << ", using default " << config.log_format << "\n";
+            }
+        }
+        
+        // Parse log_rate_limit with validation
+        if (yaml_config["log_rate_limit"]) {
+            try {
+                double value = yaml_config["log_rate_limit"].as<double>();
+                if (value >= 0.0 && value <= 1000000.0) {
+                    config.log_rate_limit = value;
+                } else {
+                    std::cerr << "Warning: log_rate_limit value " << value 
+                              << " out of range, using default " << config.log_rate_limit << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse log_rate_limit: " << e.what() 
+                          << ", using default " << config.log_rate_limit << "\n";
+            }
+        }
+        
+        // Parse log_rate_burst with validation
+        if (yaml_config["log_rate_burst"]) {
+            try {
+                int value = yaml_config["log_rate_burst"].as<int>();
+                if (value >= 1 && value <= 1000000) {
+                    config.log_rate_burst = value;
+                } else {
+                    std::cerr << "Warning: log_rate_burst value " << value 
+                              << " out of range, using default " << config.log_rate_burst << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse log_rate_burst: " << e.what() 
+                          << ", using default " << config.log_rate_burst << "\n";
+            }
+        }
+        
+        // Parse metrics_max_age_ms with validation
+        if (yaml_config["metrics_max_age_ms"]) {
+            try {
+                int value = yaml_config["metrics_max_age_ms"].as<int>();
+                if (value >= 0 && value <= 60000) {
+                    config.metrics_max_age_ms = value;
+                } else {
+                    std::cerr << "Warning: metrics_max_age_ms value " << value 
+                              << " out of range, using default " << config.metrics_max_age_ms << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse metrics_max_age_ms: " << e.what() 
+                          << ", using default " << config.metrics_max_age_ms << "\n";
+            }
+        }
+        
+        // Parse event_socket_path - trim whitespace
+        if (yaml_config["event_socket_path"]) {
+            try {
+                std::string value = yaml_config["event_socket_path"].as<std::string>();
+                value.erase(0, value.find_first_not_of(" \t\r\n"));
+                value.erase(value.find_last_not_of(" \t\r\n") + 1);
+                if (value.size() < kMaxEventSocketPath) {
+                    config.event_socket_path = value;
+                } else {
+                    std::cerr << "Warning: event_socket_path is longer than "
+                              << kMaxEventSocketPath - 1 << " bytes, leaving the event socket off\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse event_socket_path: " << e.what() 
+                          << ", leaving the event socket off\n";
+            }
+        }
+        
+        // Parse journal_dir - trim whitespace
+        if (yaml_config["journal_dir"]) {
+            try {
+                std::string value = yaml_config["journal_dir"].as<std::string>();
+                value.erase(0, value.find_first_not_of(" \t\r\n"));
+                value.erase(value.find_last_not_of(" \t\r\n") + 1);
+                config.journal_dir = value;
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse journal_dir: " << e.what() 
+                          << ", leaving the journal off\n";
+            }
+        }
+        
+        // Parse journal_segment_mb with validation
+        if (yaml_config["journal_segment_mb"]) {
+            try {
+                int value = yaml_config["journal_segment_mb"].as<int>();
+                if (value >= 1 && value <= 4096) {
+                    config.journal_segment_mb = value;
+                } else {
+                    std::cerr << "Warning: journal_segment_mb value " << value 
+                              << " out of range, using default " << config.journal_segment_mb << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse journal_segment_mb: " << e.what() 
+                          << ", using default " << config.journal_segment_mb << "\n";
+            }
+        }
+        
+        // Parse journal_commit_ms with validation
+        if (yaml_config["journal_commit_ms"]) {
+            try {
+                int value = yaml_config["journal_commit_ms"].as<int>();
+                if (value >= 1 && value <= 10000) {
+                    config.journal_commit_ms = value;
+                } else {
+                    std::cerr << "Warning: journal_commit_ms value " << value 
+                              << " out of range, using default " << config.journal_commit_ms << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse journal_commit_ms: " << e.what() 
+                          << ", using default " << config.journal_commit_ms << "\n";
+            }
+        }
+        
+        // Parse snapshot_path - trim whitespace
+        if (yaml_config["snapshot_path"]) {
+            try {
+                std::string value = yaml_config["snapshot_path"].as<std::string>();
+                value.erase(0, value.find_first_not_of(" \t\r\n"));
+                value.erase(value.find_last_not_of(" \t\r\n") + 1);
+                config.snapshot_path = value;
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse snapshot_path: " << e.what() 
+                          << ", leaving snapshots off\n";
+            }
+        }
+        
+        // Parse mode - trim whitespace
+        if (yaml_config["mode"]) {
+            try {
+                std::string value = yaml_config["mode"].as<std::string>();
+                value.erase(0, value.find_first_not_of(" \t\r\n"));
+                value.erase(value.find_last_not_of(" \t\r\n") + 1);
+                if (value == "realtime" || value == "discrete") {
+                    config.mode = value;
+                } else {
+                    std::cerr << "Warning: mode value '" << value 
+                              << "' is not realtime or discrete, using default " << config.mode << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse mode: " << e.what() 
+                          << ", using default " << config.mode << "\n";
+            }
+        }
+        
+        // Parse duration_ticks
+        if (yaml_config["duration_ticks"]) {
+            try {
+                config.duration_ticks = yaml_config["duration_ticks"].as<uint64_t>();
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse duration_ticks: " << e.what() 
+                          << ", using default " << config.duration_ticks << "\n";
+            }
+        }
+        
+        // Parse trace_path - trim whitespace
+        if (yaml_config["trace_path"]) {
+            try {
+                std::string value = yaml_config["trace_path"].as<std::string>();
+                value.erase(0, value.find_first_not_of(" \t\r\n"));
+                value.erase(value.find_last_not_of(" \t\r\n") + 1);
+                config.trace_path = value;
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse trace_path: " << e.what() 
+                          << ", leaving the trace off\n";
+            }
+        }
+        
+        // Parse tick_catch_up - trim whitespace
+        if (yaml_config["tick_catch_up"]) {
+            try {
+                std::string value = yaml_config["tick_catch_up"].as<std::string>();
+                value.erase(0, value.find_first_not_of(" \t\r\n"));
+                value.erase(value.find_last_not_of(" \t\r\n") + 1);
+                if (value == "burst" || value == "skip") {
+                    config.tick_catch_up = value;
+                } else {
+                    std::cerr << "Warning: tick_catch_up value '" << value 
+                              << "' is not burst or skip, using default " << config.tick_catch_up << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse tick_catch_up: " << e.what() 
+                          << ", using default " << config.tick_catch_up << "\n";
+            }
+        }
+        
+        // Parse tick_lag_threshold_ms with validation
+        if (yaml_config["tick_lag_threshold_ms"]) {
+            try {
+                int value = yaml_config["tick_lag_threshold_ms"].as<int>();
+                if (value >= 0) {
+                    config.tick_lag_threshold_ms = value;
+                } else {
+                    std::cerr << "Warning: tick_lag_threshold_ms value " << value 
+                              << " out of range, using default " << config.tick_lag_threshold_ms << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse tick_lag_threshold_ms: " << e.what() 
+                          << ", using default " << config.tick_lag_threshold_ms << "\n";
+            }
+        }
+        
+        // Parse tick_lag_sustain_ms with validation
+        if (yaml_config["tick_lag_sustain_ms"]) {
+            try {
+                int value = yaml_config["tick_lag_sustain_ms"].as<int>();
+                if (value >= 0) {
+                    config.tick_lag_sustain_ms = value;
+                } else {
+                    std::cerr << "Warning: tick_lag_sustain_ms value " << value 
+                              << " out of range, using default " << config.tick_lag_sustain_ms << "\n";
+                }
+            } catch (const YAML::BadConversion& e) {
+                std::cerr << "Warning: Failed to parse tick_lag_sustain_ms: " << e.what() 
+                          << ", using default " << config.tick_lag_sustain_ms << "\n";
+            }
+        }
+        
     } catch (const YAML::BadFile& e) {
         std::cerr << "Warning: Could not open config file: " << path 
                   << ", using defaults\n";
@@ -162,6 +540,26 @@ void Config::apply_cli_args(int argc, char** argv) {
                       << "  --log-level LEVEL    Log level: debug, info, warn, error (default: info)\n"
                       << "  --http-port PORT     HTTP server port (default: 8080)\n"
                       << "  --flap-probability P  Link flap probability 0.0-1.0 (default: 0.01)\n"
+                      << "  --worker-threads N   Event worker threads, 0 = one per core (default: 0)\n"
+                      << "  --port-sync MODE     Port writer sync: mutex, lock_free (default: mutex)\n"
+                      << "  --log-mode MODE      Log output: sync, async (default: sync)\n"
+                      << "  --log-queue-capacity N  Async log ring size in records (default: 8192)\n"
+                      << "  --log-overflow POLICY Full async log ring: block, drop (default: block)\n"
+                      << "  --log-format FORMAT  Log encoding: json, binary (default: json)\n"
+                      << "  --log-rate-limit R   Log records/sec per component, port and level, 0 = off (default: 0)\n"
+                      << "  --log-rate-burst N   Records per key before the rate limit applies (default: 20)\n"
+                      << "  --metrics-max-age MS How long /metrics may serve a cached render (default: 0)\n"
+                      << "  --event-socket PATH  Accept binary event batches on a Unix socket (default: off)\n"
+                      << "  --journal-dir DIR    Journal applied events to DIR and replay it at startup (default: off)\n"
+                      << "  --journal-segment-mb N  Journal segment file size in MiB (default: 64)\n"
+                      << "  --journal-commit-ms MS  Journal group commit interval (default: 10)\n"
+                      << "  --snapshot PATH      Restore ports from PATH at startup and snapshot them there (default: off)\n"
+                      << "  --mode MODE          Simulation clock: realtime, discrete (default: realtime)\n"
+                      << "  --duration-ticks N   Stop after N ticks, 0 = until signalled (default: 0)\n"
+                      << "  --trace PATH         Write every applied event to a binary trace file (default: off)\n"
+                      << "  --tick-catch-up POLICY Overdue ticks: burst, skip (default: burst)\n"
+                      << "  --tick-lag-threshold-ms MS  Tick lag that makes /health unready, 0 = never (default: 1000)\n"
+                      << "  --tick-lag-sustain-ms MS    How long lag must stay over the threshold (default: 5000)\n"
                       << "  --help               Show this help\n";
             exit(0);
         } else if (arg == "--config" && i + 1 < argc) {
@@ -179,13 +577,53 @@ void Config::apply_cli_args(int argc, char** argv) {
             http_port = std::stoi(argv[++i]);
         } else if (arg == "--flap-probability" && i + 1 < argc) {
             flap_probability = std::stod(argv[++i]);
+        } else if (arg == "--worker-threads" && i + 1 < argc) {
+            worker_threads = std::stoi(argv[++i]);
+        } else if (arg == "--port-sync" && i + 1 < argc) {
+            port_sync = argv[++i];
+        } else if (arg == "--log-mode" && i + 1 < argc) {
+            log_mode = argv[++i];
+        } else if (arg == "--log-queue-capacity" && i + 1 < argc) {
+            log_queue_capacity = std::stoi(argv[++i]);
+        } else if (arg == "--log-overflow" && i + 1 < argc) {
+            log_overflow = argv[++i];
+        } else if (arg == "--log-format" && i + 1 < argc) {
+            log_format = argv[++i];
+        } else if (arg == "--log-rate-limit" && i + 1 < argc) {
+            log_rate_limit = std::stod(argv[++i]);
+        } else if (arg == "--log-rate-burst" && i + 1 < argc) {
+            log_rate_burst = std::stoi(argv[++i]);
+        } else if (arg == "--metrics-max-age" && i + 1 < argc) {
+            metrics_max_age_ms = std::stoi(argv[++i]);
+        } else if (arg == "--event-socket" && i + 1 < argc) {
+            event_socket_path = argv[++i];
+        } else if (arg == "--journal-dir" && i + 1 < argc) {
+            journal_dir = argv[++i];
+        } else if (arg == "--journal-segment-mb" && i + 1 < argc) {
+            journal_segment_mb = std::stoi(argv[++i]);
+        } else if (arg == "--journal-commit-ms" && i + 1 < argc) {
+            journal_commit_ms = std::stoi(argv[++i]);
+        } else if (arg == "--snapshot" && i + 1 < argc) {
+            snapshot_path = argv[++i];
+        } else if (arg == "--mode" && i + 1 < argc) {
+            mode = argv[++i];
+        } else if (arg == "--duration-ticks" && i + 1 < argc) {
+            duration_ticks = std::stoull(argv[++i]);
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "--tick-catch-up" && i + 1 < argc) {
+            tick_catch_up = argv[++i];
+        } else if (arg == "--tick-lag-threshold-ms" && i + 1 < argc) {
+            tick_lag_threshold_ms = std::stoi(argv[++i]);
+        } else if (arg == "--tick-lag-sustain-ms" && i + 1 < argc) {
+            tick_lag_sustain_ms = std::stoi(argv[++i]);
         }
     }
 }
 
 bool Config::validate() const {
-    if (ports_count <= 0 || ports_count > 1000) {
-        std::cerr << "Error: ports_count must be between 1 and 1000\n";
+    if (ports_count <= 0 || ports_count > kMaxPorts) {
+        std::cerr << "Error: ports_count must be between 1 and " << kMaxPorts << "\n";
         return false;
     }
     
@@ -204,11 +642,107 @@ bool Config::validate() const {
         return false;
     }
     
+    if (init_latency_distribution != "uniform" && init_latency_distribution != "exponential") {
+        std::cerr << "Error: init_latency_distribution must be uniform or exponential\n";
+        return false;
+    }
+    
+    if (init_latency_min_ms < 0 || init_latency_max_ms < init_latency_min_ms) {
+        std::cerr << "Error: Invalid INIT latency range\n";
+        return false;
+    }
+    
     if (http_port < 1 || http_port > 65535) {
         std::cerr << "Error: http_port must be between 1 and 65535\n";
         return false;
     }
     
+    if (worker_threads < 0 || worker_threads > 256) {
+        std::cerr << "Error: worker_threads must be between 0 and 256\n";
+        return false;
+    }
+    
+    if (port_sync != "mutex" && port_sync != "lock_free") {
+        std::cerr << "Error: port_sync must be mutex or lock_free\n";
+        return false;
+    }
+    
+    if (log_mode != "sync" && log_mode != "async") {
+        std::cerr << "Error: log_mode must be sync or async\n";
+        return false;
+    }
+    
+    if (log_queue_capacity < 64 || log_queue_capacity > 1048576) {
+        std::cerr << "Error: log_queue_capacity must be between 64 and 1048576\n";
+        return false;
+    }
+    
+    if (log_overflow != "block" && log_overflow != "drop") {
+        std::cerr << "Error: log_overflow must be block or drop\n";
+        return false;
+    }
+    
+    if (log_format != "json" && log_format != "binary") {
+        std::cerr << "Error: log_format must be json or binary\n";
+        return false;
+    }
+    
+    if (log_rate_limit < 0.0 || log_rate_limit > 1000000.0) {
+        std::cerr << "Error: log_rate_limit must be between 0 and 1000000\n";
+        return false;
+    }
+    
+    if (log_rate_burst < 1 || log_rate_burst > 1000000) {
+        std::cerr << "Error: log_rate_burst must be between 1 and 1000000\n";
+        return false;
+    }
+    
+    if (metrics_max_age_ms < 0 || metrics_max_age_ms > 60000) {
+        std::cerr << "Error: metrics_max_age_ms must be between 0 and 60000\n";
+        return false;
+    }
+    
+    if (event_socket_path.size() >= kMaxEventSocketPath) {
+        std::cerr << "Error: event_socket_path must be shorter than " << kMaxEventSocketPath << " bytes\n";
+        return false;
+    }
+    
+    if (journal_segment_mb < 1 || journal_segment_mb > 4096) {
+        std::cerr << "Error: journal_segment_mb must be between 1 and 4096\n";
+        return false;
+    }
+    
+    if (journal_commit_ms < 1 || journal_commit_ms > 10000) {
+        std::cerr << "Error: journal_commit_ms must be between 1 and 10000\n";
+        return false;
+    }
+    
+    if (mode != "realtime" && mode != "discrete") {
+        std::cerr << "Error: mode must be realtime or discrete\n";
+        return false;
+    }
+    
+    // A discrete run never sleeps, so it needs an end
+    if (mode == "discrete" && duration_ticks == 0) {
+        std::cerr << "Error: discrete mode requires duration_ticks > 0\n";
+        return false;
+    }
+    
+    if (tick_catch_up != "burst" && tick_catch_up != "skip") {
+        std::cerr << "Error: tick_catch_up must be burst or skip\n";
+        return false;
+    }
+    
+    if (tick_lag_threshold_ms < 0) {
+        std::cerr << "Error: tick_lag_threshold_ms must be >= 0\n";
+        return false;
+    }
+    
+    if (tick_lag_sustain_ms < 0) {
+        std::cerr << "Error: tick_lag_sustain_ms must be >= 0\n";
+        return false;
+    }
+    
     return true;
 }
 
@@ -220,8 +754,31 @@ std::string Config::to_string() const {
         << "  flap_probability: " << flap_probability << "\n"
         << "  flap_min_ms: " << flap_min_ms << "\n"
         << "  flap_max_ms: " << flap_max_ms << "\n"
+        << "  init_latency_distribution: " << init_latency_distribution << "\n"
+        << "  init_latency_min_ms: " << init_latency_min_ms << "\n"
+        << "  init_latency_max_ms: " << init_latency_max_ms << "\n"
         << "  log_level: " << log_level << "\n"
-        << "  http_port: " << http_port << "\n";
+        << "  http_port: " << http_port << "\n"
+        << "  worker_threads: " << worker_threads << "\n"
+        << "  port_sync: " << port_sync << "\n"
+        << "  log_mode: " << log_mode << "\n"
+        << "  log_queue_capacity: " << log_queue_capacity << "\n"
+        << "  log_overflow: " << log_overflow << "\n"
+        << "  log_format: " << log_format << "\n"
+        << "  log_rate_limit: " << log_rate_limit << "\n"
+        << "  log_rate_burst: " << log_rate_burst << "\n"
+        << "  metrics_max_age_ms: " << metrics_max_age_ms << "\n"
+        << "  event_socket_path: " << (event_socket_path.empty() ? "(off)" : event_socket_path) << "\n"
+        << "  journal_dir: " << (journal_dir.empty() ? "(off)" : journal_dir) << "\n"
+        << "  journal_segment_mb: " << journal_segment_mb << "\n"
+        << "  journal_commit_ms: " << journal_commit_ms << "\n"
+        << "  snapshot_path: " << (snapshot_path.empty() ? "(off)" : snapshot_path) << "\n"
+        << "  mode: " << mode << "\n"
+        << "  duration_ticks: " << duration_ticks << "\n"
+        << "  trace_path: " << (trace_path.empty() ? "(off)" : trace_path) << "\n"
+        << "  tick_catch_up: " << tick_catch_up << "\n"
+        << "  tick_lag_threshold_ms: " << tick_lag_threshold_ms << "\n"
+        << "  tick_lag_sustain_ms: " << tick_lag_sustain_ms << "\n";
     
     if (seed.has_value()) {
         oss << "  seed: " << seed.value() << "\n";
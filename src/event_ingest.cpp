@@ -0,0 +1,229 @@
+#include "event_ingest.h"
+#include <charconv>
+#include <limits>
+
+namespace control_plane {
+
+namespace {
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Minimal cursor over one JSON object; only what event records need
+class JsonCursor {
+public:
+    explicit JsonCursor(std::string_view text) : text_(text), pos_(0) {}
+
+    void skip_space() {
+        while (pos_ < text_.size() && is_space(text_[pos_])) {
+            pos_++;
+        }
+    }
+
+    bool at_end() const { return pos_ == text_.size(); }
+
+    // Consume `c` after optional whitespace
+    bool consume(char c) {
+        skip_space();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    bool peek(char c) {
+        skip_space();
+        return pos_ < text_.size() && text_[pos_] == c;
+    }
+
+    // A string's raw contents (escapes are skipped over, not decoded)
+    bool read_string(std::string_view& out) {
+        if (!consume('"')) {
+            return false;
+        }
+        size_t begin = pos_;
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            pos_ += text_[pos_] == '\\' ? 2 : 1;
+        }
+        if (pos_ >= text_.size()) {
+            return false;
+        }
+        out = text_.substr(begin, pos_ - begin);
+        pos_++;
+        return true;
+    }
+
+    bool read_int(int64_t& out) {
+        skip_space();
+        const char* begin = text_.data() + pos_;
+        std::from_chars_result result = std::from_chars(begin, text_.data() + text_.size(), out);
+        if (result.ec != std::errc()) {
+            return false;
+        }
+        pos_ += static_cast<size_t>(result.ptr - begin);
+        return true;
+    }
+
+    // Skip a string, number, true, false or null
+    bool skip_value() {
+        if (peek('"')) {
+            std::string_view ignored;
+            return read_string(ignored);
+        }
+        size_t begin = pos_;
+        while (pos_ < text_.size() && !is_space(text_[pos_]) && text_[pos_] != ',' &&
+               text_[pos_] != '}') {
+            char c = text_[pos_];
+            if (c == '{' || c == '[' || c == '"') {
+                return false; // Nested values are not part of a record
+            }
+            pos_++;
+        }
+        return pos_ > begin;
+    }
+
+private:
+    std::string_view text_;
+    size_t pos_;
+};
+
+} // namespace
+
+bool parse_event_ingest_format(std::string_view content_type, EventIngestFormat& format) {
+    std::string_view type = content_type.substr(0, content_type.find(';'));
+    while (!type.empty() && is_space(type.back())) {
+        type.remove_suffix(1);
+    }
+    if (type == "application/x-ndjson" || type == "application/json" || type == "text/plain") {
+        format = EventIngestFormat::NDJSON;
+        return true;
+    }
+    if (type == "application/octet-stream") {
+        format = EventIngestFormat::BINARY;
+        return true;
+    }
+    return false;
+}
+
+bool parse_event_json(std::string_view line, PortEventRecord& record) {
+    JsonCursor cursor(line);
+    if (!cursor.consume('{')) {
+        return false;
+    }
+    bool have_port = false;
+    bool have_event = false;
+    if (!cursor.consume('}')) {
+        do {
+            std::string_view key;
+            if (!cursor.read_string(key) || !cursor.consume(':')) {
+                return false;
+            }
+            if (key == "port_id") {
+                int64_t port_id;
+                if (!cursor.read_int(port_id) || port_id < std::numeric_limits<int32_t>::min() ||
+                    port_id > std::numeric_limits<int32_t>::max()) {
+                    return false;
+                }
+                record.port_id = static_cast<int32_t>(port_id);
+                have_port = true;
+            } else if (key == "event") {
+                if (cursor.peek('"')) {
+                    std::string_view name;
+                    if (!cursor.read_string(name) || !parse_port_event(name, record.event)) {
+                        return false;
+                    }
+                } else {
+                    int64_t value;
+                    if (!cursor.read_int(value) || value < 0 || value >= kNumPortEvents) {
+                        return false;
+                    }
+                    record.event = static_cast<PortEvent>(value);
+                }
+                have_event = true;
+            } else if (!cursor.skip_value()) {
+                return false;
+            }
+        } while (cursor.consume(','));
+        if (!cursor.consume('}')) {
+            return false;
+        }
+    }
+    cursor.skip_space();
+    return cursor.at_end() && have_port && have_event;
+}
+
+size_t EventBodyReader::read(PortEventRecord* out, size_t capacity) {
+    return format_ == EventIngestFormat::BINARY ? read_binary(out, capacity)
+                                                : read_ndjson(out, capacity);
+}
+
+size_t EventBodyReader::read_ndjson(PortEventRecord* out, size_t capacity) {
+    size_t count = 0;
+    while (count < capacity && pos_ < body_.size()) {
+        size_t end = body_.find('\n', pos_);
+        if (end == std::string_view::npos) {
+            end = body_.size();
+        }
+        std::string_view line = body_.substr(pos_, end - pos_);
+        pos_ = end + 1;
+
+        size_t first = 0;
+        while (first < line.size() && is_space(line[first])) {
+            first++;
+        }
+        if (first == line.size()) {
+            continue; // Blank line
+        }
+        if (parse_event_json(line.substr(first), out[count])) {
+            count++;
+        } else {
+            malformed_++;
+        }
+    }
+    return count;
+}
+
+size_t EventBodyReader::read_binary(PortEventRecord* out, size_t capacity) {
+    size_t count = 0;
+    while (count < capacity && pos_ + kBinaryEventRecordBytes <= body_.size()) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(body_.data() + pos_);
+        pos_ += kBinaryEventRecordBytes;
+        uint32_t port_id = static_cast<uint32_t>(bytes[0]) |
+                           (static_cast<uint32_t>(bytes[1]) << 8) |
+                           (static_cast<uint32_t>(bytes[2]) << 16) |
+                           (static_cast<uint32_t>(bytes[3]) << 24);
+        if (bytes[4] >= kNumPortEvents) {
+            malformed_++;
+            continue;
+        }
+        out[count].port_id = static_cast<int32_t>(port_id);
+        out[count].event = static_cast<PortEvent>(bytes[4]);
+        count++;
+    }
+    if (count < capacity && pos_ < body_.size() && body_.size() - pos_ < kBinaryEventRecordBytes) {
+        // Trailing partial record
+        malformed_++;
+        pos_ = body_.size();
+    }
+    return count;
+}
+
+EventIngestSummary ingest_events(PortManager& manager, std::string_view body,
+                                 EventIngestFormat format) {
+    EventIngestSummary summary;
+    EventBodyReader reader(body, format);
+    PortEventRecord batch[kIngestBatchSize];
+    while (size_t count = reader.read(batch, kIngestBatchSize)) {
+        PortEventBatchSummary result = manager.process_port_events(batch, count);
+        summary.applied += result.applied;
+        summary.transitions += result.transitions;
+        summary.rejected += result.rejected;
+    }
+    summary.malformed = reader.malformed();
+    summary.rejected += summary.malformed;
+    return summary;
+}
+
+} // namespace control_plane
@@ -0,0 +1,531 @@
+#include "event_journal.h"
+#include "logger.h"
+#include "port_table.h"
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace control_plane {
+
+namespace {
+
+constexpr const char* kSegmentPrefix = "journal-";
+constexpr const char* kSegmentSuffix = ".seg";
+constexpr int64_t kNsPerMs = 1000000;
+
+std::string segment_path(const std::string& dir, uint64_t base_seq) {
+    char name[48];
+    std::snprintf(name, sizeof(name), "%s%020" PRIu64 "%s", kSegmentPrefix, base_seq, kSegmentSuffix);
+    return dir + "/" + name;
+}
+
+int64_t realtime_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+size_t page_size() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+} // namespace
+
+uint16_t journal_record_check(const JournalRecord& record, uint64_t seq) {
+    uint64_t h = seq * 0x9E3779B97F4A7C15ull;
+    h ^= ((static_cast<uint64_t>(static_cast<uint32_t>(record.port_id)) << 32) | record.transitions) *
+         0xC2B2AE3D27D4EB4Full;
+    h ^= ((static_cast<uint64_t>(record.time_ms) << 16) | (static_cast<uint64_t>(record.event) << 8) |
+          static_cast<uint64_t>(record.state)) * 0x165667B19E3779F9ull;
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 32;
+    return static_cast<uint16_t>(h | 1);
+}
+
+struct EventJournal::Segment {
+    std::string path;
+    int fd = -1;
+    void* map = nullptr;
+    size_t map_bytes = 0;
+    uint64_t base_seq = 0;
+    uint64_t capacity = 0;
+    int64_t steady_base_ns = 0;
+    JournalRecord* records = nullptr;
+    uint64_t synced = 0; // Slots below this are committed; commit_mutex_
+
+    // Slots handed out to writers (may run past capacity)
+    alignas(64) std::atomic<uint64_t> reserved{0};
+    // Slots that will ever be written: capacity, or fewer once retired early
+    std::atomic<uint64_t> end{0};
+};
+
+EventJournal::EventJournal(std::string dir, int num_ports, Metrics& metrics,
+                           size_t segment_bytes, std::chrono::milliseconds commit_interval)
+    : dir_(std::move(dir)),
+      num_ports_(num_ports),
+      capacity_((std::max(segment_bytes, kMinSegmentBytes) - sizeof(JournalSegmentHeader)) /
+                sizeof(JournalRecord)),
+      commit_interval_(commit_interval),
+      open_(false),
+      current_(nullptr),
+      failed_(false),
+      stopping_(false),
+      records_committed_(0),
+      metrics_(metrics) {
+    records_metric_ = metrics_.register_counter("journal_records_total");
+    commits_metric_ = metrics_.register_counter("journal_commits_total");
+    commit_latency_metric_ = metrics_.register_histogram("journal_commit_seconds");
+}
+
+EventJournal::~EventJournal() {
+    close();
+}
+
+bool EventJournal::open() {
+    if (open_) {
+        return true;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(dir_, error);
+    if (error) {
+        Logger::instance().errorf("EventJournal", -1, "Cannot create journal directory {}: {}",
+                                  dir_, error.message());
+        return false;
+    }
+
+    // Continue the sequence after every existing segment
+    uint64_t next_seq = 1;
+    for (const std::string& path : list_segments(dir_)) {
+        JournalSegmentHeader header{};
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0 && pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+            header.magic == kJournalMagic) {
+            next_seq = std::max(next_seq, header.base_seq + header.capacity);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    std::unique_ptr<Segment> first = create_segment(next_seq);
+    if (!first) {
+        return false;
+    }
+    current_.store(first.get(), std::memory_order_release);
+    segments_.push_back(std::move(first));
+    failed_.store(false);
+    stopping_ = false;
+    open_ = true;
+    commit_thread_ = std::thread([this]() { run_commits(); });
+
+    Logger::instance().infof("EventJournal", -1, "Journaling to {} from seq {} ({} records per segment)",
+                             dir_, next_seq, capacity_);
+    return true;
+}
+
+void EventJournal::close() {
+    if (!open_) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (commit_thread_.joinable()) {
+        commit_thread_.join();
+    }
+    commit();
+
+    std::lock_guard<std::mutex> roll_lock(roll_mutex_);
+    std::lock_guard<std::mutex> lock(segment_mutex_);
+    Segment* last = current_.exchange(nullptr);
+    for (auto& segment : segments_) {
+        if (segment.get() != last || !segment->map) {
+            destroy_segment(*segment, false);
+            continue;
+        }
+        // Drop the unused tail of the last segment, or the whole segment if
+        // nothing was written to it
+        uint64_t used = std::min(segment->reserved.load(), segment->capacity);
+        if (used == 0) {
+            destroy_segment(*segment, true);
+            continue;
+        }
+        off_t bytes = static_cast<off_t>(sizeof(JournalSegmentHeader) + used * sizeof(JournalRecord));
+        if (ftruncate(segment->fd, bytes) != 0) {
+            Logger::instance().errorf("EventJournal", -1, "Failed to truncate {}: {}", segment->path,
+                                      std::strerror(errno));
+        }
+        destroy_segment(*segment, false);
+    }
+    segments_.clear();
+    if (spare_) {
+        destroy_segment(*spare_, true);
+        spare_.reset();
+    }
+    open_ = false;
+    Logger::instance().infof("EventJournal", -1, "Journal closed after {} committed records",
+                             records_committed_.load());
+}
+
+void EventJournal::append(const JournalEntry* entries, size_t count, int64_t now_ns) {
+    while (count > 0) {
+        Segment* segment = current_.load(std::memory_order_acquire);
+        if (!segment) {
+            return; // Closed
+        }
+        uint64_t slot = segment->reserved.fetch_add(count, std::memory_order_relaxed);
+        if (slot >= segment->capacity) {
+            if (!roll(segment)) {
+                return;
+            }
+            continue;
+        }
+
+        // Segments retire long before this could exceed 32 bits
+        int64_t elapsed_ms = std::max<int64_t>(0, now_ns - segment->steady_base_ns) / kNsPerMs;
+        uint32_t time_ms = static_cast<uint32_t>(
+            std::min<int64_t>(elapsed_ms, std::numeric_limits<uint32_t>::max()));
+
+        // A reservation running past the end keeps its head here and
+        // retries the rest in the next segment
+        size_t n = static_cast<size_t>(std::min<uint64_t>(count, segment->capacity - slot));
+        JournalRecord* out = segment->records + slot;
+        for (size_t i = 0; i < n; i++) {
+            JournalRecord record{entries[i].port_id,
+                                 static_cast<uint32_t>(PortTable::word_transitions(entries[i].word)),
+                                 time_ms, entries[i].event, PortTable::word_state(entries[i].word), 0};
+            uint16_t check = journal_record_check(record, segment->base_seq + slot + i);
+            out[i] = record;
+            // The check value goes last: a slot is complete once it's non-zero
+            __atomic_store_n(&out[i].check, check, __ATOMIC_RELEASE);
+        }
+        entries += n;
+        count -= n;
+    }
+}
+
+bool EventJournal::roll(Segment* full, bool retire) {
+    // Waits out a spare being preallocated, which is usually the segment
+    // this roll needs
+    std::lock_guard<std::mutex> roll_lock(roll_mutex_);
+    if (current_.load(std::memory_order_acquire) != full) {
+        return current_.load() != nullptr; // Someone else rolled (or we closed)
+    }
+    if (failed_.load()) {
+        return false;
+    }
+
+    uint64_t base_seq = full->base_seq + full->capacity;
+    std::unique_ptr<Segment> next;
+    {
+        std::lock_guard<std::mutex> lock(segment_mutex_);
+        next = std::move(spare_);
+    }
+    if (!next) {
+        next = create_segment(base_seq);
+    }
+    if (!next) {
+        failed_.store(true);
+        Logger::instance().errorf("EventJournal", -1, "Journal stopped recording at seq {}", base_seq);
+        return false;
+    }
+    if (retire) {
+        // Push the reservation counter past the end: writers that already
+        // hold slots finish them, later ones roll over to `next`
+        uint64_t used = full->reserved.fetch_add(full->capacity);
+        full->end.store(std::min(used, full->capacity));
+    }
+    std::lock_guard<std::mutex> lock(segment_mutex_);
+    current_.store(next.get(), std::memory_order_release);
+    segments_.push_back(std::move(next));
+    wake_.notify_all(); // Let the commit thread preallocate the next one
+    return true;
+}
+
+std::unique_ptr<EventJournal::Segment> EventJournal::create_segment(uint64_t base_seq) {
+    auto segment = std::make_unique<Segment>();
+    segment->path = segment_path(dir_, base_seq);
+    segment->base_seq = base_seq;
+    segment->capacity = capacity_;
+    segment->end.store(capacity_);
+    segment->map_bytes = sizeof(JournalSegmentHeader) + capacity_ * sizeof(JournalRecord);
+
+    segment->fd = ::open(segment->path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    int error = segment->fd < 0 ? errno : posix_fallocate(segment->fd, 0, static_cast<off_t>(segment->map_bytes));
+    if (error == 0) {
+        segment->map = mmap(nullptr, segment->map_bytes, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, segment->fd, 0);
+        if (segment->map == MAP_FAILED) {
+            segment->map = nullptr;
+            error = errno;
+        }
+    }
+    if (error == 0) {
+        // MAP_POPULATE maps shared pages read-only; take each page's write
+        // fault here (usually on the commit thread) instead of in writers
+        volatile char* bytes = static_cast<volatile char*>(segment->map);
+        for (size_t offset = 0; offset < segment->map_bytes; offset += page_size()) {
+            bytes[offset] = 0;
+        }
+    }
+    if (error != 0) {
+        Logger::instance().errorf("EventJournal", -1, "Cannot create journal segment {}: {}",
+                                  segment->path, std::strerror(error));
+        bool created = segment->fd >= 0;
+        destroy_segment(*segment, created);
+        return nullptr;
+    }
+
+    JournalSegmentHeader header{};
+    header.magic = kJournalMagic;
+    header.version = kJournalVersion;
+    header.base_seq = base_seq;
+    header.capacity = capacity_;
+    header.num_ports = num_ports_;
+    header.record_bytes = sizeof(JournalRecord);
+    header.steady_base_ns = PortTable::now_ns();
+    header.realtime_base_ns = realtime_ns();
+    std::memcpy(segment->map, &header, sizeof(header));
+    segment->steady_base_ns = header.steady_base_ns;
+    segment->records = reinterpret_cast<JournalRecord*>(
+        static_cast<char*>(segment->map) + sizeof(JournalSegmentHeader));
+    return segment;
+}
+
+void EventJournal::destroy_segment(Segment& segment, bool remove_file) {
+    if (segment.map) {
+        munmap(segment.map, segment.map_bytes);
+        segment.map = nullptr;
+        segment.records = nullptr;
+    }
+    if (segment.fd >= 0) {
+        ::close(segment.fd);
+        segment.fd = -1;
+    }
+    if (remove_file) {
+        unlink(segment.path.c_str());
+    }
+}
+
+void EventJournal::commit() {
+    std::lock_guard<std::mutex> commit_lock(commit_mutex_);
+
+    std::vector<Segment*> live;
+    Segment* current;
+    {
+        std::lock_guard<std::mutex> lock(segment_mutex_);
+        current = current_.load();
+        for (auto& segment : segments_) {
+            if (segment->map) {
+                live.push_back(segment.get());
+            }
+        }
+    }
+
+    ScopedLatency latency(metrics_, commit_latency_metric_);
+    uint64_t committed = 0;
+    for (Segment* segment : live) {
+        // Commit up to the first slot a writer is still filling; slots are
+        // handed out in order, so everything before it is complete
+        uint64_t end = segment->end.load(std::memory_order_acquire);
+        uint64_t reserved = std::min(segment->reserved.load(std::memory_order_acquire), end);
+        uint64_t filled = segment->synced;
+        while (filled < reserved &&
+               __atomic_load_n(&segment->records[filled].check, __ATOMIC_ACQUIRE) != 0) {
+            filled++;
+        }
+        if (filled > segment->synced) {
+            size_t begin = sizeof(JournalSegmentHeader) + segment->synced * sizeof(JournalRecord);
+            size_t stop = sizeof(JournalSegmentHeader) + filled * sizeof(JournalRecord);
+            begin &= ~(page_size() - 1);
+            if (msync(static_cast<char*>(segment->map) + begin, stop - begin, MS_SYNC) != 0) {
+                Logger::instance().errorf("EventJournal", -1, "msync of {} failed: {}", segment->path,
+                                          std::strerror(errno));
+                continue;
+            }
+            committed += filled - segment->synced;
+            segment->synced = filled;
+        }
+        // A rolled segment is done once everything in it is committed
+        if (segment != current && segment->synced == end) {
+            std::lock_guard<std::mutex> lock(segment_mutex_);
+            if (end < segment->capacity && ftruncate(segment->fd, static_cast<off_t>(
+                    sizeof(JournalSegmentHeader) + end * sizeof(JournalRecord))) != 0) {
+                Logger::instance().errorf("EventJournal", -1, "Failed to truncate {}: {}",
+                                          segment->path, std::strerror(errno));
+            }
+            destroy_segment(*segment, end == 0);
+        }
+    }
+
+    if (committed > 0) {
+        records_committed_.fetch_add(committed);
+        metrics_.increment(records_metric_, committed);
+        metrics_.increment(commits_metric_);
+    }
+}
+
+void EventJournal::prepare_spare() {
+    // Preallocating and populating a segment is slow, so writers only wait
+    // for it if they fill the current segment meanwhile
+    std::lock_guard<std::mutex> roll_lock(roll_mutex_);
+    uint64_t base_seq;
+    {
+        std::lock_guard<std::mutex> lock(segment_mutex_);
+        Segment* current = current_.load();
+        if (!current || spare_ || failed_.load()) {
+            return;
+        }
+        base_seq = current->base_seq + current->capacity;
+    }
+    std::unique_ptr<Segment> spare = create_segment(base_seq);
+    std::lock_guard<std::mutex> lock(segment_mutex_);
+    spare_ = std::move(spare);
+}
+
+void EventJournal::run_commits() {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    while (!stopping_) {
+        wake_.wait_for(lock, commit_interval_);
+        if (stopping_) {
+            break;
+        }
+        lock.unlock();
+        commit();
+        prepare_spare();
+        Segment* current = current_.load(std::memory_order_acquire);
+        if (current && PortTable::now_ns() - current->steady_base_ns >
+                std::chrono::duration_cast<std::chrono::nanoseconds>(kMaxSegmentAge).count()) {
+            roll(current, true);
+        }
+        lock.lock();
+    }
+}
+
+std::vector<std::string> EventJournal::list_segments(const std::string& dir) {
+    std::vector<std::string> paths;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, error)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind(kSegmentPrefix, 0) == 0 && name.size() > std::strlen(kSegmentSuffix) &&
+            name.compare(name.size() - std::strlen(kSegmentSuffix), std::string::npos, kSegmentSuffix) == 0) {
+            paths.push_back(entry.path().string());
+        }
+    }
+    // Zero-padded base sequence numbers sort numerically
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+bool EventJournal::replay(const std::string& dir, int num_ports, JournalReplay& out) {
+    out = JournalReplay{};
+    out.ports.assign(static_cast<size_t>(std::max(num_ports, 0)), PortRecoveryState{});
+
+    std::error_code error;
+    if (!std::filesystem::exists(dir, error)) {
+        return !error;
+    }
+    if (!std::filesystem::is_directory(dir, error)) {
+        Logger::instance().errorf("EventJournal", -1, "Journal path {} is not a directory", dir);
+        return false;
+    }
+
+    // Wall-clock time of each port's latest transition, comparable across
+    // the runs that wrote the segments
+    std::vector<int64_t> transition_realtime(out.ports.size(), std::numeric_limits<int64_t>::max());
+
+    for (const std::string& path : list_segments(dir)) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat info{};
+        if (fd < 0 || fstat(fd, &info) != 0 ||
+            static_cast<size_t>(info.st_size) < sizeof(JournalSegmentHeader)) {
+            Logger::instance().warnf("EventJournal", -1, "Skipping unreadable journal segment {}", path);
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            continue;
+        }
+        size_t bytes = static_cast<size_t>(info.st_size);
+        void* map = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            Logger::instance().warnf("EventJournal", -1, "Skipping unmappable journal segment {}", path);
+            continue;
+        }
+        madvise(map, bytes, MADV_SEQUENTIAL);
+
+        JournalSegmentHeader header;
+        std::memcpy(&header, map, sizeof(header));
+        if (header.magic != kJournalMagic || header.version != kJournalVersion ||
+            header.record_bytes != sizeof(JournalRecord)) {
+            Logger::instance().warnf("EventJournal", -1, "Skipping journal segment {} with a bad header", path);
+            munmap(map, bytes);
+            continue;
+        }
+
+        // A segment closed cleanly is truncated to its records
+        uint64_t slots = std::min<uint64_t>(header.capacity,
+                                            (bytes - sizeof(header)) / sizeof(JournalRecord));
+        const JournalRecord* records = reinterpret_cast<const JournalRecord*>(
+            static_cast<const char*>(map) + sizeof(header));
+        for (uint64_t slot = 0; slot < slots; slot++) {
+            const JournalRecord& record = records[slot];
+            if (record.check == 0) {
+                continue; // Never written
+            }
+            if (record.check != journal_record_check(record, header.base_seq + slot) ||
+                static_cast<uint8_t>(record.state) >= kNumPortStates) {
+                out.corrupt++;
+                continue;
+            }
+            if (record.port_id < 0 || record.port_id >= num_ports) {
+                out.skipped++;
+                continue;
+            }
+            out.records++;
+
+            // The port's state is the one with the most transitions; among
+            // records with that count the earliest is the transition itself
+            PortRecoveryState& port = out.ports[record.port_id];
+            int64_t realtime = header.realtime_base_ns + static_cast<int64_t>(record.time_ms) * kNsPerMs;
+            if (record.transitions > port.transitions) {
+                port.state = record.state;
+                port.transitions = record.transitions;
+                transition_realtime[record.port_id] = realtime;
+            } else if (record.transitions == port.transitions && record.transitions > 0 &&
+                       realtime < transition_realtime[record.port_id]) {
+                transition_realtime[record.port_id] = realtime;
+            }
+        }
+        munmap(map, bytes);
+        out.segments++;
+    }
+
+    // Map transition times onto this process's steady clock
+    int64_t steady_now = PortTable::now_ns();
+    int64_t realtime_now = realtime_ns();
+    for (size_t port_id = 0; port_id < out.ports.size(); port_id++) {
+        if (out.ports[port_id].transitions > 0) {
+            out.ports[port_id].last_transition_ns =
+                steady_now - std::max<int64_t>(0, realtime_now - transition_realtime[port_id]);
+        } else {
+            out.ports[port_id].last_transition_ns = steady_now;
+        }
+    }
+    return true;
+}
+
+} // namespace control_plane
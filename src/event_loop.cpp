@@ -1,25 +1,67 @@
 #include "event_loop.h"
 #include "logger.h"
-#include <sstream>
 #include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <random>
 
 namespace control_plane {
 
+namespace {
+
+// CounterRng streams: flap durations use stream 0 and the flap sampler's
+// gaps FlapSampler::kGapStream
+constexpr uint32_t kInitLatencyStream = 2;
+
+} // namespace
+
+std::string simulation_mode_to_string(SimulationMode mode) {
+    switch (mode) {
+        case SimulationMode::REALTIME: return "realtime";
+        case SimulationMode::DISCRETE: return "discrete";
+        default: return "unknown";
+    }
+}
+
+bool parse_simulation_mode(const std::string& str, SimulationMode& mode) {
+    if (str == "realtime") {
+        mode = SimulationMode::REALTIME;
+        return true;
+    }
+    if (str == "discrete") {
+        mode = SimulationMode::DISCRETE;
+        return true;
+    }
+    return false;
+}
+
 EventLoop::EventLoop(std::shared_ptr<PortManager> port_manager, const Config& config)
     : port_manager_(port_manager),
       config_(config),
+      mode_(SimulationMode::REALTIME),
       running_(false),
-      tick_count_(0) {
+      finished_(false),
+      tick_count_(0),
+      catch_up_skip_(config.tick_catch_up == "skip"),
+      tick_lag_ns_(0),
+      lagging_(false),
+      tracing_(false),
+      init_latency_exponential_(config.init_latency_distribution == "exponential") {
+    
+    parse_simulation_mode(config_.mode, mode_);
+    tracing_ = mode_ == SimulationMode::DISCRETE || !config_.trace_path.empty();
+    if (!config_.trace_path.empty()) {
+        trace_.open(config_.trace_path);
+    }
     
     // Initialize RNG with seed if provided
     if (config_.seed.has_value()) {
-        rng_.seed(config_.seed.value());
-        std::stringstream ss;
-        ss << "EventLoop initialized with deterministic seed: " << config_.seed.value();
-        Logger::instance().info(ss.str(), "EventLoop");
+        rng_ = CounterRng(config_.seed.value());
+        Logger::instance().infof("EventLoop", -1, "EventLoop initialized with deterministic seed: {}",
+                                 config_.seed.value());
     } else {
         std::random_device rd;
-        rng_.seed(rd());
+        rng_ = CounterRng(static_cast<uint64_t>(rd()) << 32 | rd());
         Logger::instance().info("EventLoop initialized with random seed", "EventLoop");
     }
 }
@@ -35,22 +77,49 @@ void EventLoop::start() {
     }
     
     running_.store(true);
-    Logger::instance().info("Starting EventLoop", "EventLoop");
+    stop_token_.reset();
+    Logger::instance().infof("EventLoop", -1, "Starting EventLoop ({} clock)", simulation_mode_to_string(mode_));
     
-    // Start tick thread
-    tick_thread_ = std::thread(&EventLoop::tick_loop, this);
+    // Every port starts with a heartbeat due on the next tick, which powers it on
+    int num_ports = port_manager_->get_num_ports();
+    uint64_t now = tick_count_.load();
+    wheel_ = std::make_unique<TimingWheel>(static_cast<uint32_t>(num_ports), now);
+    flap_sampler_ = std::make_unique<FlapSampler>(rng_, config_.flap_probability);
+    for (int port_id = 0; port_id < num_ports; port_id++) {
+        wheel_->schedule(port_id, now + 1, static_cast<uint8_t>(PortTimer::HEARTBEAT));
+    }
     
-    // Start worker threads
-    int num_workers = 4; // 2 for heartbeat, 2 for flap injection
-    for (int i = 0; i < num_workers; i++) {
-        if (i < 2) {
-            worker_threads_.emplace_back(&EventLoop::heartbeat_worker, this, i);
-        } else {
-            worker_threads_.emplace_back(&EventLoop::flap_injector_worker, this, i);
-        }
+    // Worker pool, each worker owning a contiguous shard of ports
+    executor_ = std::make_unique<WorkStealingExecutor>(config_.worker_threads);
+    int num_workers = executor_->get_num_workers();
+    port_bounds_.assign(num_workers + 1, 0);
+    for (int w = 0; w <= num_workers; w++) {
+        // Rounded up so that port_bounds_ agrees with shard_of()
+        port_bounds_[w] = static_cast<uint32_t>(
+            (static_cast<uint64_t>(num_ports) * w + num_workers - 1) / num_workers);
     }
+    worker_buffers_.assign(num_workers, {});
+    published_items_.assign(num_workers, 0);
+    published_steals_.assign(num_workers, 0);
     
-    Logger::instance().info("EventLoop started with worker threads", "EventLoop");
+    Metrics& metrics = port_manager_->get_metrics();
+    metrics.set_gauge("worker_threads", static_cast<double>(num_workers));
+    flaps_injected_metric_ = metrics.register_counter("link_flaps_injected_total");
+    ticks_missed_metric_ = metrics.register_counter("ticks_missed_total");
+    tick_lag_metric_ = metrics.register_histogram("tick_lag_seconds");
+    tick_jitter_metric_ = metrics.register_histogram("tick_jitter_seconds");
+    worker_items_metrics_.clear();
+    worker_steals_metrics_.clear();
+    for (int w = 0; w < num_workers; w++) {
+        std::string label = "{worker=\"" + std::to_string(w) + "\"}";
+        worker_items_metrics_.push_back(metrics.register_counter("worker_items_processed_total" + label));
+        worker_steals_metrics_.push_back(metrics.register_counter("worker_steals_total" + label));
+    }
+    
+    // Start tick thread
+    tick_thread_ = std::thread(&EventLoop::tick_loop, this);
+    
+    Logger::instance().infof("EventLoop", -1, "EventLoop started with {} worker threads", num_workers);
 }
 
 void EventLoop::stop() {
@@ -60,139 +129,348 @@ void EventLoop::stop() {
     
     Logger::instance().info("Stopping EventLoop", "EventLoop");
     running_.store(false);
+    stop_token_.request_stop();
     
     // Wait for tick thread
     if (tick_thread_.joinable()) {
         tick_thread_.join();
     }
     
-    // Wait for all worker threads
-    for (auto& thread : worker_threads_) {
-        if (thread.joinable()) {
-            thread.join();
-        }
-    }
+    // Join the worker pool
+    executor_.reset();
+    trace_.close();
     
-    worker_threads_.clear();
     Logger::instance().info("EventLoop stopped", "EventLoop");
 }
 
 void EventLoop::tick_loop() {
     Logger::instance().info("Tick loop started", "EventLoop");
     
+    int num_workers = executor_->get_num_workers();
+    std::vector<uint32_t> shard_counts(num_workers);
+    
+    auto started = SteadyClock::now();
+    next_deadline_ = started + std::chrono::milliseconds(config_.tick_ms);
+    last_tick_start_ = SteadyClock::time_point();
+    lagging_since_ = SteadyClock::time_point();
     while (running_.load()) {
-        tick_count_.fetch_add(1);
+        uint64_t previous = tick_count_.load();
+        uint64_t tick = 0;
+        if (!wait_for_next_tick(tick)) {
+            break;
+        }
+        tick_count_.store(tick);
         
-        // Sleep for tick duration
-        std::this_thread::sleep_for(std::chrono::milliseconds(config_.tick_ms));
+        // Collect the port timers that are due this tick
+        expired_.clear();
+        wheel_->advance(tick, expired_);
+        
+        if (!expired_.empty()) {
+            // Group them by owning shard; the counting sort keeps expiry order
+            // within each shard (the trace is sorted by port separately)
+            std::fill(shard_counts.begin(), shard_counts.end(), 0);
+            for (const auto& timer : expired_) {
+                shard_counts[shard_of(timer.id)]++;
+            }
+            batch_bounds_.assign(num_workers + 1, 0);
+            for (int w = 0; w < num_workers; w++) {
+                batch_bounds_[w + 1] = batch_bounds_[w] + shard_counts[w];
+            }
+            batch_.resize(expired_.size());
+            std::copy(batch_bounds_.begin(), batch_bounds_.end() - 1, shard_counts.begin());
+            for (const auto& timer : expired_) {
+                batch_[shard_counts[shard_of(timer.id)]++] = timer;
+            }
+            
+            executor_->run(batch_bounds_, kTimerChunkSize,
+                [this, tick](int worker_id, uint32_t begin, uint32_t end) {
+                    WorkerBuffers& buffers = worker_buffers_[worker_id];
+                    for (uint32_t i = begin; i < end; i++) {
+                        on_port_timer(buffers, static_cast<int>(batch_[i].id),
+                                      static_cast<PortTimer>(batch_[i].kind), tick);
+                    }
+                    flush_events(buffers);
+                });
+            apply_worker_output(tick);
+        }
+        
+        // A skip can jump over a cycle boundary; the cycle still runs
+        if (tick / kFlapCycleTicks != previous / kFlapCycleTicks) {
+            flap_injector_cycle(tick);
+        }
+        
+        publish_worker_metrics();
         
         // Log tick every 100 ticks
-        if (tick_count_ % 100 == 0) {
-            std::stringstream ss;
-            ss << "Tick " << tick_count_.load() << " - Events processed: " 
-               << port_manager_->get_total_events_processed();
-            Logger::instance().debug(ss.str(), "EventLoop");
+        if (tick % 100 == 0) {
+            Logger::instance().debugf("EventLoop", -1, "Tick {} - Events processed: {}, pending timers: {}",
+                                      tick, port_manager_->get_total_events_processed(),
+                                      wheel_->get_pending_count());
+        }
+        
+        if (config_.duration_ticks > 0 && tick >= config_.duration_ticks) {
+            double seconds = std::chrono::duration<double>(SteadyClock::now() - started).count();
+            Logger::instance().infof("EventLoop", -1,
+                                     "Simulated {} ticks ({} ms) in {} s: {} events, trace {}",
+                                     tick, tick * config_.tick_ms, seconds, trace_.get_count(),
+                                     tracing_ ? trace_.hash_string() : std::string("off"));
+            finished_.store(true);
+            if (on_finished_) {
+                on_finished_();
+            }
+            break;
         }
     }
     
     Logger::instance().info("Tick loop stopped", "EventLoop");
 }
 
-void EventLoop::heartbeat_worker(int worker_id) {
-    std::stringstream ss;
-    ss << "Heartbeat worker " << worker_id << " started";
-    Logger::instance().info(ss.str(), "EventLoop");
+bool EventLoop::wait_for_next_tick(uint64_t& tick) {
+    tick = tick_count_.load() + 1;
+    // The virtual clock doesn't wait
+    if (mode_ == SimulationMode::DISCRETE) {
+        return true;
+    }
     
-    int num_ports = port_manager_->get_num_ports();
+    // Sleep to an absolute deadline, so time spent in ticks never adds up
+    // to drift
+    if (stop_token_.wait_until(next_deadline_)) {
+        return false;
+    }
+    SteadyClock::time_point now = SteadyClock::now();
+    std::chrono::milliseconds interval(config_.tick_ms);
+    std::chrono::nanoseconds lag = now - next_deadline_;
     
-    while (running_.load()) {
-        // Process heartbeats for assigned ports (simple round-robin)
-        for (int port_id = worker_id; port_id < num_ports; port_id += 2) {
-            if (!running_.load()) break;
-            
-            PortState state = port_manager_->get_port_state(port_id);
-            
-            // State machine progression logic
-            switch (state) {
+    // Later deadlines that have passed too: ticks that can't run in their slot
+    uint64_t overdue = static_cast<uint64_t>(lag / interval);
+    if (overdue > 0 && catch_up_skip_) {
+        if (config_.duration_ticks > 0) {
+            overdue = std::min(overdue, config_.duration_ticks - std::min(tick, config_.duration_ticks));
+        }
+        tick += overdue;
+        next_deadline_ += overdue * interval;
+    }
+    next_deadline_ += interval;
+    
+    Metrics& metrics = port_manager_->get_metrics();
+    if (overdue > 0) {
+        // Skipped, or run back to back in a burst
+        metrics.increment(ticks_missed_metric_, catch_up_skip_ ? overdue : 1);
+    }
+    if (last_tick_start_ != SteadyClock::time_point()) {
+        std::chrono::nanoseconds period = now - last_tick_start_;
+        std::chrono::nanoseconds jitter = period > interval ? period - interval : interval - period;
+        metrics.observe(tick_jitter_metric_, static_cast<uint64_t>(jitter.count()));
+    }
+    last_tick_start_ = now;
+    record_tick_lag(now, lag);
+    return true;
+}
+
+void EventLoop::record_tick_lag(SteadyClock::time_point now, std::chrono::nanoseconds lag) {
+    port_manager_->get_metrics().observe(tick_lag_metric_, static_cast<uint64_t>(lag.count()));
+    tick_lag_ns_.store(lag.count());
+    
+    if (config_.tick_lag_threshold_ms == 0 || lag < std::chrono::milliseconds(config_.tick_lag_threshold_ms)) {
+        lagging_since_ = SteadyClock::time_point();
+        if (lagging_.exchange(false)) {
+            Logger::instance().info("Tick loop caught up with the wall clock", "EventLoop");
+        }
+        return;
+    }
+    if (lagging_since_ == SteadyClock::time_point()) {
+        lagging_since_ = now;
+    }
+    if (now - lagging_since_ >= std::chrono::milliseconds(config_.tick_lag_sustain_ms) &&
+        !lagging_.exchange(true)) {
+        Logger::instance().warnf("EventLoop", -1, "Tick loop is lagging: {} ms behind for over {} ms",
+                                 std::chrono::duration_cast<std::chrono::milliseconds>(lag).count(),
+                                 config_.tick_lag_sustain_ms);
+    }
+}
+
+void EventLoop::on_port_timer(WorkerBuffers& buffers, int port_id, PortTimer timer, uint64_t now) {
+    auto& events = buffers.events;
+    auto& updates = buffers.timer_updates;
+    uint32_t port = static_cast<uint32_t>(port_id);
+    
+    switch (timer) {
+        case PortTimer::HEARTBEAT:
+            switch (port_manager_->get_port_state(port_id)) {
                 case PortState::DOWN:
-                    // Power on the port
-                    port_manager_->process_port_event(port_id, PortEvent::POWER_ON);
+                    // Power on the port and schedule initialization completion
+                    events.push_back({port_id, PortEvent::POWER_ON});
+                    updates.push_back({port, now + init_latency_ticks(port, now), PortTimer::INIT_COMPLETE});
                     break;
                     
                 case PortState::INIT:
-                    // Wait a bit then complete init (simulate initialization time)
-                    std::this_thread::sleep_for(std::chrono::milliseconds(config_.tick_ms * 2));
-                    if (running_.load()) {
-                        port_manager_->process_port_event(port_id, PortEvent::INIT_COMPLETE);
-                    }
+                    // Initialization still in flight
+                    updates.push_back({port, now + init_latency_ticks(port, now), PortTimer::INIT_COMPLETE});
                     break;
                     
                 case PortState::UP:
                     // Send periodic heartbeat
-                    port_manager_->process_port_event(port_id, PortEvent::HEARTBEAT_OK);
+                    events.push_back({port_id, PortEvent::HEARTBEAT_OK});
+                    updates.push_back({port, now + kHeartbeatTicks, PortTimer::HEARTBEAT});
                     break;
             }
-        }
-        
-        // Sleep between heartbeat cycles
-        std::this_thread::sleep_for(std::chrono::milliseconds(config_.tick_ms * 5));
+            break;
+            
+        case PortTimer::INIT_COMPLETE:
+            events.push_back({port_id, PortEvent::INIT_COMPLETE});
+            updates.push_back({port, now + kHeartbeatTicks, PortTimer::HEARTBEAT});
+            break;
+            
+        case PortTimer::FLAP_RECOVERY:
+            // Flap is over: bring the link back up
+            events.push_back({port_id, PortEvent::POWER_ON});
+            updates.push_back({port, now + init_latency_ticks(port, now), PortTimer::INIT_COMPLETE});
+            break;
+    }
+}
+
+void EventLoop::flush_events(WorkerBuffers& buffers) {
+    if (buffers.events.empty()) {
+        return;
     }
     
-    ss.str("");
-    ss << "Heartbeat worker " << worker_id << " stopped";
-    Logger::instance().info(ss.str(), "EventLoop");
+    port_manager_->process_port_events(buffers.events.data(), buffers.events.size());
+    if (tracing_) {
+        buffers.traced.insert(buffers.traced.end(), buffers.events.begin(), buffers.events.end());
+    }
+    buffers.events.clear();
 }
 
-void EventLoop::flap_injector_worker(int worker_id) {
-    std::stringstream ss;
-    ss << "Flap injector worker " << worker_id << " started";
-    Logger::instance().info(ss.str(), "EventLoop");
+void EventLoop::flap_injector_cycle(uint64_t tick) {
+    // Only the sampled ports are visited, so a cycle costs O(flaps) rather
+    // than a Bernoulli trial per port
+    flap_ports_.clear();
+    flap_sampler_->sample(static_cast<uint32_t>(port_manager_->get_num_ports()), tick, flap_ports_);
+    if (flap_ports_.empty()) {
+        return;
+    }
     
-    int num_ports = port_manager_->get_num_ports();
+    // The picks are in port order, so each shard is a contiguous run
+    int num_workers = executor_->get_num_workers();
+    batch_bounds_.assign(num_workers + 1, 0);
+    for (int w = 0; w <= num_workers; w++) {
+        batch_bounds_[w] = static_cast<uint32_t>(
+            std::lower_bound(flap_ports_.begin(), flap_ports_.end(), port_bounds_[w]) - flap_ports_.begin());
+    }
     
-    while (running_.load()) {
-        // Check each port for potential flap injection
-        for (int port_id = (worker_id - 2); port_id < num_ports; port_id += 2) {
-            if (!running_.load()) break;
-            
-            // Only inject flaps on UP ports
-            if (port_manager_->get_port_state(port_id) == PortState::UP) {
-                if (should_inject_flap()) {
-                    int flap_duration = generate_flap_duration_ms();
-                    
-                    std::stringstream log_ss;
-                    log_ss << "Injecting link flap on port " << port_id 
-                           << " for " << flap_duration << "ms";
-                    Logger::instance().info(log_ss.str(), "EventLoop", port_id);
-                    
-                    port_manager_->process_port_event(port_id, PortEvent::LINK_FLAP);
-                    port_manager_->get_metrics().increment_counter("link_flaps_injected_total");
-                    
-                    // Simulate flap duration
-                    std::this_thread::sleep_for(std::chrono::milliseconds(flap_duration));
+    executor_->run(batch_bounds_, kTimerChunkSize,
+        [this, tick](int worker_id, uint32_t begin, uint32_t end) {
+            WorkerBuffers& buffers = worker_buffers_[worker_id];
+            for (uint32_t i = begin; i < end; i++) {
+                uint32_t port_id = flap_ports_[i];
+                // Only inject flaps on UP ports
+                if (port_manager_->get_port_state(port_id) != PortState::UP) {
+                    continue;
                 }
+                
+                int flap_duration = generate_flap_duration_ms(rng_.draw(port_id, tick));
+                
+                Logger::instance().infof("EventLoop", static_cast<int>(port_id),
+                                         "Injecting link flap on port {} for {}ms",
+                                         port_id, flap_duration);
+                
+                buffers.events.push_back({static_cast<int32_t>(port_id), PortEvent::LINK_FLAP});
+                buffers.flaps_injected++;
+                
+                // Hold the port DOWN until the flap is over (replaces its heartbeat)
+                buffers.timer_updates.push_back(
+                    {port_id, tick + ms_to_ticks(flap_duration), PortTimer::FLAP_RECOVERY});
             }
+            flush_events(buffers);
+        });
+    apply_worker_output(tick);
+}
+
+void EventLoop::apply_worker_output(uint64_t tick) {
+    uint64_t flaps_injected = 0;
+    
+    if (tracing_) {
+        // Workers may have stolen each other's chunks; port order makes the
+        // trace independent of who ran what (a port has at most one event
+        // per phase, so the sort never reorders a port's events)
+        trace_batch_.clear();
+        for (auto& buffers : worker_buffers_) {
+            trace_batch_.insert(trace_batch_.end(), buffers.traced.begin(), buffers.traced.end());
+            buffers.traced.clear();
         }
-        
-        // Sleep between flap checks
-        std::this_thread::sleep_for(std::chrono::milliseconds(config_.tick_ms * 10));
+        std::stable_sort(trace_batch_.begin(), trace_batch_.end(),
+                         [](const PortEventRecord& a, const PortEventRecord& b) {
+                             return a.port_id < b.port_id;
+                         });
+        trace_.append(tick, trace_batch_.data(), trace_batch_.size());
     }
     
-    ss.str("");
-    ss << "Flap injector worker " << worker_id << " stopped";
-    Logger::instance().info(ss.str(), "EventLoop");
+    for (auto& buffers : worker_buffers_) {
+        for (const auto& update : buffers.timer_updates) {
+            wheel_->schedule(update.port_id, update.deadline, static_cast<uint8_t>(update.timer));
+        }
+        buffers.timer_updates.clear();
+        flaps_injected += buffers.flaps_injected;
+        buffers.flaps_injected = 0;
+    }
+    
+    if (flaps_injected > 0) {
+        port_manager_->get_metrics().increment(flaps_injected_metric_, flaps_injected);
+    }
 }
 
-bool EventLoop::should_inject_flap() {
-    std::lock_guard<std::mutex> lock(rng_mutex_);
-    std::uniform_real_distribution<double> dist(0.0, 1.0);
-    return dist(rng_) < config_.flap_probability;
+void EventLoop::publish_worker_metrics() {
+    Metrics& metrics = port_manager_->get_metrics();
+    
+    for (int w = 0; w < executor_->get_num_workers(); w++) {
+        uint64_t items = executor_->get_items_processed(w);
+        uint64_t steals = executor_->get_steals(w);
+        if (items == published_items_[w] && steals == published_steals_[w]) {
+            continue;
+        }
+        
+        metrics.increment(worker_items_metrics_[w], items - published_items_[w]);
+        metrics.increment(worker_steals_metrics_[w], steals - published_steals_[w]);
+        published_items_[w] = items;
+        published_steals_[w] = steals;
+    }
+}
+
+int EventLoop::shard_of(uint32_t port_id) const {
+    int num_workers = static_cast<int>(port_bounds_.size()) - 1;
+    int num_ports = port_manager_->get_num_ports();
+    return static_cast<int>(static_cast<uint64_t>(port_id) * num_workers / num_ports);
+}
+
+int EventLoop::generate_flap_duration_ms(const CounterRng::Block& draw) const {
+    uint32_t range = static_cast<uint32_t>(config_.flap_max_ms - config_.flap_min_ms) + 1;
+    return config_.flap_min_ms + static_cast<int>(CounterRng::to_range(draw[2], draw[3], range));
+}
+
+uint64_t EventLoop::init_latency_ticks(uint32_t port_id, uint64_t tick) const {
+    int min_ms = config_.init_latency_min_ms;
+    int span_ms = config_.init_latency_max_ms - min_ms;
+    if (span_ms <= 0) {
+        return ms_to_ticks(min_ms);
+    }
+    
+    CounterRng::Block draw = rng_.draw(port_id, tick, kInitLatencyStream);
+    if (!init_latency_exponential_) {
+        return ms_to_ticks(min_ms + static_cast<int>(
+            CounterRng::to_range(draw[0], draw[1], static_cast<uint32_t>(span_ms) + 1)));
+    }
+    
+    // Exponential tail with mean span / 2, truncated at the span: inverse of
+    // its CDF, (1 - e^(-x / mean)) / (1 - e^(-span / mean))
+    double mean = span_ms / 2.0;
+    double u = CounterRng::to_unit(draw[0], draw[1]);
+    double tail = -mean * std::log1p(-u * (1.0 - std::exp(-span_ms / mean)));
+    return ms_to_ticks(min_ms + std::min(span_ms, static_cast<int>(tail)));
 }
 
-int EventLoop::generate_flap_duration_ms() {
-    std::lock_guard<std::mutex> lock(rng_mutex_);
-    std::uniform_int_distribution<int> dist(config_.flap_min_ms, config_.flap_max_ms);
-    return dist(rng_);
+uint64_t EventLoop::ms_to_ticks(int ms) const {
+    uint64_t ticks = (static_cast<uint64_t>(ms) + config_.tick_ms - 1) / config_.tick_ms;
+    return ticks > 0 ? ticks : 1;
 }
 
 } // namespace control_plane
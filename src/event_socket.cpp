@@ -0,0 +1,285 @@
+#include "event_socket.h"
+#include "logger.h"
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+namespace control_plane {
+
+namespace {
+
+// Records before the first PortEventRecord of a batch in the receive buffer
+constexpr size_t kHeaderSlots = sizeof(EventBatchHeader) / sizeof(PortEventRecord);
+constexpr size_t kBufferBytes = sizeof(EventBatchHeader) + kMaxEventBatchRecords * sizeof(PortEventRecord);
+
+// Batches served per connection per wakeup, so one busy client can't starve
+// the others
+constexpr int kMaxBatchesPerWakeup = 64;
+
+static_assert(sizeof(EventBatchHeader) % sizeof(PortEventRecord) == 0,
+              "Records must start aligned after the header");
+
+} // namespace
+
+struct EventSocketServer::Connection {
+    int fd;
+    std::vector<EventBatchAck> pending; // Acks the socket had no room for
+};
+
+EventSocketServer::EventSocketServer(std::shared_ptr<PortManager> port_manager, std::string path)
+    : port_manager_(std::move(port_manager)),
+      path_(std::move(path)),
+      running_(false),
+      listen_fd_(-1),
+      epoll_fd_(-1),
+      wake_fd_(-1),
+      buffer_(new PortEventRecord[kHeaderSlots + kMaxEventBatchRecords]) {
+    Metrics& metrics = port_manager_->get_metrics();
+    events_injected_metric_ = metrics.register_counter("events_injected_total");
+    batches_metric_ = metrics.register_counter("event_socket_batches_total");
+}
+
+EventSocketServer::~EventSocketServer() {
+    stop();
+}
+
+bool EventSocketServer::start() {
+    if (running_.load()) {
+        Logger::instance().warn("EventSocketServer already running", "EventSocketServer");
+        return true;
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path_.empty() || path_.size() >= sizeof(address.sun_path)) {
+        Logger::instance().errorf("EventSocketServer", -1, "Invalid event socket path: {}", path_);
+        return false;
+    }
+    std::memcpy(address.sun_path, path_.c_str(), path_.size() + 1);
+
+    listen_fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    unlink(path_.c_str()); // A stale socket from an earlier run
+    bool ok = listen_fd_ >= 0 && epoll_fd_ >= 0 && wake_fd_ >= 0 &&
+              bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 &&
+              listen(listen_fd_, SOMAXCONN) == 0;
+    if (ok) {
+        epoll_event listen_event{};
+        listen_event.events = EPOLLIN;
+        listen_event.data.fd = listen_fd_;
+        epoll_event wake_event{};
+        wake_event.events = EPOLLIN;
+        wake_event.data.fd = wake_fd_;
+        ok = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &listen_event) == 0 &&
+             epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &wake_event) == 0;
+    }
+    if (!ok) {
+        Logger::instance().errorf("EventSocketServer", -1, "Failed to listen on {}: {}", path_,
+                                  std::strerror(errno));
+        for (int* fd : {&listen_fd_, &epoll_fd_, &wake_fd_}) {
+            if (*fd >= 0) {
+                close(*fd);
+                *fd = -1;
+            }
+        }
+        return false;
+    }
+
+    running_.store(true);
+    thread_ = std::thread([this]() { run(); });
+    Logger::instance().infof("EventSocketServer", -1, "Event socket listening on {}", path_);
+    return true;
+}
+
+void EventSocketServer::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd_, &one, sizeof(one));
+    (void)written; // The counter can't overflow here; the thread wakes either way
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    for (auto& [fd, connection] : connections_) {
+        close(fd);
+    }
+    connections_.clear();
+    close(listen_fd_);
+    close(epoll_fd_);
+    close(wake_fd_);
+    listen_fd_ = epoll_fd_ = wake_fd_ = -1;
+    unlink(path_.c_str());
+    Logger::instance().info("Event socket stopped", "EventSocketServer");
+}
+
+void EventSocketServer::run() {
+    epoll_event events[64];
+    while (running_.load(std::memory_order_relaxed)) {
+        int ready = epoll_wait(epoll_fd_, events, 64, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            Logger::instance().errorf("EventSocketServer", -1, "epoll_wait failed: {}",
+                                      std::strerror(errno));
+            break;
+        }
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+            if (fd == wake_fd_) {
+                return; // stop()
+            }
+            if (fd == listen_fd_) {
+                accept_clients();
+                continue;
+            }
+            auto it = connections_.find(fd);
+            if (it == connections_.end()) {
+                continue;
+            }
+            Connection& connection = *it->second;
+            bool keep = true;
+            if (events[i].events & EPOLLOUT) {
+                keep = flush_acks(connection);
+            }
+            if (keep && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+                keep = serve(connection);
+            }
+            if (!keep) {
+                close_connection(fd);
+            }
+        }
+    }
+}
+
+void EventSocketServer::accept_clients() {
+    while (true) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                Logger::instance().errorf("EventSocketServer", -1, "accept failed: {}",
+                                          std::strerror(errno));
+            }
+            return;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            continue;
+        }
+        connections_[fd] = std::make_unique<Connection>(Connection{fd, {}});
+    }
+}
+
+bool EventSocketServer::serve(Connection& connection) {
+    for (int batch = 0; batch < kMaxBatchesPerWakeup; batch++) {
+        // MSG_TRUNC reports the full length of an oversized batch
+        ssize_t length = recv(connection.fd, buffer_.get(), kBufferBytes, MSG_DONTWAIT | MSG_TRUNC);
+        if (length == 0) {
+            return false; // Peer closed
+        }
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        EventBatchAck ack = apply_batch(static_cast<size_t>(length));
+        if (connection.pending.empty() &&
+            send(connection.fd, &ack, sizeof(ack), MSG_DONTWAIT | MSG_NOSIGNAL) == sizeof(ack)) {
+            continue;
+        }
+        if (connection.pending.empty() && errno != EAGAIN && errno != EWOULDBLOCK) {
+            return false;
+        }
+        // The client isn't reading its acks: stop reading its batches until
+        // they have gone out
+        connection.pending.push_back(ack);
+        epoll_event event{};
+        event.events = EPOLLOUT;
+        event.data.fd = connection.fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection.fd, &event);
+        return true;
+    }
+    return true;
+}
+
+bool EventSocketServer::flush_acks(Connection& connection) {
+    size_t sent = 0;
+    while (sent < connection.pending.size()) {
+        if (send(connection.fd, &connection.pending[sent], sizeof(EventBatchAck),
+                 MSG_DONTWAIT | MSG_NOSIGNAL) != sizeof(EventBatchAck)) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                return false;
+            }
+            break;
+        }
+        sent++;
+    }
+    connection.pending.erase(connection.pending.begin(), connection.pending.begin() + sent);
+    if (connection.pending.empty()) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = connection.fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection.fd, &event);
+    }
+    return true;
+}
+
+EventBatchAck EventSocketServer::apply_batch(size_t length) {
+    EventBatchAck ack{kEventAckMagic, 0, EventBatchStatus::OK, 0, 0, 0};
+    EventBatchHeader header{};
+    if (length >= sizeof(header)) {
+        std::memcpy(&header, buffer_.get(), sizeof(header));
+        ack.sequence = header.sequence;
+    }
+    if (length < sizeof(header) || length > kBufferBytes || header.magic != kEventBatchMagic ||
+        header.count > kMaxEventBatchRecords ||
+        length != sizeof(header) + header.count * sizeof(PortEventRecord)) {
+        ack.status = EventBatchStatus::MALFORMED;
+        return ack;
+    }
+
+    // Drop event values the state machine has no entry for, compacting in
+    // place (a no-op pass for well-formed batches)
+    PortEventRecord* records = buffer_.get() + kHeaderSlots;
+    size_t valid = 0;
+    for (size_t i = 0; i < header.count; i++) {
+        if (static_cast<uint8_t>(records[i].event) < kNumPortEvents) {
+            if (valid != i) {
+                records[valid] = records[i];
+            }
+            valid++;
+        }
+    }
+
+    PortEventBatchSummary summary = port_manager_->process_port_events(records, valid);
+    ack.applied = static_cast<uint32_t>(summary.applied);
+    ack.rejected = static_cast<uint32_t>(summary.rejected + (header.count - valid));
+    ack.transitions = static_cast<uint32_t>(summary.transitions);
+
+    Metrics& metrics = port_manager_->get_metrics();
+    metrics.increment(events_injected_metric_, summary.applied);
+    metrics.increment(batches_metric_);
+    return ack;
+}
+
+void EventSocketServer::close_connection(int fd) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections_.erase(fd);
+}
+
+} // namespace control_plane
@@ -0,0 +1,86 @@
+#include "event_socket_client.h"
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace control_plane {
+
+bool EventSocketClient::connect(const std::string& path) {
+    close();
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        return false;
+    }
+    if (::connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        int error = errno;
+        close();
+        errno = error;
+        return false;
+    }
+    return true;
+}
+
+void EventSocketClient::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool EventSocketClient::send_batch(const PortEventRecord* records, size_t count,
+                                   uint32_t* sequence) {
+    if (fd_ < 0 || count > kMaxEventBatchRecords) {
+        errno = fd_ < 0 ? ENOTCONN : EMSGSIZE;
+        return false;
+    }
+    EventBatchHeader header{kEventBatchMagic, next_sequence_, static_cast<uint32_t>(count), 0};
+    iovec parts[2] = {
+        {&header, sizeof(header)},
+        {const_cast<PortEventRecord*>(records), count * sizeof(PortEventRecord)},
+    };
+    msghdr message{};
+    message.msg_iov = parts;
+    message.msg_iovlen = count > 0 ? 2 : 1;
+
+    ssize_t expected = static_cast<ssize_t>(sizeof(header) + count * sizeof(PortEventRecord));
+    ssize_t sent;
+    do {
+        sent = sendmsg(fd_, &message, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    if (sent != expected) {
+        return false;
+    }
+    if (sequence) {
+        *sequence = next_sequence_;
+    }
+    next_sequence_++;
+    return true;
+}
+
+bool EventSocketClient::read_ack(EventBatchAck& ack) {
+    if (fd_ < 0) {
+        errno = ENOTCONN;
+        return false;
+    }
+    ssize_t received;
+    do {
+        received = recv(fd_, &ack, sizeof(ack), 0);
+    } while (received < 0 && errno == EINTR);
+    if (received == 0) {
+        errno = ECONNRESET;
+    }
+    return received == sizeof(ack) && ack.magic == kEventAckMagic;
+}
+
+} // namespace control_plane
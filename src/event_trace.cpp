@@ -0,0 +1,61 @@
+#include "event_trace.h"
+#include "logger.h"
+#include <cerrno>
+#include <cinttypes>
+#include <cstring>
+
+namespace control_plane {
+
+namespace {
+
+uint64_t mix(uint64_t h, uint64_t value) {
+    h = (h ^ value) * 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 31);
+}
+
+} // namespace
+
+EventTrace::~EventTrace() {
+    close();
+}
+
+bool EventTrace::open(const std::string& path) {
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        Logger::instance().errorf("EventTrace", -1, "Cannot create trace file {}: {}", path,
+                                  std::strerror(errno));
+        return false;
+    }
+    // Traces of long discrete runs are large; write them in big blocks
+    std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+    return true;
+}
+
+void EventTrace::close() {
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+void EventTrace::append(uint64_t tick, const PortEventRecord* records, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        hash_ = mix(hash_, tick);
+        hash_ = mix(hash_, (static_cast<uint64_t>(static_cast<uint32_t>(records[i].port_id)) << 8) |
+                           static_cast<uint64_t>(records[i].event));
+        if (file_) {
+            TraceRecord record{tick, records[i].port_id, records[i].event, {0, 0, 0}};
+            std::fwrite(&record, sizeof(record), 1, file_);
+        }
+    }
+    count_ += count;
+}
+
+std::string EventTrace::hash_string() const {
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016" PRIx64, hash_);
+    return text;
+}
+
+} // namespace control_plane
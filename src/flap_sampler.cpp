@@ -0,0 +1,50 @@
+#include "flap_sampler.h"
+#include <cmath>
+
+namespace control_plane {
+
+FlapSampler::FlapSampler(const CounterRng& rng, double probability)
+    : rng_(rng),
+      probability_(probability),
+      inverse_log_q_(probability > 0.0 && probability < 1.0 ? 1.0 / std::log1p(-probability) : 0.0) {
+}
+
+uint32_t FlapSampler::gap(double u) const {
+    if (probability_ >= 1.0) {
+        return 0;
+    }
+    if (probability_ <= 0.0) {
+        return UINT32_MAX;
+    }
+    // 1 - u is in (0, 1], so the log is finite and <= 0
+    double skip = std::floor(std::log1p(-u) * inverse_log_q_);
+    return skip < static_cast<double>(UINT32_MAX) ? static_cast<uint32_t>(skip) : UINT32_MAX;
+}
+
+void FlapSampler::sample(uint32_t num_ports, uint64_t tick, std::vector<uint32_t>& ports) const {
+    if (probability_ <= 0.0) {
+        return;
+    }
+    if (probability_ >= 1.0) {
+        for (uint32_t port = 0; port < num_ports; port++) {
+            ports.push_back(port);
+        }
+        return;
+    }
+
+    // Each block holds two 64-bit uniforms, i.e. two gaps
+    uint64_t position = 0;
+    for (uint32_t block_index = 0;; block_index++) {
+        CounterRng::Block draw = rng_.draw(block_index, tick, kGapStream);
+        for (int half = 0; half < 2; half++) {
+            position += gap(CounterRng::to_unit(draw[2 * half], draw[2 * half + 1]));
+            if (position >= num_ports) {
+                return;
+            }
+            ports.push_back(static_cast<uint32_t>(position));
+            position++;
+        }
+    }
+}
+
+} // namespace control_plane
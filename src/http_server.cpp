@@ -1,15 +1,82 @@
 #include "http_server.h"
+#include "event_ingest.h"
 #include "logger.h"
+#include "port_status_writer.h"
 #include "httplib.h"
+#include <algorithm>
+#include <charconv>
 #include <sstream>
 
 namespace control_plane {
 
+namespace {
+
+constexpr int kDefaultPortsPageSize = 100;
+constexpr int kMaxPortsPageSize = 10000;
+constexpr size_t kMaxRequestBodyBytes = 64 * 1024 * 1024; // ~1.6M binary events
+
+// Read a non-negative integer query parameter into `value` (left unchanged
+// if absent); false if it is present but malformed
+bool read_int_param(const httplib::Request& req, const char* name, int& value) {
+    if (!req.has_param(name)) {
+        return true;
+    }
+    const std::string text = req.get_param_value(name);
+    int parsed = 0;
+    std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), parsed);
+    if (result.ec != std::errc() || result.ptr != text.data() + text.size() || parsed < 0) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+// Parse the optional `state` filter; false if it names no state
+bool read_state_param(const httplib::Request& req, std::optional<PortState>& state) {
+    if (!req.has_param("state")) {
+        return true;
+    }
+    PortState parsed;
+    if (!parse_port_state(req.get_param_value("state"), parsed)) {
+        return false;
+    }
+    state = parsed;
+    return true;
+}
+
+// Stream a PortStatusWriter's chunks as a chunked response. The provider
+// keeps the port manager alive for as long as the response is being sent.
+void stream_port_status(httplib::Response& res, std::shared_ptr<PortManager> port_manager,
+                        const PortStatusQuery& query, PortStatusFormat format,
+                        const char* content_type) {
+    auto writer = std::make_shared<PortStatusWriter>(port_manager->get_port_table(), query, format);
+    res.set_chunked_content_provider(content_type,
+        [port_manager, writer](size_t, httplib::DataSink& sink) {
+            std::string_view chunk = writer->next_chunk();
+            if (chunk.empty()) {
+                sink.done();
+                return true;
+            }
+            return sink.write(chunk.data(), chunk.size());
+        });
+}
+
+void bad_request(httplib::Response& res, const char* message) {
+    res.status = 400;
+    res.set_content(std::string("{\"error\":\"") + message + "\"}", "application/json");
+}
+
+} // namespace
+
 HttpServer::HttpServer(std::shared_ptr<PortManager> port_manager, int port)
     : port_manager_(port_manager),
       port_(port),
       running_(false),
       server_impl_(nullptr) {
+    metrics_render_metric_ =
+        port_manager_->get_metrics().register_histogram("metrics_render_seconds");
+    events_injected_metric_ =
+        port_manager_->get_metrics().register_counter("events_injected_total");
 }
 
 HttpServer::~HttpServer() {
@@ -27,34 +94,150 @@ void HttpServer::start() {
     server_thread_ = std::thread([this]() {
         auto* svr = new httplib::Server();
         server_impl_ = svr;
+        svr->set_payload_max_length(kMaxRequestBodyBytes);
         
-        // Health endpoint
-        svr->Get("/health", [](const httplib::Request&, httplib::Response& res) {
+        // Readiness: unready while the health check fails
+        svr->Get("/health", [this](const httplib::Request&, httplib::Response& res) {
+            std::string reason;
+            if (health_check_ && !health_check_(reason)) {
+                res.status = 503;
+                res.set_content("{\"status\":\"unready\",\"reason\":\"" + reason + "\"}",
+                                "application/json");
+                return;
+            }
+            res.set_content("{\"status\":\"ok\"}", "application/json");
+        });
+        
+        // Liveness: the process is up and serving
+        svr->Get("/health/live", [](const httplib::Request&, httplib::Response& res) {
             res.set_content("{\"status\":\"ok\"}", "application/json");
         });
         
         // Metrics endpoint
         svr->Get("/metrics", [this](const httplib::Request&, httplib::Response& res) {
-            std::string metrics = port_manager_->get_metrics().export_prometheus();
-            res.set_content(metrics, "text/plain; version=0.0.4");
+            // Render time shows up in the next render
+            Metrics& registry = port_manager_->get_metrics();
+            uint64_t start = latency_clock_ns();
+            std::shared_ptr<const std::string> metrics = registry.exposition();
+            registry.observe(metrics_render_metric_, latency_clock_ns() - start);
+            res.set_content(*metrics, "text/plain; version=0.0.4");
         });
         
         // Status endpoint (additional)
         svr->Get("/status", [this](const httplib::Request&, httplib::Response& res) {
+            PortPopulation::Counts counts = port_manager_->get_population().snapshot();
             std::ostringstream json;
             json << "{\n";
             json << "  \"total_ports\": " << port_manager_->get_num_ports() << ",\n";
             json << "  \"total_events\": " << port_manager_->get_total_events_processed() << ",\n";
-            json << "  \"ports_down\": " << port_manager_->get_metrics().get_gauge("ports_down") << ",\n";
-            json << "  \"ports_init\": " << port_manager_->get_metrics().get_gauge("ports_init") << ",\n";
-            json << "  \"ports_up\": " << port_manager_->get_metrics().get_gauge("ports_up") << "\n";
+            json << "  \"ports_down\": " << counts.down << ",\n";
+            json << "  \"ports_init\": " << counts.init << ",\n";
+            json << "  \"ports_up\": " << counts.up << "\n";
             json << "}";
             res.set_content(json.str(), "application/json");
         });
         
-        std::stringstream ss;
-        ss << "HTTP server listening on port " << port_;
-        Logger::instance().info(ss.str(), "HttpServer");
+        // Per-port status, a page at a time:
+        // /ports?offset=<first port id>&limit=<n>&state=<DOWN|INIT|UP>
+        svr->Get("/ports", [this](const httplib::Request& req, httplib::Response& res) {
+            PortStatusQuery query;
+            query.limit = kDefaultPortsPageSize;
+            if (!read_int_param(req, "offset", query.offset) ||
+                !read_int_param(req, "limit", query.limit)) {
+                bad_request(res, "offset and limit must be non-negative integers");
+                return;
+            }
+            if (!read_state_param(req, query.state)) {
+                bad_request(res, "state must be one of DOWN, INIT, UP");
+                return;
+            }
+            query.limit = std::min(query.limit, kMaxPortsPageSize);
+            stream_port_status(res, port_manager_, query, PortStatusFormat::PAGE,
+                               "application/json");
+        });
+        
+        // Every port (optionally filtered by state), one JSON object per line
+        svr->Get("/ports/stream", [this](const httplib::Request& req, httplib::Response& res) {
+            PortStatusQuery query;
+            if (!read_state_param(req, query.state)) {
+                bad_request(res, "state must be one of DOWN, INIT, UP");
+                return;
+            }
+            stream_port_status(res, port_manager_, query, PortStatusFormat::NDJSON,
+                               "application/x-ndjson");
+        });
+        
+        // Bulk event injection: NDJSON or packed binary records, parsed in
+        // place and applied in batches
+        svr->Post("/events", [this](const httplib::Request& req, httplib::Response& res) {
+            EventIngestFormat format;
+            if (!parse_event_ingest_format(req.get_header_value("Content-Type"), format)) {
+                res.status = 415;
+                res.set_content("{\"error\":\"Content-Type must be application/x-ndjson or "
+                                "application/octet-stream\"}", "application/json");
+                return;
+            }
+            EventIngestSummary summary = ingest_events(*port_manager_, req.body, format);
+            port_manager_->get_metrics().increment(events_injected_metric_, summary.applied);
+            
+            std::ostringstream json;
+            json << "{\"received\":" << summary.applied + summary.rejected
+                 << ",\"applied\":" << summary.applied
+                 << ",\"rejected\":" << summary.rejected
+                 << ",\"malformed\":" << summary.malformed
+                 << ",\"transitions\":" << summary.transitions << "}";
+            res.set_content(json.str(), "application/json");
+        });
+        
+        // One event applied to a span of ports with the bulk kernel:
+        // /events/range?first_port=<id>&count=<n>&event=<name or number>
+        svr->Post("/events/range", [this](const httplib::Request& req, httplib::Response& res) {
+            int num_ports = port_manager_->get_num_ports();
+            int first_port = 0;
+            if (!read_int_param(req, "first_port", first_port)) {
+                bad_request(res, "first_port must be a non-negative integer");
+                return;
+            }
+            int count = num_ports - std::min(first_port, num_ports); // Default: through the last port
+            if (!read_int_param(req, "count", count)) {
+                bad_request(res, "count must be a non-negative integer");
+                return;
+            }
+            PortEvent event;
+            if (!req.has_param("event") || !parse_port_event(req.get_param_value("event"), event)) {
+                bad_request(res, "event must name a port event");
+                return;
+            }
+            if (first_port > num_ports || count > num_ports - first_port) {
+                bad_request(res, "port range out of bounds");
+                return;
+            }
+            PortEventBatchSummary summary = port_manager_->process_port_event_range(first_port, count, event);
+            port_manager_->get_metrics().increment(events_injected_metric_, summary.applied);
+            
+            std::ostringstream json;
+            json << "{\"applied\":" << summary.applied
+                 << ",\"transitions\":" << summary.transitions << "}";
+            res.set_content(json.str(), "application/json");
+        });
+        
+        // Write a snapshot of the port table (see snapshot_path)
+        svr->Post("/snapshot", [this](const httplib::Request&, httplib::Response& res) {
+            if (snapshot_path_.empty()) {
+                res.status = 404;
+                res.set_content("{\"error\":\"snapshot_path is not configured\"}", "application/json");
+                return;
+            }
+            if (!port_manager_->save_snapshot(snapshot_path_)) {
+                res.status = 500;
+                res.set_content("{\"error\":\"snapshot failed\"}", "application/json");
+                return;
+            }
+            res.set_content("{\"ports\":" + std::to_string(port_manager_->get_num_ports()) + "}",
+                            "application/json");
+        });
+        
+        Logger::instance().infof("HttpServer", -1, "HTTP server listening on port {}", port_);
         
         // This blocks until stop() is called
         svr->listen("0.0.0.0", port_);
@@ -0,0 +1,253 @@
+#include "log_decoder.h"
+#include "logger.h"
+#include "port_state_machine.h"
+#include <cstring>
+
+namespace control_plane {
+
+namespace {
+
+// Reads fixed-size values and varints from a byte range, tracking whether
+// the range ran out
+class ByteReader {
+public:
+    explicit ByteReader(std::string_view data) : data_(data), pos_(0), short_(false) {}
+
+    size_t position() const { return pos_; }
+    bool ran_short() const { return short_; }
+    bool at_end() const { return pos_ >= data_.size(); }
+
+    template <typename T>
+    T read() {
+        T value{};
+        if (data_.size() - pos_ < sizeof(T)) {
+            short_ = true;
+            pos_ = data_.size();
+            return value;
+        }
+        std::memcpy(&value, data_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    uint64_t read_varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos_ >= data_.size()) {
+                short_ = true;
+                return 0;
+            }
+            uint8_t byte = static_cast<uint8_t>(data_[pos_++]);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        return value;
+    }
+
+    std::string_view read_bytes(uint64_t size) {
+        if (data_.size() - pos_ < size) {
+            short_ = true;
+            pos_ = data_.size();
+            return {};
+        }
+        std::string_view bytes = data_.substr(pos_, size);
+        pos_ += size;
+        return bytes;
+    }
+
+private:
+    std::string_view data_;
+    size_t pos_;
+    bool short_;
+};
+
+// Name of a LogEnum value, or its number for kinds this build doesn't know
+void append_enum(LogLineBuffer& out, uint8_t kind, uint8_t value) {
+    if (kind == LogEnum<PortState>::kKind && value < kNumPortStates) {
+        out.append(port_state_name(static_cast<PortState>(value)));
+    } else if (kind == LogEnum<PortEvent>::kKind && value < kNumPortEvents) {
+        out.append(port_event_name(static_cast<PortEvent>(value)));
+    } else {
+        out.append_number(value);
+    }
+}
+
+LogLineBuffer& message_buffer() {
+    static thread_local LogLineBuffer buffer;
+    return buffer;
+}
+
+} // namespace
+
+BinaryLogDecoder::BinaryLogDecoder()
+    : stream_started_(false),
+      templates_{"{}"},
+      components_{""},
+      records_(0) {
+}
+
+bool BinaryLogDecoder::feed(const char* data, size_t size, std::string& out) {
+    if (!error_.empty()) {
+        return false;
+    }
+    pending_.append(data, size);
+
+    size_t offset = 0;
+    while (offset < pending_.size()) {
+        size_t consumed = decode_frame(std::string_view(pending_).substr(offset), out);
+        if (!error_.empty()) {
+            return false;
+        }
+        if (consumed == 0) {
+            break;
+        }
+        offset += consumed;
+    }
+    pending_.erase(0, offset);
+    return true;
+}
+
+size_t BinaryLogDecoder::decode_frame(std::string_view input, std::string& out) {
+    // A stream header may start the input or follow any frame (the logger
+    // starts a new stream when its output is redirected)
+    if (static_cast<uint8_t>(input[0]) == static_cast<uint8_t>(kBinaryLogMagic[0])) {
+        if (input.size() < sizeof(kBinaryLogMagic)) {
+            return 0;
+        }
+        if (std::memcmp(input.data(), kBinaryLogMagic, sizeof(kBinaryLogMagic)) != 0) {
+            error_ = "bad stream header";
+            return 0;
+        }
+        stream_started_ = true;
+        templates_.assign(1, "{}");
+        components_.assign(1, "");
+        return sizeof(kBinaryLogMagic);
+    }
+    if (!stream_started_) {
+        error_ = "missing stream header";
+        return 0;
+    }
+
+    ByteReader reader(input);
+    BinaryLogFrame frame = static_cast<BinaryLogFrame>(reader.read<uint8_t>());
+    switch (frame) {
+        case BinaryLogFrame::TEMPLATE:
+        case BinaryLogFrame::COMPONENT: {
+            uint16_t id = reader.read<uint16_t>();
+            uint64_t size = reader.read_varint();
+            std::string_view text = reader.read_bytes(size);
+            if (reader.ran_short()) {
+                return 0;
+            }
+            std::vector<std::string>& table =
+                frame == BinaryLogFrame::TEMPLATE ? templates_ : components_;
+            if (id == 0) {
+                error_ = "definition of reserved id 0";
+                return 0;
+            }
+            if (id >= table.size()) {
+                table.resize(static_cast<size_t>(id) + 1);
+            }
+            table[id].assign(text.data(), text.size());
+            return reader.position();
+        }
+        case BinaryLogFrame::RECORD:
+            return decode_record(input, out);
+        default:
+            error_ = "unknown frame type " + std::to_string(static_cast<int>(frame));
+            return 0;
+    }
+}
+
+size_t BinaryLogDecoder::decode_record(std::string_view input, std::string& out) {
+    ByteReader reader(input);
+    reader.read<uint8_t>();
+    uint8_t level = reader.read<uint8_t>();
+    uint16_t component_id = reader.read<uint16_t>();
+    uint16_t template_id = reader.read<uint16_t>();
+    int64_t timestamp_ns = reader.read<int64_t>();
+    int32_t port_id = reader.read<int32_t>();
+    uint64_t payload_size = reader.read_varint();
+    std::string_view payload = reader.read_bytes(payload_size);
+    if (reader.ran_short()) {
+        return 0;
+    }
+
+    if (template_id >= templates_.size() || component_id >= components_.size()) {
+        error_ = "record uses an undefined template or component";
+        return 0;
+    }
+    if (level > static_cast<uint8_t>(LogLevel::ERROR)) {
+        error_ = "bad log level " + std::to_string(level);
+        return 0;
+    }
+    if (!format_message(templates_[template_id], payload)) {
+        return 0;
+    }
+
+    append_log_json_line(out, timestamp_ns, static_cast<LogLevel>(level), message_buffer().view(),
+                         components_[component_id], port_id);
+    records_++;
+    return reader.position();
+}
+
+bool BinaryLogDecoder::format_message(std::string_view fmt, std::string_view payload) {
+    LogLineBuffer& message = message_buffer();
+    message.clear();
+    ByteReader args(payload);
+
+    while (true) {
+        size_t pos = fmt.find("{}");
+        // Like format_log_message: the rest is copied through once the
+        // arguments run out
+        if (pos == std::string_view::npos || args.at_end()) {
+            message.append(fmt);
+            return true;
+        }
+        message.append(fmt.substr(0, pos));
+        fmt.remove_prefix(pos + 2);
+
+        BinaryLogArg type = static_cast<BinaryLogArg>(args.read<uint8_t>());
+        switch (type) {
+            case BinaryLogArg::INT: {
+                uint64_t zigzag = args.read_varint();
+                message.append_number(static_cast<int64_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1)));
+                break;
+            }
+            case BinaryLogArg::UINT:
+                message.append_number(args.read_varint());
+                break;
+            case BinaryLogArg::DOUBLE:
+                message.append_number(args.read<double>());
+                break;
+            case BinaryLogArg::FLOAT:
+                message.append_number(args.read<float>());
+                break;
+            case BinaryLogArg::STRING:
+                message.append(args.read_bytes(args.read_varint()));
+                break;
+            case BinaryLogArg::BOOL_FALSE:
+                message.append("false");
+                break;
+            case BinaryLogArg::BOOL_TRUE:
+                message.append("true");
+                break;
+            case BinaryLogArg::ENUM: {
+                uint8_t kind = args.read<uint8_t>();
+                append_enum(message, kind, args.read<uint8_t>());
+                break;
+            }
+            default:
+                error_ = "unknown argument type " + std::to_string(static_cast<int>(type));
+                return false;
+        }
+        if (args.ran_short()) {
+            error_ = "truncated record payload";
+            return false;
+        }
+    }
+}
+
+} // namespace control_plane
@@ -2,10 +2,17 @@
 #include <iomanip>
 #include <ctime>
 #include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <unistd.h>
 
 namespace control_plane {
 
 std::string log_level_to_string(LogLevel level) {
+    return std::string(log_level_name(level));
+}
+
+std::string_view log_level_name(LogLevel level) {
     switch (level) {
         case LogLevel::DEBUG: return "DEBUG";
         case LogLevel::INFO: return "INFO";
@@ -18,80 +25,496 @@ std::string log_level_to_string(LogLevel level) {
 LogLevel parse_log_level(const std::string& level_str) {
     std::string lower = level_str;
     std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-    
+
     if (lower == "debug") return LogLevel::DEBUG;
     if (lower == "info") return LogLevel::INFO;
     if (lower == "warn" || lower == "warning") return LogLevel::WARN;
     if (lower == "error") return LogLevel::ERROR;
-    
+
     return LogLevel::INFO; // default
 }
 
-void Logger::log(LogLevel level, const std::string& message, 
-                 const std::string& component, int port_id) {
-    if (level < min_level_) {
-        return;
+std::string log_overflow_policy_to_string(LogOverflowPolicy policy) {
+    switch (policy) {
+        case LogOverflowPolicy::BLOCK: return "block";
+        case LogOverflowPolicy::DROP: return "drop";
+        default: return "unknown";
     }
-    
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    // Build JSON log line
-    std::ostringstream json;
-    json << "{";
-    json << "\"timestamp\":\"" << get_timestamp() << "\",";
-    json << "\"level\":\"" << log_level_to_string(level) << "\",";
-    json << "\"message\":\"" << escape_json(message) << "\"";
-    
-    if (!component.empty()) {
-        json << ",\"component\":\"" << escape_json(component) << "\"";
+}
+
+bool parse_log_overflow_policy(const std::string& str, LogOverflowPolicy& policy) {
+    if (str == "block") {
+        policy = LogOverflowPolicy::BLOCK;
+        return true;
     }
-    
-    if (port_id >= 0) {
-        json << ",\"port_id\":" << port_id;
-    }
-    
-    json << "}\n";
-    
-    // Write to stdout
-    std::cout << json.str() << std::flush;
-}
-
-std::string Logger::get_timestamp() const {
-    auto now = std::chrono::system_clock::now();
-    auto time_t_now = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
-    
-    std::ostringstream oss;
-    oss << std::put_time(std::gmtime(&time_t_now), "%Y-%m-%dT%H:%M:%S");
-    oss << '.' << std::setfill('0') << std::setw(3) << ms.count() << 'Z';
-    
-    return oss.str();
-}
-
-std::string Logger::escape_json(const std::string& str) const {
-    std::ostringstream oss;
-    
+    if (str == "drop") {
+        policy = LogOverflowPolicy::DROP;
+        return true;
+    }
+    return false;
+}
+
+std::string log_output_format_to_string(LogOutputFormat format) {
+    switch (format) {
+        case LogOutputFormat::JSON: return "json";
+        case LogOutputFormat::BINARY: return "binary";
+        default: return "unknown";
+    }
+}
+
+bool parse_log_output_format(const std::string& str, LogOutputFormat& format) {
+    if (str == "json") {
+        format = LogOutputFormat::JSON;
+        return true;
+    }
+    if (str == "binary") {
+        format = LogOutputFormat::BINARY;
+        return true;
+    }
+    return false;
+}
+
+namespace {
+
+// Append an ISO8601 timestamp
+void append_timestamp(std::string& out, int64_t timestamp_ns) {
+    time_t seconds = static_cast<time_t>(timestamp_ns / 1000000000);
+    int ms = static_cast<int>((timestamp_ns / 1000000) % 1000);
+    struct tm utc;
+    gmtime_r(&seconds, &utc);
+
+    char buf[32];
+    int n = std::snprintf(buf, sizeof(buf), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                          utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday,
+                          utc.tm_hour, utc.tm_min, utc.tm_sec, ms);
+    out.append(buf, static_cast<size_t>(n));
+}
+
+// Append a JSON-escaped string
+void append_escaped(std::string& out, std::string_view str) {
     for (char c : str) {
         switch (c) {
-            case '"': oss << "\\\""; break;
-            case '\\': oss << "\\\\"; break;
-            case '\b': oss << "\\b"; break;
-            case '\f': oss << "\\f"; break;
-            case '\n': oss << "\\n"; break;
-            case '\r': oss << "\\r"; break;
-            case '\t': oss << "\\t"; break;
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
             default:
-                if (c < 0x20) {
-                    oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c;
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                    out += buf;
                 } else {
-                    oss << c;
+                    out += c;
                 }
                 break;
         }
     }
-    
-    return oss.str();
+}
+
+template <typename T>
+void append_raw(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void append_varint(std::string& out, uint64_t value) {
+    char buf[10];
+    out.append(buf, BinaryArgWriter::encode_varint(buf, value));
+}
+
+} // namespace
+
+void append_log_json_line(std::string& out, int64_t timestamp_ns, LogLevel level,
+                          std::string_view message, std::string_view component, int port_id) {
+    out += "{\"timestamp\":\"";
+    append_timestamp(out, timestamp_ns);
+    out += "\",\"level\":\"";
+    out += log_level_name(level);
+    out += "\",\"message\":\"";
+    append_escaped(out, message);
+    out += '"';
+
+    if (!component.empty()) {
+        out += ",\"component\":\"";
+        append_escaped(out, component);
+        out += '"';
+    }
+
+    if (port_id >= 0) {
+        out += ",\"port_id\":";
+        char digits[16];
+        std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), port_id);
+        out.append(digits, static_cast<size_t>(result.ptr - digits));
+    }
+
+    out += "}\n";
+}
+
+Logger::Logger()
+    : min_level_(LogLevel::INFO),
+      output_fd_(STDOUT_FILENO),
+      format_(LogOutputFormat::JSON),
+      stream_started_(false),
+      next_suppression_sweep_ns_(0),
+      async_active_(false),
+      overflow_policy_(LogOverflowPolicy::BLOCK),
+      writer_stop_(false),
+      writer_idle_(false),
+      enqueued_(0),
+      written_(0),
+      dropped_(0) {
+    // Id 0 is reserved in both tables
+    templates_.texts.emplace_back("{}");
+    components_.texts.emplace_back("");
+}
+
+Logger::~Logger() {
+    stop_async();
+}
+
+void Logger::write_record(LogLevel level, std::string_view message,
+                          std::string_view component, int port_id) {
+    if (format_.load(std::memory_order_relaxed) == LogOutputFormat::BINARY) {
+        // Untemplated text travels as the single argument of template 0 ("{}")
+        LogRecord record;
+        record.template_id = 0;
+        BinaryArgWriter writer(record.message, LogRecord::kMaxMessage);
+        writer.put_string(message);
+        record.message_len = static_cast<uint16_t>(writer.size());
+        write_binary_record(record, level, component, port_id);
+        return;
+    }
+
+    int64_t timestamp = now_ns();
+
+    if (async_active_.load(std::memory_order_acquire)) {
+        LogRecord record;
+        record.timestamp_ns = timestamp;
+        record.port_id = port_id;
+        record.level = static_cast<uint8_t>(level);
+        record.set_component(component);
+        record.set_message(message);
+        if (enqueue(record) || async_active_.load(std::memory_order_acquire)) {
+            return;
+        }
+        // The logger left async mode while we waited for room; write directly
+    }
+
+    static thread_local std::string line;
+    line.clear();
+    append_log_json_line(line, timestamp, level, message, component, port_id);
+
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    write_all(line);
+}
+
+bool Logger::admit_limited(LogLevel level, std::string_view component, int port_id) {
+    int64_t now = steady_now_ns();
+    uint64_t key = LogRateLimiter::make_key(intern_component(component), port_id,
+                                            static_cast<uint8_t>(level));
+    LogRateLimiter::Suppression closed;
+    if (!rate_limiter_.allow(key, now, closed)) {
+        return false;
+    }
+    if (closed.count > 0) {
+        emit_suppression(key, closed);
+    }
+
+    // Keys that went quiet never reach the check above; pick up their closed
+    // windows at most once per sweep interval
+    int64_t next_sweep = next_suppression_sweep_ns_.load(std::memory_order_relaxed);
+    if (now >= next_sweep &&
+        next_suppression_sweep_ns_.compare_exchange_strong(next_sweep, now + kSuppressionSweepNs,
+                                                           std::memory_order_relaxed)) {
+        rate_limiter_.collect(now, false, [this](uint64_t closed_key,
+                                                 const LogRateLimiter::Suppression& window) {
+            emit_suppression(closed_key, window);
+        });
+    }
+    return true;
+}
+
+void Logger::emit_suppression(uint64_t key, const LogRateLimiter::Suppression& closed) {
+    std::string_view component = interned_text(components_, LogRateLimiter::key_component(key));
+    emit(static_cast<LogLevel>(LogRateLimiter::key_level(key)), component,
+         LogRateLimiter::key_port(key), "Suppressed {} messages over {}ms (rate limit)",
+         closed.count, closed.window_ns / 1000000);
+}
+
+void Logger::report_suppressed() {
+    if (!rate_limiter_.enabled()) {
+        return;
+    }
+    rate_limiter_.collect(steady_now_ns(), true, [this](uint64_t key,
+                                                        const LogRateLimiter::Suppression& window) {
+        emit_suppression(key, window);
+    });
+}
+
+void Logger::write_binary_record(LogRecord& record, LogLevel level,
+                                 std::string_view component, int port_id) {
+    record.timestamp_ns = now_ns();
+    record.port_id = port_id;
+    record.level = static_cast<uint8_t>(level);
+    record.component_id = intern_component(component);
+    record.component_len = 0;
+
+    if (async_active_.load(std::memory_order_acquire)) {
+        if (enqueue(record) || async_active_.load(std::memory_order_acquire)) {
+            return;
+        }
+    }
+
+    static thread_local std::string frame;
+    frame.clear();
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    append_binary_record(frame, record);
+    write_all(frame);
+}
+
+void Logger::set_output_fd(int fd) {
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    output_fd_.store(fd, std::memory_order_relaxed);
+    stream_started_ = false;
+    templates_written_.clear();
+    components_written_.clear();
+}
+
+bool Logger::set_format(LogOutputFormat format) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (async_active_.load()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> output_lock(output_mutex_);
+    format_.store(format, std::memory_order_relaxed);
+    stream_started_ = false;
+    templates_written_.clear();
+    components_written_.clear();
+    return true;
+}
+
+uint16_t Logger::intern(InternTable& table, std::string_view text, const char*& stored) {
+    std::lock_guard<std::mutex> lock(table.mutex);
+    auto it = table.ids.find(text);
+    if (it != table.ids.end()) {
+        stored = it->first.data();
+        return it->second;
+    }
+    if (table.texts.size() > UINT16_MAX) {
+        // Full: fall back to the reserved id (the cache then keeps retrying)
+        stored = nullptr;
+        return 0;
+    }
+    uint16_t id = static_cast<uint16_t>(table.texts.size());
+    const std::string& text_copy = table.texts.emplace_back(text);
+    table.ids.emplace(text_copy, id);
+    stored = text_copy.data();
+    return id;
+}
+
+std::string_view Logger::interned_text(InternTable& table, uint16_t id) {
+    std::lock_guard<std::mutex> lock(table.mutex);
+    return table.texts[id];
+}
+
+bool Logger::enqueue(const LogRecord& record) {
+    while (!ring_->try_push(record)) {
+        if (overflow_policy_ == LogOverflowPolicy::DROP) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (!async_active_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        // BLOCK: make sure the writer is awake, then wait for it to free a slot
+        wake_cv_.notify_one();
+        std::this_thread::yield();
+    }
+    enqueued_.fetch_add(1, std::memory_order_release);
+
+    if (writer_idle_.load(std::memory_order_relaxed)) {
+        wake_cv_.notify_one();
+    }
+    return true;
+}
+
+void Logger::start_async(size_t capacity, LogOverflowPolicy policy) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (async_active_.load()) {
+        return;
+    }
+
+    // Records left by a previous stop_async() race are kept if the ring is
+    // big enough
+    if (!ring_ || ring_->capacity() < capacity) {
+        ring_ = std::make_unique<LogRing>(capacity);
+        enqueued_.store(written_.load());
+    }
+    overflow_policy_ = policy;
+    writer_stop_.store(false);
+    writer_thread_ = std::thread(&Logger::writer_loop, this);
+    async_active_.store(true, std::memory_order_release);
+}
+
+void Logger::stop_async() {
+    report_suppressed();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!async_active_.load()) {
+        return;
+    }
+
+    // New records go straight to the output from here on
+    async_active_.store(false, std::memory_order_release);
+    writer_stop_.store(true);
+    wake_cv_.notify_one();
+    writer_thread_.join();
+
+    // Anything pushed after the writer's last pass
+    std::string buffer;
+    drain(buffer);
+}
+
+void Logger::flush() {
+    report_suppressed();
+
+    if (!async_active_.load(std::memory_order_acquire)) {
+        return;
+    }
+    uint64_t target = enqueued_.load(std::memory_order_acquire);
+    while (written_.load(std::memory_order_acquire) < target &&
+           async_active_.load(std::memory_order_acquire)) {
+        wake_cv_.notify_one();
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+void Logger::writer_loop() {
+    std::string buffer;
+    buffer.reserve(kWriteBatchBytes + 4096);
+
+    while (true) {
+        if (drain(buffer) > 0) {
+            continue;
+        }
+        if (writer_stop_.load()) {
+            break;
+        }
+
+        // Idle: sleep until a producer notices and wakes us (the timeout
+        // bounds the latency of a missed wakeup)
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        writer_idle_.store(true);
+        wake_cv_.wait_for(lock, std::chrono::milliseconds(5));
+        writer_idle_.store(false);
+    }
+
+    drain(buffer);
+}
+
+size_t Logger::drain(std::string& buffer) {
+    LogRecord record;
+    size_t count = 0;
+    bool more = true;
+
+    while (more) {
+        // Format and write one batch under the output lock, so binary
+        // definitions always reach the fd before the records that use them
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        buffer.clear();
+        size_t pending = 0;
+        while (buffer.size() < kWriteBatchBytes && (more = ring_->try_pop(record))) {
+            append_record(buffer, record);
+            pending++;
+        }
+        if (pending == 0) {
+            break;
+        }
+        write_all(buffer);
+        written_.fetch_add(pending, std::memory_order_release);
+        count += pending;
+    }
+    buffer.clear();
+    return count;
+}
+
+void Logger::append_record(std::string& out, const LogRecord& record) {
+    if (format_.load(std::memory_order_relaxed) == LogOutputFormat::BINARY) {
+        append_binary_record(out, record);
+    } else {
+        append_log_json_line(out, record.timestamp_ns, static_cast<LogLevel>(record.level),
+                             record.message_view(), record.component_view(), record.port_id);
+    }
+}
+
+void Logger::append_binary_record(std::string& out, const LogRecord& record) {
+    if (!stream_started_) {
+        out.append(kBinaryLogMagic, sizeof(kBinaryLogMagic));
+        stream_started_ = true;
+    }
+    if (record.component_id != 0) {
+        append_definition(out, BinaryLogFrame::COMPONENT, components_, components_written_,
+                          record.component_id);
+    }
+    if (record.template_id != 0) {
+        append_definition(out, BinaryLogFrame::TEMPLATE, templates_, templates_written_,
+                          record.template_id);
+    }
+
+    out += static_cast<char>(BinaryLogFrame::RECORD);
+    out += static_cast<char>(record.level);
+    append_raw(out, record.component_id);
+    append_raw(out, record.template_id);
+    append_raw(out, record.timestamp_ns);
+    append_raw(out, record.port_id);
+    append_varint(out, record.message_len);
+    out.append(record.message, record.message_len);
+}
+
+void Logger::append_definition(std::string& out, BinaryLogFrame frame, InternTable& table,
+                               std::vector<bool>& written, uint16_t id) {
+    if (id < written.size() && written[id]) {
+        return;
+    }
+    if (id >= written.size()) {
+        written.resize(static_cast<size_t>(id) + 1, false);
+    }
+    written[id] = true;
+
+    std::string_view text = interned_text(table, id);
+    out += static_cast<char>(frame);
+    append_raw(out, id);
+    append_varint(out, text.size());
+    out.append(text.data(), text.size());
+}
+
+void Logger::write_all(const std::string& buffer) {
+    int fd = output_fd_.load(std::memory_order_relaxed);
+    const char* data = buffer.data();
+    size_t remaining = buffer.size();
+    while (remaining > 0) {
+        ssize_t n = ::write(fd, data, remaining);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return; // Nowhere left to report it
+        }
+        data += n;
+        remaining -= static_cast<size_t>(n);
+    }
+}
+
+int64_t Logger::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int64_t Logger::steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
 } // namespace control_plane
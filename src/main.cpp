@@ -3,23 +3,28 @@
 #include "port_manager.h"
 #include "event_loop.h"
 #include "http_server.h"
-#include <csignal>
-#include <atomic>
+#include "event_socket.h"
+#include "event_journal.h"
+#include "port_snapshot.h"
+#include "signal_watcher.h"
+#include "stop_token.h"
+#include <chrono>
+#include <filesystem>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
 
 using namespace control_plane;
 
-// Global flag for graceful shutdown
-std::atomic<bool> shutdown_requested(false);
-
-void signal_handler(int signal) {
-    if (signal == SIGINT || signal == SIGTERM) {
-        Logger::instance().info("Shutdown signal received", "main");
-        shutdown_requested.store(true);
-    }
-}
-
 int main(int argc, char** argv) {
+    // Signals are read from a signalfd by the watcher thread; they are
+    // blocked here first so that every thread started later inherits that
+    SignalWatcher signals({SIGINT, SIGTERM, SIGUSR1});
+    
+    // Set by SIGINT/SIGTERM or the end of a discrete run; main waits on it
+    StopToken shutdown;
+    
     // Load configuration
     Config config;
     
@@ -44,58 +49,180 @@ int main(int argc, char** argv) {
         return 1;
     }
     
-    // Set log level
+    // Set log level and encoding
     Logger::instance().set_level(parse_log_level(config.log_level));
+    LogOutputFormat log_format = LogOutputFormat::JSON;
+    parse_log_output_format(config.log_format, log_format);
+    Logger::instance().set_format(log_format);
+    Logger::instance().set_rate_limit(config.log_rate_limit, static_cast<uint32_t>(config.log_rate_burst));
+    if (parse_log_level(config.log_level) < Logger::kCompiledMinLevel) {
+        Logger::instance().warnf("main", -1,
+                                 "log_level {} is below the compiled-in minimum {}; "
+                                 "rebuild with -DLOG_MIN_LEVEL=DEBUG to enable it",
+                                 config.log_level, log_level_name(Logger::kCompiledMinLevel));
+    }
+    
+    // Hand log output to the background writer
+    if (config.log_mode == "async") {
+        LogOverflowPolicy overflow = LogOverflowPolicy::BLOCK;
+        parse_log_overflow_policy(config.log_overflow, overflow);
+        Logger::instance().start_async(static_cast<size_t>(config.log_queue_capacity), overflow);
+    }
     
     // Print configuration
     Logger::instance().info("Starting Control Plane Simulator", "main");
-    std::cout << config.to_string() << std::endl;
-    
-    // Setup signal handlers
-    std::signal(SIGINT, signal_handler);
-    std::signal(SIGTERM, signal_handler);
+    // Keep a binary log stream on stdout free of plain text
+    (log_format == LogOutputFormat::BINARY ? std::cerr : std::cout) << config.to_string() << std::endl;
     
     try {
         // Create port manager
-        auto port_manager = std::make_shared<PortManager>(config.ports_count);
+        PortSyncMode sync_mode = PortSyncMode::MUTEX;
+        parse_port_sync_mode(config.port_sync, sync_mode);
+        std::shared_ptr<PortManager> port_manager;
+        if (!config.snapshot_path.empty() && std::filesystem::exists(config.snapshot_path)) {
+            // Start from the snapshot, mapped as the live table
+            std::optional<PortTable> table;
+            if (!PortSnapshot::load(config.snapshot_path, table)) {
+                Logger::instance().warnf("main", -1, "Ignoring unusable snapshot {}", config.snapshot_path);
+            } else if (table->size() != config.ports_count) {
+                Logger::instance().warnf("main", -1, "Ignoring snapshot {} of {} ports (configured for {})",
+                                         config.snapshot_path, table->size(), config.ports_count);
+            } else {
+                port_manager = std::make_shared<PortManager>(std::move(*table), sync_mode);
+                Logger::instance().infof("main", -1, "Restored {} ports from snapshot {}",
+                                         config.ports_count, config.snapshot_path);
+            }
+        }
+        if (!port_manager) {
+            port_manager = std::make_shared<PortManager>(config.ports_count, sync_mode);
+        }
+        port_manager->get_metrics().register_counter_callback("log_records_dropped_total", []() {
+            return Logger::instance().get_dropped_count();
+        });
+        port_manager->get_metrics().register_counter_callback("log_records_suppressed_total", []() {
+            return Logger::instance().get_suppressed_count();
+        });
+        port_manager->get_metrics().set_exposition_max_age(
+            std::chrono::milliseconds(config.metrics_max_age_ms));
+        
+        // Rebuild port states from the journal, then keep journaling
+        std::shared_ptr<EventJournal> journal;
+        if (!config.journal_dir.empty()) {
+            JournalReplay replay;
+            if (!EventJournal::replay(config.journal_dir, config.ports_count, replay)) {
+                throw std::runtime_error("Could not replay event journal in " + config.journal_dir);
+            }
+            port_manager->restore_states(replay.ports);
+            Logger::instance().infof("main", -1,
+                                     "Replayed {} journal records from {} segments ({} corrupt, {} for unknown ports)",
+                                     replay.records, replay.segments, replay.corrupt, replay.skipped);
+            
+            journal = std::make_shared<EventJournal>(
+                config.journal_dir, config.ports_count, port_manager->get_metrics(),
+                static_cast<size_t>(config.journal_segment_mb) << 20,
+                std::chrono::milliseconds(config.journal_commit_ms));
+            if (!journal->open()) {
+                throw std::runtime_error("Could not open event journal in " + config.journal_dir);
+            }
+            port_manager->set_journal(journal);
+        }
+        
+        // Created ahead of the HTTP server, whose readiness check reads it
+        EventLoop event_loop(port_manager, config);
+        event_loop.set_finished_callback([&shutdown]() { shutdown.request_stop(); });
         
         // Create and start HTTP server
         HttpServer http_server(port_manager, config.http_port);
+        http_server.set_snapshot_path(config.snapshot_path);
+        http_server.set_health_check([&event_loop](std::string& reason) {
+            if (!event_loop.is_lagging()) {
+                return true;
+            }
+            reason = "tick loop lagging " +
+                std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    event_loop.get_tick_lag()).count()) + " ms behind";
+            return false;
+        });
         http_server.start();
         
-        // Create and start event loop
-        EventLoop event_loop(port_manager, config);
+        // Optional binary event channel beside the HTTP API
+        std::unique_ptr<EventSocketServer> event_socket;
+        if (!config.event_socket_path.empty()) {
+            event_socket = std::make_unique<EventSocketServer>(port_manager, config.event_socket_path);
+            if (!event_socket->start()) {
+                throw std::runtime_error("Could not listen on event socket " + config.event_socket_path);
+            }
+        }
+        
+        // Start event loop
         event_loop.start();
         
+        // Signal handling: snapshots are written on the watcher thread
+        bool watching = signals.start([&](int signal) {
+            if (signal == SIGUSR1) {
+                if (config.snapshot_path.empty()) {
+                    Logger::instance().warn("SIGUSR1 ignored: snapshot_path is not configured", "main");
+                } else {
+                    port_manager->save_snapshot(config.snapshot_path);
+                }
+                return;
+            }
+            Logger::instance().info("Shutdown signal received", "main");
+            shutdown.request_stop();
+        });
+        if (!watching) {
+            throw std::runtime_error("Could not set up signal handling");
+        }
+        
         Logger::instance().info("Control plane simulator is running", "main");
         Logger::instance().info("Press Ctrl+C to stop", "main");
         
         // Main loop - wait for shutdown
-        while (!shutdown_requested.load()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
+        shutdown.wait();
+        signals.stop();
         
         // Graceful shutdown
         Logger::instance().info("Initiating graceful shutdown", "main");
         
         event_loop.stop();
+        if (event_socket) {
+            event_socket->stop();
+        }
         http_server.stop();
+        if (!config.snapshot_path.empty()) {
+            port_manager->save_snapshot(config.snapshot_path);
+        }
+        if (journal) {
+            journal->close();
+        }
+        
+        // Write out queued records and any open rate-limit summaries; the
+        // multi-line summary below is longer than an async record holds, so
+        // it goes out synchronously
+        Logger::instance().stop_async();
         
         // Print final statistics
+        PortPopulation::Counts counts = port_manager->get_population().snapshot();
         std::ostringstream stats;
         stats << "Final statistics:\n"
               << "  Total events processed: " << port_manager->get_total_events_processed() << "\n"
               << "  State transitions: " << port_manager->get_metrics().get_counter("state_transitions_total") << "\n"
               << "  Link flaps injected: " << port_manager->get_metrics().get_counter("link_flaps_injected_total") << "\n"
-              << "  Ports UP: " << port_manager->get_metrics().get_gauge("ports_up") << "\n"
-              << "  Ports INIT: " << port_manager->get_metrics().get_gauge("ports_init") << "\n"
-              << "  Ports DOWN: " << port_manager->get_metrics().get_gauge("ports_down");
+              << "  Ports UP: " << counts.up << "\n"
+              << "  Ports INIT: " << counts.init << "\n"
+              << "  Ports DOWN: " << counts.down << "\n"
+              << "  Ticks: " << event_loop.get_tick_count();
+        if (event_loop.is_tracing()) {
+            stats << "\n  Trace: " << event_loop.get_trace().get_count() << " events, hash "
+                  << event_loop.get_trace().hash_string();
+        }
         
         Logger::instance().info(stats.str(), "main");
         Logger::instance().info("Control plane simulator stopped cleanly", "main");
         
     } catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << std::endl;
+        Logger::instance().stop_async();
         Logger::instance().error(std::string("Fatal error: ") + e.what(), "main");
         return 1;
     }
@@ -1,89 +1,423 @@
 #include "metrics.h"
-#include <sstream>
-#include <iomanip>
+#include "logger.h"
+#include <array>
+#include <charconv>
 
 namespace control_plane {
 
-Metrics::Metrics() {
+namespace {
+
+std::atomic<uint64_t> next_registry_id(1); // 0 marks an empty thread cache slot
+
+void append_uint(std::string& out, uint64_t value) {
+    char digits[24];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+// Fixed-point, as the exposition has always printed values
+void append_fixed(std::string& out, double value, int precision) {
+    char digits[64];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value,
+                                                std::chars_format::fixed, precision);
+    if (result.ec != std::errc()) {
+        // Out of range for fixed-point; not expected for metric values
+        result = std::to_chars(digits, digits + sizeof(digits), value);
+    }
+    out.append(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+// `le="<bound>"} ` for every bucket, in seconds; the same for all histograms
+const std::array<std::string, LatencyBuckets::kCount>& bucket_bound_labels() {
+    static const std::array<std::string, LatencyBuckets::kCount> labels = []() {
+        std::array<std::string, LatencyBuckets::kCount> out;
+        for (int b = 0; b < LatencyBuckets::kCount; b++) {
+            std::string label = "le=\"";
+            if (b == LatencyBuckets::kOverflow) {
+                label += "+Inf";
+            } else {
+                append_fixed(label, LatencyBuckets::upper_bound_ns(b) / 1e9, 9);
+            }
+            label += "\"} ";
+            out[b] = std::move(label);
+        }
+        return out;
+    }();
+    return labels;
+}
+
+} // namespace
+
+// Everything a render needs besides the numbers. Callbacks are copied in so
+// a render never touches the registry's own tables.
+struct Metrics::ExpositionLayout {
+    struct Counter {
+        std::string prefix; // "control_plane_<name> "
+        uint32_t index;
+        std::function<uint64_t()> read;
+    };
+    struct Gauge {
+        std::string prefix;
+        uint32_t index;
+        std::function<double()> read;
+    };
+    struct Histogram {
+        std::string type_line;     // Empty unless first of its name
+        std::string bucket_prefix; // "control_plane_<name>_bucket{<labels>,"
+        std::string sum_prefix;    // "control_plane_<name>_sum{<labels>} "
+        std::string count_prefix;
+        uint32_t index;
+    };
+
+    uint64_t version = 0;
+    std::vector<Counter> counters;
+    std::vector<Gauge> gauges;
+    std::vector<Histogram> histograms;
+    size_t last_size = 0; // Size of the previous render, to reserve up front
+};
+
+Metrics::Metrics()
+    : registry_id_(next_registry_id.fetch_add(1)),
+      gauges_(new std::atomic<double>[kMaxGauges]),
+      gauge_callbacks_(kMaxGauges),
+      counter_callbacks_(kMaxCounters) {
+    for (uint32_t i = 0; i < kMaxGauges; i++) {
+        gauges_[i].store(0.0, std::memory_order_relaxed);
+    }
+
     // Initialize common metrics
-    increment_counter("events_processed_total", 0);
-    increment_counter("state_transitions_total", 0);
-    increment_counter("link_flaps_injected_total", 0);
-    
-    set_gauge("ports_total", 0.0);
-    set_gauge("ports_down", 0.0);
-    set_gauge("ports_init", 0.0);
-    set_gauge("ports_up", 0.0);
+    register_counter("events_processed_total");
+    register_counter("state_transitions_total");
+    register_counter("link_flaps_injected_total");
+
+    register_gauge("ports_total");
+    register_gauge("ports_down");
+    register_gauge("ports_init");
+    register_gauge("ports_up");
 }
 
-void Metrics::increment_counter(const std::string& name, uint64_t value) {
+Metrics::~Metrics() = default;
+
+CounterHandle Metrics::register_counter(const std::string& name) {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto& counter = get_or_create_counter(name);
-    counter.fetch_add(value);
+    auto it = counter_names_.find(name);
+    if (it != counter_names_.end()) {
+        return CounterHandle{it->second};
+    }
+    if (counter_names_.size() >= kMaxCounters) {
+        Logger::instance().errorf("Metrics", -1, "Counter registry full, dropping {}", name);
+        return CounterHandle{};
+    }
+    uint32_t index = static_cast<uint32_t>(counter_names_.size());
+    counter_names_.emplace(name, index);
+    layout_version_.fetch_add(1, std::memory_order_release);
+    return CounterHandle{index};
 }
 
-void Metrics::set_gauge(const std::string& name, double value) {
+GaugeHandle Metrics::register_gauge(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = gauge_names_.find(name);
+    if (it != gauge_names_.end()) {
+        return GaugeHandle{it->second};
+    }
+    if (gauge_names_.size() >= kMaxGauges) {
+        Logger::instance().errorf("Metrics", -1, "Gauge registry full, dropping {}", name);
+        return GaugeHandle{};
+    }
+    uint32_t index = static_cast<uint32_t>(gauge_names_.size());
+    gauge_names_.emplace(name, index);
+    layout_version_.fetch_add(1, std::memory_order_release);
+    return GaugeHandle{index};
+}
+
+GaugeHandle Metrics::register_gauge_callback(const std::string& name,
+                                             std::function<double()> read) {
+    GaugeHandle gauge = register_gauge(name);
+    if (gauge.valid()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        gauge_callbacks_[gauge.index] = std::move(read);
+        layout_version_.fetch_add(1, std::memory_order_release);
+    }
+    return gauge;
+}
+
+HistogramHandle Metrics::register_histogram(const std::string& name, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    HistogramKey key{name, labels};
+    auto it = histogram_names_.find(key);
+    if (it != histogram_names_.end()) {
+        return HistogramHandle{it->second};
+    }
+    if (histogram_names_.size() >= kMaxHistograms) {
+        Logger::instance().errorf("Metrics", -1, "Histogram registry full, dropping {}", name);
+        return HistogramHandle{};
+    }
+    uint32_t index = static_cast<uint32_t>(histogram_names_.size());
+    histogram_names_.emplace(std::move(key), index);
+    layout_version_.fetch_add(1, std::memory_order_release);
+    return HistogramHandle{index};
+}
+
+CounterHandle Metrics::register_counter_callback(const std::string& name,
+                                                 std::function<uint64_t()> read) {
+    CounterHandle counter = register_counter(name);
+    if (counter.valid()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        counter_callbacks_[counter.index] = std::move(read);
+        layout_version_.fetch_add(1, std::memory_order_release);
+    }
+    return counter;
+}
+
+uint64_t Metrics::value(CounterHandle counter) const {
+    if (!counter.valid()) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sum_counter(counter.index);
+}
+
+double Metrics::value(GaugeHandle gauge) const {
+    if (!gauge.valid()) {
+        return 0.0;
+    }
     std::lock_guard<std::mutex> lock(mutex_);
-    auto& gauge = get_or_create_gauge(name);
-    gauge.store(value);
+    return read_gauge(gauge.index);
+}
+
+HistogramSnapshot Metrics::value(HistogramHandle histogram) const {
+    if (!histogram.valid()) {
+        return HistogramSnapshot{};
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sum_histogram(histogram.index);
+}
+
+void Metrics::increment_counter(const std::string& name, uint64_t value) {
+    increment(register_counter(name), value);
+}
+
+void Metrics::set_gauge(const std::string& name, double value) {
+    set(register_gauge(name), value);
 }
 
 uint64_t Metrics::get_counter(const std::string& name) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it = counters_.find(name);
-    if (it != counters_.end()) {
-        return it->second.load();
+    auto it = counter_names_.find(name);
+    if (it != counter_names_.end()) {
+        return sum_counter(it->second);
     }
     return 0;
 }
 
 double Metrics::get_gauge(const std::string& name) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it = gauges_.find(name);
-    if (it != gauges_.end()) {
-        return it->second.load();
+    auto it = gauge_names_.find(name);
+    if (it != gauge_names_.end()) {
+        return read_gauge(it->second);
     }
     return 0.0;
 }
 
 std::string Metrics::export_prometheus() const {
+    std::lock_guard<std::mutex> lock(render_mutex_);
+    return render_exposition();
+}
+
+std::shared_ptr<const std::string> Metrics::exposition() const {
+    uint64_t now = latency_clock_ns();
+    uint64_t max_age = max_age_ns_.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        if (cached_exposition_ && now - cached_at_ns_ < max_age) {
+            return cached_exposition_;
+        }
+    }
+
+    std::unique_lock<std::mutex> render_lock(render_mutex_, std::try_to_lock);
+    if (!render_lock.owns_lock()) {
+        // Someone else is rendering: serve the previous render, if there is
+        // one, rather than queue behind it
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex_);
+            if (cached_exposition_) {
+                return cached_exposition_;
+            }
+        }
+        render_lock.lock();
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        if (cached_exposition_ && cached_at_ns_ >= now) {
+            return cached_exposition_; // Rendered while we waited
+        }
+    }
+
+    auto text = std::make_shared<const std::string>(render_exposition());
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    cached_exposition_ = text;
+    cached_at_ns_ = latency_clock_ns();
+    return text;
+}
+
+void Metrics::build_layout() const {
+    // Note: This assumes render_mutex_ is already locked by caller
     std::lock_guard<std::mutex> lock(mutex_);
-    std::ostringstream oss;
-    
+    auto layout = std::make_unique<ExpositionLayout>();
+    layout->version = layout_version_.load(std::memory_order_acquire);
+    layout->last_size = layout_ ? layout_->last_size : 0;
+
+    for (const auto& [name, index] : counter_names_) {
+        layout->counters.push_back({"control_plane_" + name + " ", index, counter_callbacks_[index]});
+    }
+    for (const auto& [name, index] : gauge_names_) {
+        layout->gauges.push_back({"control_plane_" + name + " ", index, gauge_callbacks_[index]});
+    }
+    const std::string* current_name = nullptr;
+    for (const auto& [key, index] : histogram_names_) {
+        ExpositionLayout::Histogram histogram;
+        if (!current_name || *current_name != key.name) {
+            histogram.type_line = "# TYPE control_plane_" + key.name + " histogram\n";
+            current_name = &key.name;
+        }
+        std::string series = "control_plane_" + key.name;
+        std::string labels = key.labels.empty() ? "" : "{" + key.labels + "}";
+        histogram.bucket_prefix = series + "_bucket{" + (key.labels.empty() ? "" : key.labels + ",");
+        histogram.sum_prefix = series + "_sum" + labels + " ";
+        histogram.count_prefix = series + "_count" + labels + " ";
+        histogram.index = index;
+        layout->histograms.push_back(std::move(histogram));
+    }
+    layout_ = std::move(layout);
+}
+
+std::string Metrics::render_exposition() const {
+    // Note: This assumes render_mutex_ is already locked by caller
+    if (!layout_ || layout_->version != layout_version_.load(std::memory_order_acquire)) {
+        build_layout();
+    }
+    ExpositionLayout& layout = *layout_;
+
+    std::string out;
+    out.reserve(layout.last_size + layout.last_size / 8);
+
     // Export counters
-    oss << "# TYPE control_plane_events_processed_total counter\n";
-    for (const auto& [name, value] : counters_) {
-        oss << "control_plane_" << name << " " << value.load() << "\n";
+    out += "# TYPE control_plane_events_processed_total counter\n";
+    for (const auto& counter : layout.counters) {
+        out += counter.prefix;
+        append_uint(out, (counter.read ? counter.read() : 0) + sum_shards(counter.index));
+        out += '\n';
     }
-    
+
     // Export gauges
-    oss << "# TYPE control_plane_ports gauge\n";
-    for (const auto& [name, value] : gauges_) {
-        oss << "control_plane_" << name << " " << std::fixed 
-            << std::setprecision(2) << value.load() << "\n";
+    out += "# TYPE control_plane_ports gauge\n";
+    for (const auto& gauge : layout.gauges) {
+        out += gauge.prefix;
+        append_fixed(out, gauge.read ? gauge.read() : gauges_[gauge.index].load(std::memory_order_relaxed), 2);
+        out += '\n';
+    }
+
+#if CONTROL_PLANE_LATENCY_HISTOGRAMS
+    // Export histograms: cumulative buckets from the first to the last
+    // non-empty one, then +Inf, _sum and _count. Values are in seconds.
+    const auto& bounds = bucket_bound_labels();
+    for (const auto& histogram : layout.histograms) {
+        out += histogram.type_line;
+
+        HistogramSnapshot snapshot = sum_histogram(histogram.index);
+        int first = 0;
+        int last = -1;
+        for (int b = 0; b < LatencyBuckets::kOverflow; b++) {
+            if (snapshot.buckets[b] != 0) {
+                if (last < 0) first = b;
+                last = b;
+            }
+        }
+        uint64_t cumulative = 0;
+        for (int b = 0; b < first; b++) {
+            cumulative += snapshot.buckets[b];
+        }
+        for (int b = first; b <= last; b++) {
+            cumulative += snapshot.buckets[b];
+            out += histogram.bucket_prefix;
+            out += bounds[b];
+            append_uint(out, cumulative);
+            out += '\n';
+        }
+        // Count from the buckets themselves so +Inf always matches them
+        // while writers are active
+        uint64_t total = cumulative;
+        for (int b = last + 1; b < LatencyBuckets::kCount; b++) {
+            total += snapshot.buckets[b];
+        }
+        out += histogram.bucket_prefix;
+        out += bounds[LatencyBuckets::kOverflow];
+        append_uint(out, total);
+        out += '\n';
+        out += histogram.sum_prefix;
+        append_fixed(out, snapshot.sum_ns / 1e9, 9);
+        out += '\n';
+        out += histogram.count_prefix;
+        append_uint(out, total);
+        out += '\n';
     }
-    
-    return oss.str();
+#endif
+
+    layout.last_size = out.size();
+    return out;
+}
+
+Metrics::ThreadShard* Metrics::create_local_shard() {
+    // Slow path: first increment from this thread (or the thread cache
+    // evicted this registry)
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& shard = shards_by_thread_[std::this_thread::get_id()];
+    if (!shard) {
+        shard = std::make_unique<ThreadShard>();
+        // Publish fully initialized for lock-free readers
+        shard->next = shards_head_.load(std::memory_order_relaxed);
+        shards_head_.store(shard.get(), std::memory_order_release);
+    }
+    return shard.get();
 }
 
-std::atomic<uint64_t>& Metrics::get_or_create_counter(const std::string& name) {
+uint64_t Metrics::sum_shards(uint32_t index) const {
+    // Shards are only ever prepended and live as long as the registry
+    uint64_t total = 0;
+    for (const ThreadShard* shard = shards_head_.load(std::memory_order_acquire); shard;
+         shard = shard->next) {
+        total += shard->values[index].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t Metrics::sum_counter(uint32_t index) const {
     // Note: This assumes mutex is already locked by caller
-    auto it = counters_.find(name);
-    if (it == counters_.end()) {
-        counters_[name].store(0);
-        it = counters_.find(name);
+    uint64_t total = counter_callbacks_[index] ? counter_callbacks_[index]() : 0;
+    return total + sum_shards(index);
+}
+
+HistogramSnapshot Metrics::sum_histogram(uint32_t index) const {
+    HistogramSnapshot snapshot;
+    for (const ThreadShard* shard = shards_head_.load(std::memory_order_acquire); shard;
+         shard = shard->next) {
+        const HistogramCells* cells = shard->histograms[index].load(std::memory_order_acquire);
+        if (!cells) {
+            continue;
+        }
+        for (int b = 0; b < LatencyBuckets::kCount; b++) {
+            snapshot.buckets[b] += cells->buckets[b].load(std::memory_order_relaxed);
+        }
+        snapshot.sum_ns += cells->sum_ns.load(std::memory_order_relaxed);
+        snapshot.count += cells->count.load(std::memory_order_relaxed);
     }
-    return const_cast<std::atomic<uint64_t>&>(it->second);
+    return snapshot;
 }
 
-std::atomic<double>& Metrics::get_or_create_gauge(const std::string& name) {
+double Metrics::read_gauge(uint32_t index) const {
     // Note: This assumes mutex is already locked by caller
-    auto it = gauges_.find(name);
-    if (it == gauges_.end()) {
-        gauges_[name].store(0.0);
-        it = gauges_.find(name);
+    if (gauge_callbacks_[index]) {
+        return gauge_callbacks_[index]();
     }
-    return const_cast<std::atomic<double>&>(it->second);
+    return gauges_[index].load(std::memory_order_relaxed);
 }
 
 } // namespace control_plane
@@ -1,97 +1,375 @@
 #include "port_manager.h"
+#include "event_journal.h"
+#include "port_snapshot.h"
 #include "logger.h"
-#include <sstream>
+#include <algorithm>
 
 namespace control_plane {
 
-PortManager::PortManager(int num_ports)
-    : num_ports_(num_ports),
-      port_mutexes_(num_ports),
-      total_events_processed_(0) {
-    
-    // Initialize all ports
-    ports_.reserve(num_ports);
-    for (int i = 0; i < num_ports; i++) {
-        ports_.push_back(std::make_unique<PortStateMachine>(i));
+std::string port_sync_mode_to_string(PortSyncMode mode) {
+    switch (mode) {
+        case PortSyncMode::MUTEX: return "mutex";
+        case PortSyncMode::LOCK_FREE: return "lock_free";
+        default: return "unknown";
+    }
+}
+
+bool parse_port_sync_mode(const std::string& str, PortSyncMode& mode) {
+    if (str == "mutex") {
+        mode = PortSyncMode::MUTEX;
+        return true;
+    }
+    if (str == "lock_free") {
+        mode = PortSyncMode::LOCK_FREE;
+        return true;
     }
+    return false;
+}
+
+PortManager::PortManager(int num_ports, PortSyncMode sync_mode)
+    : PortManager(PortTable(num_ports), sync_mode) {}
+
+PortManager::PortManager(PortTable table, PortSyncMode sync_mode)
+    : num_ports_(table.size()),
+      sync_mode_(sync_mode),
+      table_(std::move(table)),
+      stripe_mutexes_(stripe_count(num_ports_)),
+      stripe_mask_(stripe_count(num_ports_) - 1),
+      total_events_processed_(0),
+      population_(static_cast<uint32_t>(num_ports_)),
+      latency_sampler_(kDefaultEventLatencySampleInterval) {
+    
+    // The population starts all DOWN; move it to the table's actual states
+    int64_t state_counts[kNumPortStates];
+    table_.count_states(state_counts);
+    state_counts[static_cast<int>(PortState::DOWN)] -= num_ports_;
+    population_.apply(state_counts);
     
-    std::stringstream ss;
-    ss << "PortManager initialized with " << num_ports << " ports";
-    Logger::instance().info(ss.str(), "PortManager");
+    Logger::instance().infof("PortManager", -1, "PortManager initialized with {} ports ({} sync)",
+                             num_ports_, port_sync_mode_to_string(sync_mode_));
     
     // Initialize metrics
-    metrics_.set_gauge("ports_total", static_cast<double>(num_ports));
-    metrics_.set_gauge("ports_down", static_cast<double>(num_ports));
-    metrics_.set_gauge("ports_init", 0.0);
-    metrics_.set_gauge("ports_up", 0.0);
+    events_processed_metric_ = metrics_.register_counter("events_processed_total");
+    state_transitions_metric_ = metrics_.register_counter("state_transitions_total");
+    for (int event = 0; event < kNumPortEvents; event++) {
+        event_latency_metrics_[event] = metrics_.register_histogram(
+            "port_event_latency_seconds",
+            "event=\"" + port_event_to_string(static_cast<PortEvent>(event)) + "\"");
+    }
+    lock_wait_metric_ = metrics_.register_histogram("port_lock_wait_seconds");
+    snapshot_metric_ = metrics_.register_histogram("port_snapshot_seconds");
+    
+    metrics_.set(metrics_.register_gauge("ports_total"), static_cast<double>(num_ports_));
+    
+    // State gauges are read from the population tracker at scrape time
+    static const char* const kStateGauges[3] = {"ports_down", "ports_init", "ports_up"};
+    for (int state = 0; state < kNumPortStates; state++) {
+        metrics_.register_gauge_callback(kStateGauges[state], [this, state]() {
+            return static_cast<double>(population_.count(static_cast<PortState>(state)));
+        });
+    }
 }
 
 bool PortManager::process_port_event(int port_id, PortEvent event) {
     if (!is_valid_port(port_id)) {
-        std::stringstream ss;
-        ss << "Invalid port ID: " << port_id;
-        Logger::instance().error(ss.str(), "PortManager");
+        Logger::instance().errorf("PortManager", -1, "Invalid port ID: {}", port_id);
         return false;
     }
     
-    // Lock this specific port's mutex
-    std::lock_guard<std::mutex> lock(port_mutexes_[port_id]);
+    ScopedLatency latency(metrics_, event_latency_metrics_[static_cast<int>(event)],
+                          latency_sampler_.due());
     
-    // Capture old state before processing event
-    PortState old_state = ports_[port_id]->get_state();
+    int64_t now = PortTable::now_ns();
+    PortTransition transition;
+    if (sync_mode_ == PortSyncMode::LOCK_FREE) {
+        transition = table_.apply_event_atomic(port_id, event, now);
+    } else {
+        // Lock the stripe guarding this port
+        std::unique_lock<std::mutex> lock = lock_stripe(port_id);
+        transition = table_.apply_event(port_id, event, now);
+    }
     
-    // Process the event
-    bool changed = ports_[port_id]->process_event(event);
+    // Replay orders records by transition count, so the append needn't
+    // happen under the port's lock
+    if (journal_) {
+        journal_->append(port_id, event, transition.word, now);
+    }
     
-    total_events_processed_.fetch_add(1);
+    bool changed = transition.changed();
+    int64_t state_deltas[3] = {0, 0, 0};
+    if (changed) {
+        state_deltas[static_cast<int>(transition.old_state)]--;
+        state_deltas[static_cast<int>(transition.new_state)]++;
+    }
+    publish_event_metrics(1, changed ? 1 : 0, state_deltas);
     
-    // Update metrics
-    metrics_.increment_counter("events_processed_total");
+    return changed;
+}
+
+PortEventBatchSummary PortManager::process_port_events(const PortEventRecord* records, size_t count,
+                                                       PortEventResult* results) {
+    PortEventBatchSummary summary;
+    if (count == 0) {
+        return summary;
+    }
     
-    if (changed) {
-        metrics_.increment_counter("state_transitions_total");
+    // Order record indices by (port, position) so each port's events form one
+    // run in arrival order. Sweeps usually arrive sorted already.
+    static thread_local std::vector<uint64_t> order;
+    order.clear();
+    bool sorted = true;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t port = static_cast<uint32_t>(records[i].port_id);
+        order.push_back((static_cast<uint64_t>(port) << 32) | i);
+        sorted = sorted && (i == 0 || order[i - 1] <= order[i]);
+    }
+    if (!sorted) {
+        std::sort(order.begin(), order.end());
+    }
+    
+    int64_t state_deltas[3] = {0, 0, 0};
+    int64_t now = PortTable::now_ns();
+    
+    // Journal records are staged and appended with one reservation
+    static thread_local std::vector<JournalEntry> journal_records;
+    if (journal_) {
+        journal_records.clear();
+    }
+    
+    size_t run_begin = 0;
+    while (run_begin < count) {
+        int port_id = records[order[run_begin] & 0xFFFFFFFFu].port_id;
+        size_t run_end = run_begin + 1;
+        while (run_end < count && records[order[run_end] & 0xFFFFFFFFu].port_id == port_id) {
+            run_end++;
+        }
         
-        // Capture new state after transition
-        PortState new_state = ports_[port_id]->get_state();
+        if (!is_valid_port(port_id)) {
+            for (size_t i = run_begin; i < run_end; i++) {
+                if (results) results[order[i] & 0xFFFFFFFFu] = PortEventResult::INVALID_PORT;
+            }
+            summary.rejected += run_end - run_begin;
+            run_begin = run_end;
+            continue;
+        }
         
-        // Update state gauges: decrement old state, increment new state
-        switch (old_state) {
-            case PortState::DOWN:
-                metrics_.set_gauge("ports_down", metrics_.get_gauge("ports_down") - 1.0);
-                break;
-            case PortState::INIT:
-                metrics_.set_gauge("ports_init", metrics_.get_gauge("ports_init") - 1.0);
-                break;
-            case PortState::UP:
-                metrics_.set_gauge("ports_up", metrics_.get_gauge("ports_up") - 1.0);
-                break;
+        // Apply the whole run under one acquisition of the port's stripe
+        std::unique_lock<std::mutex> lock;
+        if (sync_mode_ == PortSyncMode::MUTEX) {
+            lock = lock_stripe(port_id);
+        }
+        for (size_t i = run_begin; i < run_end; i++) {
+            size_t index = order[i] & 0xFFFFFFFFu;
+            // The run's lock wait is recorded separately, in lock_stripe()
+            ScopedLatency latency(metrics_, event_latency_metrics_[static_cast<int>(records[index].event)],
+                                  latency_sampler_.due());
+            PortTransition transition = sync_mode_ == PortSyncMode::LOCK_FREE
+                ? table_.apply_event_atomic(port_id, records[index].event, now)
+                : table_.apply_event(port_id, records[index].event, now);
+            
+            if (transition.changed()) {
+                state_deltas[static_cast<int>(transition.old_state)]--;
+                state_deltas[static_cast<int>(transition.new_state)]++;
+                summary.transitions++;
+            }
+            if (results) {
+                results[index] = transition.changed() ? PortEventResult::TRANSITIONED
+                                                      : PortEventResult::NO_TRANSITION;
+            }
+            if (journal_) {
+                journal_records.push_back({port_id, records[index].event, transition.word});
+            }
         }
         
-        switch (new_state) {
-            case PortState::DOWN:
-                metrics_.set_gauge("ports_down", metrics_.get_gauge("ports_down") + 1.0);
-                break;
-            case PortState::INIT:
-                metrics_.set_gauge("ports_init", metrics_.get_gauge("ports_init") + 1.0);
-                break;
-            case PortState::UP:
-                metrics_.set_gauge("ports_up", metrics_.get_gauge("ports_up") + 1.0);
-                break;
+        summary.applied += run_end - run_begin;
+        run_begin = run_end;
+    }
+    
+    if (summary.rejected > 0) {
+        Logger::instance().errorf("PortManager", -1, "Rejected {} events with invalid port IDs",
+                                  summary.rejected);
+    }
+    
+    if (journal_ && !journal_records.empty()) {
+        journal_->append(journal_records.data(), journal_records.size(), now);
+    }
+    
+    publish_event_metrics(summary.applied, summary.transitions, state_deltas);
+    return summary;
+}
+
+PortEventBatchSummary PortManager::process_port_event_range(int first_port, int count,
+                                                            PortEvent event,
+                                                            uint64_t* changed_mask) {
+    PortEventBatchSummary summary;
+    if (count <= 0) {
+        return summary;
+    }
+    
+    if (first_port < 0 || first_port > num_ports_ - count) {
+        Logger::instance().errorf("PortManager", -1, "Invalid port range: [{}, {})",
+                                  first_port, static_cast<int64_t>(first_port) + count);
+        summary.rejected = static_cast<uint64_t>(count);
+        return summary;
+    }
+    
+    int64_t now = PortTable::now_ns();
+    BulkTransitionResult bulk;
+    if (sync_mode_ == PortSyncMode::LOCK_FREE) {
+        bulk = table_.apply_event_range_atomic(first_port, count, event, now, changed_mask);
+        if (journal_) {
+            journal_range(first_port, count, event, now);
+        }
+    } else {
+        lock_stripe_range(first_port, count);
+        bulk = table_.apply_event_range(first_port, count, event, now, changed_mask);
+        if (journal_) {
+            journal_range(first_port, count, event, now);
         }
+        unlock_stripe_range(first_port, count);
     }
     
-    return changed;
+    // Every transition out of a state lands in that state's table entry
+    int64_t state_deltas[3] = {0, 0, 0};
+    for (int state = 0; state < kNumPortStates; state++) {
+        int64_t moved = static_cast<int64_t>(bulk.from_state[state]);
+        state_deltas[state] -= moved;
+        state_deltas[static_cast<int>(kPortTransitionTable.next[state][static_cast<int>(event)])] += moved;
+    }
+    
+    summary.applied = static_cast<uint64_t>(count);
+    summary.transitions = bulk.transitions;
+    publish_event_metrics(summary.applied, summary.transitions, state_deltas);
+    
+    Logger::instance().infof("PortManager", -1, "Applied {} to ports [{}, {}): {} transitions",
+                             event, first_port, first_port + count,
+                             bulk.transitions);
+    
+    return summary;
 }
 
-std::vector<PortState> PortManager::get_all_states() const {
-    std::vector<PortState> states;
-    states.reserve(num_ports_);
+void PortManager::restore_states(const std::vector<PortRecoveryState>& ports) {
+    int64_t state_deltas[3] = {0, 0, 0};
+    int count = static_cast<int>(std::min(ports.size(), static_cast<size_t>(num_ports_)));
+    for (int port_id = 0; port_id < count; port_id++) {
+        const PortRecoveryState& port = ports[port_id];
+        if (port.transitions <= table_.get_transition_count(port_id)) {
+            continue;
+        }
+        PortState old_state = table_.get_state(port_id);
+        table_.restore_port(port_id, port.state, port.transitions, port.last_transition_ns);
+        state_deltas[static_cast<int>(old_state)]--;
+        state_deltas[static_cast<int>(port.state)]++;
+    }
+    population_.apply(state_deltas);
+}
+
+bool PortManager::save_snapshot(const std::string& path) {
+    std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex_);
+    ScopedLatency latency(metrics_, snapshot_metric_);
+    
+    // Only the copy pauses writers, not the file write
+    std::vector<uint64_t> image;
+    if (sync_mode_ == PortSyncMode::MUTEX) {
+        lock_stripe_range(0, num_ports_);
+        image = PortSnapshot::capture(table_);
+        unlock_stripe_range(0, num_ports_);
+    } else {
+        image = PortSnapshot::capture(table_);
+    }
+    if (!PortSnapshot::write(path, image)) {
+        return false;
+    }
+    
+    Logger::instance().infof("PortManager", -1, "Wrote snapshot of {} ports to {}", num_ports_, path);
+    return true;
+}
+
+void PortManager::journal_range(int first_port, int count, PortEvent event, int64_t now_ns) {
+    // Chunked so a whole-table range doesn't stage one record per port
+    constexpr int kChunk = 256;
+    JournalEntry chunk[kChunk];
+    for (int offset = 0; offset < count; offset += kChunk) {
+        int n = std::min(kChunk, count - offset);
+        for (int i = 0; i < n; i++) {
+            int port_id = first_port + offset + i;
+            chunk[i] = {port_id, event, table_.get_word(port_id)};
+        }
+        journal_->append(chunk, static_cast<size_t>(n), now_ns);
+    }
+}
+
+std::unique_lock<std::mutex> PortManager::lock_stripe(int port_id) {
+    std::unique_lock<std::mutex> lock(stripe_for(port_id), std::try_to_lock);
+    if (lock.owns_lock()) {
+        metrics_.observe(lock_wait_metric_, 0);
+        return lock;
+    }
+    uint64_t start = latency_clock_ns();
+    lock.lock();
+    metrics_.observe(lock_wait_metric_, latency_clock_ns() - start);
+    return lock;
+}
+
+void PortManager::lock_stripe_range(int first_port, int count) {
+    int stripes = stripe_mask_ + 1;
+    if (count >= stripes) {
+        for (int i = 0; i < stripes; i++) {
+            stripe_mutexes_[i].lock();
+        }
+        return;
+    }
+    // The range's stripes may wrap past the end of the pool
+    int first = first_port & stripe_mask_;
+    int last = (first_port + count - 1) & stripe_mask_;
+    if (first <= last) {
+        for (int i = first; i <= last; i++) stripe_mutexes_[i].lock();
+    } else {
+        for (int i = 0; i <= last; i++) stripe_mutexes_[i].lock();
+        for (int i = first; i < stripes; i++) stripe_mutexes_[i].lock();
+    }
+}
+
+void PortManager::unlock_stripe_range(int first_port, int count) {
+    int stripes = stripe_mask_ + 1;
+    if (count >= stripes) {
+        for (int i = 0; i < stripes; i++) {
+            stripe_mutexes_[i].unlock();
+        }
+        return;
+    }
+    int first = first_port & stripe_mask_;
+    int last = (first_port + count - 1) & stripe_mask_;
+    if (first <= last) {
+        for (int i = first; i <= last; i++) stripe_mutexes_[i].unlock();
+    } else {
+        for (int i = 0; i <= last; i++) stripe_mutexes_[i].unlock();
+        for (int i = first; i < stripes; i++) stripe_mutexes_[i].unlock();
+    }
+}
+
+void PortManager::publish_event_metrics(uint64_t applied, uint64_t transitions,
+                                        const int64_t state_deltas[3]) {
+    if (applied == 0) {
+        return;
+    }
+    
+    total_events_processed_.fetch_add(applied);
+    metrics_.increment(events_processed_metric_, applied);
     
-    for (int i = 0; i < num_ports_; i++) {
-        std::lock_guard<std::mutex> lock(port_mutexes_[i]);
-        states.push_back(ports_[i]->get_state());
+    if (transitions == 0) {
+        return;
     }
+    metrics_.increment(state_transitions_metric_, transitions);
     
+    // One atomic add publishes the net change of every state's population
+    population_.apply(state_deltas);
+}
+
+std::vector<PortState> PortManager::get_all_states() const {
+    // Linear pass over the packed state words; no per-port locking needed
+    std::vector<PortState> states(num_ports_);
+    table_.copy_states(states.data());
     return states;
 }
 
@@ -100,8 +378,32 @@ PortState PortManager::get_port_state(int port_id) const {
         return PortState::DOWN;
     }
     
-    std::lock_guard<std::mutex> lock(port_mutexes_[port_id]);
-    return ports_[port_id]->get_state();
+    return table_.get_state(port_id);
+}
+
+uint64_t PortManager::get_transition_count(int port_id) const {
+    if (!is_valid_port(port_id)) {
+        return 0;
+    }
+    
+    return table_.get_transition_count(port_id);
+}
+
+std::chrono::steady_clock::time_point PortManager::get_last_transition_time(int port_id) const {
+    if (!is_valid_port(port_id)) {
+        return std::chrono::steady_clock::time_point();
+    }
+    
+    return std::chrono::steady_clock::time_point(
+        std::chrono::nanoseconds(table_.get_last_transition_ns(port_id)));
+}
+
+int PortManager::stripe_count(int num_ports) {
+    int stripes = 1;
+    while (stripes < num_ports && stripes < kMaxLockStripes) {
+        stripes <<= 1;
+    }
+    return stripes;
 }
 
 } // namespace control_plane
@@ -0,0 +1,193 @@
+#include "port_snapshot.h"
+#include "logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace control_plane {
+
+namespace {
+
+constexpr size_t kHeaderWords = sizeof(PortSnapshotHeader) / sizeof(uint64_t);
+
+int64_t realtime_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+uint64_t mix(uint64_t lane, uint64_t word) {
+    lane = (lane ^ word) * 0x9E3779B97F4A7C15ull;
+    return lane ^ (lane >> 29);
+}
+
+// Checksum of a file image: the header with its checksum field zeroed,
+// then the arrays
+uint64_t image_checksum(const uint64_t* image, size_t words) {
+    PortSnapshotHeader header;
+    std::memcpy(&header, image, sizeof(header));
+    header.checksum = 0;
+    uint64_t header_words[kHeaderWords];
+    std::memcpy(header_words, &header, sizeof(header));
+    uint64_t seed = PortSnapshot::checksum(header_words, kHeaderWords);
+    return PortSnapshot::checksum(image + kHeaderWords, words - kHeaderWords, seed);
+}
+
+bool write_all(int fd, const void* data, size_t bytes) {
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t n = ::write(fd, p, bytes);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += n;
+        bytes -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+uint64_t PortSnapshot::checksum(const uint64_t* words, size_t count, uint64_t seed) {
+    // Four independent lanes so the multiplies overlap
+    uint64_t lanes[4] = {seed ^ 0x243F6A8885A308D3ull, seed ^ 0x13198A2E03707344ull,
+                         seed ^ 0xA4093822299F31D0ull, seed ^ 0x082EFA98EC4E6C89ull};
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        lanes[0] = mix(lanes[0], words[i]);
+        lanes[1] = mix(lanes[1], words[i + 1]);
+        lanes[2] = mix(lanes[2], words[i + 2]);
+        lanes[3] = mix(lanes[3], words[i + 3]);
+    }
+    for (; i < count; i++) {
+        lanes[i & 3] = mix(lanes[i & 3], words[i]);
+    }
+    uint64_t h = mix(mix(mix(mix(count, lanes[0]), lanes[1]), lanes[2]), lanes[3]);
+    return mix(h, h >> 32);
+}
+
+std::vector<uint64_t> PortSnapshot::capture(const PortTable& table) {
+    size_t num_ports = static_cast<size_t>(table.size());
+    std::vector<uint64_t> image(kHeaderWords + 2 * num_ports);
+
+    PortSnapshotHeader header{};
+    header.magic = kSnapshotMagic;
+    header.version = kSnapshotVersion;
+    header.num_ports = table.size();
+    header.header_bytes = sizeof(PortSnapshotHeader);
+    header.steady_ns = PortTable::now_ns();
+    header.realtime_ns = realtime_ns();
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    uint64_t* words = image.data() + kHeaderWords;
+    table.copy_words(words, reinterpret_cast<int64_t*>(words + num_ports));
+    return image;
+}
+
+bool PortSnapshot::write(const std::string& path, std::vector<uint64_t>& image) {
+    PortSnapshotHeader header;
+    std::memcpy(&header, image.data(), sizeof(header));
+    header.checksum = image_checksum(image.data(), image.size());
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    std::string temp_path = path + ".tmp";
+    int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        Logger::instance().errorf("PortSnapshot", -1, "Cannot create {}: {}", temp_path, std::strerror(errno));
+        return false;
+    }
+    bool written = write_all(fd, image.data(), image.size() * sizeof(uint64_t)) && fsync(fd) == 0;
+    int error = errno;
+    ::close(fd);
+    if (!written || rename(temp_path.c_str(), path.c_str()) != 0) {
+        error = written ? errno : error;
+        Logger::instance().errorf("PortSnapshot", -1, "Failed to write snapshot {}: {}", path,
+                                  std::strerror(error));
+        unlink(temp_path.c_str());
+        return false;
+    }
+
+    // Make the rename itself durable
+    std::string dir = std::filesystem::path(path).parent_path().string();
+    int dir_fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        ::close(dir_fd);
+    }
+    return true;
+}
+
+bool PortSnapshot::load(const std::string& path, std::optional<PortTable>& table) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        Logger::instance().warnf("PortSnapshot", -1, "Cannot open snapshot {}: {}", path, std::strerror(errno));
+        return false;
+    }
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(PortSnapshotHeader) ||
+        info.st_size % sizeof(uint64_t) != 0) {
+        Logger::instance().warnf("PortSnapshot", -1, "Snapshot {} is truncated", path);
+        ::close(fd);
+        return false;
+    }
+
+    // Private and writable: the mapping becomes the live table, and pages
+    // that ports are written to are copied instead of changing the file
+    size_t bytes = static_cast<size_t>(info.st_size);
+    void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        Logger::instance().warnf("PortSnapshot", -1, "Cannot map snapshot {}: {}", path, std::strerror(errno));
+        return false;
+    }
+    std::shared_ptr<void> storage(map, [bytes](void* p) { munmap(p, bytes); });
+
+    const uint64_t* image = static_cast<const uint64_t*>(map);
+    size_t words = bytes / sizeof(uint64_t);
+    PortSnapshotHeader header;
+    std::memcpy(&header, image, sizeof(header));
+    if (header.magic != kSnapshotMagic || header.version != kSnapshotVersion ||
+        header.header_bytes != sizeof(PortSnapshotHeader) || header.num_ports <= 0) {
+        Logger::instance().warnf("PortSnapshot", -1, "Snapshot {} has an unknown format", path);
+        return false;
+    }
+    size_t num_ports = static_cast<size_t>(header.num_ports);
+    if (words != kHeaderWords + 2 * num_ports) {
+        Logger::instance().warnf("PortSnapshot", -1, "Snapshot {} is {} bytes, expected {} for {} ports",
+                                 path, bytes, (kHeaderWords + 2 * num_ports) * sizeof(uint64_t), num_ports);
+        return false;
+    }
+    if (image_checksum(image, words) != header.checksum) {
+        Logger::instance().warnf("PortSnapshot", -1, "Snapshot {} fails its checksum", path);
+        return false;
+    }
+    const uint64_t* state_words = image + kHeaderWords;
+    uint64_t max_state = 0;
+    for (size_t i = 0; i < num_ports; i++) {
+        max_state = std::max(max_state, state_words[i] & PortTable::kStateMask);
+    }
+    if (max_state >= static_cast<uint64_t>(kNumPortStates)) {
+        Logger::instance().warnf("PortSnapshot", -1, "Snapshot {} holds an invalid port state", path);
+        return false;
+    }
+
+    // Stored times are on the writer's steady clock; carry them over through
+    // the wall clock
+    int64_t time_offset_ns = (PortTable::now_ns() - realtime_ns()) - (header.steady_ns - header.realtime_ns);
+
+    char* base = static_cast<char*>(map) + sizeof(PortSnapshotHeader);
+    table.emplace(header.num_ports, std::move(storage), reinterpret_cast<std::atomic<uint64_t>*>(base),
+                  reinterpret_cast<std::atomic<int64_t>*>(base + num_ports * sizeof(uint64_t)),
+                  time_offset_ns);
+    return true;
+}
+
+} // namespace control_plane
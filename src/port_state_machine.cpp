@@ -1,10 +1,19 @@
 #include "port_state_machine.h"
 #include "logger.h"
-#include <sstream>
+#include <algorithm>
+#include <cctype>
 
 namespace control_plane {
 
 std::string port_state_to_string(PortState state) {
+    return std::string(port_state_name(state));
+}
+
+std::string port_event_to_string(PortEvent event) {
+    return std::string(port_event_name(event));
+}
+
+std::string_view port_state_name(PortState state) {
     switch (state) {
         case PortState::DOWN: return "DOWN";
         case PortState::INIT: return "INIT";
@@ -13,7 +22,40 @@ std::string port_state_to_string(PortState state) {
     }
 }
 
-std::string port_event_to_string(PortEvent event) {
+namespace {
+
+// Compare against an upper-case name, ignoring the case of `str`
+bool equals_upper(std::string_view str, std::string_view name) {
+    return str.size() == name.size() &&
+           std::equal(str.begin(), str.end(), name.begin(), [](char a, char b) {
+               return std::toupper(static_cast<unsigned char>(a)) == b;
+           });
+}
+
+} // namespace
+
+bool parse_port_state(std::string_view str, PortState& state) {
+    for (PortState candidate : {PortState::DOWN, PortState::INIT, PortState::UP}) {
+        if (equals_upper(str, port_state_name(candidate))) {
+            state = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parse_port_event(std::string_view str, PortEvent& event) {
+    for (int i = 0; i < kNumPortEvents; i++) {
+        PortEvent candidate = static_cast<PortEvent>(i);
+        if (equals_upper(str, port_event_name(candidate))) {
+            event = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string_view port_event_name(PortEvent event) {
     switch (event) {
         case PortEvent::POWER_ON: return "POWER_ON";
         case PortEvent::INIT_COMPLETE: return "INIT_COMPLETE";
@@ -29,65 +71,33 @@ PortStateMachine::PortStateMachine(int port_id)
       transition_count_(0),
       last_transition_time_(std::chrono::steady_clock::now()) {
     
-    std::stringstream ss;
-    ss << "Port " << port_id_ << " initialized in DOWN state";
-    Logger::instance().debug(ss.str(), "PortStateMachine", port_id_);
+    Logger::instance().debugf("PortStateMachine", port_id_, "Port {} initialized in DOWN state", port_id_);
 }
 
 bool PortStateMachine::process_event(PortEvent event) {
     PortState old_state = state_;
-    bool state_changed = false;
-    
-    // State machine logic
-    switch (state_) {
-        case PortState::DOWN:
-            if (event == PortEvent::POWER_ON) {
-                transition_to(PortState::INIT);
-                state_changed = true;
-            }
-            break;
-            
-        case PortState::INIT:
-            if (event == PortEvent::INIT_COMPLETE) {
-                transition_to(PortState::UP);
-                state_changed = true;
-            } else if (event == PortEvent::LINK_FLAP) {
-                transition_to(PortState::DOWN);
-                state_changed = true;
-            }
-            break;
-            
-        case PortState::UP:
-            if (event == PortEvent::LINK_FLAP) {
-                transition_to(PortState::DOWN);
-                state_changed = true;
-            }
-            // HEARTBEAT_OK keeps us in UP state (no transition)
-            break;
-    }
+    state_ = next_state(old_state, event);
+    bool state_changed = state_ != old_state;
     
     if (state_changed) {
-        std::stringstream ss;
-        ss << "Port " << port_id_ << " transitioned from " 
-           << port_state_to_string(old_state) << " to " 
-           << port_state_to_string(state_) << " on event " 
-           << port_event_to_string(event);
-        Logger::instance().info(ss.str(), "PortStateMachine", port_id_);
-    } else {
-        std::stringstream ss;
-        ss << "Port " << port_id_ << " received event " 
-           << port_event_to_string(event) << " in state " 
-           << port_state_to_string(state_) << " (no transition)";
-        Logger::instance().debug(ss.str(), "PortStateMachine", port_id_);
+        transition_count_++;
+        last_transition_time_ = std::chrono::steady_clock::now();
     }
     
+    log_port_event(port_id_, old_state, state_, event);
     return state_changed;
 }
 
-void PortStateMachine::transition_to(PortState new_state) {
-    state_ = new_state;
-    transition_count_++;
-    last_transition_time_ = std::chrono::steady_clock::now();
+void log_port_event(int port_id, PortState old_state, PortState new_state, PortEvent event) {
+    if (new_state != old_state) {
+        Logger::instance().infof("PortStateMachine", port_id,
+                                 "Port {} transitioned from {} to {} on event {}", port_id,
+                                 old_state, new_state, event);
+    } else {
+        Logger::instance().debugf("PortStateMachine", port_id,
+                                  "Port {} received event {} in state {} (no transition)", port_id,
+                                  event, new_state);
+    }
 }
 
 } // namespace control_plane
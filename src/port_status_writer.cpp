@@ -0,0 +1,128 @@
+#include "port_status_writer.h"
+#include <algorithm>
+#include <charconv>
+
+namespace control_plane {
+
+namespace {
+
+template <typename T>
+void append_number(std::string& out, T value) {
+    char digits[24];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+} // namespace
+
+PortStatusWriter::PortStatusWriter(const PortTable& table, const PortStatusQuery& query,
+                                   PortStatusFormat format)
+    : table_(table),
+      query_(query),
+      format_(format),
+      now_ns_(PortTable::now_ns()),
+      phase_(Phase::HEADER),
+      next_port_(std::max(query.offset, 0)),
+      written_(0) {
+    chunk_.reserve(kChunkBytes);
+}
+
+std::string_view PortStatusWriter::next_chunk() {
+    chunk_.clear();
+    while (phase_ != Phase::DONE && chunk_.size() + kMaxEntryBytes <= kChunkBytes) {
+        switch (phase_) {
+            case Phase::HEADER:
+                write_header();
+                phase_ = Phase::PORTS;
+                // Send the header on its own so the first byte goes out
+                // before the table is scanned
+                if (!chunk_.empty()) {
+                    return chunk_;
+                }
+                break;
+            case Phase::PORTS:
+                write_ports();
+                break;
+            case Phase::FOOTER:
+                write_footer();
+                phase_ = Phase::DONE;
+                break;
+            case Phase::DONE:
+                break;
+        }
+    }
+    return chunk_;
+}
+
+void PortStatusWriter::write_header() {
+    if (format_ != PortStatusFormat::PAGE) {
+        return;
+    }
+    chunk_ += "{\"total_ports\":";
+    append_number(chunk_, table_.size());
+    chunk_ += ",\"offset\":";
+    append_number(chunk_, next_port_);
+    chunk_ += ",\"limit\":";
+    append_number(chunk_, query_.limit);
+    if (query_.state) {
+        chunk_ += ",\"state\":\"";
+        chunk_ += port_state_name(*query_.state);
+        chunk_ += '"';
+    }
+    chunk_ += ",\"ports\":[";
+}
+
+void PortStatusWriter::write_ports() {
+    // Fill the chunk, stopping at the limit or the end of the table
+    int size = table_.size();
+    while (next_port_ < size && chunk_.size() + kMaxEntryBytes <= kChunkBytes) {
+        if (query_.limit >= 0 && written_ >= query_.limit) {
+            break;
+        }
+        int port_id = next_port_++;
+        uint64_t word = table_.get_word(port_id);
+        if (query_.state && PortTable::word_state(word) != *query_.state) {
+            continue;
+        }
+        write_port(port_id, word);
+        written_++;
+    }
+    if (next_port_ >= size || (query_.limit >= 0 && written_ >= query_.limit)) {
+        phase_ = Phase::FOOTER;
+    }
+}
+
+void PortStatusWriter::write_port(int port_id, uint64_t word) {
+    if (format_ == PortStatusFormat::PAGE && written_ > 0) {
+        chunk_ += ',';
+    }
+    int64_t age_ns = now_ns_ - table_.get_last_transition_ns(port_id);
+    chunk_ += "{\"port_id\":";
+    append_number(chunk_, port_id);
+    chunk_ += ",\"state\":\"";
+    chunk_ += port_state_name(PortTable::word_state(word));
+    chunk_ += "\",\"transitions\":";
+    append_number(chunk_, PortTable::word_transitions(word));
+    chunk_ += ",\"ms_in_state\":";
+    append_number(chunk_, age_ns > 0 ? age_ns / 1000000 : 0);
+    chunk_ += '}';
+    if (format_ == PortStatusFormat::NDJSON) {
+        chunk_ += '\n';
+    }
+}
+
+void PortStatusWriter::write_footer() {
+    if (format_ != PortStatusFormat::PAGE) {
+        return;
+    }
+    // Where the next page starts, if the limit cut this one short
+    chunk_ += "],\"next_offset\":";
+    if (next_port_ < table_.size()) {
+        append_number(chunk_, next_port_);
+    } else {
+        chunk_ += "null";
+    }
+    chunk_ += "}";
+}
+
+} // namespace control_plane
@@ -0,0 +1,222 @@
+#include "port_table.h"
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+namespace control_plane {
+
+PortTable::PortTable(int num_ports)
+    : num_ports_(num_ports),
+      time_offset_ns_(0) {
+    struct HeapArrays {
+        std::unique_ptr<std::atomic<uint64_t>[]> words;
+        std::unique_ptr<std::atomic<int64_t>[]> last_transition_ns;
+    };
+    auto arrays = std::make_shared<HeapArrays>();
+    arrays->words.reset(new std::atomic<uint64_t>[num_ports]);
+    arrays->last_transition_ns.reset(new std::atomic<int64_t>[num_ports]);
+    words_ = arrays->words.get();
+    last_transition_ns_ = arrays->last_transition_ns.get();
+    storage_ = std::move(arrays);
+
+    // Every port starts DOWN with no transitions
+    int64_t now = now_ns();
+    uint64_t initial = make_word(PortState::DOWN, 0, 0);
+    for (int i = 0; i < num_ports_; i++) {
+        words_[i].store(initial, std::memory_order_relaxed);
+        last_transition_ns_[i].store(now, std::memory_order_relaxed);
+    }
+}
+
+PortTable::PortTable(int num_ports, std::shared_ptr<void> storage, std::atomic<uint64_t>* words,
+                     std::atomic<int64_t>* last_transition_ns, int64_t time_offset_ns)
+    : num_ports_(num_ports),
+      storage_(std::move(storage)),
+      words_(words),
+      last_transition_ns_(last_transition_ns),
+      time_offset_ns_(time_offset_ns) {}
+
+PortTransition PortTable::apply_event(int port_id, PortEvent event, int64_t now_ns) {
+    uint64_t word = words_[port_id].load(std::memory_order_relaxed);
+    PortState old_state = word_state(word);
+    PortState new_state = PortStateMachine::next_state(old_state, event);
+
+    if (new_state != old_state) {
+        // Only the lock holder writes, so a plain store is enough
+        word = next_word(word, new_state);
+        record_transition_time(port_id, now_ns);
+        words_[port_id].store(word, std::memory_order_release);
+    }
+
+    log_port_event(port_id, old_state, new_state, event);
+    return {old_state, new_state, word};
+}
+
+PortTransition PortTable::apply_event_atomic(int port_id, PortEvent event, int64_t now_ns) {
+    PortTransition transition = transition_atomic(port_id, event, now_ns);
+    log_port_event(port_id, transition.old_state, transition.new_state, event);
+    return transition;
+}
+
+PortTransition PortTable::transition_atomic(int port_id, PortEvent event, int64_t now_ns) {
+    uint64_t word = words_[port_id].load(std::memory_order_acquire);
+    PortState old_state;
+    PortState new_state;
+
+    while (true) {
+        old_state = word_state(word);
+        new_state = PortStateMachine::next_state(old_state, event);
+        if (new_state == old_state) {
+            break;
+        }
+        // On failure `word` is reloaded and the rule re-evaluated
+        uint64_t desired = next_word(word, new_state);
+        if (words_[port_id].compare_exchange_weak(word, desired,
+                                                  std::memory_order_acq_rel,
+                                                  std::memory_order_acquire)) {
+            record_transition_time(port_id, now_ns);
+            word = desired;
+            break;
+        }
+    }
+
+    return {old_state, new_state, word};
+}
+
+void PortTable::record_transition_time(int port_id, int64_t now_ns) {
+    // Writers timestamp an event before applying it, so a racing transition
+    // can arrive here with an older time than the one already stored
+    int64_t relative = now_ns - time_offset_ns_;
+    std::atomic<int64_t>& slot = last_transition_ns_[port_id];
+    int64_t current = slot.load(std::memory_order_relaxed);
+    while (current < relative &&
+           !slot.compare_exchange_weak(current, relative, std::memory_order_relaxed)) {
+    }
+}
+
+BulkTransitionResult PortTable::apply_event_range(int first_port, int count, PortEvent event,
+                                                  int64_t now_ns, uint64_t* changed_mask) {
+    return apply_range(first_port, count, event, now_ns, changed_mask, false);
+}
+
+BulkTransitionResult PortTable::apply_event_range_atomic(int first_port, int count, PortEvent event,
+                                                         int64_t now_ns, uint64_t* changed_mask) {
+    return apply_range(first_port, count, event, now_ns, changed_mask, true);
+}
+
+BulkTransitionResult PortTable::apply_range(int first_port, int count, PortEvent event,
+                                            int64_t now_ns, uint64_t* changed_mask, bool atomic) {
+    // The kernel runs on a private copy of each block of words; only changed
+    // words are written back, so lock-free readers always see whole words.
+    constexpr int kBlock = 256;
+    constexpr int kMaskWords = kBlock / 64;
+    uint64_t before[kBlock];
+    uint64_t after[kBlock];
+    uint64_t block_mask[kMaskWords];
+
+    BulkTransitionResult result;
+    if (changed_mask) {
+        std::memset(changed_mask, 0, ((static_cast<size_t>(count) + 63) / 64) * sizeof(uint64_t));
+    }
+
+    for (int offset = 0; offset < count; offset += kBlock) {
+        int n = std::min(kBlock, count - offset);
+        int base = first_port + offset;
+        for (int i = 0; i < n; i++) {
+            before[i] = words_[base + i].load(std::memory_order_acquire);
+        }
+        std::memcpy(after, before, n * sizeof(uint64_t));
+
+        BulkTransitionResult block = apply_event_to_words(after, n, event, block_mask);
+
+        for (int w = 0; w < (n + 63) / 64; w++) {
+            for (uint64_t bits = block_mask[w]; bits != 0; bits &= bits - 1) {
+                int i = w * 64 + __builtin_ctzll(bits);
+                int port_id = base + i;
+
+                if (!atomic) {
+                    record_transition_time(port_id, now_ns);
+                    words_[port_id].store(after[i], std::memory_order_release);
+                    continue;
+                }
+
+                uint64_t expected = before[i];
+                if (words_[port_id].compare_exchange_strong(expected, after[i],
+                                                            std::memory_order_acq_rel,
+                                                            std::memory_order_acquire)) {
+                    record_transition_time(port_id, now_ns);
+                    continue;
+                }
+
+                // Lost a race with another writer: undo the kernel's verdict
+                // for this port and apply the event to the current word
+                block.transitions--;
+                block.from_state[static_cast<int>(word_state(before[i]))]--;
+                PortTransition transition = transition_atomic(port_id, event, now_ns);
+                if (transition.changed()) {
+                    block.transitions++;
+                    block.from_state[static_cast<int>(transition.old_state)]++;
+                } else {
+                    block_mask[w] &= ~(1ull << (i % 64));
+                }
+            }
+        }
+
+        result.transitions += block.transitions;
+        for (int s = 0; s < kNumPortStates; s++) {
+            result.from_state[s] += block.from_state[s];
+        }
+        if (changed_mask) {
+            // Blocks are a multiple of 64 ports, so their masks line up
+            std::memcpy(changed_mask + offset / 64, block_mask,
+                        ((n + 63) / 64) * sizeof(uint64_t));
+        }
+    }
+
+    return result;
+}
+
+void PortTable::restore_port(int port_id, PortState state, uint64_t transitions,
+                             int64_t last_transition_ns) {
+    last_transition_ns_[port_id].store(last_transition_ns - time_offset_ns_, std::memory_order_relaxed);
+    words_[port_id].store(make_word(state, transitions, static_cast<uint32_t>(transitions)),
+                          std::memory_order_release);
+}
+
+void PortTable::copy_states(PortState* out) const {
+    for (int i = 0; i < num_ports_; i++) {
+        out[i] = word_state(words_[i].load(std::memory_order_relaxed));
+    }
+}
+
+void PortTable::copy_words(uint64_t* words, int64_t* last_transition_ns) const {
+    for (int i = 0; i < num_ports_; i++) {
+        words[i] = words_[i].load(std::memory_order_acquire);
+        last_transition_ns[i] = last_transition_ns_[i].load(std::memory_order_relaxed) + time_offset_ns_;
+    }
+}
+
+void PortTable::count_states(int64_t counts[kNumPortStates]) const {
+    // Compare-and-add per state rather than counts[state]++, which the
+    // compiler can vectorize
+    int64_t down = 0, init = 0;
+    for (int i = 0; i < num_ports_; i++) {
+        uint64_t state = words_[i].load(std::memory_order_relaxed) & kStateMask;
+        down += state == static_cast<uint64_t>(PortState::DOWN);
+        init += state == static_cast<uint64_t>(PortState::INIT);
+    }
+    counts[static_cast<int>(PortState::DOWN)] = down;
+    counts[static_cast<int>(PortState::INIT)] = init;
+    counts[static_cast<int>(PortState::UP)] = num_ports_ - down - init;
+}
+
+size_t PortTable::memory_bytes() const {
+    return static_cast<size_t>(num_ports_) * (sizeof(words_[0]) + sizeof(last_transition_ns_[0]));
+}
+
+int64_t PortTable::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace control_plane
@@ -0,0 +1,82 @@
+#include "signal_watcher.h"
+#include "logger.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+namespace control_plane {
+
+SignalWatcher::SignalWatcher(std::initializer_list<int> signals)
+    : signal_fd_(-1),
+      wake_fd_(-1) {
+    sigemptyset(&signals_);
+    for (int signal : signals) {
+        sigaddset(&signals_, signal);
+    }
+    pthread_sigmask(SIG_BLOCK, &signals_, nullptr);
+}
+
+SignalWatcher::~SignalWatcher() {
+    stop();
+}
+
+bool SignalWatcher::start(Handler handler) {
+    if (thread_.joinable()) {
+        return true;
+    }
+    signal_fd_ = signalfd(-1, &signals_, SFD_NONBLOCK | SFD_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (signal_fd_ < 0 || wake_fd_ < 0) {
+        Logger::instance().errorf("SignalWatcher", -1, "Cannot create signalfd: {}", std::strerror(errno));
+        for (int* fd : {&signal_fd_, &wake_fd_}) {
+            if (*fd >= 0) {
+                close(*fd);
+            }
+            *fd = -1;
+        }
+        return false;
+    }
+    handler_ = std::move(handler);
+    thread_ = std::thread(&SignalWatcher::run, this);
+    return true;
+}
+
+void SignalWatcher::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd_, &one, sizeof(one));
+    (void)written; // The counter can't overflow here; the thread wakes either way
+    thread_.join();
+    close(signal_fd_);
+    close(wake_fd_);
+    signal_fd_ = wake_fd_ = -1;
+}
+
+void SignalWatcher::run() {
+    pollfd fds[2] = {{signal_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            Logger::instance().errorf("SignalWatcher", -1, "poll failed: {}", std::strerror(errno));
+            return;
+        }
+        if (fds[1].revents != 0) {
+            return;
+        }
+        signalfd_siginfo info;
+        while (read(signal_fd_, &info, sizeof(info)) == static_cast<ssize_t>(sizeof(info))) {
+            handler_(static_cast<int>(info.ssi_signo));
+        }
+    }
+}
+
+} // namespace control_plane
@@ -0,0 +1,131 @@
+#include "timing_wheel.h"
+#include <algorithm>
+
+namespace control_plane {
+
+namespace {
+
+constexpr uint64_t kSlotMask = TimingWheel::kSlotsPerLevel - 1;
+constexpr uint64_t kHorizonMask = (uint64_t(1) << (TimingWheel::kLevelBits * TimingWheel::kLevels)) - 1;
+
+// Mask of the tick bits below `level`
+constexpr uint64_t level_mask(int level) {
+    return (uint64_t(1) << (TimingWheel::kLevelBits * level)) - 1;
+}
+
+} // namespace
+
+TimingWheel::TimingWheel(uint32_t num_timers, uint64_t start_tick)
+    : timers_(num_timers),
+      heads_(kLevels * kSlotsPerLevel + 1, kNil),
+      current_tick_(start_tick),
+      pending_(0) {
+}
+
+void TimingWheel::schedule(uint32_t id, uint64_t deadline, uint8_t kind) {
+    if (is_scheduled(id)) {
+        unlink(id);
+    } else {
+        pending_++;
+    }
+
+    Timer& timer = timers_[id];
+    // Anything already due fires on the next tick
+    timer.deadline = std::max(deadline, current_tick_ + 1);
+    timer.kind = kind;
+    insert(id);
+}
+
+void TimingWheel::cancel(uint32_t id) {
+    if (!is_scheduled(id)) {
+        return;
+    }
+
+    unlink(id);
+    pending_--;
+}
+
+void TimingWheel::advance(uint64_t now, std::vector<Expired>& expired) {
+    while (current_tick_ < now) {
+        current_tick_++;
+        const uint64_t tick = current_tick_;
+
+        // Cascade from the top so timers dropping several levels at once
+        // land in slots that are cascaded later in this same tick
+        if ((tick & kHorizonMask) == 0) {
+            cascade(kOverflowSlot);
+        }
+        for (int level = kLevels - 1; level > 0; level--) {
+            if ((tick & level_mask(level)) == 0) {
+                uint64_t index = (tick >> (kLevelBits * level)) & kSlotMask;
+                cascade(static_cast<uint16_t>(level * kSlotsPerLevel + index));
+            }
+        }
+
+        // Everything left on the level-0 slot for this tick is due now
+        uint16_t slot = static_cast<uint16_t>(tick & kSlotMask);
+        while (heads_[slot] != kNil) {
+            uint32_t id = heads_[slot];
+            unlink(id);
+            pending_--;
+            expired.push_back({id, timers_[id].kind});
+        }
+    }
+}
+
+void TimingWheel::insert(uint32_t id) {
+    Timer& timer = timers_[id];
+
+    // File on the level of the highest 8-bit group that differs from now
+    uint64_t diff = timer.deadline ^ current_tick_;
+    uint16_t slot;
+    if (diff == 0) {
+        slot = static_cast<uint16_t>(timer.deadline & kSlotMask);
+    } else {
+        int level = (63 - __builtin_clzll(diff)) / kLevelBits;
+        if (level >= kLevels) {
+            slot = kOverflowSlot;
+        } else {
+            uint64_t index = (timer.deadline >> (kLevelBits * level)) & kSlotMask;
+            slot = static_cast<uint16_t>(level * kSlotsPerLevel + index);
+        }
+    }
+
+    timer.slot = slot;
+    timer.prev = kNil;
+    timer.next = heads_[slot];
+    if (timer.next != kNil) {
+        timers_[timer.next].prev = id;
+    }
+    heads_[slot] = id;
+}
+
+void TimingWheel::unlink(uint32_t id) {
+    Timer& timer = timers_[id];
+
+    if (timer.prev != kNil) {
+        timers_[timer.prev].next = timer.next;
+    } else {
+        heads_[timer.slot] = timer.next;
+    }
+    if (timer.next != kNil) {
+        timers_[timer.next].prev = timer.prev;
+    }
+
+    timer.next = kNil;
+    timer.prev = kNil;
+    timer.slot = kNoSlot;
+}
+
+void TimingWheel::cascade(uint16_t slot) {
+    uint32_t id = heads_[slot];
+    heads_[slot] = kNil;
+
+    while (id != kNil) {
+        uint32_t next = timers_[id].next;
+        insert(id);
+        id = next;
+    }
+}
+
+} // namespace control_plane
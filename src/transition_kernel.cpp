@@ -0,0 +1,165 @@
+#include "transition_kernel.h"
+#include "port_table.h"
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CONTROL_PLANE_HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+namespace control_plane {
+
+namespace {
+
+constexpr uint64_t kStateMask = PortTable::kStateMask;
+constexpr uint64_t kTransitionField = PortTable::kTransitionMask << PortTable::kTransitionShift;
+constexpr uint64_t kVersionField = PortTable::kVersionMask << PortTable::kVersionShift;
+constexpr uint64_t kTransitionOne = 1ull << PortTable::kTransitionShift;
+constexpr uint64_t kVersionOne = 1ull << PortTable::kVersionShift;
+
+// Word after a transition to `new_state`, matching PortTable::next_word
+inline uint64_t advance_word(uint64_t word, uint64_t new_state) {
+    return new_state |
+           ((word + kTransitionOne) & kTransitionField) |
+           ((word + kVersionOne) & kVersionField);
+}
+
+// Scalar loop over words[begin, end). Mask bits are indexed from words[0].
+void apply_scalar(uint64_t* words, size_t begin, size_t end, PortEvent event,
+                  uint64_t* changed_mask, BulkTransitionResult& result) {
+    int e = static_cast<int>(event);
+    for (size_t i = begin; i < end; i++) {
+        uint64_t word = words[i];
+        uint64_t state = word & kStateMask;
+        uint64_t next = static_cast<uint64_t>(kPortTransitionTable.next[state][e]);
+        if (next != state) {
+            words[i] = advance_word(word, next);
+            result.transitions++;
+            result.from_state[state]++;
+            if (changed_mask) {
+                changed_mask[i / 64] |= 1ull << (i % 64);
+            }
+        }
+    }
+}
+
+#ifdef CONTROL_PLANE_HAVE_AVX2_KERNEL
+
+// Four words per iteration. The event's column of the transition table is a
+// 16-byte shuffle LUT, so the next state of all four lanes is one vpshufb on
+// the lanes' low bytes.
+__attribute__((target("avx2")))
+size_t apply_avx2(uint64_t* words, size_t count, PortEvent event,
+                  uint64_t* changed_mask, BulkTransitionResult& result) {
+    int e = static_cast<int>(event);
+    alignas(16) uint8_t lut[16] = {};
+    for (int s = 0; s < kNumPortStates; s++) {
+        lut[s] = static_cast<uint8_t>(kPortTransitionTable.next[s][e]);
+    }
+    const __m256i lut_vec = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(lut)));
+
+    const __m256i state_mask = _mm256_set1_epi64x(static_cast<long long>(kStateMask));
+    const __m256i transition_field = _mm256_set1_epi64x(static_cast<long long>(kTransitionField));
+    const __m256i version_field = _mm256_set1_epi64x(static_cast<long long>(kVersionField));
+    const __m256i transition_one = _mm256_set1_epi64x(static_cast<long long>(kTransitionOne));
+    const __m256i version_one = _mm256_set1_epi64x(static_cast<long long>(kVersionOne));
+
+    __m256i state_is[kNumPortStates];
+    __m256i from_counts[kNumPortStates];
+    for (int s = 0; s < kNumPortStates; s++) {
+        state_is[s] = _mm256_set1_epi64x(s);
+        from_counts[s] = _mm256_setzero_si256();
+    }
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i word = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+        __m256i state = _mm256_and_si256(word, state_mask);
+        // Bytes other than the state byte index lut[0]; mask them back off
+        __m256i next = _mm256_and_si256(_mm256_shuffle_epi8(lut_vec, state), state_mask);
+        __m256i same = _mm256_cmpeq_epi64(next, state);
+
+        int lane_mask = ~_mm256_movemask_pd(_mm256_castsi256_pd(same)) & 0xF;
+        if (lane_mask == 0) {
+            continue;
+        }
+
+        __m256i advanced = _mm256_or_si256(
+            next,
+            _mm256_or_si256(
+                _mm256_and_si256(_mm256_add_epi64(word, transition_one), transition_field),
+                _mm256_and_si256(_mm256_add_epi64(word, version_one), version_field)));
+        // Unchanged lanes keep their original word
+        __m256i out = _mm256_blendv_epi8(advanced, word, same);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(words + i), out);
+
+        // Changed lanes are all-ones (-1); subtracting counts them per old state
+        __m256i changed = _mm256_andnot_si256(same, _mm256_set1_epi64x(-1));
+        for (int s = 0; s < kNumPortStates; s++) {
+            __m256i hit = _mm256_and_si256(changed, _mm256_cmpeq_epi64(state, state_is[s]));
+            from_counts[s] = _mm256_sub_epi64(from_counts[s], hit);
+        }
+
+        if (changed_mask) {
+            changed_mask[i / 64] |= static_cast<uint64_t>(lane_mask) << (i % 64);
+        }
+    }
+
+    for (int s = 0; s < kNumPortStates; s++) {
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), from_counts[s]);
+        uint64_t total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        result.from_state[s] += total;
+        result.transitions += total;
+    }
+    return i;
+}
+
+bool detect_avx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+} // namespace
+
+bool transition_kernel_uses_avx2() {
+#ifdef CONTROL_PLANE_HAVE_AVX2_KERNEL
+    static const bool supported = detect_avx2();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+BulkTransitionResult apply_event_to_words_scalar(uint64_t* words, size_t count, PortEvent event,
+                                                 uint64_t* changed_mask) {
+    BulkTransitionResult result;
+    if (changed_mask) {
+        std::memset(changed_mask, 0, ((count + 63) / 64) * sizeof(uint64_t));
+    }
+    apply_scalar(words, 0, count, event, changed_mask, result);
+    return result;
+}
+
+BulkTransitionResult apply_event_to_words(uint64_t* words, size_t count, PortEvent event,
+                                          uint64_t* changed_mask) {
+    BulkTransitionResult result;
+    if (changed_mask) {
+        std::memset(changed_mask, 0, ((count + 63) / 64) * sizeof(uint64_t));
+    }
+
+    size_t done = 0;
+#ifdef CONTROL_PLANE_HAVE_AVX2_KERNEL
+    if (transition_kernel_uses_avx2()) {
+        done = apply_avx2(words, count, event, changed_mask, result);
+    }
+#endif
+    // Tail (or everything, without AVX2)
+    apply_scalar(words, done, count, event, changed_mask, result);
+    return result;
+}
+
+} // namespace control_plane
@@ -0,0 +1,162 @@
+#include "work_stealing_executor.h"
+#include "logger.h"
+#include <algorithm>
+
+namespace control_plane {
+
+WorkStealingExecutor::WorkStealingExecutor(int num_workers)
+    : generation_(0),
+      stopping_(false),
+      body_(nullptr),
+      active_workers_(0),
+      remaining_chunks_(0) {
+
+    int count = resolve_worker_count(num_workers);
+    workers_.reserve(count);
+    for (int i = 0; i < count; i++) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (int i = 0; i < count; i++) {
+        workers_[i]->thread = std::thread(&WorkStealingExecutor::worker_loop, this, i);
+    }
+
+    Logger::instance().infof("WorkStealingExecutor", -1, "WorkStealingExecutor started with {} workers",
+                             count);
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(batch_mutex_);
+        stopping_ = true;
+    }
+    batch_cv_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+void WorkStealingExecutor::run(const std::vector<uint32_t>& shard_bounds, uint32_t chunk_size,
+                               const Body& body) {
+    if (chunk_size == 0) {
+        chunk_size = 1;
+    }
+
+    // Seed each worker's deque with the chunks of its own shard
+    uint32_t total_chunks = 0;
+    int num_workers = get_num_workers();
+    for (int w = 0; w < num_workers; w++) {
+        std::lock_guard<std::mutex> lock(workers_[w]->mutex);
+        for (uint32_t begin = shard_bounds[w]; begin < shard_bounds[w + 1]; begin += chunk_size) {
+            uint32_t end = std::min(begin + chunk_size, shard_bounds[w + 1]);
+            workers_[w]->chunks.push_back({begin, end});
+            total_chunks++;
+        }
+    }
+
+    if (total_chunks == 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(batch_mutex_);
+    body_ = &body;
+    remaining_chunks_.store(total_chunks);
+    generation_++;
+    batch_cv_.notify_all();
+
+    // Wait until the work is done and no worker is still inside the batch,
+    // so none of them can pick up the next batch's chunks with this body
+    done_cv_.wait(lock, [this]() {
+        return remaining_chunks_.load() == 0 && active_workers_ == 0;
+    });
+    body_ = nullptr;
+}
+
+uint64_t WorkStealingExecutor::get_items_processed(int worker_id) const {
+    return workers_[worker_id]->items_processed.load(std::memory_order_relaxed);
+}
+
+uint64_t WorkStealingExecutor::get_steals(int worker_id) const {
+    return workers_[worker_id]->steals.load(std::memory_order_relaxed);
+}
+
+int WorkStealingExecutor::resolve_worker_count(int configured) {
+    if (configured > 0) {
+        return configured;
+    }
+    unsigned int hw = std::thread::hardware_concurrency();
+    return hw > 0 ? static_cast<int>(hw) : 1;
+}
+
+void WorkStealingExecutor::worker_loop(int worker_id) {
+    Worker& self = *workers_[worker_id];
+    uint64_t seen_generation = 0;
+
+    while (true) {
+        const Body* body;
+        {
+            std::unique_lock<std::mutex> lock(batch_mutex_);
+            batch_cv_.wait(lock, [&]() { return stopping_ || generation_ != seen_generation; });
+            if (stopping_) {
+                return;
+            }
+            seen_generation = generation_;
+            body = body_;
+            if (body == nullptr) {
+                // Woke after the batch had already completed
+                continue;
+            }
+            active_workers_++;
+        }
+
+        Chunk chunk;
+        bool stolen;
+        while (next_chunk(worker_id, chunk, stolen)) {
+            (*body)(worker_id, chunk.begin, chunk.end);
+
+            self.items_processed.fetch_add(chunk.end - chunk.begin, std::memory_order_relaxed);
+            if (stolen) {
+                self.steals.fetch_add(1, std::memory_order_relaxed);
+            }
+            remaining_chunks_.fetch_sub(1);
+        }
+
+        std::lock_guard<std::mutex> lock(batch_mutex_);
+        if (--active_workers_ == 0) {
+            done_cv_.notify_one();
+        }
+    }
+}
+
+bool WorkStealingExecutor::next_chunk(int worker_id, Chunk& chunk, bool& stolen) {
+    // Own work first, newest chunk (still warm in cache)
+    {
+        Worker& self = *workers_[worker_id];
+        std::lock_guard<std::mutex> lock(self.mutex);
+        if (!self.chunks.empty()) {
+            chunk = self.chunks.back();
+            self.chunks.pop_back();
+            stolen = false;
+            return true;
+        }
+    }
+
+    // Steal the oldest chunk from the next non-empty victim
+    int num_workers = get_num_workers();
+    for (int i = 1; i < num_workers; i++) {
+        Worker& victim = *workers_[(worker_id + i) % num_workers];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.front();
+            victim.chunks.pop_front();
+            stolen = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace control_plane
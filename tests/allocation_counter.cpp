@@ -0,0 +1,53 @@
+#include "allocation_counter.h"
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+thread_local bool g_counting = false;
+thread_local uint64_t g_allocations = 0;
+
+void* counted_alloc(size_t size, size_t alignment) {
+    if (g_counting) {
+        g_allocations++;
+    }
+    void* ptr;
+    if (alignment <= alignof(std::max_align_t)) {
+        ptr = std::malloc(size ? size : 1);
+    } else {
+        ptr = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+} // namespace
+
+AllocationCounter::AllocationCounter() {
+    g_allocations = 0;
+    g_counting = true;
+}
+
+AllocationCounter::~AllocationCounter() { g_counting = false; }
+
+uint64_t AllocationCounter::count() const { return g_allocations; }
+
+void* operator new(size_t size) { return counted_alloc(size, 0); }
+void* operator new[](size_t size) { return counted_alloc(size, 0); }
+void* operator new(size_t size, std::align_val_t align) {
+    return counted_alloc(size, static_cast<size_t>(align));
+}
+void* operator new[](size_t size, std::align_val_t align) {
+    return counted_alloc(size, static_cast<size_t>(align));
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
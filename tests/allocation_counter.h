@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts heap allocations made by the current thread while in scope.
+// allocation_counter.cpp replaces the global operator new for the whole test
+// binary; it only counts inside an AllocationCounter scope.
+class AllocationCounter {
+public:
+    AllocationCounter();
+    ~AllocationCounter();
+
+    AllocationCounter(const AllocationCounter&) = delete;
+    AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+    uint64_t count() const;
+};
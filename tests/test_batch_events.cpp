@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "port_manager.h"
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace control_plane;
+
+class BatchEventsTest : public ::testing::TestWithParam<PortSyncMode> {};
+
+TEST_P(BatchEventsTest, AppliesEventsInPerPortOrder) {
+    PortManager manager(4, GetParam());
+    
+    // Interleaved ports: port 1's events must still apply in order
+    std::vector<PortEventRecord> records = {
+        {1, PortEvent::POWER_ON},
+        {0, PortEvent::POWER_ON},
+        {1, PortEvent::INIT_COMPLETE},
+        {3, PortEvent::HEARTBEAT_OK},
+        {1, PortEvent::HEARTBEAT_OK},
+    };
+    std::vector<PortEventResult> results(records.size());
+    
+    PortEventBatchSummary summary = manager.process_port_events(records.data(), records.size(),
+                                                                results.data());
+    
+    EXPECT_EQ(summary.applied, 5u);
+    EXPECT_EQ(summary.transitions, 3u);
+    EXPECT_EQ(summary.rejected, 0u);
+    EXPECT_EQ(results[0], PortEventResult::TRANSITIONED);
+    EXPECT_EQ(results[1], PortEventResult::TRANSITIONED);
+    EXPECT_EQ(results[2], PortEventResult::TRANSITIONED);
+    EXPECT_EQ(results[3], PortEventResult::NO_TRANSITION);
+    EXPECT_EQ(results[4], PortEventResult::NO_TRANSITION);
+    
+    EXPECT_EQ(manager.get_port_state(0), PortState::INIT);
+    EXPECT_EQ(manager.get_port_state(1), PortState::UP);
+    EXPECT_EQ(manager.get_port_state(3), PortState::DOWN);
+}
+
+TEST_P(BatchEventsTest, RejectsInvalidPorts) {
+    PortManager manager(2, GetParam());
+    std::vector<PortEventRecord> records = {
+        {-1, PortEvent::POWER_ON},
+        {0, PortEvent::POWER_ON},
+        {2, PortEvent::POWER_ON},
+    };
+    std::vector<PortEventResult> results(records.size());
+    
+    PortEventBatchSummary summary = manager.process_port_events(records.data(), records.size(),
+                                                                results.data());
+    
+    EXPECT_EQ(summary.applied, 1u);
+    EXPECT_EQ(summary.rejected, 2u);
+    EXPECT_EQ(results[0], PortEventResult::INVALID_PORT);
+    EXPECT_EQ(results[1], PortEventResult::TRANSITIONED);
+    EXPECT_EQ(results[2], PortEventResult::INVALID_PORT);
+    EXPECT_EQ(manager.get_total_events_processed(), 1u);
+}
+
+TEST_P(BatchEventsTest, MatchesSingleEventPath) {
+    const int num_ports = 32;
+    PortManager batched(num_ports, GetParam());
+    PortManager single(num_ports, GetParam());
+    
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> port_dist(0, num_ports - 1);
+    std::uniform_int_distribution<int> event_dist(0, 3);
+    
+    for (int round = 0; round < 50; round++) {
+        std::vector<PortEventRecord> records(64);
+        for (auto& record : records) {
+            record = {port_dist(rng), static_cast<PortEvent>(event_dist(rng))};
+        }
+        batched.process_port_events(records.data(), records.size());
+        for (const auto& record : records) {
+            single.process_port_event(record.port_id, record.event);
+        }
+    }
+    
+    EXPECT_EQ(batched.get_all_states(), single.get_all_states());
+    for (int port_id = 0; port_id < num_ports; port_id++) {
+        EXPECT_EQ(batched.get_transition_count(port_id), single.get_transition_count(port_id));
+    }
+    
+    const Metrics& a = batched.get_metrics();
+    const Metrics& b = single.get_metrics();
+    EXPECT_EQ(a.get_counter("events_processed_total"), b.get_counter("events_processed_total"));
+    EXPECT_EQ(a.get_counter("state_transitions_total"), b.get_counter("state_transitions_total"));
+    EXPECT_DOUBLE_EQ(a.get_gauge("ports_down"), b.get_gauge("ports_down"));
+    EXPECT_DOUBLE_EQ(a.get_gauge("ports_init"), b.get_gauge("ports_init"));
+    EXPECT_DOUBLE_EQ(a.get_gauge("ports_up"), b.get_gauge("ports_up"));
+}
+
+TEST_P(BatchEventsTest, ConcurrentBatchesOnDisjointPorts) {
+    const int num_threads = 4;
+    const int ports_per_thread = 64;
+    PortManager manager(num_threads * ports_per_thread, GetParam());
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&manager, t]() {
+            std::vector<PortEventRecord> records;
+            for (int p = 0; p < ports_per_thread; p++) {
+                records.push_back({t * ports_per_thread + p, PortEvent::POWER_ON});
+                records.push_back({t * ports_per_thread + p, PortEvent::INIT_COMPLETE});
+            }
+            manager.process_port_events(records.data(), records.size());
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    EXPECT_DOUBLE_EQ(manager.get_metrics().get_gauge("ports_up"), num_threads * ports_per_thread);
+    EXPECT_DOUBLE_EQ(manager.get_metrics().get_gauge("ports_down"), 0.0);
+    EXPECT_EQ(manager.get_total_events_processed(), 2u * num_threads * ports_per_thread);
+}
+
+INSTANTIATE_TEST_SUITE_P(SyncModes, BatchEventsTest,
+                         ::testing::Values(PortSyncMode::MUTEX, PortSyncMode::LOCK_FREE));
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include "log_decoder.h"
+#include "logger.h"
+#include "port_manager.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace control_plane;
+
+namespace {
+
+std::string read_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+// Split into lines with the timestamp value removed (the two runs differ)
+std::vector<std::string> lines_without_timestamps(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        size_t start = line.find("\"timestamp\":\"");
+        if (start != std::string::npos) {
+            start += 13;
+            line.erase(start, line.find('"', start) - start);
+        }
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+// One of every argument type, plus untemplated and escaped messages
+void log_sample_records() {
+    Logger& logger = Logger::instance();
+    logger.infof("PortStateMachine", 3, "Port {} transitioned from {} to {} on event {}",
+                 3, PortState::INIT, PortState::UP, PortEvent::INIT_COMPLETE);
+    logger.warnf("Bench", -1, "ints {} {} {} {}", -7, int64_t(INT64_MIN), uint64_t(UINT64_MAX), 0);
+    logger.errorf("", 12, "floats {} {} and {} {} {}", 0.1, 2.5f, true, false, 'q');
+    logger.infof("EventLoop", -1, "text \"{}\" and {}", std::string("quoted\n"), "literal");
+    logger.infof("EventLoop", -1, "fewer args {} {}", 1);
+    logger.infof("EventLoop", -1, "no placeholders", 1, 2);
+    logger.info("plain message with \\ backslash", "main");
+    logger.error("no component");
+    logger.infof("PortStateMachine", 4, "Port {} transitioned from {} to {} on event {}",
+                 4, PortState::UP, PortState::DOWN, PortEvent::LINK_FLAP);
+}
+
+} // namespace
+
+class BinaryLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Logger::instance().set_level(LogLevel::INFO);
+    }
+
+    void TearDown() override {
+        Logger::instance().stop_async();
+        Logger::instance().set_format(LogOutputFormat::JSON);
+        Logger::instance().set_output_fd(STDOUT_FILENO);
+        for (const auto& path : paths_) {
+            std::remove(path.c_str());
+        }
+    }
+
+    // Run `body` with the logger writing `format` to a fresh temp file;
+    // returns the file contents
+    template <typename Body>
+    std::string capture(LogOutputFormat format, bool async, Body body) {
+        char path[] = "/tmp/binary_log_test_XXXXXX";
+        int fd = mkstemp(path);
+        EXPECT_GE(fd, 0);
+        paths_.push_back(path);
+
+        EXPECT_TRUE(Logger::instance().set_format(format));
+        Logger::instance().set_output_fd(fd);
+        if (async) {
+            Logger::instance().start_async(256, LogOverflowPolicy::BLOCK);
+        }
+        body();
+        Logger::instance().stop_async();
+        Logger::instance().set_output_fd(STDOUT_FILENO);
+        ::close(fd);
+        return read_file(path);
+    }
+
+    std::vector<std::string> paths_;
+};
+
+TEST_F(BinaryLogTest, DecodedBinaryMatchesJsonOutput) {
+    for (bool async : {false, true}) {
+        std::string json = capture(LogOutputFormat::JSON, async, log_sample_records);
+        std::string binary = capture(LogOutputFormat::BINARY, async, log_sample_records);
+        ASSERT_EQ(binary.compare(0, sizeof(kBinaryLogMagic),
+                                 std::string(kBinaryLogMagic, sizeof(kBinaryLogMagic))), 0);
+
+        BinaryLogDecoder decoder;
+        std::string decoded;
+        ASSERT_TRUE(decoder.feed(binary.data(), binary.size(), decoded)) << decoder.error();
+        EXPECT_TRUE(decoder.at_frame_boundary());
+        EXPECT_EQ(decoder.records_decoded(), 9u);
+
+        std::vector<std::string> expected = lines_without_timestamps(json);
+        ASSERT_EQ(expected.size(), 9u);
+        EXPECT_EQ(lines_without_timestamps(decoded), expected) << (async ? "async" : "sync");
+    }
+}
+
+TEST_F(BinaryLogTest, DecoderAcceptsInputInAnyPieces) {
+    std::string binary = capture(LogOutputFormat::BINARY, false, log_sample_records);
+
+    BinaryLogDecoder whole;
+    std::string expected;
+    ASSERT_TRUE(whole.feed(binary.data(), binary.size(), expected));
+
+    BinaryLogDecoder bytewise;
+    std::string decoded;
+    for (char byte : binary) {
+        ASSERT_TRUE(bytewise.feed(&byte, 1, decoded)) << bytewise.error();
+    }
+    EXPECT_EQ(decoded, expected);
+    EXPECT_TRUE(bytewise.at_frame_boundary());
+
+    // A stream cut mid-record leaves a partial frame behind
+    BinaryLogDecoder cut;
+    std::string partial;
+    ASSERT_TRUE(cut.feed(binary.data(), binary.size() - 3, partial));
+    EXPECT_FALSE(cut.at_frame_boundary());
+    EXPECT_EQ(cut.records_decoded(), 8u);
+}
+
+TEST_F(BinaryLogTest, DecoderRejectsMalformedStreams) {
+    std::string out;
+    BinaryLogDecoder no_header;
+    EXPECT_FALSE(no_header.feed("\x03garbage", 8, out));
+    EXPECT_FALSE(no_header.error().empty());
+
+    std::string bad_frame(kBinaryLogMagic, sizeof(kBinaryLogMagic));
+    bad_frame += '\x7f';
+    BinaryLogDecoder unknown;
+    EXPECT_FALSE(unknown.feed(bad_frame.data(), bad_frame.size(), out));
+
+    // A record naming a template that was never defined
+    std::string undefined(kBinaryLogMagic, sizeof(kBinaryLogMagic));
+    const char record[] = {3, 1, 0, 0, 9, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1, -1, -1, -1, 0};
+    undefined.append(record, sizeof(record));
+    BinaryLogDecoder missing;
+    EXPECT_FALSE(missing.feed(undefined.data(), undefined.size(), out));
+}
+
+TEST_F(BinaryLogTest, EachOutputStartsItsOwnStream) {
+    auto log_transition = []() {
+        Logger::instance().infof("PortStateMachine", 1, "Port {} is {}", 1, PortState::UP);
+    };
+    capture(LogOutputFormat::BINARY, false, log_transition);
+    std::string second = capture(LogOutputFormat::BINARY, false, log_transition);
+
+    // The second file repeats the header and definitions, so it decodes alone
+    BinaryLogDecoder decoder;
+    std::string decoded;
+    ASSERT_TRUE(decoder.feed(second.data(), second.size(), decoded)) << decoder.error();
+    EXPECT_NE(decoded.find("\"message\":\"Port 1 is UP\""), std::string::npos) << decoded;
+}
+
+TEST_F(BinaryLogTest, FormatCannotChangeWhileAsync) {
+    Logger::instance().start_async(64, LogOverflowPolicy::BLOCK);
+    EXPECT_FALSE(Logger::instance().set_format(LogOutputFormat::BINARY));
+    EXPECT_EQ(Logger::instance().get_format(), LogOutputFormat::JSON);
+    Logger::instance().stop_async();
+    EXPECT_TRUE(Logger::instance().set_format(LogOutputFormat::BINARY));
+}
+
+TEST_F(BinaryLogTest, TransitionLogsAreAtLeastFiveTimesSmaller) {
+    auto flap_storm = []() {
+        PortManager manager(64, PortSyncMode::MUTEX);
+        for (int round = 0; round < 20; round++) {
+            for (int port = 0; port < 64; port++) {
+                manager.process_port_event(port, PortEvent::POWER_ON);
+                manager.process_port_event(port, PortEvent::INIT_COMPLETE);
+                manager.process_port_event(port, PortEvent::LINK_FLAP);
+            }
+        }
+    };
+    std::string json = capture(LogOutputFormat::JSON, false, flap_storm);
+    std::string binary = capture(LogOutputFormat::BINARY, false, flap_storm);
+
+    ASSERT_GT(binary.size(), 0u);
+    double ratio = static_cast<double>(json.size()) / static_cast<double>(binary.size());
+    EXPECT_GE(ratio, 5.0) << json.size() << " JSON bytes vs " << binary.size() << " binary bytes";
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "config.h"
+#include <cstdio>
 #include <fstream>
 #include <vector>
 
@@ -116,7 +117,7 @@ TEST_F(ConfigTest, ConfigValidation) {
     // Invalid ports_count
     config.ports_count = 0;
     EXPECT_FALSE(config.validate());
-    config.ports_count = 1001;
+    config.ports_count = Config::kMaxPorts + 1;
     EXPECT_FALSE(config.validate());
     
     // Reset to valid
@@ -175,3 +176,194 @@ TEST_F(ConfigTest, ConfigToString) {
     EXPECT_NE(str.find("http_port: 9090"), std::string::npos);
     EXPECT_NE(str.find("seed: 12345"), std::string::npos);
 }
+
+TEST_F(ConfigTest, WorkerThreadsValidation) {
+    Config config;
+    EXPECT_EQ(config.worker_threads, 0); // Default: one per hardware thread
+    EXPECT_TRUE(config.validate());
+    
+    config.worker_threads = 16;
+    EXPECT_TRUE(config.validate());
+    
+    config.worker_threads = -1;
+    EXPECT_FALSE(config.validate());
+    config.worker_threads = 257;
+    EXPECT_FALSE(config.validate());
+    
+    const char* argv[] = {"test", "--worker-threads", "4"};
+    config.apply_cli_args(3, const_cast<char**>(argv));
+    EXPECT_EQ(config.worker_threads, 4);
+}
+
+TEST_F(ConfigTest, PortSyncValidation) {
+    Config config;
+    EXPECT_EQ(config.port_sync, "mutex");
+    EXPECT_TRUE(config.validate());
+    
+    config.port_sync = "lock_free";
+    EXPECT_TRUE(config.validate());
+    
+    config.port_sync = "spinlock";
+    EXPECT_FALSE(config.validate());
+}
+
+TEST_F(ConfigTest, LogOutputValidation) {
+    Config config;
+    EXPECT_EQ(config.log_mode, "sync");
+    EXPECT_EQ(config.log_queue_capacity, 8192);
+    EXPECT_EQ(config.log_overflow, "block");
+    EXPECT_TRUE(config.validate());
+    
+    config.log_mode = "buffered";
+    EXPECT_FALSE(config.validate());
+    config.log_mode = "async";
+    EXPECT_TRUE(config.validate());
+    
+    config.log_queue_capacity = 63;
+    EXPECT_FALSE(config.validate());
+    config.log_queue_capacity = 1048577;
+    EXPECT_FALSE(config.validate());
+    config.log_queue_capacity = 1024;
+    
+    config.log_overflow = "spill";
+    EXPECT_FALSE(config.validate());
+    config.log_overflow = "block";
+    
+    EXPECT_EQ(config.log_format, "json");
+    config.log_format = "protobuf";
+    EXPECT_FALSE(config.validate());
+    config.log_format = "binary";
+    EXPECT_TRUE(config.validate());
+    
+    const char* argv[] = {"test", "--log-mode", "sync", "--log-queue-capacity", "256",
+                          "--log-overflow", "drop"};
+    config.apply_cli_args(7, const_cast<char**>(argv));
+    EXPECT_EQ(config.log_mode, "sync");
+    EXPECT_EQ(config.log_queue_capacity, 256);
+    EXPECT_EQ(config.log_overflow, "drop");
+    EXPECT_TRUE(config.validate());
+}
+
+TEST_F(ConfigTest, LogRateLimitValidation) {
+    Config config;
+    EXPECT_EQ(config.log_rate_limit, 0.0);
+    EXPECT_EQ(config.log_rate_burst, 20);
+    EXPECT_TRUE(config.validate());
+    
+    config.log_rate_limit = -1.0;
+    EXPECT_FALSE(config.validate());
+    config.log_rate_limit = 5.0;
+    EXPECT_TRUE(config.validate());
+    
+    config.log_rate_burst = 0;
+    EXPECT_FALSE(config.validate());
+    config.log_rate_burst = 1;
+    EXPECT_TRUE(config.validate());
+    
+    const char* argv[] = {"test", "--log-rate-limit", "2.5", "--log-rate-burst", "8"};
+    config.apply_cli_args(5, const_cast<char**>(argv));
+    EXPECT_DOUBLE_EQ(config.log_rate_limit, 2.5);
+    EXPECT_EQ(config.log_rate_burst, 8);
+    EXPECT_TRUE(config.validate());
+}
+
+TEST_F(ConfigTest, InitLatencyValidation) {
+    Config config;
+    EXPECT_EQ(config.init_latency_distribution, "uniform");
+    EXPECT_EQ(config.init_latency_min_ms, 200);
+    EXPECT_EQ(config.init_latency_max_ms, 200);
+    EXPECT_TRUE(config.validate());
+    
+    config.init_latency_distribution = "normal";
+    EXPECT_FALSE(config.validate());
+    config.init_latency_distribution = "exponential";
+    EXPECT_TRUE(config.validate());
+    
+    config.init_latency_min_ms = -1;
+    EXPECT_FALSE(config.validate());
+    config.init_latency_min_ms = 300;
+    EXPECT_FALSE(config.validate());
+    config.init_latency_max_ms = 2000;
+    EXPECT_TRUE(config.validate());
+    
+    std::string path = "/tmp/cp_config_test_init_latency.yaml";
+    {
+        std::ofstream file(path);
+        file << "init_latency_distribution: \" exponential \"\n"
+             << "init_latency_min_ms: 50\n"
+             << "init_latency_max_ms: 900\n";
+    }
+    Config loaded = Config::load_from_file(path);
+    std::remove(path.c_str());
+    EXPECT_EQ(loaded.init_latency_distribution, "exponential");
+    EXPECT_EQ(loaded.init_latency_min_ms, 50);
+    EXPECT_EQ(loaded.init_latency_max_ms, 900);
+    EXPECT_NE(loaded.to_string().find("init_latency_max_ms: 900"), std::string::npos);
+}
+
+TEST_F(ConfigTest, TickSchedulerValidation) {
+    Config config;
+    EXPECT_EQ(config.tick_catch_up, "burst");
+    EXPECT_EQ(config.tick_lag_threshold_ms, 1000);
+    EXPECT_EQ(config.tick_lag_sustain_ms, 5000);
+    EXPECT_TRUE(config.validate());
+    
+    config.tick_catch_up = "drop";
+    EXPECT_FALSE(config.validate());
+    config.tick_catch_up = "skip";
+    EXPECT_TRUE(config.validate());
+    
+    config.tick_lag_threshold_ms = -1;
+    EXPECT_FALSE(config.validate());
+    config.tick_lag_threshold_ms = 0;
+    EXPECT_TRUE(config.validate());
+    config.tick_lag_sustain_ms = -1;
+    EXPECT_FALSE(config.validate());
+    
+    std::string path = "/tmp/cp_config_test_tick_scheduler.yaml";
+    {
+        std::ofstream file(path);
+        file << "tick_catch_up: \" skip \"\n"
+             << "tick_lag_threshold_ms: 250\n"
+             << "tick_lag_sustain_ms: 2000\n";
+    }
+    Config loaded = Config::load_from_file(path);
+    std::remove(path.c_str());
+    EXPECT_EQ(loaded.tick_catch_up, "skip");
+    EXPECT_EQ(loaded.tick_lag_threshold_ms, 250);
+    EXPECT_EQ(loaded.tick_lag_sustain_ms, 2000);
+    
+    const char* argv[] = {"test", "--tick-catch-up", "burst", "--tick-lag-threshold-ms", "40",
+                          "--tick-lag-sustain-ms", "300"};
+    loaded.apply_cli_args(7, const_cast<char**>(argv));
+    EXPECT_EQ(loaded.tick_catch_up, "burst");
+    EXPECT_EQ(loaded.tick_lag_threshold_ms, 40);
+    EXPECT_EQ(loaded.tick_lag_sustain_ms, 300);
+    EXPECT_TRUE(loaded.validate());
+    
+    const char* negative[] = {"test", "--tick-lag-sustain-ms", "-5"};
+    loaded.apply_cli_args(3, const_cast<char**>(negative));
+    EXPECT_FALSE(loaded.validate());
+}
+
+TEST_F(ConfigTest, AcceptsMillionsOfPorts) {
+    Config config;
+    for (int ports : {1001, 1000000, 10000000, Config::kMaxPorts}) {
+        config.ports_count = ports;
+        EXPECT_TRUE(config.validate()) << ports;
+    }
+    
+    std::string path = "/tmp/cp_config_test_ports.yaml";
+    {
+        std::ofstream file(path);
+        file << "ports_count: 1000000\n";
+    }
+    Config loaded = Config::load_from_file(path);
+    std::remove(path.c_str());
+    EXPECT_EQ(loaded.ports_count, 1000000);
+    
+    const char* argv[] = {"test", "--ports", "10000000"};
+    loaded.apply_cli_args(3, const_cast<char**>(argv));
+    EXPECT_EQ(loaded.ports_count, 10000000);
+    EXPECT_TRUE(loaded.validate());
+}
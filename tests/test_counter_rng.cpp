@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "counter_rng.h"
+#include <set>
+#include <vector>
+
+using namespace control_plane;
+
+// Known-answer vectors from the Random123 distribution (philox4x32_10)
+TEST(Philox4x32Test, MatchesReferenceVectors) {
+    EXPECT_EQ(Philox4x32::generate({0, 0, 0, 0}, {0, 0}),
+              (Philox4x32::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(Philox4x32::generate({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}),
+              (Philox4x32::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    EXPECT_EQ(Philox4x32::generate({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}),
+              (Philox4x32::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+TEST(CounterRngTest, DrawsDependOnlyOnTheirCoordinates) {
+    CounterRng rng(42);
+    CounterRng::Block first = rng.draw(7, 1000);
+    // Other draws in between change nothing
+    for (uint32_t port = 0; port < 100; port++) {
+        rng.draw(port, 999);
+    }
+    EXPECT_EQ(rng.draw(7, 1000), first);
+    EXPECT_EQ(CounterRng(42).draw(7, 1000), first);
+
+    // Every coordinate and the seed select a different block
+    EXPECT_NE(rng.draw(8, 1000), first);
+    EXPECT_NE(rng.draw(7, 1001), first);
+    EXPECT_NE(rng.draw(7, 1000 + (1ull << 32)), first);
+    EXPECT_NE(rng.draw(7, 1000, 1), first);
+    EXPECT_NE(CounterRng(43).draw(7, 1000), first);
+    EXPECT_NE(CounterRng(42 + (1ull << 32)).draw(7, 1000), first);
+}
+
+TEST(CounterRngTest, UnitDrawsAreUniform) {
+    CounterRng rng(12345);
+    const int n = 200000;
+    const int buckets = 20;
+    std::vector<int> counts(buckets, 0);
+    double sum = 0;
+    for (int i = 0; i < n; i++) {
+        CounterRng::Block draw = rng.draw(static_cast<uint32_t>(i % 1000), static_cast<uint64_t>(i / 1000));
+        double u = CounterRng::to_unit(draw[0], draw[1]);
+        ASSERT_GE(u, 0.0);
+        ASSERT_LT(u, 1.0);
+        sum += u;
+        counts[static_cast<int>(u * buckets)]++;
+    }
+    EXPECT_NEAR(sum / n, 0.5, 0.005);
+
+    // Chi-square with 19 degrees of freedom; 43.8 is the 0.1% critical value
+    double expected = static_cast<double>(n) / buckets;
+    double chi_square = 0;
+    for (int count : counts) {
+        chi_square += (count - expected) * (count - expected) / expected;
+    }
+    EXPECT_LT(chi_square, 43.8);
+
+    EXPECT_EQ(CounterRng::to_unit(0, 0), 0.0);
+    EXPECT_LT(CounterRng::to_unit(0xffffffff, 0xffffffff), 1.0);
+}
+
+TEST(CounterRngTest, RangeDrawsCoverTheRange) {
+    CounterRng rng(7);
+    std::set<uint64_t> seen;
+    for (uint32_t port = 0; port < 10000; port++) {
+        CounterRng::Block draw = rng.draw(port, 0);
+        uint64_t value = CounterRng::to_range(draw[2], draw[3], 10);
+        ASSERT_LT(value, 10u);
+        seen.insert(value);
+    }
+    EXPECT_EQ(seen.size(), 10u);
+    EXPECT_EQ(CounterRng::to_range(0xffffffff, 0xffffffff, 10), 9u);
+    EXPECT_EQ(CounterRng::to_range(0, 0, 10), 0u);
+    EXPECT_EQ(CounterRng::to_range(0x12345678, 0x9abcdef0, 1), 0u);
+}
@@ -2,11 +2,53 @@
 #include "event_loop.h"
 #include "port_manager.h"
 #include "config.h"
+#include "logger.h"
+#include <unistd.h>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
 #include <thread>
 #include <chrono>
 
 using namespace control_plane;
 
+namespace {
+
+// Run a simulation until it has done config.duration_ticks ticks
+void run_to_completion(EventLoop& loop) {
+    loop.start();
+    while (!loop.is_finished()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    loop.stop();
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+std::vector<TraceRecord> parse_trace(const std::string& trace) {
+    std::vector<TraceRecord> records(trace.size() / sizeof(TraceRecord));
+    std::memcpy(records.data(), trace.data(), records.size() * sizeof(TraceRecord));
+    return records;
+}
+
+size_t count_events(const std::string& trace, PortEvent event) {
+    size_t count = 0;
+    for (size_t offset = 0; offset + sizeof(TraceRecord) <= trace.size(); offset += sizeof(TraceRecord)) {
+        TraceRecord record;
+        std::memcpy(&record, trace.data() + offset, sizeof(record));
+        count += record.event == event;
+    }
+    return count;
+}
+
+} // namespace
+
 class DeterminismTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -16,6 +58,8 @@ protected:
         config.flap_probability = 0.5; // High probability for testing
         config.flap_min_ms = 10;
         config.flap_max_ms = 20;
+        config.init_latency_min_ms = 20; // Two ticks
+        config.init_latency_max_ms = 20;
         config.seed = 12345; // Fixed seed
     }
     
@@ -23,37 +67,27 @@ protected:
 };
 
 TEST_F(DeterminismTest, SameSeedProducesSameSequence) {
-    // Run simulation twice with same seed and compare results
+    // Run the same ticks twice with the same seed, on different numbers of
+    // workers, and compare every port
+    config.duration_ticks = 12;
     
-    // First run
+    config.worker_threads = 1;
     auto port_manager1 = std::make_shared<PortManager>(config.ports_count);
     EventLoop loop1(port_manager1, config);
+    run_to_completion(loop1);
     
-    loop1.start();
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    loop1.stop();
-    
-    uint64_t events1 = port_manager1->get_total_events_processed();
-    auto states1 = port_manager1->get_all_states();
-    
-    // Second run with same seed
+    config.worker_threads = 4;
     auto port_manager2 = std::make_shared<PortManager>(config.ports_count);
     EventLoop loop2(port_manager2, config);
+    run_to_completion(loop2);
     
-    loop2.start();
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    loop2.stop();
-    
-    uint64_t events2 = port_manager2->get_total_events_processed();
-    auto states2 = port_manager2->get_all_states();
-    
-    // With same seed, we should see similar behavior (not exactly same due to threading,
-    // but event counts should be in same ballpark)
-    EXPECT_GT(events1, 0);
-    EXPECT_GT(events2, 0);
-    
-    // States should have same distribution pattern
-    EXPECT_EQ(states1.size(), states2.size());
+    EXPECT_GT(port_manager1->get_total_events_processed(), 0u);
+    EXPECT_EQ(port_manager1->get_total_events_processed(), port_manager2->get_total_events_processed());
+    EXPECT_EQ(port_manager1->get_all_states(), port_manager2->get_all_states());
+    for (int port = 0; port < config.ports_count; port++) {
+        EXPECT_EQ(port_manager1->get_transition_count(port), port_manager2->get_transition_count(port))
+            << "port " << port;
+    }
 }
 
 TEST_F(DeterminismTest, DifferentSeedsProduceDifferentSequences) {
@@ -105,3 +139,245 @@ TEST_F(DeterminismTest, TickCountIncrementsMonotonically) {
     EXPECT_GT(tick2, tick1);
     EXPECT_GT(tick3, tick2);
 }
+
+
+class DiscreteModeTest : public DeterminismTest {
+protected:
+    void SetUp() override {
+        DeterminismTest::SetUp();
+        Logger::instance().set_level(LogLevel::ERROR);
+        config.ports_count = 64;
+        config.tick_ms = 100;
+        config.flap_probability = 0.05;
+        config.flap_min_ms = 100;
+        config.flap_max_ms = 2000;
+        config.init_latency_min_ms = 200;
+        config.init_latency_max_ms = 200;
+        config.mode = "discrete";
+        config.duration_ticks = 5000;
+    }
+    
+    void TearDown() override {
+        for (const auto& path : trace_paths_) {
+            std::remove(path.c_str());
+        }
+        Logger::instance().set_level(LogLevel::INFO);
+    }
+    
+    std::string trace_path(int run) {
+        std::string path = "/tmp/cp_trace_test_" + std::to_string(getpid()) + "_" + std::to_string(run);
+        trace_paths_.push_back(path);
+        return path;
+    }
+    
+    std::vector<std::string> trace_paths_;
+};
+
+TEST_F(DiscreteModeTest, SameSeedProducesBitIdenticalTrace) {
+    std::string traces[2];
+    uint64_t hashes[2];
+    std::vector<PortState> states[2];
+    for (int run = 0; run < 2; run++) {
+        config.trace_path = trace_path(run);
+        auto port_manager = std::make_shared<PortManager>(config.ports_count);
+        EventLoop loop(port_manager, config);
+        run_to_completion(loop);
+        
+        EXPECT_EQ(loop.get_tick_count(), config.duration_ticks);
+        EXPECT_EQ(loop.get_trace().get_count(), port_manager->get_total_events_processed());
+        hashes[run] = loop.get_trace().get_hash();
+        traces[run] = read_file(config.trace_path);
+        states[run] = port_manager->get_all_states();
+        EXPECT_EQ(traces[run].size(), loop.get_trace().get_count() * sizeof(TraceRecord));
+    }
+    
+    EXPECT_GT(count_events(traces[0], PortEvent::LINK_FLAP), 0u);
+    EXPECT_EQ(hashes[0], hashes[1]);
+    EXPECT_TRUE(traces[0] == traces[1]);
+    EXPECT_EQ(states[0], states[1]);
+}
+
+TEST_F(DiscreteModeTest, DifferentSeedsProduceDifferentTraces) {
+    uint64_t hashes[2];
+    for (int run = 0; run < 2; run++) {
+        config.seed = 1000 + run;
+        auto port_manager = std::make_shared<PortManager>(config.ports_count);
+        EventLoop loop(port_manager, config);
+        run_to_completion(loop);
+        hashes[run] = loop.get_trace().get_hash();
+    }
+    EXPECT_NE(hashes[0], hashes[1]);
+}
+
+TEST_F(DiscreteModeTest, RunsFasterThanRealTime) {
+    // A simulated day at 100 ms ticks
+    config.duration_ticks = 24 * 3600 * 10;
+    auto port_manager = std::make_shared<PortManager>(config.ports_count);
+    EventLoop loop(port_manager, config);
+    auto started = std::chrono::steady_clock::now();
+    run_to_completion(loop);
+    auto elapsed = std::chrono::steady_clock::now() - started;
+    
+    EXPECT_EQ(loop.get_tick_count(), config.duration_ticks);
+    EXPECT_LT(elapsed, std::chrono::seconds(60));
+    EXPECT_GT(port_manager->get_metrics().get_counter("link_flaps_injected_total"), 0u);
+}
+
+TEST_F(DiscreteModeTest, SameTraceWithAnyNumberOfWorkers) {
+    config.ports_count = 3000;
+    config.flap_probability = 0.02;
+    config.duration_ticks = 1000;
+    uint64_t expected_hash = 0;
+    uint64_t expected_count = 0;
+    for (int workers : {1, 2, 3, 8, 64}) {
+        config.worker_threads = workers;
+        auto port_manager = std::make_shared<PortManager>(config.ports_count);
+        EventLoop loop(port_manager, config);
+        run_to_completion(loop);
+        
+        if (workers == 1) {
+            expected_hash = loop.get_trace().get_hash();
+            expected_count = loop.get_trace().get_count();
+            EXPECT_GT(port_manager->get_metrics().get_counter("link_flaps_injected_total"), 0u);
+            continue;
+        }
+        EXPECT_EQ(loop.get_trace().get_hash(), expected_hash) << workers << " workers";
+        EXPECT_EQ(loop.get_trace().get_count(), expected_count) << workers << " workers";
+    }
+}
+
+TEST_F(DiscreteModeTest, MatchesRealtimeMode) {
+    // Short enough to run in real time
+    config.tick_ms = 1;
+    config.flap_min_ms = 1;
+    config.flap_max_ms = 20;
+    config.init_latency_min_ms = 2;
+    config.init_latency_max_ms = 2;
+    config.flap_probability = 0.2;
+    config.worker_threads = 1;
+    config.duration_ticks = 60;
+    auto discrete_manager = std::make_shared<PortManager>(config.ports_count);
+    EventLoop discrete(discrete_manager, config);
+    run_to_completion(discrete);
+    
+    // Same events, paced by the wall clock on more workers (tracing needs a
+    // trace file here)
+    config.mode = "realtime";
+    config.worker_threads = 4;
+    config.trace_path = trace_path(0);
+    auto realtime_manager = std::make_shared<PortManager>(config.ports_count);
+    EventLoop realtime(realtime_manager, config);
+    run_to_completion(realtime);
+    
+    EXPECT_EQ(discrete.get_tick_count(), realtime.get_tick_count());
+    EXPECT_GT(discrete_manager->get_metrics().get_counter("link_flaps_injected_total"), 0u);
+    EXPECT_EQ(discrete.get_trace().get_hash(), realtime.get_trace().get_hash());
+    EXPECT_EQ(discrete_manager->get_all_states(), realtime_manager->get_all_states());
+}
+
+TEST_F(DiscreteModeTest, InitLatencyFollowsConfiguredDistribution) {
+    config.ports_count = 4000;
+    config.flap_probability = 0.0;
+    config.duration_ticks = 25;
+    
+    // Every port powers on at tick 1; its INIT_COMPLETE tick gives the latency
+    auto init_latencies = [&]() {
+        config.trace_path = trace_path(static_cast<int>(trace_paths_.size()));
+        auto port_manager = std::make_shared<PortManager>(config.ports_count);
+        EventLoop loop(port_manager, config);
+        run_to_completion(loop);
+        std::map<uint64_t, int> latencies;
+        for (const TraceRecord& record : parse_trace(read_file(config.trace_path))) {
+            if (record.event == PortEvent::INIT_COMPLETE) {
+                latencies[record.tick - 1]++;
+            }
+        }
+        return latencies;
+    };
+    
+    // Uniform over [1, 1000] ms: 1 to 10 ticks, equally often
+    config.init_latency_min_ms = 1;
+    config.init_latency_max_ms = 1000;
+    std::map<uint64_t, int> uniform = init_latencies();
+    ASSERT_EQ(uniform.size(), 10u);
+    EXPECT_EQ(uniform.begin()->first, 1u);
+    EXPECT_EQ(uniform.rbegin()->first, 10u);
+    for (uint64_t ticks = 1; ticks <= 10; ticks++) {
+        EXPECT_NEAR(uniform[ticks], config.ports_count / 10.0, 100) << ticks << " ticks";
+    }
+    
+    // Exponential: 100 ms plus a tail with mean 1000 ms cut off at 2000 ms,
+    // so 73% of ports are done within 1100 ms and none after 2100 ms
+    config.init_latency_distribution = "exponential";
+    config.init_latency_min_ms = 100;
+    config.init_latency_max_ms = 2100;
+    std::map<uint64_t, int> exponential = init_latencies();
+    EXPECT_GE(exponential.begin()->first, 1u);
+    EXPECT_LE(exponential.rbegin()->first, 21u);
+    int within = 0;
+    for (const auto& [ticks, ports] : exponential) {
+        within += ticks <= 11 ? ports : 0;
+    }
+    double expected = (1 - std::exp(-1.0)) / (1 - std::exp(-2.0));
+    EXPECT_NEAR(within / static_cast<double>(config.ports_count), expected, 0.03);
+    EXPECT_GT(exponential[2], exponential[20]);
+}
+
+TEST_F(DiscreteModeTest, FlapStormLeavesHeartbeatCadenceAlone) {
+    // Realtime, with long flaps on a third of the UP ports each cycle: flapped
+    // ports wait on their own recovery timers, and no worker waits with them
+    config.mode = "realtime";
+    config.tick_ms = 10;
+    config.ports_count = 1000;
+    config.worker_threads = 2;
+    config.flap_probability = 0.3;
+    config.flap_min_ms = 2000;
+    config.flap_max_ms = 5000;
+    config.init_latency_min_ms = 20;
+    config.init_latency_max_ms = 20;
+    config.duration_ticks = 100;
+    config.trace_path = trace_path(0);
+    auto port_manager = std::make_shared<PortManager>(config.ports_count);
+    EventLoop loop(port_manager, config);
+    auto started = std::chrono::steady_clock::now();
+    run_to_completion(loop);
+    auto elapsed = std::chrono::steady_clock::now() - started;
+    
+    // The ticks kept up with the wall clock
+    EXPECT_LT(elapsed, std::chrono::milliseconds(config.tick_ms * config.duration_ticks * 3 / 2));
+    
+    std::vector<std::vector<TraceRecord>> by_port(config.ports_count);
+    size_t flaps = 0;
+    for (const TraceRecord& record : parse_trace(read_file(config.trace_path))) {
+        by_port[record.port_id].push_back(record);
+        flaps += record.event == PortEvent::LINK_FLAP;
+    }
+    EXPECT_GT(flaps, 500u);
+    
+    int unaffected = 0;
+    for (int port = 0; port < config.ports_count; port++) {
+        const auto& events = by_port[port];
+        bool flapped = false;
+        uint64_t last_heartbeat = 0;
+        for (const TraceRecord& record : events) {
+            if (record.event == PortEvent::LINK_FLAP) {
+                // Held DOWN until recovery, which is beyond the end of the run
+                EXPECT_EQ(&record, &events.back()) << "port " << port;
+                flapped = true;
+            } else if (record.event == PortEvent::HEARTBEAT_OK) {
+                if (last_heartbeat != 0) {
+                    uint64_t gap = record.tick - last_heartbeat;
+                    EXPECT_GE(gap, EventLoop::kHeartbeatTicks - 1) << "port " << port;
+                    EXPECT_LE(gap, EventLoop::kHeartbeatTicks + 1) << "port " << port;
+                }
+                last_heartbeat = record.tick;
+            }
+        }
+        if (!flapped) {
+            unaffected++;
+            EXPECT_GT(last_heartbeat, config.duration_ticks - EventLoop::kHeartbeatTicks - 1)
+                << "port " << port;
+        }
+    }
+    EXPECT_GT(unaffected, 0);
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include "allocation_counter.h"
+#include "event_ingest.h"
+#include "logger.h"
+#include "port_manager.h"
+#include <string>
+#include <vector>
+
+using namespace control_plane;
+
+namespace {
+
+std::string binary_record(int32_t port_id, uint8_t event) {
+    uint32_t bits = static_cast<uint32_t>(port_id);
+    std::string out;
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<char>((bits >> shift) & 0xFF));
+    }
+    out.push_back(static_cast<char>(event));
+    return out;
+}
+
+class EventIngestTest : public ::testing::Test {
+protected:
+    void SetUp() override { Logger::instance().set_level(LogLevel::ERROR); }
+    void TearDown() override { Logger::instance().set_level(LogLevel::INFO); }
+};
+
+} // namespace
+
+TEST(EventIngestParseTest, ParsesEventObjects) {
+    PortEventRecord record{};
+    EXPECT_TRUE(parse_event_json("{\"port_id\":3,\"event\":\"POWER_ON\"}", record));
+    EXPECT_EQ(record.port_id, 3);
+    EXPECT_EQ(record.event, PortEvent::POWER_ON);
+
+    EXPECT_TRUE(parse_event_json(" { \"event\" : \"link_flap\" , \"port_id\" : 12 }\r", record));
+    EXPECT_EQ(record.port_id, 12);
+    EXPECT_EQ(record.event, PortEvent::LINK_FLAP);
+
+    // Numeric events, negative ports (rejected later) and ignored keys
+    EXPECT_TRUE(parse_event_json("{\"port_id\":-1,\"event\":3,\"note\":\"a \\\"b\\\"\",\"x\":1.5,"
+                                 "\"y\":null}", record));
+    EXPECT_EQ(record.port_id, -1);
+    EXPECT_EQ(record.event, PortEvent::HEARTBEAT_OK);
+}
+
+TEST(EventIngestParseTest, RejectsMalformedObjects) {
+    PortEventRecord record{};
+    EXPECT_FALSE(parse_event_json("{\"port_id\":3}", record));
+    EXPECT_FALSE(parse_event_json("{\"event\":\"POWER_ON\"}", record));
+    EXPECT_FALSE(parse_event_json("{}", record));
+    EXPECT_FALSE(parse_event_json("{\"port_id\":3,\"event\":\"REBOOT\"}", record));
+    EXPECT_FALSE(parse_event_json("{\"port_id\":3,\"event\":4}", record));
+    EXPECT_FALSE(parse_event_json("{\"port_id\":\"3\",\"event\":0}", record));
+    EXPECT_FALSE(parse_event_json("{\"port_id\":3000000000,\"event\":0}", record));
+    EXPECT_FALSE(parse_event_json("{\"port_id\":3,\"event\":0} trailing", record));
+    EXPECT_FALSE(parse_event_json("{\"port_id\":3,\"event\":0,\"meta\":{}}", record));
+    EXPECT_FALSE(parse_event_json("{\"port_id\":3,\"event\":0", record));
+    EXPECT_FALSE(parse_event_json("[1,2]", record));
+}
+
+TEST(EventIngestParseTest, MapsContentTypes) {
+    EventIngestFormat format = EventIngestFormat::BINARY;
+    EXPECT_TRUE(parse_event_ingest_format("application/x-ndjson", format));
+    EXPECT_EQ(format, EventIngestFormat::NDJSON);
+    EXPECT_TRUE(parse_event_ingest_format("application/octet-stream", format));
+    EXPECT_EQ(format, EventIngestFormat::BINARY);
+    EXPECT_TRUE(parse_event_ingest_format("application/json; charset=utf-8", format));
+    EXPECT_EQ(format, EventIngestFormat::NDJSON);
+    EXPECT_FALSE(parse_event_ingest_format("application/x-www-form-urlencoded", format));
+    EXPECT_FALSE(parse_event_ingest_format("", format));
+}
+
+TEST_F(EventIngestTest, NdjsonBodyReportsAppliedRejectedAndTransitions) {
+    PortManager manager(4);
+    std::string body =
+        "{\"port_id\":0,\"event\":\"POWER_ON\"}\n"
+        "{\"port_id\":0,\"event\":\"INIT_COMPLETE\"}\n"
+        "\n"
+        "{\"port_id\":1,\"event\":\"POWER_ON\"}\r\n"
+        "{\"port_id\":0,\"event\":\"HEARTBEAT_OK\"}\n"
+        "{\"port_id\":9,\"event\":\"POWER_ON\"}\n"
+        "not json\n"
+        "{\"port_id\":2,\"event\":\"POWER_ON\"}";
+
+    EventIngestSummary summary = ingest_events(manager, body, EventIngestFormat::NDJSON);
+    EXPECT_EQ(summary.applied, 5u);
+    EXPECT_EQ(summary.transitions, 4u);
+    EXPECT_EQ(summary.rejected, 2u);
+    EXPECT_EQ(summary.malformed, 1u);
+    EXPECT_EQ(manager.get_port_state(0), PortState::UP);
+    EXPECT_EQ(manager.get_port_state(1), PortState::INIT);
+    EXPECT_EQ(manager.get_port_state(2), PortState::INIT);
+    EXPECT_EQ(manager.get_port_state(3), PortState::DOWN);
+}
+
+TEST_F(EventIngestTest, BinaryBodyDecodesPackedRecords) {
+    PortManager manager(4);
+    std::string body = binary_record(3, 0) + binary_record(3, 1) + binary_record(-5, 0) +
+                       binary_record(2, 7) + binary_record(1, 0) + std::string("\x01\x00", 2);
+
+    EventIngestSummary summary = ingest_events(manager, body, EventIngestFormat::BINARY);
+    EXPECT_EQ(summary.applied, 3u);
+    EXPECT_EQ(summary.transitions, 3u);
+    EXPECT_EQ(summary.rejected, 3u);  // Port -5, event 7, trailing partial record
+    EXPECT_EQ(summary.malformed, 2u);
+    EXPECT_EQ(manager.get_port_state(3), PortState::UP);
+    EXPECT_EQ(manager.get_port_state(1), PortState::INIT);
+}
+
+TEST_F(EventIngestTest, LargeBodyMatchesDirectBatches) {
+    const int num_ports = 1000;
+    const size_t num_events = 300000;
+    static const char* cycle[] = {"POWER_ON", "INIT_COMPLETE", "HEARTBEAT_OK", "LINK_FLAP"};
+
+    std::vector<PortEventRecord> records(num_events);
+    std::string ndjson;
+    std::string binary;
+    for (size_t i = 0; i < num_events; i++) {
+        int port_id = static_cast<int>((i * 7919) % num_ports);
+        int event = static_cast<int>((i / num_ports) % 4);
+        records[i] = {port_id, static_cast<PortEvent>(event)};
+        ndjson += "{\"port_id\":" + std::to_string(port_id) + ",\"event\":\"" + cycle[event] + "\"}\n";
+        binary += binary_record(port_id, static_cast<uint8_t>(event));
+    }
+
+    PortManager direct(num_ports);
+    PortEventBatchSummary expected = direct.process_port_events(records.data(), records.size());
+
+    PortManager from_ndjson(num_ports);
+    EventIngestSummary summary = ingest_events(from_ndjson, ndjson, EventIngestFormat::NDJSON);
+    EXPECT_EQ(summary.applied, num_events);
+    EXPECT_EQ(summary.rejected, 0u);
+    EXPECT_EQ(summary.transitions, expected.transitions);
+    EXPECT_EQ(from_ndjson.get_all_states(), direct.get_all_states());
+
+    PortManager from_binary(num_ports);
+    summary = ingest_events(from_binary, binary, EventIngestFormat::BINARY);
+    EXPECT_EQ(summary.applied, num_events);
+    EXPECT_EQ(summary.transitions, expected.transitions);
+    EXPECT_EQ(from_binary.get_all_states(), direct.get_all_states());
+}
+
+TEST_F(EventIngestTest, IngestDoesNotAllocatePerRecord) {
+    const int num_ports = 64;
+    std::string ndjson;
+    std::string binary;
+    for (int i = 0; i < 20000; i++) {
+        ndjson += "{\"port_id\":" + std::to_string(i % num_ports) + ",\"event\":\"HEARTBEAT_OK\"}\n";
+        binary += binary_record(i % num_ports, 3);
+    }
+    PortManager manager(num_ports);
+    ingest_events(manager, ndjson, EventIngestFormat::NDJSON); // Warm up thread shards
+
+    {
+        AllocationCounter allocations;
+        ingest_events(manager, ndjson, EventIngestFormat::NDJSON);
+        EXPECT_EQ(allocations.count(), 0u);
+    }
+    {
+        AllocationCounter allocations;
+        ingest_events(manager, binary, EventIngestFormat::BINARY);
+        EXPECT_EQ(allocations.count(), 0u);
+    }
+}
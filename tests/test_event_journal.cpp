@@ -0,0 +1,257 @@
+#include <gtest/gtest.h>
+#include "event_journal.h"
+#include "logger.h"
+#include "port_manager.h"
+#include <unistd.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace control_plane;
+
+namespace {
+
+class EventJournalTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Logger::instance().set_level(LogLevel::ERROR);
+        static std::atomic<int> next_id(0);
+        dir_ = "/tmp/cp_journal_test_" + std::to_string(getpid()) + "_" +
+               std::to_string(next_id.fetch_add(1));
+        std::filesystem::remove_all(dir_);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir_);
+        Logger::instance().set_level(LogLevel::INFO);
+    }
+
+    // A manager journaling to dir_
+    std::shared_ptr<PortManager> make_manager(int num_ports, size_t segment_bytes,
+                                              PortSyncMode mode = PortSyncMode::MUTEX) {
+        auto manager = std::make_shared<PortManager>(num_ports, mode);
+        auto journal = std::make_shared<EventJournal>(dir_, num_ports, manager->get_metrics(),
+                                                      segment_bytes);
+        EXPECT_TRUE(journal->open());
+        manager->set_journal(journal);
+        managers_.push_back(manager);
+        journals_.push_back(journal);
+        return manager;
+    }
+
+    // A fresh manager rebuilt from dir_
+    std::unique_ptr<PortManager> recover(int num_ports, JournalReplay* replay_out = nullptr) {
+        JournalReplay replay;
+        EXPECT_TRUE(EventJournal::replay(dir_, num_ports, replay));
+        auto manager = std::make_unique<PortManager>(num_ports);
+        manager->restore_states(replay.ports);
+        if (replay_out) {
+            *replay_out = replay;
+        }
+        return manager;
+    }
+
+    void close_journals() {
+        for (auto& journal : journals_) {
+            journal->close();
+        }
+    }
+
+    static void expect_same_ports(const PortManager& expected, const PortManager& actual) {
+        ASSERT_EQ(expected.get_num_ports(), actual.get_num_ports());
+        for (int port = 0; port < expected.get_num_ports(); port++) {
+            EXPECT_EQ(actual.get_port_state(port), expected.get_port_state(port)) << "port " << port;
+            EXPECT_EQ(actual.get_transition_count(port), expected.get_transition_count(port))
+                << "port " << port;
+        }
+        PortPopulation::Counts want = expected.get_population().snapshot();
+        PortPopulation::Counts got = actual.get_population().snapshot();
+        EXPECT_EQ(got.down, want.down);
+        EXPECT_EQ(got.init, want.init);
+        EXPECT_EQ(got.up, want.up);
+    }
+
+    std::string dir_;
+    // Journals report to their manager's metrics, so they are closed
+    // (destroyed) before the managers
+    std::vector<std::shared_ptr<PortManager>> managers_;
+    std::vector<std::shared_ptr<EventJournal>> journals_;
+};
+
+} // namespace
+
+TEST_F(EventJournalTest, ReplayRebuildsPortStates) {
+    auto manager = make_manager(8, EventJournal::kDefaultSegmentBytes);
+    manager->process_port_event(0, PortEvent::POWER_ON);
+    manager->process_port_event(0, PortEvent::INIT_COMPLETE);
+    manager->process_port_event(0, PortEvent::HEARTBEAT_OK);
+    manager->process_port_event(1, PortEvent::POWER_ON);
+    manager->process_port_event(2, PortEvent::POWER_ON);
+    manager->process_port_event(2, PortEvent::INIT_COMPLETE);
+    manager->process_port_event(2, PortEvent::LINK_FLAP);
+    manager->process_port_event(9, PortEvent::POWER_ON); // Invalid, not journaled
+    close_journals();
+
+    JournalReplay replay;
+    auto recovered = recover(8, &replay);
+    EXPECT_EQ(replay.segments, 1u);
+    EXPECT_EQ(replay.records, 7u);
+    EXPECT_EQ(replay.corrupt, 0u);
+    expect_same_ports(*manager, *recovered);
+    EXPECT_EQ(recovered->get_port_state(0), PortState::UP);
+    EXPECT_EQ(recovered->get_transition_count(2), 3u);
+
+    // The recovered transition time is close to the original one
+    auto age = std::chrono::steady_clock::now() - recovered->get_last_transition_time(0);
+    EXPECT_GE(age, std::chrono::nanoseconds(0));
+    EXPECT_LT(age, std::chrono::seconds(5));
+}
+
+TEST_F(EventJournalTest, BatchAndRangePathsAreJournaled) {
+    auto manager = make_manager(300, EventJournal::kDefaultSegmentBytes);
+    manager->process_port_event_range(0, 300, PortEvent::POWER_ON);
+    std::vector<PortEventRecord> batch;
+    for (int port = 0; port < 300; port += 3) {
+        batch.push_back({port, PortEvent::INIT_COMPLETE});
+        batch.push_back({port + 1, PortEvent::LINK_FLAP});
+    }
+    batch.push_back({1000, PortEvent::POWER_ON});
+    manager->process_port_events(batch.data(), batch.size());
+    manager->process_port_event_range(100, 50, PortEvent::LINK_FLAP);
+    close_journals();
+
+    JournalReplay replay;
+    auto recovered = recover(300, &replay);
+    EXPECT_EQ(replay.records, 300u + 200u + 50u);
+    expect_same_ports(*manager, *recovered);
+}
+
+TEST_F(EventJournalTest, RollsSegmentsAtSizeLimit) {
+    // Room for 252 records per segment
+    auto manager = make_manager(16, EventJournal::kMinSegmentBytes);
+    static const PortEvent cycle[] = {PortEvent::POWER_ON, PortEvent::INIT_COMPLETE,
+                                      PortEvent::HEARTBEAT_OK, PortEvent::LINK_FLAP};
+    for (int i = 0; i < 2000; i++) {
+        manager->process_port_event(i % 16, cycle[(i / 16) % 4]);
+    }
+    // Batches larger than a segment are split across segments
+    std::vector<PortEventRecord> batch(500, PortEventRecord{5, PortEvent::HEARTBEAT_OK});
+    manager->process_port_events(batch.data(), batch.size());
+    close_journals();
+
+    EXPECT_EQ(EventJournal::list_segments(dir_).size(), (2500u + 251u) / 252u);
+    JournalReplay replay;
+    auto recovered = recover(16, &replay);
+    EXPECT_EQ(replay.records, 2500u);
+    expect_same_ports(*manager, *recovered);
+}
+
+TEST_F(EventJournalTest, ConcurrentWritersReplayExactly) {
+    for (PortSyncMode mode : {PortSyncMode::MUTEX, PortSyncMode::LOCK_FREE}) {
+        std::filesystem::remove_all(dir_);
+        journals_.clear();
+        managers_.clear();
+        const int num_ports = 64;
+        auto manager = make_manager(num_ports, 64 * 1024, mode);
+
+        // Threads share every port, so records of one port interleave
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&, t]() {
+                static const PortEvent cycle[] = {PortEvent::POWER_ON, PortEvent::INIT_COMPLETE,
+                                                  PortEvent::HEARTBEAT_OK, PortEvent::LINK_FLAP};
+                for (int i = 0; i < 20000; i++) {
+                    manager->process_port_event((i * 7 + t) % num_ports, cycle[(i + t) % 4]);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        close_journals();
+
+        JournalReplay replay;
+        auto recovered = recover(num_ports, &replay);
+        EXPECT_EQ(replay.records, 80000u);
+        expect_same_ports(*manager, *recovered);
+    }
+}
+
+TEST_F(EventJournalTest, ReplaysUncleanSegmentsAndSkipsDamage) {
+    auto manager = make_manager(4, EventJournal::kDefaultSegmentBytes);
+    manager->process_port_event(0, PortEvent::POWER_ON);
+    manager->process_port_event(0, PortEvent::INIT_COMPLETE);
+    manager->process_port_event(1, PortEvent::POWER_ON);
+    journals_[0]->commit();
+    EXPECT_EQ(journals_[0]->get_records_committed(), 3u);
+
+    // Copy the live, preallocated segment as a crash would leave it
+    std::string crash_dir = dir_ + "/crash";
+    std::filesystem::create_directories(crash_dir);
+    std::vector<std::string> segments = EventJournal::list_segments(dir_);
+    ASSERT_EQ(segments.size(), 1u);
+    std::string copy = crash_dir + "/" + std::filesystem::path(segments[0]).filename().string();
+    std::filesystem::copy_file(segments[0], copy);
+    EXPECT_EQ(std::filesystem::file_size(copy), EventJournal::kDefaultSegmentBytes -
+              (EventJournal::kDefaultSegmentBytes - sizeof(JournalSegmentHeader)) % sizeof(JournalRecord));
+
+    JournalReplay replay;
+    ASSERT_TRUE(EventJournal::replay(crash_dir, 4, replay));
+    EXPECT_EQ(replay.records, 3u);
+    EXPECT_EQ(replay.ports[0].state, PortState::UP);
+    EXPECT_EQ(replay.ports[1].state, PortState::INIT);
+
+    // Damage the second record: port 0 falls back to its first transition
+    {
+        std::fstream file(copy, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(sizeof(JournalSegmentHeader) + sizeof(JournalRecord) + 8);
+        file.put('\x7f');
+    }
+    ASSERT_TRUE(EventJournal::replay(crash_dir, 4, replay));
+    EXPECT_EQ(replay.records, 2u);
+    EXPECT_EQ(replay.corrupt, 1u);
+    EXPECT_EQ(replay.ports[0].state, PortState::INIT);
+    EXPECT_EQ(replay.ports[0].transitions, 1u);
+}
+
+TEST_F(EventJournalTest, ReopenContinuesAfterExistingSegments) {
+    {
+        auto manager = make_manager(4, EventJournal::kDefaultSegmentBytes);
+        manager->process_port_event(3, PortEvent::POWER_ON);
+        close_journals();
+    }
+    journals_.clear();
+    managers_.clear();
+
+    // Second run: recover, then keep journaling
+    JournalReplay replay;
+    ASSERT_TRUE(EventJournal::replay(dir_, 4, replay));
+    auto manager = make_manager(4, EventJournal::kDefaultSegmentBytes);
+    manager->restore_states(replay.ports);
+    EXPECT_EQ(manager->get_port_state(3), PortState::INIT);
+    manager->process_port_event(3, PortEvent::INIT_COMPLETE);
+    manager->process_port_event(2, PortEvent::POWER_ON);
+    close_journals();
+
+    EXPECT_EQ(EventJournal::list_segments(dir_).size(), 2u);
+    auto recovered = recover(4);
+    expect_same_ports(*manager, *recovered);
+    EXPECT_EQ(recovered->get_port_state(3), PortState::UP);
+    EXPECT_EQ(recovered->get_transition_count(3), 2u);
+
+    // An empty run leaves no segment behind
+    make_manager(4, EventJournal::kDefaultSegmentBytes);
+    close_journals();
+    EXPECT_EQ(EventJournal::list_segments(dir_).size(), 2u);
+}
+
+TEST_F(EventJournalTest, MissingDirectoryReplaysEmpty) {
+    JournalReplay replay;
+    ASSERT_TRUE(EventJournal::replay(dir_ + "/absent", 4, replay));
+    EXPECT_EQ(replay.segments, 0u);
+    ASSERT_EQ(replay.ports.size(), 4u);
+    EXPECT_EQ(replay.ports[2].state, PortState::DOWN);
+}
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include "event_socket.h"
+#include "event_socket_client.h"
+#include "logger.h"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace control_plane;
+
+namespace {
+
+class EventSocketTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Logger::instance().set_level(LogLevel::ERROR);
+        static std::atomic<int> next_id(0);
+        path_ = "/tmp/cp_event_socket_test_" + std::to_string(getpid()) + "_" +
+                std::to_string(next_id.fetch_add(1)) + ".sock";
+        manager_ = std::make_shared<PortManager>(16);
+        server_ = std::make_unique<EventSocketServer>(manager_, path_);
+        ASSERT_TRUE(server_->start());
+    }
+
+    void TearDown() override {
+        server_.reset();
+        Logger::instance().set_level(LogLevel::INFO);
+    }
+
+    std::string path_;
+    std::shared_ptr<PortManager> manager_;
+    std::unique_ptr<EventSocketServer> server_;
+};
+
+} // namespace
+
+TEST_F(EventSocketTest, SubmitAppliesBatchAndAcks) {
+    EventSocketClient client;
+    ASSERT_TRUE(client.connect(path_));
+
+    std::vector<PortEventRecord> batch = {
+        {0, PortEvent::POWER_ON}, {1, PortEvent::POWER_ON}, {0, PortEvent::INIT_COMPLETE},
+        {99, PortEvent::POWER_ON},                          // Invalid port
+        {2, static_cast<PortEvent>(9)},                     // Invalid event
+        {3, PortEvent::HEARTBEAT_OK},
+    };
+    EventBatchAck ack{};
+    ASSERT_TRUE(client.submit(batch.data(), batch.size(), ack));
+    EXPECT_EQ(ack.status, EventBatchStatus::OK);
+    EXPECT_EQ(ack.sequence, 0u);
+    EXPECT_EQ(ack.applied, 4u);
+    EXPECT_EQ(ack.rejected, 2u);
+    EXPECT_EQ(ack.transitions, 3u);
+
+    EXPECT_EQ(manager_->get_port_state(0), PortState::UP);
+    EXPECT_EQ(manager_->get_port_state(1), PortState::INIT);
+    EXPECT_EQ(manager_->get_port_state(2), PortState::DOWN);
+    EXPECT_EQ(manager_->get_metrics().get_counter("events_injected_total"), 4u);
+
+    // An empty batch is acked too
+    ASSERT_TRUE(client.submit(nullptr, 0, ack));
+    EXPECT_EQ(ack.sequence, 1u);
+    EXPECT_EQ(ack.applied, 0u);
+}
+
+TEST_F(EventSocketTest, PipelinedBatchesAreAckedInOrder) {
+    EventSocketClient client;
+    ASSERT_TRUE(client.connect(path_));
+
+    std::vector<PortEventRecord> batch(kMaxEventBatchRecords);
+    for (size_t i = 0; i < batch.size(); i++) {
+        batch[i] = {static_cast<int32_t>(i % 16), PortEvent::HEARTBEAT_OK};
+    }
+    const uint32_t batches = 40;
+    std::thread sender([&]() {
+        for (uint32_t i = 0; i < batches; i++) {
+            ASSERT_TRUE(client.send_batch(batch.data(), batch.size()));
+        }
+    });
+    for (uint32_t i = 0; i < batches; i++) {
+        EventBatchAck ack{};
+        ASSERT_TRUE(client.read_ack(ack));
+        EXPECT_EQ(ack.sequence, i);
+        EXPECT_EQ(ack.applied, kMaxEventBatchRecords);
+    }
+    sender.join();
+    EXPECT_EQ(manager_->get_total_events_processed(),
+              static_cast<uint64_t>(batches) * kMaxEventBatchRecords);
+}
+
+TEST_F(EventSocketTest, MalformedBatchIsRejectedWhole) {
+    EventSocketClient client;
+    ASSERT_TRUE(client.connect(path_));
+
+    // Build frames by hand on a second connection
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", path_.c_str());
+    ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+
+    struct {
+        EventBatchHeader header;
+        PortEventRecord records[2];
+    } frame = {{kEventBatchMagic, 7, 3, 0}, {{0, PortEvent::POWER_ON}, {1, PortEvent::POWER_ON}}};
+    ASSERT_EQ(send(fd, &frame, sizeof(frame), 0), static_cast<ssize_t>(sizeof(frame)));
+    EventBatchAck ack{};
+    ASSERT_EQ(recv(fd, &ack, sizeof(ack), 0), static_cast<ssize_t>(sizeof(ack)));
+    EXPECT_EQ(ack.sequence, 7u);
+    EXPECT_EQ(ack.status, EventBatchStatus::MALFORMED);
+    EXPECT_EQ(ack.applied, 0u);
+
+    frame.header = {0xDEADBEEF, 8, 2, 0};
+    ASSERT_EQ(send(fd, &frame, sizeof(frame), 0), static_cast<ssize_t>(sizeof(frame)));
+    ASSERT_EQ(recv(fd, &ack, sizeof(ack), 0), static_cast<ssize_t>(sizeof(ack)));
+    EXPECT_EQ(ack.status, EventBatchStatus::MALFORMED);
+
+    // The connection stays usable
+    frame.header = {kEventBatchMagic, 9, 2, 0};
+    ASSERT_EQ(send(fd, &frame, sizeof(frame), 0), static_cast<ssize_t>(sizeof(frame)));
+    ASSERT_EQ(recv(fd, &ack, sizeof(ack), 0), static_cast<ssize_t>(sizeof(ack)));
+    EXPECT_EQ(ack.status, EventBatchStatus::OK);
+    EXPECT_EQ(ack.applied, 2u);
+    close(fd);
+    EXPECT_EQ(manager_->get_port_state(0), PortState::INIT);
+}
+
+TEST_F(EventSocketTest, ServesSeveralClients) {
+    const int clients = 4;
+    const int batches = 50;
+    std::vector<std::thread> threads;
+    std::atomic<uint64_t> applied(0);
+    for (int c = 0; c < clients; c++) {
+        threads.emplace_back([&, c]() {
+            EventSocketClient client;
+            ASSERT_TRUE(client.connect(path_));
+            std::vector<PortEventRecord> batch(256, PortEventRecord{c, PortEvent::HEARTBEAT_OK});
+            for (int i = 0; i < batches; i++) {
+                EventBatchAck ack{};
+                ASSERT_TRUE(client.submit(batch.data(), batch.size(), ack));
+                applied.fetch_add(ack.applied);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(applied.load(), static_cast<uint64_t>(clients) * batches * 256);
+    EXPECT_EQ(manager_->get_metrics().get_counter("event_socket_batches_total"),
+              static_cast<uint64_t>(clients) * batches);
+}
+
+TEST_F(EventSocketTest, StopClosesClientsAndRemovesSocket) {
+    EventSocketClient client;
+    ASSERT_TRUE(client.connect(path_));
+    struct stat info;
+    EXPECT_EQ(stat(path_.c_str(), &info), 0);
+
+    server_->stop();
+    EXPECT_FALSE(server_->is_running());
+    EXPECT_NE(stat(path_.c_str(), &info), 0);
+
+    EventBatchAck ack{};
+    EXPECT_FALSE(client.read_ack(ack));
+    EventSocketClient late;
+    EXPECT_FALSE(late.connect(path_));
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include "flap_sampler.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace control_plane;
+
+namespace {
+
+// Picks over `cycles` consecutive ticks
+uint64_t count_picks(const FlapSampler& sampler, uint32_t num_ports, uint64_t cycles) {
+    std::vector<uint32_t> ports;
+    uint64_t picks = 0;
+    for (uint64_t tick = 1; tick <= cycles; tick++) {
+        ports.clear();
+        sampler.sample(num_ports, tick, ports);
+        picks += ports.size();
+    }
+    return picks;
+}
+
+} // namespace
+
+TEST(FlapSamplerTest, FlapRateMatchesPerPortTrials) {
+    struct Case {
+        double probability;
+        uint32_t num_ports;
+        uint64_t cycles;
+    };
+    for (const Case& c : {Case{1e-5, 1000000, 500}, Case{1e-3, 100000, 100}, Case{0.05, 1000, 200},
+                          Case{0.5, 1000, 20}}) {
+        FlapSampler sampler(CounterRng(99), c.probability);
+        // Binomial(ports * cycles, p): within 5 standard deviations
+        double trials = static_cast<double>(c.num_ports) * c.cycles;
+        double mean = trials * c.probability;
+        double sigma = std::sqrt(trials * c.probability * (1 - c.probability));
+        uint64_t picks = count_picks(sampler, c.num_ports, c.cycles);
+        EXPECT_NEAR(static_cast<double>(picks), mean, 5 * sigma) << "p = " << c.probability;
+    }
+}
+
+TEST(FlapSamplerTest, PicksAreUniformOverPorts) {
+    const uint32_t num_ports = 50000;
+    const int buckets = 50;
+    FlapSampler sampler(CounterRng(7), 0.01);
+    std::vector<uint32_t> ports;
+    std::vector<double> counts(buckets, 0);
+    uint64_t picks = 0;
+    for (uint64_t tick = 1; tick <= 100; tick++) {
+        ports.clear();
+        sampler.sample(num_ports, tick, ports);
+        for (uint32_t port : ports) {
+            counts[port / (num_ports / buckets)]++;
+        }
+        picks += ports.size();
+    }
+
+    // Chi-square with 49 degrees of freedom; 85.4 is the 0.1% critical value
+    double expected = static_cast<double>(picks) / buckets;
+    double chi_square = 0;
+    for (double count : counts) {
+        chi_square += (count - expected) * (count - expected) / expected;
+    }
+    EXPECT_LT(chi_square, 85.4);
+}
+
+TEST(FlapSamplerTest, GapsAreGeometric) {
+    // Independent per-port trials leave geometric gaps between picks:
+    // P(gap = k) = (1 - p)^k p
+    const double p = 0.2;
+    const int max_gap = 15; // Last bucket collects gaps >= max_gap
+    FlapSampler sampler(CounterRng(3), p);
+    std::vector<uint32_t> ports;
+    std::vector<double> counts(max_gap + 1, 0);
+    uint64_t gaps = 0;
+    for (uint64_t tick = 1; tick <= 200; tick++) {
+        ports.clear();
+        sampler.sample(1000, tick, ports);
+        for (size_t i = 1; i < ports.size(); i++) {
+            counts[std::min<uint32_t>(ports[i] - ports[i - 1] - 1, max_gap)]++;
+            gaps++;
+        }
+    }
+
+    double chi_square = 0;
+    for (int k = 0; k <= max_gap; k++) {
+        double probability = k < max_gap ? std::pow(1 - p, k) * p : std::pow(1 - p, max_gap);
+        double expected = probability * static_cast<double>(gaps);
+        chi_square += (counts[k] - expected) * (counts[k] - expected) / expected;
+    }
+    // 15 degrees of freedom; 37.7 is the 0.1% critical value
+    EXPECT_LT(chi_square, 37.7);
+}
+
+TEST(FlapSamplerTest, PicksAreSortedAndDependOnlyOnTheTick) {
+    FlapSampler sampler(CounterRng(42), 0.1);
+    std::vector<uint32_t> first;
+    sampler.sample(5000, 10, first);
+    ASSERT_FALSE(first.empty());
+    EXPECT_TRUE(std::is_sorted(first.begin(), first.end()));
+    EXPECT_EQ(std::adjacent_find(first.begin(), first.end()), first.end());
+    EXPECT_LT(first.back(), 5000u);
+
+    // Appends, and repeats for the same tick and seed
+    std::vector<uint32_t> again = {7};
+    FlapSampler(CounterRng(42), 0.1).sample(5000, 10, again);
+    ASSERT_EQ(again.size(), first.size() + 1);
+    EXPECT_TRUE(std::equal(first.begin(), first.end(), again.begin() + 1));
+
+    std::vector<uint32_t> other_tick;
+    sampler.sample(5000, 20, other_tick);
+    EXPECT_NE(other_tick, first);
+    std::vector<uint32_t> other_seed;
+    FlapSampler(CounterRng(43), 0.1).sample(5000, 10, other_seed);
+    EXPECT_NE(other_seed, first);
+}
+
+TEST(FlapSamplerTest, HandlesProbabilityBounds) {
+    std::vector<uint32_t> ports;
+    FlapSampler(CounterRng(1), 0.0).sample(1000, 1, ports);
+    EXPECT_TRUE(ports.empty());
+    EXPECT_EQ(FlapSampler(CounterRng(1), 0.0).gap(0.5), UINT32_MAX);
+
+    FlapSampler(CounterRng(1), 1.0).sample(1000, 1, ports);
+    ASSERT_EQ(ports.size(), 1000u);
+    EXPECT_EQ(ports.front(), 0u);
+    EXPECT_EQ(ports.back(), 999u);
+
+    // A tiny probability saturates instead of overflowing
+    FlapSampler rare(CounterRng(1), 1e-300);
+    EXPECT_EQ(rare.gap(0.999), UINT32_MAX);
+    EXPECT_EQ(rare.gap(0.0), 0u);
+    ports.clear();
+    rare.sample(UINT32_MAX, 1, ports);
+    EXPECT_TRUE(ports.empty());
+}
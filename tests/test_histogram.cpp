@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include "histogram.h"
+#include "metrics.h"
+#include "port_manager.h"
+#include <thread>
+#include <vector>
+
+using namespace control_plane;
+
+TEST(HistogramTest, BucketBoundsContainTheirValues) {
+    // Exact buckets below kSubBuckets, then log-linear up to the overflow
+    for (uint64_t value = 0; value < 5000; value++) {
+        int index = LatencyBuckets::index_of(value);
+        ASSERT_LE(value, LatencyBuckets::upper_bound_ns(index)) << value;
+        if (index > 0) {
+            ASSERT_GT(value, LatencyBuckets::upper_bound_ns(index - 1)) << value;
+        }
+    }
+
+    // Bucket bounds are strictly increasing and at most 25% wide
+    for (int index = 1; index < LatencyBuckets::kOverflow; index++) {
+        uint64_t lower = LatencyBuckets::upper_bound_ns(index - 1) + 1;
+        uint64_t upper = LatencyBuckets::upper_bound_ns(index);
+        ASSERT_GE(upper, lower);
+        if (lower >= LatencyBuckets::kSubBuckets) {
+            EXPECT_LE(upper - lower + 1, lower / 4 + 1) << "bucket " << index;
+        }
+        EXPECT_EQ(LatencyBuckets::index_of(lower), index);
+        EXPECT_EQ(LatencyBuckets::index_of(upper), index);
+    }
+
+    EXPECT_EQ(LatencyBuckets::index_of(1ull << LatencyBuckets::kMaxExponent), LatencyBuckets::kOverflow);
+    EXPECT_EQ(LatencyBuckets::index_of(UINT64_MAX), LatencyBuckets::kOverflow);
+}
+
+#if CONTROL_PLANE_LATENCY_HISTOGRAMS
+
+TEST(HistogramTest, ObservationsAreSummedAcrossThreads) {
+    Metrics metrics;
+    HistogramHandle histogram = metrics.register_histogram("op_seconds");
+    EXPECT_EQ(histogram.index, metrics.register_histogram("op_seconds").index);
+    EXPECT_NE(histogram.index, metrics.register_histogram("op_seconds", "op=\"x\"").index);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&]() {
+            for (uint64_t i = 0; i < 1000; i++) {
+                metrics.observe(histogram, i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    HistogramSnapshot snapshot = metrics.value(histogram);
+    EXPECT_EQ(snapshot.count, 4000u);
+    EXPECT_EQ(snapshot.sum_ns, 4u * (999u * 1000u / 2));
+    EXPECT_EQ(snapshot.buckets[LatencyBuckets::index_of(0)], 4u);
+    uint64_t total = 0;
+    for (uint64_t bucket : snapshot.buckets) {
+        total += bucket;
+    }
+    EXPECT_EQ(total, 4000u);
+}
+
+TEST(HistogramTest, ExportsPrometheusHistogramSeries) {
+    Metrics metrics;
+    HistogramHandle histogram = metrics.register_histogram("op_seconds", "op=\"read\"");
+    metrics.observe(histogram, 100);
+    metrics.observe(histogram, 100);
+    metrics.observe(histogram, 3000);
+    metrics.register_histogram("idle_seconds");
+
+    std::string text = metrics.export_prometheus();
+    EXPECT_NE(text.find("# TYPE control_plane_op_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(text.find("control_plane_op_seconds_bucket{op=\"read\",le=\"0.000000111\"} 2\n"),
+              std::string::npos) << text;
+    EXPECT_NE(text.find("control_plane_op_seconds_bucket{op=\"read\",le=\"+Inf\"} 3\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("control_plane_op_seconds_sum{op=\"read\"} 0.000003200\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("control_plane_op_seconds_count{op=\"read\"} 3\n"), std::string::npos);
+
+    // The last finite bucket is cumulative up to the largest sample
+    size_t last_bucket = text.find("control_plane_op_seconds_bucket{op=\"read\",le=\"0.000003071\"} 3\n");
+    EXPECT_NE(last_bucket, std::string::npos) << text;
+
+    // An empty histogram still exports +Inf, _sum and _count
+    EXPECT_NE(text.find("control_plane_idle_seconds_bucket{le=\"+Inf\"} 0\n"), std::string::npos);
+    EXPECT_NE(text.find("control_plane_idle_seconds_count 0\n"), std::string::npos);
+}
+
+TEST(HistogramTest, PortManagerRecordsEventLatencyAndLockWait) {
+    PortManager manager(8, PortSyncMode::MUTEX);
+    manager.set_event_latency_sample_interval(1);
+    manager.process_port_event(0, PortEvent::POWER_ON);
+    manager.process_port_event(1, PortEvent::POWER_ON);
+    manager.process_port_event(0, PortEvent::INIT_COMPLETE);
+
+    Metrics& metrics = manager.get_metrics();
+    EXPECT_EQ(metrics.value(metrics.register_histogram("port_event_latency_seconds",
+                                                       "event=\"POWER_ON\"")).count, 2u);
+    EXPECT_EQ(metrics.value(metrics.register_histogram("port_event_latency_seconds",
+                                                       "event=\"INIT_COMPLETE\"")).count, 1u);
+    EXPECT_EQ(metrics.value(metrics.register_histogram("port_event_latency_seconds",
+                                                       "event=\"LINK_FLAP\"")).count, 0u);
+
+    // Uncontended acquisitions record zero wait
+    HistogramSnapshot lock_wait = metrics.value(metrics.register_histogram("port_lock_wait_seconds"));
+    EXPECT_EQ(lock_wait.count, 3u);
+    EXPECT_EQ(lock_wait.buckets[0], 3u);
+}
+
+TEST(HistogramTest, BatchPathRecordsEventLatency) {
+    PortManager manager(8, PortSyncMode::MUTEX);
+    manager.set_event_latency_sample_interval(1);
+    std::vector<PortEventRecord> records = {
+        {0, PortEvent::POWER_ON}, {1, PortEvent::POWER_ON}, {0, PortEvent::INIT_COMPLETE},
+        {2, PortEvent::POWER_ON}, {1, PortEvent::LINK_FLAP}};
+    manager.process_port_events(records.data(), records.size());
+
+    Metrics& metrics = manager.get_metrics();
+    EXPECT_EQ(metrics.value(metrics.register_histogram("port_event_latency_seconds",
+                                                       "event=\"POWER_ON\"")).count, 3u);
+    EXPECT_EQ(metrics.value(metrics.register_histogram("port_event_latency_seconds",
+                                                       "event=\"INIT_COMPLETE\"")).count, 1u);
+    EXPECT_EQ(metrics.value(metrics.register_histogram("port_event_latency_seconds",
+                                                       "event=\"LINK_FLAP\"")).count, 1u);
+
+    std::string text = metrics.export_prometheus();
+    EXPECT_NE(text.find("control_plane_port_event_latency_seconds_count{event=\"POWER_ON\"} 3\n"),
+              std::string::npos) << text;
+}
+
+TEST(HistogramTest, EventLatencyIsSampledByDefault) {
+    PortManager manager(64, PortSyncMode::MUTEX);
+    constexpr uint32_t kEvents = 1600;
+    std::vector<PortEventRecord> records;
+    for (uint32_t i = 0; i < kEvents; i++) {
+        records.push_back({static_cast<int>(i % 64), PortEvent::LINK_FLAP});
+    }
+    manager.process_port_events(records.data(), records.size());
+
+    // 1 in 16, starting with the first event
+    Metrics& metrics = manager.get_metrics();
+    EXPECT_EQ(metrics.value(metrics.register_histogram("port_event_latency_seconds",
+                                                       "event=\"LINK_FLAP\"")).count,
+              kEvents / PortManager::kDefaultEventLatencySampleInterval);
+}
+
+#endif
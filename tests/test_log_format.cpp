@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include "allocation_counter.h"
+#include "logger.h"
+#include "port_manager.h"
+#include <atomic>
+#include <fcntl.h>
+#include <sstream>
+#include <unistd.h>
+#include <vector>
+
+using namespace control_plane;
+
+namespace {
+
+// Counts how often it is converted for formatting
+struct CountingArg {
+    int* conversions;
+    operator std::string_view() const {
+        (*conversions)++;
+        return "counted";
+    }
+};
+
+std::string format(std::string_view fmt) {
+    LogLineBuffer buffer;
+    format_log_message(buffer, fmt);
+    return std::string(buffer.view());
+}
+
+template <typename... Args>
+std::string format(std::string_view fmt, const Args&... args) {
+    LogLineBuffer buffer;
+    format_log_message(buffer, fmt, args...);
+    return std::string(buffer.view());
+}
+
+} // namespace
+
+TEST(LogFormatTest, AllocationCounterSeesStringstreamFormatting) {
+    // The formatting this front end replaced allocates on every call
+    uint64_t allocations;
+    {
+        AllocationCounter counter;
+        std::ostringstream ss;
+        ss << "Port " << 7 << " received event " << port_event_to_string(PortEvent::HEARTBEAT_OK)
+           << " in state " << port_state_to_string(PortState::UP) << " (no transition)";
+        EXPECT_FALSE(ss.str().empty());
+        allocations = counter.count();
+    }
+    EXPECT_GT(allocations, 0u);
+}
+
+TEST(LogFormatTest, ReplacesPlaceholdersInOrder) {
+    EXPECT_EQ(format("Port {} went {} after {}ms", 7, "UP", 12.5),
+              "Port 7 went UP after 12.5ms");
+    EXPECT_EQ(format("{} {} {} {}", -42, uint64_t(18446744073709551615ull), true, 'x'),
+              "-42 18446744073709551615 true x");
+    EXPECT_EQ(format("{}", std::string("owned")), "owned");
+    EXPECT_EQ(format("{} on {}", PortState::UP, PortEvent::HEARTBEAT_OK), "UP on HEARTBEAT_OK");
+    EXPECT_EQ(format("policy {}", LogOverflowPolicy::DROP), "policy 1");
+
+    // Missing arguments leave the placeholder; extra arguments are ignored
+    EXPECT_EQ(format("a {} b {}", 1), "a 1 b {}");
+    EXPECT_EQ(format("no placeholders", 1, 2), "no placeholders");
+    EXPECT_EQ(format("plain"), "plain");
+}
+
+TEST(LogFormatTest, TruncatesAtBufferCapacity) {
+    std::string long_arg(LogLineBuffer::kCapacity * 2, 'x');
+    std::string formatted = format("head {} tail", long_arg);
+    ASSERT_EQ(formatted.size(), LogLineBuffer::kCapacity);
+    EXPECT_EQ(formatted.substr(0, 5), "head ");
+    EXPECT_EQ(formatted.substr(formatted.size() - 3), "...");
+}
+
+class LogFrontEndTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        null_fd_ = ::open("/dev/null", O_WRONLY);
+        ASSERT_GE(null_fd_, 0);
+        Logger::instance().set_output_fd(null_fd_);
+        Logger::instance().set_level(LogLevel::INFO);
+    }
+
+    void TearDown() override {
+        Logger::instance().stop_async();
+        Logger::instance().set_output_fd(STDOUT_FILENO);
+        Logger::instance().set_level(LogLevel::INFO);
+        ::close(null_fd_);
+    }
+
+    int null_fd_ = -1;
+};
+
+TEST_F(LogFrontEndTest, FilteredCallsDoNotFormatArguments) {
+    int conversions = 0;
+    CountingArg arg{&conversions};
+
+    Logger::instance().set_level(LogLevel::WARN);
+    Logger::instance().infof("test", -1, "value {}", arg);
+    Logger::instance().debugf("test", -1, "value {}", arg);
+    EXPECT_EQ(conversions, 0);
+
+    Logger::instance().warnf("test", -1, "value {}", arg);
+    EXPECT_EQ(conversions, 1);
+
+    // DEBUG below the compiled-in minimum never formats, whatever the runtime level
+    Logger::instance().set_level(LogLevel::DEBUG);
+    Logger::instance().debugf("test", -1, "value {}", arg);
+    EXPECT_EQ(conversions, Logger::kCompiledMinLevel <= LogLevel::DEBUG ? 2 : 1);
+}
+
+class HeartbeatAllocationTest : public LogFrontEndTest,
+                                public ::testing::WithParamInterface<PortSyncMode> {};
+
+TEST_P(HeartbeatAllocationTest, HeartbeatPathMakesNoHeapAllocationsAtInfo) {
+    const int kPorts = 64;
+    PortManager manager(kPorts, GetParam());
+    std::vector<PortEventRecord> heartbeats;
+    for (int port = 0; port < kPorts; port++) {
+        manager.process_port_event(port, PortEvent::POWER_ON);
+        manager.process_port_event(port, PortEvent::INIT_COMPLETE);
+        heartbeats.push_back({port, PortEvent::HEARTBEAT_OK});
+    }
+
+    // First use on this thread sets up metric shards and scratch buffers
+    manager.process_port_event(0, PortEvent::HEARTBEAT_OK);
+    manager.process_port_events(heartbeats.data(), heartbeats.size());
+
+    uint64_t allocations;
+    {
+        AllocationCounter counter;
+        for (int round = 0; round < 100; round++) {
+            manager.process_port_event(round % kPorts, PortEvent::HEARTBEAT_OK);
+            manager.process_port_events(heartbeats.data(), heartbeats.size());
+        }
+        allocations = counter.count();
+    }
+    EXPECT_EQ(allocations, 0u);
+    EXPECT_EQ(manager.get_population().snapshot().up, static_cast<uint64_t>(kPorts));
+}
+
+TEST_P(HeartbeatAllocationTest, LoggedTransitionsMakeNoHeapAllocations) {
+    PortManager manager(4, GetParam());
+    // Every event timed, so the warm-up cycle sets up each event's
+    // histogram cells on this thread
+    manager.set_event_latency_sample_interval(1);
+    auto flap_cycle = [&]() {
+        manager.process_port_event(1, PortEvent::POWER_ON);
+        manager.process_port_event(1, PortEvent::INIT_COMPLETE);
+        manager.process_port_event(1, PortEvent::LINK_FLAP);
+    };
+
+    for (bool async : {false, true}) {
+        if (async) {
+            Logger::instance().start_async(1024, LogOverflowPolicy::BLOCK);
+        }
+        flap_cycle();
+
+        uint64_t allocations;
+        {
+            AllocationCounter counter;
+            for (int i = 0; i < 100; i++) {
+                flap_cycle();
+            }
+            allocations = counter.count();
+        }
+        EXPECT_EQ(allocations, 0u) << (async ? "async" : "sync");
+        Logger::instance().stop_async();
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(SyncModes, HeartbeatAllocationTest,
+                         ::testing::Values(PortSyncMode::MUTEX, PortSyncMode::LOCK_FREE));
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include "log_rate_limiter.h"
+#include "logger.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace control_plane;
+
+namespace {
+
+constexpr int64_t kMs = 1000000;
+
+} // namespace
+
+TEST(LogRateLimiterTest, AllowsBurstThenRate) {
+    LogRateLimiter limiter;
+    limiter.configure(10.0, 5); // One record per 100ms after 5 up front
+    ASSERT_TRUE(limiter.enabled());
+
+    uint64_t key = LogRateLimiter::make_key(3, 7, 1);
+    LogRateLimiter::Suppression closed;
+    int64_t now = 1000 * kMs;
+    for (int i = 0; i < 5; i++) {
+        EXPECT_TRUE(limiter.allow(key, now, closed)) << i;
+    }
+    EXPECT_FALSE(limiter.allow(key, now, closed));
+    EXPECT_FALSE(limiter.allow(key, now + 50 * kMs, closed));
+    EXPECT_EQ(limiter.total_suppressed(), 2u);
+
+    // Another port, component or level has its own bucket
+    EXPECT_TRUE(limiter.allow(LogRateLimiter::make_key(3, 8, 1), now, closed));
+    EXPECT_TRUE(limiter.allow(LogRateLimiter::make_key(4, 7, 1), now, closed));
+    EXPECT_TRUE(limiter.allow(LogRateLimiter::make_key(3, 7, 2), now, closed));
+    EXPECT_EQ(closed.count, 0u);
+
+    // One token has refilled: the next record closes the window
+    EXPECT_TRUE(limiter.allow(key, now + 100 * kMs, closed));
+    EXPECT_EQ(closed.count, 2u);
+    EXPECT_EQ(closed.window_ns, 100 * kMs);
+    EXPECT_FALSE(limiter.allow(key, now + 100 * kMs, closed));
+
+    EXPECT_EQ(LogRateLimiter::key_component(key), 3);
+    EXPECT_EQ(LogRateLimiter::key_port(key), 7);
+    EXPECT_EQ(LogRateLimiter::key_level(key), 1);
+    EXPECT_EQ(LogRateLimiter::key_port(LogRateLimiter::make_key(0, -1, 0)), -1);
+}
+
+TEST(LogRateLimiterTest, CollectReportsWindowsOnlyOnceClosed) {
+    LogRateLimiter limiter;
+    limiter.configure(1.0, 1);
+    uint64_t key = LogRateLimiter::make_key(1, 1, 1);
+    LogRateLimiter::Suppression closed;
+    int64_t now = 5000 * kMs;
+    EXPECT_TRUE(limiter.allow(key, now, closed));
+    for (int i = 0; i < 10; i++) {
+        EXPECT_FALSE(limiter.allow(key, now, closed));
+    }
+
+    std::vector<std::pair<uint64_t, uint64_t>> reported;
+    auto record = [&](uint64_t k, const LogRateLimiter::Suppression& s) {
+        reported.push_back({k, s.count});
+    };
+    limiter.collect(now + 500 * kMs, false, record);
+    EXPECT_TRUE(reported.empty()); // Bucket still empty
+
+    limiter.collect(now + 1000 * kMs, false, record);
+    ASSERT_EQ(reported.size(), 1u);
+    EXPECT_EQ(reported[0], std::make_pair(key, uint64_t(10)));
+
+    // Reported once
+    limiter.collect(now + 2000 * kMs, true, record);
+    EXPECT_EQ(reported.size(), 1u);
+}
+
+TEST(LogRateLimiterTest, ConcurrentCallersNeverExceedTheBudget) {
+    LogRateLimiter limiter;
+    limiter.configure(1.0, 100); // Effectively no refill during the test
+    uint64_t key = LogRateLimiter::make_key(1, 0, 1);
+    const int kThreads = 8;
+    const int kPerThread = 10000;
+    std::atomic<uint64_t> allowed(0);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&]() {
+            LogRateLimiter::Suppression closed;
+            for (int i = 0; i < kPerThread; i++) {
+                if (limiter.allow(key, 1000 * kMs, closed)) {
+                    allowed.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(allowed.load(), 100u);
+    EXPECT_EQ(allowed.load() + limiter.total_suppressed(),
+              static_cast<uint64_t>(kThreads * kPerThread));
+}
+
+class LoggerRateLimitTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char path[] = "/tmp/log_rate_limit_test_XXXXXX";
+        fd_ = mkstemp(path);
+        ASSERT_GE(fd_, 0);
+        path_ = path;
+        Logger::instance().set_level(LogLevel::INFO);
+        Logger::instance().set_output_fd(fd_);
+    }
+
+    void TearDown() override {
+        Logger::instance().set_rate_limit(0, 0);
+        Logger::instance().stop_async();
+        Logger::instance().set_output_fd(STDOUT_FILENO);
+        ::close(fd_);
+        std::remove(path_.c_str());
+    }
+
+    std::vector<std::string> read_lines() {
+        std::ifstream file(path_);
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(file, line)) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    int fd_ = -1;
+    std::string path_;
+};
+
+TEST_F(LoggerRateLimitTest, FloodingPortIsSummarizedOthersUnaffected) {
+    Logger& logger = Logger::instance();
+    logger.set_rate_limit(0.001, 3); // No refill within the test
+    uint64_t suppressed_before = logger.get_suppressed_count();
+
+    for (int i = 0; i < 100; i++) {
+        logger.infof("PortStateMachine", 1, "Port {} flapped ({})", 1, i);
+    }
+    logger.infof("PortStateMachine", 2, "Port {} flapped", 2);
+    logger.info("untemplated", "EventLoop", 1);
+    logger.warnf("PortStateMachine", 1, "Port {} warning", 1);
+    EXPECT_EQ(logger.get_suppressed_count() - suppressed_before, 97u);
+
+    logger.report_suppressed();
+    std::vector<std::string> lines = read_lines();
+    ASSERT_EQ(lines.size(), 7u);
+    EXPECT_NE(lines[2].find("\"message\":\"Port 1 flapped (2)\""), std::string::npos);
+    EXPECT_NE(lines[3].find("\"message\":\"Port 2 flapped\""), std::string::npos);
+
+    // One summary for the flooding key, at its level, component and port
+    const std::string& summary = lines[6];
+    EXPECT_NE(summary.find("\"level\":\"INFO\""), std::string::npos) << summary;
+    EXPECT_NE(summary.find("\"message\":\"Suppressed 97 messages over "), std::string::npos) << summary;
+    EXPECT_NE(summary.find("\"component\":\"PortStateMachine\",\"port_id\":1}"), std::string::npos)
+        << summary;
+
+    // Nothing left to report
+    logger.report_suppressed();
+    EXPECT_EQ(read_lines().size(), 7u);
+}
+
+TEST_F(LoggerRateLimitTest, NextAllowedRecordClosesTheWindow) {
+    Logger& logger = Logger::instance();
+    logger.set_rate_limit(5.0, 1); // One record per 200ms
+    logger.start_async(256, LogOverflowPolicy::BLOCK);
+
+    logger.infof("EventLoop", 5, "Injecting link flap on port {}", 5);
+    logger.infof("EventLoop", 5, "Injecting link flap on port {}", 5);
+    logger.infof("EventLoop", 5, "Injecting link flap on port {}", 5);
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    logger.infof("EventLoop", 5, "Injecting link flap on port {}", 5);
+    logger.flush();
+
+    std::vector<std::string> lines = read_lines();
+    ASSERT_EQ(lines.size(), 3u);
+    EXPECT_NE(lines[1].find("\"message\":\"Suppressed 2 messages over "), std::string::npos) << lines[1];
+    EXPECT_NE(lines[2].find("Injecting link flap on port 5"), std::string::npos);
+}
+
+TEST_F(LoggerRateLimitTest, DisabledLimiterPassesEverything) {
+    Logger& logger = Logger::instance();
+    uint64_t suppressed_before = logger.get_suppressed_count();
+    for (int i = 0; i < 200; i++) {
+        logger.infof("PortStateMachine", 1, "Port {} flapped", 1);
+    }
+    EXPECT_EQ(read_lines().size(), 200u);
+    EXPECT_EQ(logger.get_suppressed_count(), suppressed_before);
+}
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include "metrics.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace control_plane;
+
+TEST(MetricsTest, RegisterReturnsStableHandles) {
+    Metrics metrics;
+    CounterHandle a = metrics.register_counter("requests_total");
+    CounterHandle b = metrics.register_counter("requests_total");
+    CounterHandle c = metrics.register_counter("errors_total");
+
+    EXPECT_TRUE(a.valid());
+    EXPECT_EQ(a.index, b.index);
+    EXPECT_NE(a.index, c.index);
+
+    GaugeHandle g = metrics.register_gauge("queue_depth");
+    EXPECT_EQ(g.index, metrics.register_gauge("queue_depth").index);
+}
+
+TEST(MetricsTest, StringApiSharesHandleStorage) {
+    Metrics metrics;
+    CounterHandle counter = metrics.register_counter("requests_total");
+    GaugeHandle gauge = metrics.register_gauge("queue_depth");
+
+    metrics.increment(counter, 5);
+    metrics.increment_counter("requests_total", 2);
+    EXPECT_EQ(metrics.value(counter), 7u);
+    EXPECT_EQ(metrics.get_counter("requests_total"), 7u);
+
+    metrics.set_gauge("queue_depth", 3.0);
+    metrics.add(gauge, -1.5);
+    EXPECT_DOUBLE_EQ(metrics.value(gauge), 1.5);
+    EXPECT_DOUBLE_EQ(metrics.get_gauge("queue_depth"), 1.5);
+
+    EXPECT_EQ(metrics.get_counter("unknown_total"), 0u);
+    EXPECT_DOUBLE_EQ(metrics.get_gauge("unknown"), 0.0);
+}
+
+TEST(MetricsTest, ConcurrentIncrementsAreSummedAtScrape) {
+    Metrics metrics;
+    CounterHandle counter = metrics.register_counter("events_total");
+    GaugeHandle gauge = metrics.register_gauge("balance");
+    const int num_threads = 8;
+    const int increments = 100000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < increments; i++) {
+                metrics.increment(counter);
+                metrics.add(gauge, (i % 2 == 0) ? 1.0 : -1.0);
+            }
+        });
+    }
+
+    // Scrapes may run while writers are active
+    for (int i = 0; i < 10; i++) {
+        EXPECT_LE(metrics.value(counter), static_cast<uint64_t>(num_threads) * increments);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Shards of exited threads keep their counts
+    EXPECT_EQ(metrics.value(counter), static_cast<uint64_t>(num_threads) * increments);
+    EXPECT_DOUBLE_EQ(metrics.value(gauge), 0.0);
+}
+
+TEST(MetricsTest, RegistriesDoNotShareThreadShards) {
+    // One thread alternating between registries, including ones created after
+    // others were destroyed
+    Metrics first;
+    CounterHandle a = first.register_counter("x_total");
+    for (int round = 0; round < 20; round++) {
+        Metrics scratch;
+        CounterHandle b = scratch.register_counter("x_total");
+        first.increment(a);
+        scratch.increment(b, 10);
+        EXPECT_EQ(scratch.value(b), 10u);
+    }
+    EXPECT_EQ(first.value(a), 20u);
+}
+
+TEST(MetricsTest, FullRegistryReturnsInvalidHandle) {
+    Metrics metrics;
+    for (uint32_t i = 0; i < Metrics::kMaxCounters; i++) {
+        metrics.register_counter("c" + std::to_string(i));
+    }
+    CounterHandle overflow = metrics.register_counter("one_too_many");
+    EXPECT_FALSE(overflow.valid());
+    metrics.increment(overflow); // Ignored
+    EXPECT_EQ(metrics.value(overflow), 0u);
+}
+
+TEST(MetricsTest, ExportIncludesRegisteredMetrics) {
+    Metrics metrics;
+    metrics.increment(metrics.register_counter("requests_total"), 42);
+    metrics.set(metrics.register_gauge("temperature"), 21.5);
+
+    std::string text = metrics.export_prometheus();
+    EXPECT_NE(text.find("control_plane_requests_total 42\n"), std::string::npos);
+    EXPECT_NE(text.find("control_plane_temperature 21.50\n"), std::string::npos);
+    EXPECT_NE(text.find("control_plane_events_processed_total 0\n"), std::string::npos);
+}
+
+TEST(MetricsTest, ExportFollowsNewRegistrationsAndValues) {
+    Metrics metrics;
+    CounterHandle counter = metrics.register_counter("requests_total");
+    metrics.increment(counter, 1);
+    std::string first = metrics.export_prometheus();
+    EXPECT_NE(first.find("control_plane_requests_total 1\n"), std::string::npos);
+    EXPECT_EQ(first.find("control_plane_late_total"), std::string::npos);
+
+    // A registration after the first render changes the layout
+    metrics.increment(metrics.register_counter("late_total"), 3);
+    metrics.register_gauge_callback("answer", []() { return 42.0; });
+    metrics.increment(counter, 1);
+    std::string second = metrics.export_prometheus();
+    EXPECT_NE(second.find("control_plane_requests_total 2\n"), std::string::npos);
+    EXPECT_NE(second.find("control_plane_late_total 3\n"), std::string::npos);
+    EXPECT_NE(second.find("control_plane_answer 42.00\n"), std::string::npos);
+}
+
+TEST(MetricsTest, ExpositionReusesRenderWithinMaxAge) {
+    Metrics metrics;
+    CounterHandle counter = metrics.register_counter("requests_total");
+
+    // Default max age 0: every call renders
+    metrics.increment(counter, 1);
+    std::shared_ptr<const std::string> a = metrics.exposition();
+    metrics.increment(counter, 1);
+    std::shared_ptr<const std::string> b = metrics.exposition();
+    EXPECT_NE(a, b);
+    EXPECT_NE(b->find("control_plane_requests_total 2\n"), std::string::npos);
+
+    metrics.set_exposition_max_age(std::chrono::hours(1));
+    std::shared_ptr<const std::string> c = metrics.exposition();
+    metrics.increment(counter, 1);
+    EXPECT_EQ(metrics.exposition(), c);
+    EXPECT_NE(c->find("control_plane_requests_total 2\n"), std::string::npos);
+
+    metrics.set_exposition_max_age(std::chrono::milliseconds(0));
+    EXPECT_NE(metrics.exposition()->find("control_plane_requests_total 3\n"), std::string::npos);
+}
+
+TEST(MetricsTest, RenderDoesNotBlockRegistrationOrNewWriters) {
+    Metrics metrics;
+    std::atomic<bool> in_render(false);
+    std::atomic<bool> release(false);
+    metrics.register_gauge_callback("slow", [&]() {
+        in_render.store(true);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!release.load() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        return 1.0;
+    });
+
+    std::thread scraper([&]() { metrics.exposition(); });
+    while (!in_render.load()) {
+        std::this_thread::yield();
+    }
+
+    // A registration and a new thread's first increment both take the
+    // registry mutex; neither may wait for the render
+    CounterHandle counter = metrics.register_counter("registered_mid_render_total");
+    std::thread writer([&]() { metrics.increment(counter, 7); });
+    writer.join();
+    EXPECT_EQ(metrics.value(counter), 7u);
+    EXPECT_FALSE(release.load());
+
+    release.store(true);
+    scraper.join();
+    EXPECT_NE(metrics.exposition()->find("control_plane_registered_mid_render_total 7\n"),
+              std::string::npos);
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "port_population.h"
+#include "port_manager.h"
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace control_plane;
+
+TEST(PortPopulationTest, AppliesPackedDeltas) {
+    PortPopulation population(10);
+    PortPopulation::Counts counts = population.snapshot();
+    EXPECT_EQ(counts.down, 10);
+    EXPECT_EQ(counts.init, 0);
+    EXPECT_EQ(counts.up, 0);
+
+    int64_t power_on[3] = {-4, 4, 0};
+    population.apply(power_on);
+    int64_t init_complete[3] = {0, -3, 3};
+    population.apply(init_complete);
+    counts = population.snapshot();
+    EXPECT_EQ(counts.down, 6);
+    EXPECT_EQ(counts.init, 1);
+    EXPECT_EQ(counts.up, 3);
+
+    // Flap of every non-DOWN port: DOWN gains, INIT and UP lose
+    int64_t flap[3] = {4, -1, -3};
+    population.apply(flap);
+    EXPECT_EQ(population.count(PortState::DOWN), 10);
+    EXPECT_EQ(population.count(PortState::INIT), 0);
+    EXPECT_EQ(population.count(PortState::UP), 0);
+}
+
+TEST(PortPopulationTest, ToleratesTransientNegativeCounts) {
+    // A publish can land before the one it logically follows
+    PortPopulation population(5);
+    int64_t init_complete_first[3] = {0, -1, 1};
+    population.apply(init_complete_first);
+    PortPopulation::Counts counts = population.snapshot();
+    EXPECT_EQ(counts.down, 5);
+    EXPECT_EQ(counts.init, -1);
+    EXPECT_EQ(counts.up, 1);
+
+    int64_t power_on[3] = {-1, 1, 0};
+    population.apply(power_on);
+    counts = population.snapshot();
+    EXPECT_EQ(counts.down, 4);
+    EXPECT_EQ(counts.init, 0);
+    EXPECT_EQ(counts.up, 1);
+
+    // DOWN going transiently negative borrows correctly from INIT
+    PortPopulation all_init(3);
+    int64_t to_init[3] = {-3, 3, 0};
+    all_init.apply(to_init);
+    int64_t early_power_on[3] = {-1, 1, 0};
+    all_init.apply(early_power_on);
+    counts = all_init.snapshot();
+    EXPECT_EQ(counts.down, -1);
+    EXPECT_EQ(counts.init, 4);
+    EXPECT_EQ(counts.up, 0);
+}
+
+class PortPopulationStressTest : public ::testing::TestWithParam<PortSyncMode> {};
+
+TEST_P(PortPopulationStressTest, CountsMatchTableScanAfterConcurrentTransitions) {
+    const int num_ports = 256;
+    const int num_writers = 4;
+    PortManager manager(num_ports, GetParam());
+
+    // Several rounds, each checked once the writers have quiesced, so a lost
+    // or misattributed delta shows up in the per-state count it belongs to
+    for (int round = 0; round < 5; round++) {
+        std::vector<std::thread> writers;
+        for (int t = 0; t < num_writers; t++) {
+            writers.emplace_back([&manager, round, t]() {
+                std::mt19937 rng(round * num_writers + t);
+                std::uniform_int_distribution<int> port_dist(0, num_ports - 1);
+                std::uniform_int_distribution<int> event_dist(0, kNumPortEvents - 1);
+                std::vector<PortEventRecord> records;
+                for (int i = 0; i < 20000; i++) {
+                    int port_id = port_dist(rng);
+                    PortEvent event = static_cast<PortEvent>(event_dist(rng));
+                    if (i % 4 == 0) {
+                        records.push_back({port_id, event});
+                    } else {
+                        manager.process_port_event(port_id, event);
+                    }
+                    if (records.size() == 64) {
+                        manager.process_port_events(records.data(), records.size());
+                        records.clear();
+                    }
+                }
+                manager.process_port_events(records.data(), records.size());
+            });
+        }
+        // Chassis-wide flaps and power-ons racing the per-port writers
+        writers.emplace_back([&manager]() {
+            for (int i = 0; i < 200; i++) {
+                manager.process_port_event_range(0, num_ports, PortEvent::LINK_FLAP);
+                manager.process_port_event_range(num_ports / 4, num_ports / 2, PortEvent::POWER_ON);
+            }
+        });
+        for (auto& writer : writers) {
+            writer.join();
+        }
+
+        int64_t scanned[kNumPortStates];
+        manager.get_port_table().count_states(scanned);
+        PortPopulation::Counts counts = manager.get_population().snapshot();
+        EXPECT_EQ(counts.down, scanned[static_cast<int>(PortState::DOWN)]) << "round " << round;
+        EXPECT_EQ(counts.init, scanned[static_cast<int>(PortState::INIT)]) << "round " << round;
+        EXPECT_EQ(counts.up, scanned[static_cast<int>(PortState::UP)]) << "round " << round;
+
+        const Metrics& metrics = manager.get_metrics();
+        EXPECT_DOUBLE_EQ(metrics.get_gauge("ports_down"), scanned[static_cast<int>(PortState::DOWN)]);
+        EXPECT_DOUBLE_EQ(metrics.get_gauge("ports_init"), scanned[static_cast<int>(PortState::INIT)]);
+        EXPECT_DOUBLE_EQ(metrics.get_gauge("ports_up"), scanned[static_cast<int>(PortState::UP)]);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(SyncModes, PortPopulationStressTest,
+                         ::testing::Values(PortSyncMode::MUTEX, PortSyncMode::LOCK_FREE));
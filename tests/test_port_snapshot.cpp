@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include "event_journal.h"
+#include "logger.h"
+#include "port_manager.h"
+#include "port_snapshot.h"
+#include <unistd.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace control_plane;
+
+namespace {
+
+class PortSnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Logger::instance().set_level(LogLevel::ERROR);
+        static std::atomic<int> next_id(0);
+        dir_ = "/tmp/cp_snapshot_test_" + std::to_string(getpid()) + "_" +
+               std::to_string(next_id.fetch_add(1));
+        std::filesystem::remove_all(dir_);
+        std::filesystem::create_directories(dir_);
+        path_ = dir_ + "/ports.snap";
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir_);
+        Logger::instance().set_level(LogLevel::INFO);
+    }
+
+    // A manager with ports in every state and a mix of transition counts
+    static std::unique_ptr<PortManager> make_busy_manager(int num_ports) {
+        auto manager = std::make_unique<PortManager>(num_ports);
+        manager->process_port_event_range(0, num_ports, PortEvent::POWER_ON);
+        for (int port = 0; port < num_ports; port += 2) {
+            manager->process_port_event(port, PortEvent::INIT_COMPLETE);
+        }
+        for (int port = 0; port < num_ports; port += 6) {
+            manager->process_port_event(port, PortEvent::LINK_FLAP);
+        }
+        return manager;
+    }
+
+    static void expect_same_ports(const PortManager& expected, const PortManager& actual) {
+        ASSERT_EQ(expected.get_num_ports(), actual.get_num_ports());
+        for (int port = 0; port < expected.get_num_ports(); port++) {
+            EXPECT_EQ(actual.get_port_state(port), expected.get_port_state(port)) << "port " << port;
+            EXPECT_EQ(actual.get_transition_count(port), expected.get_transition_count(port))
+                << "port " << port;
+        }
+        PortPopulation::Counts want = expected.get_population().snapshot();
+        PortPopulation::Counts got = actual.get_population().snapshot();
+        EXPECT_EQ(got.down, want.down);
+        EXPECT_EQ(got.init, want.init);
+        EXPECT_EQ(got.up, want.up);
+    }
+
+    std::string dir_;
+    std::string path_;
+};
+
+} // namespace
+
+TEST_F(PortSnapshotTest, LoadRestoresTheSavedTable) {
+    auto manager = make_busy_manager(1000);
+    ASSERT_TRUE(manager->save_snapshot(path_));
+    EXPECT_FALSE(std::filesystem::exists(path_ + ".tmp"));
+    EXPECT_EQ(std::filesystem::file_size(path_), sizeof(PortSnapshotHeader) + 1000 * 16);
+
+    std::optional<PortTable> table;
+    ASSERT_TRUE(PortSnapshot::load(path_, table));
+    PortManager restored(std::move(*table));
+    expect_same_ports(*manager, restored);
+
+    // Transition times carry over to this process's steady clock
+    for (int port : {0, 1, 6, 999}) {
+        auto skew = restored.get_last_transition_time(port) - manager->get_last_transition_time(port);
+        EXPECT_LT(std::chrono::abs(skew), std::chrono::milliseconds(50)) << "port " << port;
+    }
+}
+
+TEST_F(PortSnapshotTest, RestoredTableIsLiveAndLeavesTheFileUnchanged) {
+    auto manager = make_busy_manager(64);
+    ASSERT_TRUE(manager->save_snapshot(path_));
+
+    std::optional<PortTable> table;
+    ASSERT_TRUE(PortSnapshot::load(path_, table));
+    PortManager restored(std::move(*table), PortSyncMode::LOCK_FREE);
+    EXPECT_EQ(restored.get_port_state(1), PortState::INIT);
+    EXPECT_TRUE(restored.process_port_event(1, PortEvent::INIT_COMPLETE));
+    restored.process_port_event_range(0, 64, PortEvent::LINK_FLAP);
+    EXPECT_EQ(restored.get_port_state(1), PortState::DOWN);
+    EXPECT_EQ(restored.get_population().snapshot().down, 64);
+
+    // The mapping is private: the file still holds the saved table
+    std::optional<PortTable> again;
+    ASSERT_TRUE(PortSnapshot::load(path_, again));
+    PortManager reloaded(std::move(*again));
+    expect_same_ports(*manager, reloaded);
+}
+
+TEST_F(PortSnapshotTest, SnapshotOfRestoredTableRoundTrips) {
+    auto manager = make_busy_manager(128);
+    ASSERT_TRUE(manager->save_snapshot(path_));
+    std::optional<PortTable> table;
+    ASSERT_TRUE(PortSnapshot::load(path_, table));
+    PortManager restored(std::move(*table));
+    restored.process_port_event(3, PortEvent::INIT_COMPLETE);
+    manager->process_port_event(3, PortEvent::INIT_COMPLETE);
+
+    // Overwrite the snapshot the live table is mapped from
+    ASSERT_TRUE(restored.save_snapshot(path_));
+    std::optional<PortTable> again;
+    ASSERT_TRUE(PortSnapshot::load(path_, again));
+    PortManager reloaded(std::move(*again));
+    expect_same_ports(*manager, reloaded);
+    EXPECT_EQ(reloaded.get_port_state(3), PortState::UP);
+}
+
+TEST_F(PortSnapshotTest, RejectsDamagedSnapshots) {
+    auto manager = make_busy_manager(32);
+    ASSERT_TRUE(manager->save_snapshot(path_));
+    std::optional<PortTable> table;
+
+    // One flipped byte in the arrays
+    std::string damaged = dir_ + "/damaged.snap";
+    std::filesystem::copy_file(path_, damaged);
+    {
+        std::fstream file(damaged, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(sizeof(PortSnapshotHeader) + 5 * sizeof(uint64_t) + 2);
+        file.put('\x55');
+    }
+    EXPECT_FALSE(PortSnapshot::load(damaged, table));
+
+    // Truncated
+    std::string truncated = dir_ + "/truncated.snap";
+    std::filesystem::copy_file(path_, truncated);
+    std::filesystem::resize_file(truncated, std::filesystem::file_size(path_) - 8);
+    EXPECT_FALSE(PortSnapshot::load(truncated, table));
+
+    // Another format version
+    std::string version = dir_ + "/version.snap";
+    std::filesystem::copy_file(path_, version);
+    {
+        std::fstream file(version, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(offsetof(PortSnapshotHeader, version));
+        file.put(static_cast<char>(kSnapshotVersion + 1));
+    }
+    EXPECT_FALSE(PortSnapshot::load(version, table));
+
+    EXPECT_FALSE(PortSnapshot::load(dir_ + "/missing.snap", table));
+    EXPECT_FALSE(table.has_value());
+}
+
+TEST_F(PortSnapshotTest, SnapshotIsConsistentWithConcurrentWriters) {
+    const int num_ports = 256;
+    PortManager manager(num_ports);
+    std::atomic<bool> stop(false);
+    std::thread writer([&]() {
+        static const PortEvent cycle[] = {PortEvent::POWER_ON, PortEvent::INIT_COMPLETE,
+                                          PortEvent::LINK_FLAP};
+        for (int i = 0; !stop.load(); i++) {
+            // Whole-table ranges: a point-in-time copy sees every port with
+            // the same transition count
+            manager.process_port_event_range(0, num_ports, cycle[i % 3]);
+        }
+    });
+    for (int round = 0; round < 20; round++) {
+        ASSERT_TRUE(manager.save_snapshot(path_));
+        std::optional<PortTable> table;
+        ASSERT_TRUE(PortSnapshot::load(path_, table));
+        for (int port = 1; port < num_ports; port++) {
+            ASSERT_EQ(table->get_transition_count(port), table->get_transition_count(0)) << "port " << port;
+        }
+    }
+    stop.store(true);
+    writer.join();
+}
+
+TEST_F(PortSnapshotTest, JournalReplayMovesSnapshotForward) {
+    auto manager = make_busy_manager(16);
+    ASSERT_TRUE(manager->save_snapshot(path_));
+
+    // Events after the snapshot are only in the journal
+    std::string journal_dir = dir_ + "/journal";
+    auto journal = std::make_shared<EventJournal>(journal_dir, 16, manager->get_metrics());
+    ASSERT_TRUE(journal->open());
+    manager->set_journal(journal);
+    manager->process_port_event(1, PortEvent::INIT_COMPLETE);
+    manager->process_port_event(2, PortEvent::LINK_FLAP);
+    journal->close();
+
+    std::optional<PortTable> table;
+    ASSERT_TRUE(PortSnapshot::load(path_, table));
+    PortManager restored(std::move(*table));
+    JournalReplay replay;
+    ASSERT_TRUE(EventJournal::replay(journal_dir, 16, replay));
+    restored.restore_states(replay.ports);
+    expect_same_ports(*manager, restored);
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "port_manager.h"
+#include "port_status_writer.h"
+#include "logger.h"
+#include <algorithm>
+#include <string>
+
+using namespace control_plane;
+
+namespace {
+
+// Concatenate every chunk, checking each against the chunk bound
+std::string drain(PortStatusWriter& writer, size_t* chunks = nullptr) {
+    std::string out;
+    size_t count = 0;
+    while (true) {
+        std::string_view chunk = writer.next_chunk();
+        if (chunk.empty()) {
+            break;
+        }
+        EXPECT_LE(chunk.size(), PortStatusWriter::kChunkBytes);
+        out.append(chunk);
+        count++;
+    }
+    EXPECT_TRUE(writer.done());
+    if (chunks) {
+        *chunks = count;
+    }
+    return out;
+}
+
+class PortStatusWriterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Logger::instance().set_level(LogLevel::ERROR);
+        // Ports 0-3 UP, 4-5 INIT, the rest DOWN
+        for (int port = 0; port < 6; port++) {
+            manager_.process_port_event(port, PortEvent::POWER_ON);
+        }
+        for (int port = 0; port < 4; port++) {
+            manager_.process_port_event(port, PortEvent::INIT_COMPLETE);
+        }
+    }
+
+    PortManager manager_{10};
+};
+
+} // namespace
+
+TEST_F(PortStatusWriterTest, PageReportsPortsAndNextOffset) {
+    PortStatusQuery query;
+    query.offset = 2;
+    query.limit = 3;
+    PortStatusWriter writer(manager_.get_port_table(), query, PortStatusFormat::PAGE);
+
+    // The header goes out on its own, before any port is read
+    std::string header(writer.next_chunk());
+    EXPECT_EQ(header, "{\"total_ports\":10,\"offset\":2,\"limit\":3,\"ports\":[");
+
+    std::string body = header + drain(writer);
+    EXPECT_NE(body.find("{\"port_id\":2,\"state\":\"UP\",\"transitions\":2,\"ms_in_state\":"),
+              std::string::npos) << body;
+    EXPECT_NE(body.find("{\"port_id\":4,\"state\":\"INIT\",\"transitions\":1,"), std::string::npos);
+    EXPECT_EQ(body.find("\"port_id\":5"), std::string::npos);
+    EXPECT_EQ(body.substr(body.size() - 18), "],\"next_offset\":5}");
+    EXPECT_EQ(std::count(body.begin(), body.end(), '{'), 4); // Envelope + 3 ports
+}
+
+TEST_F(PortStatusWriterTest, StateFilterScansToTheEnd) {
+    PortStatusQuery query;
+    query.state = PortState::INIT;
+    PortStatusWriter writer(manager_.get_port_table(), query, PortStatusFormat::PAGE);
+    std::string body = drain(writer);
+
+    EXPECT_NE(body.find("\"limit\":-1,\"state\":\"INIT\",\"ports\":[{\"port_id\":4,"),
+              std::string::npos) << body;
+    EXPECT_NE(body.find("},{\"port_id\":5,"), std::string::npos);
+    EXPECT_EQ(body.find("\"UP\""), std::string::npos);
+    EXPECT_EQ(body.substr(body.size() - 22), "}],\"next_offset\":null}");
+}
+
+TEST_F(PortStatusWriterTest, EmptyPageIsWellFormed) {
+    PortStatusQuery query;
+    query.offset = 50;
+    PortStatusWriter writer(manager_.get_port_table(), query, PortStatusFormat::PAGE);
+    EXPECT_EQ(drain(writer),
+              "{\"total_ports\":10,\"offset\":50,\"limit\":-1,\"ports\":[],\"next_offset\":null}");
+}
+
+TEST(PortStatusWriterStreamTest, StreamsLargeTableInBoundedChunks) {
+    Logger::instance().set_level(LogLevel::ERROR);
+    const int num_ports = 200000;
+    PortManager manager(num_ports);
+    manager.process_port_event_range(0, num_ports / 2, PortEvent::POWER_ON);
+
+    PortStatusWriter writer(manager.get_port_table(), PortStatusQuery{}, PortStatusFormat::NDJSON);
+    size_t chunks = 0;
+    std::string body = drain(writer, &chunks);
+
+    EXPECT_EQ(std::count(body.begin(), body.end(), '\n'), num_ports);
+    EXPECT_GT(chunks, body.size() / PortStatusWriter::kChunkBytes);
+    EXPECT_EQ(body.rfind("{\"port_id\":0,\"state\":\"INIT\",", 0), 0u);
+    EXPECT_NE(body.find("{\"port_id\":199999,\"state\":\"DOWN\",\"transitions\":0,"),
+              std::string::npos);
+
+    PortStatusQuery down;
+    down.state = PortState::DOWN;
+    PortStatusWriter filtered(manager.get_port_table(), down, PortStatusFormat::NDJSON);
+    std::string down_body = drain(filtered);
+    EXPECT_EQ(std::count(down_body.begin(), down_body.end(), '\n'), num_ports / 2);
+}
+
+TEST(PortStateParseTest, AcceptsNamesInAnyCase) {
+    PortState state = PortState::DOWN;
+    EXPECT_TRUE(parse_port_state("up", state));
+    EXPECT_EQ(state, PortState::UP);
+    EXPECT_TRUE(parse_port_state("Init", state));
+    EXPECT_EQ(state, PortState::INIT);
+    EXPECT_FALSE(parse_port_state("UNKNOWN", state));
+    EXPECT_FALSE(parse_port_state("", state));
+    EXPECT_EQ(state, PortState::INIT);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "port_table.h"
+#include "port_manager.h"
+
+using namespace control_plane;
+
+TEST(PortTableTest, AllPortsStartDown) {
+    PortTable table(16);
+    
+    std::vector<PortState> states(table.size());
+    table.copy_states(states.data());
+    for (int i = 0; i < table.size(); i++) {
+        EXPECT_EQ(states[i], PortState::DOWN);
+        EXPECT_EQ(table.get_transition_count(i), 0u);
+    }
+}
+
+TEST(PortTableTest, ApplyEventFollowsStateMachineRules) {
+    PortTable table(2);
+    int64_t t0 = PortTable::now_ns();
+    
+    EXPECT_TRUE(table.apply_event(1, PortEvent::POWER_ON, t0 + 100).changed());
+    EXPECT_EQ(table.get_state(1), PortState::INIT);
+    EXPECT_EQ(table.get_last_transition_ns(1), t0 + 100);
+    
+    // No transition: timestamp and count untouched
+    EXPECT_FALSE(table.apply_event(1, PortEvent::HEARTBEAT_OK, t0 + 200).changed());
+    EXPECT_EQ(table.get_last_transition_ns(1), t0 + 100);
+    EXPECT_EQ(table.get_transition_count(1), 1u);
+    
+    EXPECT_TRUE(table.apply_event(1, PortEvent::INIT_COMPLETE, t0 + 300).changed());
+    EXPECT_EQ(table.get_state(1), PortState::UP);
+    EXPECT_EQ(table.get_transition_count(1), 2u);
+    
+    // Neighbouring port unaffected
+    EXPECT_EQ(table.get_state(0), PortState::DOWN);
+    EXPECT_EQ(table.get_transition_count(0), 0u);
+}
+
+TEST(PortTableTest, NextStateMatchesStateMachine) {
+    const PortState states[] = {PortState::DOWN, PortState::INIT, PortState::UP};
+    const PortEvent events[] = {PortEvent::POWER_ON, PortEvent::INIT_COMPLETE,
+                                PortEvent::LINK_FLAP, PortEvent::HEARTBEAT_OK};
+    
+    for (PortState state : states) {
+        for (PortEvent event : events) {
+            PortTable table(1);
+            // Drive the table port into `state`
+            if (state != PortState::DOWN) table.apply_event(0, PortEvent::POWER_ON, 0);
+            if (state == PortState::UP) table.apply_event(0, PortEvent::INIT_COMPLETE, 0);
+            ASSERT_EQ(table.get_state(0), state);
+            
+            table.apply_event(0, event, 0);
+            EXPECT_EQ(table.get_state(0), PortStateMachine::next_state(state, event))
+                << port_state_to_string(state) << " + " << port_event_to_string(event);
+        }
+    }
+}
+
+TEST(PortTableTest, ManagerExposesPerPortHistory) {
+    PortManager manager(4);
+    auto before = std::chrono::steady_clock::now();
+    
+    manager.process_port_event(2, PortEvent::POWER_ON);
+    manager.process_port_event(2, PortEvent::INIT_COMPLETE);
+    
+    EXPECT_EQ(manager.get_transition_count(2), 2u);
+    EXPECT_EQ(manager.get_transition_count(1), 0u);
+    EXPECT_GE(manager.get_last_transition_time(2), before);
+    EXPECT_EQ(manager.get_transition_count(99), 0u); // Invalid port
+}
+
+TEST(PortTableTest, AtomicApplyPacksStateCountAndVersion) {
+    PortTable table(1);
+    int64_t t0 = PortTable::now_ns();
+    
+    PortTransition t = table.apply_event_atomic(0, PortEvent::POWER_ON, t0 + 10);
+    EXPECT_EQ(t.old_state, PortState::DOWN);
+    EXPECT_EQ(t.new_state, PortState::INIT);
+    EXPECT_EQ(table.get_version(0), 1u);
+    
+    // No-op events leave the word untouched
+    EXPECT_FALSE(table.apply_event_atomic(0, PortEvent::HEARTBEAT_OK, t0 + 20).changed());
+    EXPECT_EQ(table.get_version(0), 1u);
+    
+    table.apply_event_atomic(0, PortEvent::INIT_COMPLETE, t0 + 30);
+    EXPECT_EQ(table.get_state(0), PortState::UP);
+    EXPECT_EQ(table.get_transition_count(0), 2u);
+    EXPECT_EQ(table.get_version(0), 2u);
+    EXPECT_EQ(table.get_last_transition_ns(0), t0 + 30);
+}
+
+TEST(PortTableTest, TransitionTimeNeverMovesBackwards) {
+    // Writers read the clock before applying, so a racing writer can finish
+    // its transition later with an older timestamp: played here in sequence
+    PortTable table(1);
+    int64_t t0 = PortTable::now_ns();
+    
+    table.apply_event_atomic(0, PortEvent::POWER_ON, t0 + 300);
+    table.apply_event_atomic(0, PortEvent::INIT_COMPLETE, t0 + 200);
+    EXPECT_EQ(table.get_transition_count(0), 2u);
+    EXPECT_EQ(table.get_last_transition_ns(0), t0 + 300);
+    
+    table.apply_event_range_atomic(0, 1, PortEvent::LINK_FLAP, t0 + 100, nullptr);
+    EXPECT_EQ(table.get_state(0), PortState::DOWN);
+    EXPECT_EQ(table.get_last_transition_ns(0), t0 + 300);
+    
+    table.apply_event(0, PortEvent::POWER_ON, t0 + 400);
+    EXPECT_EQ(table.get_last_transition_ns(0), t0 + 400);
+}
+
+TEST(PortTableTest, WordFieldsRoundTrip) {
+    uint64_t word = PortTable::make_word(PortState::UP, 0xFFFFFFFFull, 0xABCDEF);
+    EXPECT_EQ(PortTable::word_state(word), PortState::UP);
+    EXPECT_EQ(PortTable::word_transitions(word), 0xFFFFFFFFull);
+    EXPECT_EQ(PortTable::word_version(word), 0xABCDEFu);
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include "config.h"
+#include "event_loop.h"
+#include "logger.h"
+#include "port_manager.h"
+#include "signal_watcher.h"
+#include "stop_token.h"
+#include <signal.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace control_plane;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+} // namespace
+
+TEST(StopTokenTest, WaitsUntilTimeoutWithoutStop) {
+    StopToken token;
+    auto started = Clock::now();
+    EXPECT_FALSE(token.wait_for(std::chrono::milliseconds(20)));
+    EXPECT_GE(Clock::now() - started, std::chrono::milliseconds(20));
+    EXPECT_FALSE(token.stop_requested());
+}
+
+TEST(StopTokenTest, StopWakesEveryWaiter) {
+    StopToken token;
+    std::atomic<int> woken(0);
+    std::vector<std::thread> waiters;
+    for (int i = 0; i < 3; i++) {
+        waiters.emplace_back([&]() {
+            if (token.wait_for(std::chrono::seconds(30))) {
+                woken++;
+            }
+        });
+    }
+    std::thread forever([&]() {
+        token.wait();
+        woken++;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    auto stopped = Clock::now();
+    token.request_stop();
+    for (auto& waiter : waiters) {
+        waiter.join();
+    }
+    forever.join();
+    EXPECT_LT(Clock::now() - stopped, std::chrono::milliseconds(50));
+    EXPECT_EQ(woken.load(), 4);
+
+    // Later waits return at once until reset
+    EXPECT_TRUE(token.wait_for(std::chrono::seconds(30)));
+    token.reset();
+    EXPECT_FALSE(token.wait_for(std::chrono::milliseconds(1)));
+}
+
+TEST(EventLoopShutdownTest, StopReturnsWithinMillisecondsOfLongTicks) {
+    Logger::instance().set_level(LogLevel::ERROR);
+    Config config;
+    config.ports_count = 1000;
+    config.tick_ms = 10000;       // Longest allowed tick
+    config.flap_probability = 1.0; // Every UP port flaps...
+    config.flap_min_ms = 60000;    // ...for a minute
+    config.flap_max_ms = 60000;
+    config.seed = 1;
+    for (SimulationMode mode : {SimulationMode::REALTIME, SimulationMode::DISCRETE}) {
+        config.mode = simulation_mode_to_string(mode);
+        config.duration_ticks = mode == SimulationMode::DISCRETE ? UINT64_MAX : 0;
+        auto port_manager = std::make_shared<PortManager>(config.ports_count);
+        EventLoop loop(port_manager, config);
+        loop.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        auto stopping = Clock::now();
+        loop.stop();
+        auto elapsed = Clock::now() - stopping;
+        EXPECT_LT(elapsed, std::chrono::milliseconds(20)) << config.mode << ": stop took "
+            << std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() << " us";
+        EXPECT_FALSE(loop.is_running());
+    }
+    Logger::instance().set_level(LogLevel::INFO);
+}
+
+TEST(EventLoopShutdownTest, FinishedCallbackRunsAfterDuration) {
+    Logger::instance().set_level(LogLevel::ERROR);
+    Config config;
+    config.ports_count = 16;
+    config.mode = "discrete";
+    config.duration_ticks = 500;
+    config.seed = 1;
+    auto port_manager = std::make_shared<PortManager>(config.ports_count);
+    EventLoop loop(port_manager, config);
+    StopToken done;
+    loop.set_finished_callback([&]() { done.request_stop(); });
+    loop.start();
+    EXPECT_TRUE(done.wait_for(std::chrono::seconds(10)));
+    EXPECT_TRUE(loop.is_finished());
+    EXPECT_EQ(loop.get_tick_count(), config.duration_ticks);
+    loop.stop();
+    Logger::instance().set_level(LogLevel::INFO);
+}
+
+TEST(SignalWatcherTest, DeliversSignalsThroughTheWatcherThread) {
+    // Ignored as well as blocked, so that a stray thread that still accepts
+    // it drops it instead of terminating the test run
+    struct sigaction previous{};
+    struct sigaction ignore{};
+    ignore.sa_handler = SIG_IGN;
+    sigaction(SIGUSR2, &ignore, &previous);
+    {
+        SignalWatcher watcher({SIGUSR2});
+        // Sent before start: held pending, then delivered
+        kill(getpid(), SIGUSR2);
+
+        StopToken received;
+        std::atomic<int> signal_number(0);
+        std::thread::id handler_thread;
+        ASSERT_TRUE(watcher.start([&](int signal) {
+            handler_thread = std::this_thread::get_id();
+            signal_number = signal;
+            received.request_stop();
+        }));
+        EXPECT_TRUE(received.wait_for(std::chrono::seconds(5)));
+        EXPECT_EQ(signal_number.load(), SIGUSR2);
+        EXPECT_NE(handler_thread, std::this_thread::get_id());
+
+        // stop() returns promptly with no signal pending
+        auto stopping = Clock::now();
+        watcher.stop();
+        EXPECT_LT(Clock::now() - stopping, std::chrono::milliseconds(50));
+    }
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGUSR2);
+    pthread_sigmask(SIG_UNBLOCK, &set, nullptr);
+    sigaction(SIGUSR2, &previous, nullptr);
+}
@@ -141,3 +141,59 @@ TEST_F(ThreadSafetyTest, MetricsThreadSafety) {
     uint64_t counter_value = port_manager->get_metrics().get_counter("test_counter");
     EXPECT_EQ(counter_value, num_threads * 100);
 }
+
+TEST_F(ThreadSafetyTest, LockFreeConcurrentEventProcessing) {
+    auto lock_free = std::make_unique<PortManager>(8, PortSyncMode::LOCK_FREE);
+    const int num_threads = 8;
+    const int events_per_thread = 1000;
+    std::vector<std::thread> threads;
+    
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&lock_free, t, events_per_thread]() {
+            for (int i = 0; i < events_per_thread; i++) {
+                int port_id = (i + t) % lock_free->get_num_ports();
+                static const PortEvent cycle[] = {PortEvent::POWER_ON, PortEvent::INIT_COMPLETE,
+                                                  PortEvent::HEARTBEAT_OK, PortEvent::LINK_FLAP};
+                lock_free->process_port_event(port_id, cycle[(i / 8 + t) % 4]);
+            }
+        });
+    }
+    
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    EXPECT_EQ(lock_free->get_total_events_processed(),
+              static_cast<uint64_t>(num_threads * events_per_thread));
+    
+    // Every successful CAS was counted exactly once, both per port and globally
+    uint64_t port_transitions = 0;
+    for (int port_id = 0; port_id < lock_free->get_num_ports(); port_id++) {
+        port_transitions += lock_free->get_transition_count(port_id);
+    }
+    EXPECT_EQ(port_transitions, lock_free->get_metrics().get_counter("state_transitions_total"));
+}
+
+TEST_F(ThreadSafetyTest, LockFreeRacingFlapsTransitionOnce) {
+    // Many threads flap the same UP port: exactly one of them wins the CAS
+    auto lock_free = std::make_unique<PortManager>(1, PortSyncMode::LOCK_FREE);
+    lock_free->process_port_event(0, PortEvent::POWER_ON);
+    lock_free->process_port_event(0, PortEvent::INIT_COMPLETE);
+    
+    std::atomic<int> winners(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&lock_free, &winners]() {
+            if (lock_free->process_port_event(0, PortEvent::LINK_FLAP)) {
+                winners.fetch_add(1);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    EXPECT_EQ(winners.load(), 1);
+    EXPECT_EQ(lock_free->get_port_state(0), PortState::DOWN);
+    EXPECT_EQ(lock_free->get_transition_count(0), 3u);
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "config.h"
+#include "event_loop.h"
+#include "logger.h"
+#include "port_manager.h"
+#include "stop_token.h"
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace control_plane;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class TickSchedulerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Logger::instance().set_level(LogLevel::ERROR);
+        config_.mode = "realtime";
+        config_.seed = 1;
+        config_.worker_threads = 1;
+    }
+
+    void TearDown() override {
+        Logger::instance().set_level(LogLevel::INFO);
+    }
+
+    // A loop whose ticks take far longer than tick_ms: every port flaps
+    // each flap cycle, with timers expiring on most ticks
+    void overload() {
+        config_.ports_count = 200000;
+        config_.tick_ms = 1;
+        config_.flap_probability = 1.0;
+        config_.flap_min_ms = 1;
+        config_.flap_max_ms = 5;
+        config_.init_latency_min_ms = 1;
+        config_.init_latency_max_ms = 5;
+    }
+
+    Config config_;
+};
+
+} // namespace
+
+TEST_F(TickSchedulerTest, TicksFollowTheWallClockWithoutDrift) {
+    config_.ports_count = 64;
+    config_.tick_ms = 5;
+    config_.duration_ticks = 200;
+    auto port_manager = std::make_shared<PortManager>(config_.ports_count);
+    EventLoop loop(port_manager, config_);
+    StopToken done;
+    loop.set_finished_callback([&]() { done.request_stop(); });
+
+    auto started = Clock::now();
+    loop.start();
+    ASSERT_TRUE(done.wait_for(std::chrono::seconds(10)));
+    auto elapsed = Clock::now() - started;
+    loop.stop();
+
+    // Relative sleeps would add the tick's own run time (and the wakeup
+    // latency) to every one of the 200 periods
+    EXPECT_GE(elapsed, std::chrono::milliseconds(1000));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(1000 + 50))
+        << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms";
+
+    Metrics& metrics = port_manager->get_metrics();
+    EXPECT_EQ(metrics.value(metrics.register_histogram("tick_lag_seconds")).count, 200u);
+    EXPECT_EQ(metrics.value(metrics.register_histogram("tick_jitter_seconds")).count, 199u);
+    EXPECT_FALSE(loop.is_lagging());
+}
+
+TEST_F(TickSchedulerTest, SkipPolicyKeepsTheTickCountOnTheWallClock) {
+    overload();
+    config_.tick_catch_up = "skip";
+    auto port_manager = std::make_shared<PortManager>(config_.ports_count);
+    EventLoop loop(port_manager, config_);
+
+    auto started = Clock::now();
+    loop.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    auto elapsed = Clock::now() - started;
+    uint64_t ticks = loop.get_tick_count();
+    loop.stop();
+
+    // Ticks that fell behind are skipped rather than run, so the count
+    // tracks elapsed time to within the one tick still running
+    uint64_t expected = static_cast<uint64_t>(elapsed / std::chrono::milliseconds(config_.tick_ms));
+    uint64_t missed = port_manager->get_metrics().get_counter("ticks_missed_total");
+    EXPECT_GT(missed, 0u);
+    EXPECT_GT(ticks, expected / 2) << "ticks " << ticks << ", expected ~" << expected;
+    EXPECT_LE(ticks, expected + 1);
+}
+
+TEST_F(TickSchedulerTest, BurstPolicyRunsEveryTickLate) {
+    overload();
+    config_.tick_catch_up = "burst";
+    auto port_manager = std::make_shared<PortManager>(config_.ports_count);
+    EventLoop loop(port_manager, config_);
+
+    auto started = Clock::now();
+    loop.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    auto elapsed = Clock::now() - started;
+    uint64_t ticks = loop.get_tick_count();
+    loop.stop();
+
+    // Every tick runs, so the count falls behind the wall clock, and the
+    // ticks that ran a slot or more late are counted as missed
+    uint64_t expected = static_cast<uint64_t>(elapsed / std::chrono::milliseconds(config_.tick_ms));
+    uint64_t missed = port_manager->get_metrics().get_counter("ticks_missed_total");
+    EXPECT_LT(ticks, expected);
+    EXPECT_GT(missed, 0u);
+    EXPECT_LE(missed, ticks);
+    EXPECT_GE(loop.get_tick_lag(), std::chrono::milliseconds(config_.tick_ms));
+}
+
+TEST_F(TickSchedulerTest, SustainedLagMarksTheLoopLagging) {
+    overload();
+    config_.tick_catch_up = "burst";
+    config_.tick_lag_threshold_ms = 5;
+    config_.tick_lag_sustain_ms = 50;
+    auto port_manager = std::make_shared<PortManager>(config_.ports_count);
+    EventLoop loop(port_manager, config_);
+    loop.start();
+
+    auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (!loop.is_lagging() && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_TRUE(loop.is_lagging());
+    EXPECT_GE(loop.get_tick_lag(), std::chrono::milliseconds(config_.tick_lag_threshold_ms));
+    loop.stop();
+}
+
+TEST_F(TickSchedulerTest, ThresholdZeroNeverLags) {
+    overload();
+    config_.tick_lag_threshold_ms = 0;
+    config_.tick_lag_sustain_ms = 0;
+    auto port_manager = std::make_shared<PortManager>(config_.ports_count);
+    EventLoop loop(port_manager, config_);
+    loop.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_FALSE(loop.is_lagging());
+    loop.stop();
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "timing_wheel.h"
+#include <vector>
+
+using namespace control_plane;
+
+class TimingWheelTest : public ::testing::Test {
+protected:
+    // Advance one tick at a time, returning the tick each timer id fired on
+    std::vector<uint64_t> run_until(TimingWheel& wheel, uint64_t end_tick) {
+        std::vector<uint64_t> fired_at(wheel.get_capacity(), 0);
+        std::vector<TimingWheel::Expired> expired;
+        for (uint64_t tick = wheel.get_current_tick() + 1; tick <= end_tick; tick++) {
+            expired.clear();
+            wheel.advance(tick, expired);
+            for (const auto& timer : expired) {
+                fired_at[timer.id] = tick;
+            }
+        }
+        return fired_at;
+    }
+};
+
+TEST_F(TimingWheelTest, FiresAtDeadline) {
+    TimingWheel wheel(4);
+    wheel.schedule(0, 1);
+    wheel.schedule(1, 5);
+    wheel.schedule(2, 255);
+
+    auto fired_at = run_until(wheel, 300);
+
+    EXPECT_EQ(fired_at[0], 1u);
+    EXPECT_EQ(fired_at[1], 5u);
+    EXPECT_EQ(fired_at[2], 255u);
+    EXPECT_EQ(fired_at[3], 0u); // Never scheduled
+    EXPECT_EQ(wheel.get_pending_count(), 0u);
+}
+
+TEST_F(TimingWheelTest, CascadesAcrossLevels) {
+    TimingWheel wheel(5, 100);
+    wheel.schedule(0, 256);       // Crosses into level 1
+    wheel.schedule(1, 300);
+    wheel.schedule(2, 65536);     // Level 2 boundary
+    wheel.schedule(3, 70001);
+    wheel.schedule(4, 65536 + 256 + 7);
+
+    auto fired_at = run_until(wheel, 70100);
+
+    EXPECT_EQ(fired_at[0], 256u);
+    EXPECT_EQ(fired_at[1], 300u);
+    EXPECT_EQ(fired_at[2], 65536u);
+    EXPECT_EQ(fired_at[3], 70001u);
+    EXPECT_EQ(fired_at[4], 65536u + 256 + 7);
+}
+
+TEST_F(TimingWheelTest, AdvanceByManyTicksReportsInDeadlineOrder) {
+    TimingWheel wheel(3);
+    wheel.schedule(0, 900);
+    wheel.schedule(1, 10);
+    wheel.schedule(2, 300);
+
+    std::vector<TimingWheel::Expired> expired;
+    wheel.advance(1000, expired);
+
+    ASSERT_EQ(expired.size(), 3u);
+    EXPECT_EQ(expired[0].id, 1u);
+    EXPECT_EQ(expired[1].id, 2u);
+    EXPECT_EQ(expired[2].id, 0u);
+}
+
+TEST_F(TimingWheelTest, RescheduleReplacesPendingDeadline) {
+    TimingWheel wheel(1);
+    wheel.schedule(0, 50, 1);
+    wheel.schedule(0, 20, 2);
+    EXPECT_EQ(wheel.get_pending_count(), 1u);
+    EXPECT_EQ(wheel.get_kind(0), 2);
+
+    std::vector<TimingWheel::Expired> expired;
+    wheel.advance(100, expired);
+
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0].kind, 2);
+    EXPECT_EQ(wheel.get_current_tick(), 100u);
+}
+
+TEST_F(TimingWheelTest, CancelRemovesTimer) {
+    TimingWheel wheel(2);
+    wheel.schedule(0, 10);
+    wheel.schedule(1, 10);
+    wheel.cancel(0);
+    wheel.cancel(0); // Idempotent
+
+    EXPECT_FALSE(wheel.is_scheduled(0));
+    EXPECT_TRUE(wheel.is_scheduled(1));
+
+    std::vector<TimingWheel::Expired> expired;
+    wheel.advance(10, expired);
+
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0].id, 1u);
+}
+
+TEST_F(TimingWheelTest, PastDeadlineFiresOnNextTick) {
+    TimingWheel wheel(1, 500);
+    wheel.schedule(0, 10);
+
+    std::vector<TimingWheel::Expired> expired;
+    wheel.advance(501, expired);
+
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0].id, 0u);
+}
+
+TEST_F(TimingWheelTest, ExpiredTimerCanBeRescheduledFromCallback) {
+    TimingWheel wheel(1);
+    wheel.schedule(0, 5);
+
+    // Periodic timer: reschedule every 5 ticks
+    int fires = 0;
+    std::vector<TimingWheel::Expired> expired;
+    for (uint64_t tick = 1; tick <= 100; tick++) {
+        expired.clear();
+        wheel.advance(tick, expired);
+        for (const auto& timer : expired) {
+            EXPECT_EQ(tick % 5, 0u);
+            wheel.schedule(timer.id, tick + 5);
+            fires++;
+        }
+    }
+
+    EXPECT_EQ(fires, 20);
+}
+
+TEST_F(TimingWheelTest, ManyTimersAllFireExactlyOnce) {
+    const uint32_t num_timers = 100000;
+    TimingWheel wheel(num_timers);
+    for (uint32_t id = 0; id < num_timers; id++) {
+        wheel.schedule(id, 1 + (id * 7919ull) % 200000);
+    }
+
+    auto fired_at = run_until(wheel, 200001);
+
+    for (uint32_t id = 0; id < num_timers; id++) {
+        ASSERT_EQ(fired_at[id], 1 + (id * 7919ull) % 200000) << "timer " << id;
+    }
+    EXPECT_EQ(wheel.get_pending_count(), 0u);
+}
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include "transition_kernel.h"
+#include "port_manager.h"
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace control_plane;
+
+namespace {
+
+// Random state words: any state, arbitrary counts and versions (including
+// values about to wrap)
+std::vector<uint64_t> random_words(std::mt19937& rng, size_t count) {
+    std::uniform_int_distribution<int> state_dist(0, kNumPortStates - 1);
+    std::uniform_int_distribution<uint64_t> field_dist;
+    std::vector<uint64_t> words(count);
+    for (auto& word : words) {
+        uint64_t transitions = field_dist(rng) % 4 == 0 ? PortTable::kTransitionMask : field_dist(rng);
+        uint32_t version = static_cast<uint32_t>(field_dist(rng) % 4 == 0 ? PortTable::kVersionMask
+                                                                           : field_dist(rng));
+        word = PortTable::make_word(static_cast<PortState>(state_dist(rng)), transitions, version);
+    }
+    return words;
+}
+
+} // namespace
+
+TEST(TransitionKernelTest, TableMatchesStateMachineRules) {
+    for (int s = 0; s < kNumPortStates; s++) {
+        for (int e = 0; e < kNumPortEvents; e++) {
+            PortState state = static_cast<PortState>(s);
+            PortEvent event = static_cast<PortEvent>(e);
+            PortStateMachine machine(0);
+            // Drive a fresh machine to `state` first
+            if (state != PortState::DOWN) machine.process_event(PortEvent::POWER_ON);
+            if (state == PortState::UP) machine.process_event(PortEvent::INIT_COMPLETE);
+            ASSERT_EQ(machine.get_state(), state);
+
+            machine.process_event(event);
+            EXPECT_EQ(machine.get_state(), PortStateMachine::next_state(state, event));
+        }
+    }
+}
+
+TEST(TransitionKernelTest, MatchesScalarReference) {
+    std::mt19937 rng(99);
+    for (size_t count : {0, 1, 3, 4, 5, 63, 64, 65, 257, 1000}) {
+        for (int e = 0; e < kNumPortEvents; e++) {
+            PortEvent event = static_cast<PortEvent>(e);
+            std::vector<uint64_t> input = random_words(rng, count);
+
+            // Offset by one word so the vector loads are unaligned
+            std::vector<uint64_t> fast(count + 1);
+            std::copy(input.begin(), input.end(), fast.begin() + 1);
+            std::vector<uint64_t> reference = input;
+            std::vector<uint64_t> fast_mask((count + 63) / 64 + 1, ~0ull);
+            std::vector<uint64_t> reference_mask((count + 63) / 64 + 1, ~0ull);
+
+            BulkTransitionResult a = apply_event_to_words(fast.data() + 1, count, event,
+                                                          fast_mask.data());
+            BulkTransitionResult b = apply_event_to_words_scalar(reference.data(), count, event,
+                                                                 reference_mask.data());
+
+            ASSERT_TRUE(std::equal(reference.begin(), reference.end(), fast.begin() + 1))
+                << "count " << count << " event " << e;
+            EXPECT_EQ(fast_mask, reference_mask);
+            EXPECT_EQ(a.transitions, b.transitions);
+            for (int s = 0; s < kNumPortStates; s++) {
+                EXPECT_EQ(a.from_state[s], b.from_state[s]);
+            }
+        }
+    }
+}
+
+TEST(TransitionKernelTest, ScalarReferenceFollowsPortTableRules) {
+    std::mt19937 rng(5);
+    std::vector<uint64_t> words = random_words(rng, 200);
+    std::vector<uint64_t> original = words;
+    std::vector<uint64_t> mask(4);
+
+    BulkTransitionResult result = apply_event_to_words_scalar(words.data(), words.size(),
+                                                              PortEvent::LINK_FLAP, mask.data());
+
+    uint64_t transitions = 0;
+    for (size_t i = 0; i < words.size(); i++) {
+        PortState old_state = PortTable::word_state(original[i]);
+        bool changed = old_state != PortState::DOWN;
+        EXPECT_EQ(((mask[i / 64] >> (i % 64)) & 1) != 0, changed);
+        if (!changed) {
+            EXPECT_EQ(words[i], original[i]);
+            continue;
+        }
+        transitions++;
+        EXPECT_EQ(PortTable::word_state(words[i]), PortState::DOWN);
+        EXPECT_EQ(PortTable::word_transitions(words[i]),
+                  (PortTable::word_transitions(original[i]) + 1) & PortTable::kTransitionMask);
+        EXPECT_EQ(PortTable::word_version(words[i]),
+                  (PortTable::word_version(original[i]) + 1) & PortTable::kVersionMask);
+    }
+    EXPECT_EQ(result.transitions, transitions);
+    EXPECT_EQ(result.from_state[0], 0u);
+}
+
+class PortRangeTest : public ::testing::TestWithParam<PortSyncMode> {};
+
+TEST_P(PortRangeTest, AppliesEventToRange) {
+    PortManager manager(300, GetParam());
+    manager.process_port_event(10, PortEvent::POWER_ON);
+
+    std::vector<uint64_t> mask(4);
+    PortEventBatchSummary summary = manager.process_port_event_range(0, 200, PortEvent::POWER_ON,
+                                                                     mask.data());
+
+    EXPECT_EQ(summary.applied, 200u);
+    EXPECT_EQ(summary.transitions, 199u);
+    EXPECT_EQ(summary.rejected, 0u);
+    for (int port_id = 0; port_id < 300; port_id++) {
+        PortState expected = port_id < 200 ? PortState::INIT : PortState::DOWN;
+        EXPECT_EQ(manager.get_port_state(port_id), expected) << "port " << port_id;
+    }
+    EXPECT_EQ(mask[0], ~0ull & ~(1ull << 10));
+    EXPECT_EQ(mask[3], (1ull << (200 - 192)) - 1);
+    EXPECT_EQ(manager.get_transition_count(10), 1u);
+
+    const Metrics& metrics = manager.get_metrics();
+    EXPECT_EQ(metrics.get_counter("events_processed_total"), 201u);
+    EXPECT_EQ(metrics.get_counter("state_transitions_total"), 200u);
+    EXPECT_DOUBLE_EQ(metrics.get_gauge("ports_down"), 100.0);
+    EXPECT_DOUBLE_EQ(metrics.get_gauge("ports_init"), 200.0);
+}
+
+TEST_P(PortRangeTest, RejectsOutOfRangeSpan) {
+    PortManager manager(16, GetParam());
+    EXPECT_EQ(manager.process_port_event_range(8, 9, PortEvent::POWER_ON).rejected, 9u);
+    EXPECT_EQ(manager.process_port_event_range(-1, 4, PortEvent::POWER_ON).rejected, 4u);
+    EXPECT_EQ(manager.get_total_events_processed(), 0u);
+    EXPECT_EQ(manager.get_port_state(8), PortState::DOWN);
+}
+
+TEST_P(PortRangeTest, ConcurrentRangeAndSingleEvents) {
+    const int num_ports = 512;
+    PortManager manager(num_ports, GetParam());
+
+    // Per-port writers racing chassis-wide events must leave the gauges
+    // consistent with the table
+    std::vector<std::thread> threads;
+    threads.emplace_back([&manager]() {
+        for (int round = 0; round < 50; round++) {
+            manager.process_port_event_range(0, num_ports, PortEvent::POWER_ON);
+            manager.process_port_event_range(0, num_ports, PortEvent::INIT_COMPLETE);
+            manager.process_port_event_range(100, 300, PortEvent::LINK_FLAP);
+        }
+    });
+    threads.emplace_back([&manager]() {
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<int> port_dist(0, num_ports - 1);
+        std::uniform_int_distribution<int> event_dist(0, kNumPortEvents - 1);
+        for (int i = 0; i < 20000; i++) {
+            manager.process_port_event(port_dist(rng), static_cast<PortEvent>(event_dist(rng)));
+        }
+    });
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    int counts[kNumPortStates] = {0, 0, 0};
+    uint64_t transitions = 0;
+    for (int port_id = 0; port_id < num_ports; port_id++) {
+        counts[static_cast<int>(manager.get_port_state(port_id))]++;
+        transitions += manager.get_transition_count(port_id);
+    }
+    const Metrics& metrics = manager.get_metrics();
+    EXPECT_DOUBLE_EQ(metrics.get_gauge("ports_down"), counts[0]);
+    EXPECT_DOUBLE_EQ(metrics.get_gauge("ports_init"), counts[1]);
+    EXPECT_DOUBLE_EQ(metrics.get_gauge("ports_up"), counts[2]);
+    EXPECT_EQ(metrics.get_counter("state_transitions_total"), transitions);
+}
+
+INSTANTIATE_TEST_SUITE_P(SyncModes, PortRangeTest,
+                         ::testing::Values(PortSyncMode::MUTEX, PortSyncMode::LOCK_FREE));
@@ -0,0 +1,88 @@
+// Converts a binary log stream (log_format: binary) back into JSON lines.
+//
+// Usage: log_decoder [FILE]   (reads stdin if FILE is omitted or "-")
+//   control_plane_sim --log-format binary | log_decoder | jq .
+
+#include "log_decoder.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+using namespace control_plane;
+
+namespace {
+
+bool write_all(const std::string& data) {
+    const char* ptr = data.data();
+    size_t remaining = data.size();
+    while (remaining > 0) {
+        ssize_t n = ::write(STDOUT_FILENO, ptr, remaining);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        ptr += n;
+        remaining -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc > 2 || (argc == 2 && (std::strcmp(argv[1], "-h") == 0 ||
+                                   std::strcmp(argv[1], "--help") == 0))) {
+        std::cerr << "Usage: " << argv[0] << " [FILE]\n"
+                  << "Convert a binary control plane log to JSON lines (stdin if no FILE)\n";
+        return argc > 2 ? 1 : 0;
+    }
+
+    int fd = STDIN_FILENO;
+    if (argc == 2 && std::strcmp(argv[1], "-") != 0) {
+        fd = ::open(argv[1], O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "log_decoder: cannot open " << argv[1] << ": " << std::strerror(errno) << "\n";
+            return 1;
+        }
+    }
+
+    BinaryLogDecoder decoder;
+    std::string out;
+    char buffer[1 << 16];
+    while (true) {
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "log_decoder: read failed: " << std::strerror(errno) << "\n";
+            return 1;
+        }
+        if (n == 0) {
+            break;
+        }
+
+        out.clear();
+        bool ok = decoder.feed(buffer, static_cast<size_t>(n), out);
+        if (!write_all(out)) {
+            return 1;
+        }
+        if (!ok) {
+            std::cerr << "log_decoder: " << decoder.error() << " after "
+                      << decoder.records_decoded() << " records\n";
+            return 1;
+        }
+    }
+
+    if (!decoder.at_frame_boundary()) {
+        std::cerr << "log_decoder: stream ends mid-record after "
+                  << decoder.records_decoded() << " records\n";
+        return 1;
+    }
+    return 0;
+}